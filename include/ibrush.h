@@ -17,6 +17,15 @@ class BrushCreator :
 {
 public:
 	virtual scene::INodePtr createBrush() = 0;
+
+	/**
+	 * Rebuilds the b-reps of all brushes whose planes changed since the last
+	 * call, working on several brushes at once. Call this after transforming
+	 * or creating many brushes, before their bounds or geometry are queried.
+	 * Brushes are otherwise evaluated one by one on first access.
+	 * Must be called from the main thread.
+	 */
+	virtual void evaluatePendingBReps() = 0;
 };
 
 // The structure defining a single corner point of an IWinding
@@ -23,6 +23,27 @@ typedef void (*GraphTraversalFunc) (const scene::INodePtr& root, scene::NodeVisi
 namespace map
 {
 
+struct EntitySnapshot;
+struct BrushSnapshot;
+struct PatchSnapshot;
+
+/**
+ * The data of a primitive as read from a map file, which has not been turned
+ * into a scene node yet. See PrimitiveParser::parseDeferred().
+ */
+class ParsedPrimitive
+{
+public:
+	virtual ~ParsedPrimitive() {}
+
+	/**
+	 * Creates the scene node from the parsed data. Since this involves the
+	 * brush/patch creator modules, this must be called from the main thread.
+	 */
+	virtual scene::INodePtr createNode() const = 0;
+};
+typedef std::shared_ptr<ParsedPrimitive> ParsedPrimitivePtr;
+
 /**
  * A Primitive parser is able to create a primitive (brush, patch) from a given token stream.
  * The initial token, e.g. "brushDef3" is already parsed when the stream is passed to the
@@ -49,6 +70,27 @@ public:
 	 * Creates and returns a primitive node according to the encountered token.
 	 */
     virtual scene::INodePtr parse(parser::DefTokeniser& tok) const = 0;
+
+	/**
+	 * Returns true if this parser supports parseDeferred(). Parsers which need
+	 * to access other modules while reading the tokens must return false here.
+	 */
+	virtual bool canParseDeferred() const
+	{
+		return false;
+	}
+
+	/**
+	 * Reads the primitive from the token stream without creating the scene node,
+	 * which is done by calling createNode() on the returned object later on.
+	 * Other than parse() this doesn't touch any modules and may be called from
+	 * worker threads. Only invoked if canParseDeferred() returns true, returns
+	 * an empty pointer on failure.
+	 */
+	virtual ParsedPrimitivePtr parseDeferred(parser::DefTokeniser& tok) const
+	{
+		return ParsedPrimitivePtr();
+	}
 };
 typedef std::shared_ptr<PrimitiveParser> PrimitiveParserPtr;
 
@@ -72,6 +114,9 @@ typedef std::shared_ptr<PrimitiveParser> PrimitiveParserPtr;
  *    ...
  * endWriteMap
  *
+ * The scene elements are passed as snapshots (see imapsnapshot.h), the
+ * writer doesn't access the scene and can be used from any thread.
+ *
  * Failure Handling: when the IMapWriter implementation encounters
  * errors during write (e.g. a visited node is not exportable) a
  * IMapWriter::FailureException will be thrown. The calling code
@@ -106,16 +151,16 @@ public:
 	virtual void endWriteMap(std::ostream& stream) = 0;
 
 	// Entity export methods
-	virtual void beginWriteEntity(const Entity& entity, std::ostream& stream) = 0;
-	virtual void endWriteEntity(const Entity& entity, std::ostream& stream) = 0;
+	virtual void beginWriteEntity(const EntitySnapshot& entity, std::ostream& stream) = 0;
+	virtual void endWriteEntity(const EntitySnapshot& entity, std::ostream& stream) = 0;
 
 	// Brush export methods
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream) = 0;
-	virtual void endWriteBrush(const IBrush& brush, std::ostream& stream) = 0;
+	virtual void beginWriteBrush(const BrushSnapshot& brush, std::ostream& stream) = 0;
+	virtual void endWriteBrush(const BrushSnapshot& brush, std::ostream& stream) = 0;
 
 	// Patch export methods
-	virtual void beginWritePatch(const IPatch& patch, std::ostream& stream) = 0;
-	virtual void endWritePatch(const IPatch& patch, std::ostream& stream) = 0;
+	virtual void beginWritePatch(const PatchSnapshot& patch, std::ostream& stream) = 0;
+	virtual void endWritePatch(const PatchSnapshot& patch, std::ostream& stream) = 0;
 };
 typedef std::shared_ptr<IMapWriter> IMapWriterPtr;
 
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ibrush.h"
+#include "ipatch.h"
+#include "ientity.h"
+#include "math/Plane3.h"
+#include "math/Matrix4.h"
+
+#include <string>
+#include <vector>
+
+namespace map
+{
+
+/**
+ * The map writers don't work on the scene nodes directly, they are passed
+ * copies of the data they need to export. These snapshots are taken on the
+ * main thread, which allows the actual formatting to happen on a worker
+ * thread while the user continues to edit the map.
+ */
+
+// The spawnargs of an entity
+struct EntitySnapshot
+{
+	Entity::KeyValuePairs keyValues;
+
+	EntitySnapshot()
+	{}
+
+	explicit EntitySnapshot(const Entity& entity)
+	{
+		entity.forEachKeyValue([this](const std::string& key, const std::string& value)
+		{
+			keyValues.push_back(std::make_pair(key, value));
+		});
+	}
+};
+
+// The contributing faces of a brush (faces with degenerate windings are not part of the snapshot)
+struct BrushSnapshot
+{
+	struct Face
+	{
+		Plane3 plane;
+		Matrix4 texdef;
+		std::string shader;
+
+		// The first three winding points, used by the formats defining the plane by points
+		Vector3 points[3];
+	};
+
+	std::vector<Face> faces;
+	IBrush::DetailFlag detailFlag;
+
+	BrushSnapshot() :
+		detailFlag(IBrush::Structural)
+	{}
+
+	explicit BrushSnapshot(const IBrush& brush) :
+		detailFlag(brush.getDetailFlag())
+	{
+		faces.reserve(brush.getNumFaces());
+
+		for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+		{
+			const IFace& face = brush.getFace(i);
+			const IWinding& winding = face.getWinding();
+
+			if (winding.size() <= 2)
+			{
+				continue;
+			}
+
+			faces.push_back(Face());
+			Face& snapshot = faces.back();
+
+			snapshot.plane = face.getPlane3();
+			snapshot.texdef = face.getTexDefMatrix();
+			snapshot.shader = face.getShader();
+
+			for (std::size_t p = 0; p < 3; ++p)
+			{
+				snapshot.points[p] = winding[p].vertex;
+			}
+		}
+	}
+};
+
+// The shader, dimensions and control points of a patch
+struct PatchSnapshot
+{
+	std::string shader;
+
+	std::size_t width;
+	std::size_t height;
+
+	bool subdivisionsFixed;
+	Subdivisions subdivisions;
+
+	// The control points, stored row by row
+	std::vector<PatchControl> controlPoints;
+
+	PatchSnapshot() :
+		width(0),
+		height(0),
+		subdivisionsFixed(false)
+	{}
+
+	explicit PatchSnapshot(const IPatch& patch) :
+		shader(patch.getShader()),
+		width(patch.getWidth()),
+		height(patch.getHeight()),
+		subdivisionsFixed(patch.subdivionsFixed()),
+		subdivisions(patch.getSubdivisions())
+	{
+		controlPoints.reserve(width * height);
+
+		for (std::size_t r = 0; r < height; ++r)
+		{
+			for (std::size_t c = 0; c < width; ++c)
+			{
+				controlPoints.push_back(patch.ctrlAt(r, c));
+			}
+		}
+	}
+
+	const PatchControl& ctrlAt(std::size_t row, std::size_t col) const
+	{
+		return controlPoints[row * width + col];
+	}
+};
+
+} // namespace map
@@ -184,6 +184,17 @@ public:
     /// Return true if this light intersects the given AABB
 	virtual bool intersectsAABB(const AABB& aabb) const = 0;
 
+    /**
+     * \brief
+     * Return a world-space AABB enclosing the whole light volume.
+     *
+     * The bounds are used by the renderer to find the objects which might be
+     * lit by this light, intersectsAABB() is only called for objects within
+     * these bounds. The result may be invalid if the light volume is
+     * degenerate, in which case the light is tested against every object.
+     */
+    virtual AABB lightAABB() const = 0;
+
     /**
      * \brief
      * Return the light origin in world space.
@@ -230,6 +241,9 @@ public:
     /// Test if the given light intersects the LitObject
     virtual bool intersectsLight(const RendererLight& light) const = 0;
 
+    /// Return the world-space bounds used to look up the lights near this object
+    virtual AABB litObjectAABB() const = 0;
+
     /// Add a light to the set of lights which do intersect this object
     virtual void insertLight(const RendererLight& light) {}
 
@@ -270,14 +284,16 @@ typedef std::function<void(const RendererLight&)> RendererLightCallback;
  * it invokes LightList::calculateIntersectingLights() on the stored LightList
  * reference.
  * 4. calculateIntersectingLights() first checks to see if the lights need
- * updating, which is true if EITHER this LightList's setDirty() method OR the
- * RenderSystem's lightChanged() has been called since the last calculation. If
- * no update is needed, it returns.
- * 5. If an update IS needed, the LightList iterates over all lights in the
- * scene, and tests if each one intersects its associated lit object (which is
- * the one that just invoked calculateIntersectingLights(), although nothing
- * enforces this). This intersection test is performed by passing the light to
- * the LitObject::intersectsLight() method.
+ * updating, which is true if EITHER this LightList's setDirty() method has
+ * been called OR the RenderSystem's lightChanged() has been called for a light
+ * whose old or new lightAABB() overlaps the object since the last calculation.
+ * If no update is needed, it returns.
+ * 5. If an update IS needed, the LightList looks up the lights near the
+ * object's litObjectAABB() in the RenderSystem's light index, and tests if
+ * each one intersects its associated lit object (which is the one that just
+ * invoked calculateIntersectingLights(), although nothing enforces this).
+ * This intersection test is performed by passing the light to the
+ * LitObject::intersectsLight() method.
  * 6. For each light which passes the intersection test, the LightList both adds
  * it to its internal list of "active" (i.e. intersecting) lights for its
  * object, and passes it to the object's insertLight() method. Some object
@@ -298,10 +314,10 @@ typedef std::function<void(const RendererLight&)> RendererLightCallback;
  * its internal OpenGLShaderPasses: once only if RENDER_BUMP is not active, not
  * at all if RENDER_BUMP is active but the LightList is NULL, or once for each
  * light in the LightList otherwise.
- * 12. The OpenGLShaderPass now contains a list of TransformedRenderable
- * structures, each associating a single renderable with a single light.
- * Multiple TransformedRenderable will exist for the same renderable if there
- * were multiple lights illuminating it.
+ * 12. The OpenGLShaderPass submits a TransformedRenderable structure to the
+ * render system's RenderQueue, each associating a single renderable with a
+ * single light. Multiple TransformedRenderable will exist for the same
+ * renderable if there were multiple lights illuminating it.
  */
 class LightList
 {
@@ -114,6 +114,14 @@ public:
 
 	// Returns the associated spacepartition
 	virtual ISpacePartitionSystemPtr getSpacePartition() = 0;
+
+	/**
+	 * Enables or disables multi-threaded culling for the foreach*NodeInVolume
+	 * methods. In parallel mode the space partition is culled against the
+	 * volume by a pool of worker threads, the walkers and functors are
+	 * still invoked sequentially in the calling thread afterwards.
+	 */
+	virtual void setParallelTraversal(bool enabled) = 0;
 };
 typedef std::shared_ptr<Graph> GraphPtr;
 typedef std::weak_ptr<Graph> GraphWeakPtr;
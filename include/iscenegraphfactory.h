@@ -5,6 +5,19 @@
 namespace scene
 {
 
+/**
+ * The space partition implementations a scenegraph can be based on.
+ *
+ * Octree: the classic octree with separately allocated nodes.
+ * FlatOctree: same subdivision rules, but with pooled octants and a
+ * hashed node lookup, faster for maps with many frequently moving nodes.
+ */
+enum class SpacePartitionType
+{
+	Octree,
+	FlatOctree,
+};
+
 /**
  * greebo: The scenegraph factory can be used to generate
  * new instances of DarkRadiant's main scene manager.
@@ -19,9 +32,14 @@ class ISceneGraphFactory :
 {
 public:
 	/**
-	 * Instantiates a new scenegraph.
+	 * Instantiates a new scenegraph, using the default space partition.
 	 */
 	virtual GraphPtr createSceneGraph() = 0;
+
+	/**
+	 * Instantiates a new scenegraph, using the given type of space partition.
+	 */
+	virtual GraphPtr createSceneGraph(SpacePartitionType spacePartitionType) = 0;
 };
 
 } // namespace
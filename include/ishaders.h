@@ -435,6 +435,21 @@ public:
 	 */
 	virtual TexturePtr loadTextureFromFile(const std::string& filename) = 0;
 
+	/**
+	 * Uploads the textures which have been decoded in the background since the
+	 * last call. To be called by the renderer at the beginning of each frame,
+	 * with the GL context being current. The time spent is limited, remaining
+	 * textures are uploaded in the following frames.
+	 */
+	virtual void processPendingTextureUploads() = 0;
+
+	/**
+	 * Starts a new render frame. The shader expression results depending on
+	 * the render entity are cached per entity until the next frame begins.
+	 * To be called by the renderer at the beginning of each frame.
+	 */
+	virtual void beginFrame() = 0;
+
 	/**
 	 * Creates a new shader expression for the given string. This can be used to create standalone
 	 * expression objects for unit testing purposes.
@@ -1,7 +1,6 @@
 #ifndef _ISPACE_PARTITION_H_
 #define _ISPACE_PARTITION_H_
 
-#include <list>
 #include <vector>
 #include "imodule.h"
 
@@ -43,8 +42,8 @@ public:
 	// The child nodes
 	typedef std::vector<ISPNodePtr> NodeList;
 
-	// The members
-	typedef std::list<INodePtr> MemberList;
+	// The members (kept in a compact array, their order is not significant)
+	typedef std::vector<INodePtr> MemberList;
 
 	// Get the parent node (can be NULL for the root node)
 	virtual ISPNodePtr getParent() const = 0;
@@ -72,6 +71,11 @@ typedef std::shared_ptr<ISPNode> ISPNodePtr;
  * The link() method makes sure the given node is added as member to the ISPNode it fits best.
  * The unlink() method can be used to remove a node from the tree again.
  *
+ * The relink() method is to be used when the bounds of an already linked node
+ * have changed. It is equivalent to an unlink() followed by link(), but will
+ * leave the node where it is if it's still fitting its current ISPNode, or
+ * will only walk up to the nearest ancestor being able to host the node.
+ *
  * Note: It's not allowed to call link() for nodes which are already linked into the tree.
  * It's safe to call unlink() for any node at any time, even multiple times in a row.
  * The unlink() method will return true if the node had been linked before.
@@ -88,6 +92,10 @@ public:
 	// (node had been linked before)
 	virtual bool unlink(const scene::INodePtr& sceneNode) = 0;
 
+	// Re-links this node after its bounds changed. Returns false if the node
+	// had not been linked before, in which case nothing happens.
+	virtual bool relink(const scene::INodePtr& sceneNode) = 0;
+
 	// Returns the root node of this SP tree (the largest one, encompassing everything)
 	virtual ISPNodePtr getRoot() const = 0;
 };
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "DefBlockTokeniser.h"
+#include "BufferedDefTokeniser.h"
+
+namespace parser
+{
+
+/**
+ * BlockTokeniser working on a buffer which is held in memory as a whole.
+ * The blocks are split exactly like BasicDefBlockTokeniser does, but the
+ * block contents are copied out of the buffer at once instead of being
+ * assembled character by character.
+ */
+class BufferedDefBlockTokeniser :
+	public BlockTokeniser
+{
+private:
+	CharacterClasses _classes;
+
+	const char _blockStartChar;
+	const char _blockEndChar;
+
+	const char* _next;
+	const char* _end;
+
+	// The upcoming block
+	bool _hasBlock;
+	Block _block;
+
+public:
+	BufferedDefBlockTokeniser(const char* data,
+							  std::size_t length,
+							  const char* delims = WHITESPACE,
+							  const char blockStartChar = '{',
+							  const char blockEndChar = '}') :
+		_classes(delims, ""),
+		_blockStartChar(blockStartChar),
+		_blockEndChar(blockEndChar),
+		_next(data),
+		_end(data + length)
+	{
+		_hasBlock = readBlock(_block);
+	}
+
+	BufferedDefBlockTokeniser(const std::string& str,
+							  const char* delims = WHITESPACE,
+							  const char blockStartChar = '{',
+							  const char blockEndChar = '}') :
+		_classes(delims, ""),
+		_blockStartChar(blockStartChar),
+		_blockEndChar(blockEndChar),
+		_next(str.data()),
+		_end(str.data() + str.size())
+	{
+		_hasBlock = readBlock(_block);
+	}
+
+	bool hasMoreBlocks()
+	{
+		return _hasBlock;
+	}
+
+	Block nextBlock()
+	{
+		if (!_hasBlock)
+		{
+			throw ParseException("BlockTokeniser: no more blocks");
+		}
+
+		Block block;
+		std::swap(block, _block);
+
+		_hasBlock = readBlock(_block);
+
+		return block;
+	}
+
+private:
+	enum State
+	{
+		SEARCHING_NAME,
+		TOKEN_STARTED,
+		SEARCHING_BLOCK,
+	};
+
+	bool readBlock(Block& block)
+	{
+		block.clear();
+
+		State state = SEARCHING_NAME;
+
+		while (_next != _end)
+		{
+			char ch = *_next;
+
+			if (ch == '/')
+			{
+				if (_next + 1 == _end)
+				{
+					// A trailing slash is dropped
+					_next = _end;
+					break;
+				}
+
+				if (_next[1] == '/' || _next[1] == '*')
+				{
+					skipComment();
+
+					// A comment after the name means searching for the block
+					state = block.name.empty() ? SEARCHING_NAME : SEARCHING_BLOCK;
+					continue;
+				}
+
+				// Not a comment, the slash continues (or starts) the name without a space
+				block.name += ch;
+				state = TOKEN_STARTED;
+				++_next;
+				continue;
+			}
+
+			switch (state)
+			{
+			case SEARCHING_NAME:
+				if (_classes.isDelim(ch))
+				{
+					++_next;
+					continue;
+				}
+
+				state = TOKEN_STARTED;
+				continue;
+
+			case TOKEN_STARTED:
+				if (_classes.isDelim(ch))
+				{
+					state = SEARCHING_BLOCK;
+					continue;
+				}
+
+				block.name += ch;
+				++_next;
+				continue;
+
+			case SEARCHING_BLOCK:
+				if (_classes.isDelim(ch))
+				{
+					++_next;
+					continue;
+				}
+
+				if (ch == _blockStartChar)
+				{
+					readContents(block);
+					return true;
+				}
+
+				// Not a delimiter, not an opening brace, must be an "extension" for the name
+				block.name += ' ';
+				block.name += ch;
+
+				state = TOKEN_STARTED;
+				++_next;
+				continue;
+			}
+		}
+
+		return !block.name.empty();
+	}
+
+	// Copies the contents of the block starting at _next (excluding the outermost braces)
+	void readContents(Block& block)
+	{
+		const char* start = ++_next;
+		std::size_t blockLevel = 1;
+
+		for (; _next != _end; ++_next)
+		{
+			if (*_next == _blockEndChar)
+			{
+				if (--blockLevel == 0)
+				{
+					block.contents.assign(start, _next++);
+					return;
+				}
+			}
+			else if (*_next == _blockStartChar)
+			{
+				blockLevel++;
+			}
+		}
+
+		block.contents.assign(start, _end);
+	}
+
+	// Skips the comment starting at _next
+	void skipComment()
+	{
+		if (_next[1] == '/')
+		{
+			for (_next += 2; _next != _end; ++_next)
+			{
+				if (*_next == '\r' || *_next == '\n')
+				{
+					++_next;
+					return;
+				}
+			}
+		}
+		else
+		{
+			for (_next += 2; _next != _end; ++_next)
+			{
+				if (*_next == '*' && _next + 1 != _end && _next[1] == '/')
+				{
+					_next += 2;
+					return;
+				}
+			}
+		}
+	}
+};
+
+} // namespace parser
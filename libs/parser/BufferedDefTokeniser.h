@@ -0,0 +1,397 @@
+#pragma once
+
+#include "DefTokeniser.h"
+
+#include <string>
+#include <cstring>
+#include <boost/utility/string_ref.hpp>
+
+namespace parser
+{
+
+/**
+ * Lookup table assigning a character class to each of the 256 byte values,
+ * built from the delimiter strings passed to the tokeniser. This replaces
+ * the linear search through the delimiter strings DefTokeniserFunc performs
+ * for every character.
+ */
+class CharacterClasses
+{
+public:
+	enum Class
+	{
+		OTHER = 0,
+		DELIM,		// delimiter to skip (whitespace)
+		KEPT_DELIM, // delimiter returned as token of its own
+		QUOTE,		// double quote
+		SLASH,		// forward slash, possibly starting a comment
+	};
+
+private:
+	unsigned char _classes[256];
+
+public:
+	CharacterClasses(const char* delims, const char* keptDelims)
+	{
+		std::memset(_classes, OTHER, sizeof(_classes));
+
+		_classes[static_cast<unsigned char>('"')] = QUOTE;
+		_classes[static_cast<unsigned char>('/')] = SLASH;
+
+		// Delimiters are checked before anything else
+		for (const char* c = keptDelims; *c != 0; ++c)
+		{
+			_classes[static_cast<unsigned char>(*c)] = KEPT_DELIM;
+		}
+
+		for (const char* c = delims; *c != 0; ++c)
+		{
+			_classes[static_cast<unsigned char>(*c)] = DELIM;
+		}
+	}
+
+	Class get(char c) const
+	{
+		return static_cast<Class>(_classes[static_cast<unsigned char>(c)]);
+	}
+
+	bool isDelim(char c) const
+	{
+		return get(c) == DELIM;
+	}
+};
+
+/**
+ * DefTokeniser working on a buffer which is held in memory as a whole, like
+ * a file which has been read at once. It splits the tokens exactly like
+ * BasicDefTokeniser, but doesn't need to assemble each token character by
+ * character: most tokens are returned as references into the buffer.
+ * Only quoted strings containing escape sequences or continuations need to be
+ * copied into an internal buffer.
+ *
+ * The buffer must stay alive as long as the tokeniser is in use. The tokens
+ * returned by nextTokenRef() are valid until the next call to it.
+ */
+class BufferedDefTokeniser :
+	public DefTokeniser
+{
+private:
+	CharacterClasses _classes;
+
+	const char* _next;
+	const char* _end;
+
+	// The upcoming token
+	bool _hasToken;
+	boost::string_ref _token;
+
+	// Quoted strings which had to be unescaped, the token returned by the
+	// previous call needs to stay intact while the next one is read
+	std::string _unescaped[2];
+	std::size_t _unescapedIndex;
+
+public:
+	BufferedDefTokeniser(const char* data,
+						 std::size_t length,
+						 const char* delims = WHITESPACE,
+						 const char* keptDelims = "{}()") :
+		_classes(delims, keptDelims),
+		_next(data),
+		_end(data + length),
+		_unescapedIndex(0)
+	{
+		_hasToken = readToken(_token);
+	}
+
+	BufferedDefTokeniser(const std::string& str,
+						 const char* delims = WHITESPACE,
+						 const char* keptDelims = "{}()") :
+		_classes(delims, keptDelims),
+		_next(str.data()),
+		_end(str.data() + str.size()),
+		_unescapedIndex(0)
+	{
+		_hasToken = readToken(_token);
+	}
+
+	bool hasMoreTokens() const
+	{
+		return _hasToken;
+	}
+
+	// Returns the next token without copying it
+	boost::string_ref nextTokenRef() override
+	{
+		boost::string_ref token = peekRef();
+
+		_hasToken = readToken(_token);
+
+		return token;
+	}
+
+	boost::string_ref peekRef() const
+	{
+		if (!_hasToken)
+		{
+			throw ParseException("DefTokeniser: no more tokens");
+		}
+
+		return _token;
+	}
+
+	std::string nextToken()
+	{
+		return nextTokenRef().to_string();
+	}
+
+	std::string peek() const
+	{
+		return peekRef().to_string();
+	}
+
+	void assertNextToken(const std::string& val)
+	{
+		boost::string_ref tok = nextTokenRef();
+
+		if (tok != val)
+		{
+			throw ParseException("DefTokeniser: Assertion failed: Required \""
+								 + val + "\", found \"" + tok.to_string() + "\"");
+		}
+	}
+
+	void skipTokens(unsigned int n)
+	{
+		for (unsigned int i = 0; i < n; i++)
+		{
+			nextTokenRef();
+		}
+	}
+
+private:
+	// Reads the token starting at _next, returns false if there is none left
+	bool readToken(boost::string_ref& token)
+	{
+		while (true)
+		{
+			while (_next != _end && _classes.isDelim(*_next))
+			{
+				++_next;
+			}
+
+			if (_next == _end)
+			{
+				return false;
+			}
+
+			switch (_classes.get(*_next))
+			{
+			case CharacterClasses::KEPT_DELIM:
+				token = boost::string_ref(_next++, 1);
+				return true;
+
+			case CharacterClasses::QUOTE:
+				return readQuotedToken(token);
+
+			case CharacterClasses::SLASH:
+				if (_next + 1 == _end)
+				{
+					// A trailing slash is dropped
+					_next = _end;
+					return false;
+				}
+
+				if (_next[1] == '/' || _next[1] == '*')
+				{
+					skipComment();
+					continue;
+				}
+
+				return readPlainToken(token);
+
+			default:
+				return readPlainToken(token);
+			}
+		}
+	}
+
+	// Token which isn't quoted, this is always a contiguous range of the buffer
+	bool readPlainToken(boost::string_ref& token)
+	{
+		const char* start = _next;
+
+		for (const char* p = _next; p != _end; ++p)
+		{
+			switch (_classes.get(*p))
+			{
+			case CharacterClasses::DELIM:
+			case CharacterClasses::KEPT_DELIM:
+			case CharacterClasses::QUOTE:
+				token = boost::string_ref(start, p - start);
+				_next = p;
+				return true;
+
+			case CharacterClasses::SLASH:
+				if (p + 1 == _end || p[1] == '/' || p[1] == '*')
+				{
+					// The token ends here, a trailing slash at the end of the buffer is dropped
+					token = boost::string_ref(start, p - start);
+					_next = p;
+
+					if (p + 1 == _end)
+					{
+						_next = _end;
+					}
+					else
+					{
+						skipComment();
+					}
+
+					return true;
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		token = boost::string_ref(start, _end - start);
+		_next = _end;
+
+		return true;
+	}
+
+	// Skips the comment starting at _next
+	void skipComment()
+	{
+		if (_next[1] == '/')
+		{
+			// Line comment, including the line break
+			for (_next += 2; _next != _end; ++_next)
+			{
+				if (*_next == '\r' || *_next == '\n')
+				{
+					++_next;
+					return;
+				}
+			}
+		}
+		else
+		{
+			for (_next += 2; _next != _end; ++_next)
+			{
+				if (*_next == '*' && _next + 1 != _end && _next[1] == '/')
+				{
+					_next += 2;
+					return;
+				}
+			}
+		}
+	}
+
+	// Quoted strings: unless they contain a backslash, the contents can be referenced directly
+	bool readQuotedToken(boost::string_ref& token)
+	{
+		const char* start = _next + 1;
+		const char* p = start;
+
+		while (p != _end && *p != '"' && *p != '\\')
+		{
+			++p;
+		}
+
+		if (p == _end || *p == '\\')
+		{
+			return readUnescapedToken(token, start);
+		}
+
+		boost::string_ref contents(start, p - start);
+
+		// Look behind the closing quote for a continuation backslash
+		for (++p; p != _end && _classes.isDelim(*p); ++p) {}
+
+		if (p != _end && *p == '\\')
+		{
+			return readUnescapedToken(token, start);
+		}
+
+		_next = p;
+		token = contents;
+
+		// An empty string at the end of the buffer doesn't count as token
+		return p != _end || !contents.empty();
+	}
+
+	// Slow path for quoted strings, copies the unescaped contents into a buffer
+	bool readUnescapedToken(boost::string_ref& token, const char* start)
+	{
+		_unescapedIndex ^= 1;
+
+		std::string& buffer = _unescaped[_unescapedIndex];
+		buffer.clear();
+
+		const char* p = start;
+
+		while (true)
+		{
+			// Quoted contents
+			while (p != _end && *p != '"')
+			{
+				if (*p == '\\')
+				{
+					if (++p == _end) break;
+
+					switch (*p)
+					{
+					case 'n': buffer += '\n'; break;
+					case 't': buffer += '\t'; break;
+					case '"': buffer += '"'; break;
+					default:
+						// No special escape sequence, keep the backslash
+						buffer += '\\';
+						buffer += *p;
+					}
+
+					++p;
+					continue;
+				}
+
+				buffer += *p++;
+			}
+
+			if (p == _end) break;
+
+			// Skip the closing quote and check for a continuation
+			for (++p; p != _end && _classes.isDelim(*p); ++p) {}
+
+			if (p == _end) break;
+
+			if (*p != '\\')
+			{
+				_next = p;
+				token = boost::string_ref(buffer);
+				return true;
+			}
+
+			// Backslash found, the string continues at the next opening quote
+			for (++p; p != _end && _classes.isDelim(*p); ++p) {}
+
+			if (p == _end) break;
+
+			if (*p != '"')
+			{
+				throw ParseException("Could not find opening double quote after backslash.");
+			}
+
+			++p;
+		}
+
+		_next = _end;
+		token = boost::string_ref(buffer);
+
+		return !buffer.empty();
+	}
+};
+
+} // namespace parser
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <boost/tokenizer.hpp>
+#include <boost/utility/string_ref.hpp>
 
 namespace parser {
 
@@ -364,6 +365,10 @@ const char* const WHITESPACE = " \t\n\v\r";
  */
 class DefTokeniser
 {
+private:
+	// Holds the token returned by the default nextTokenRef() implementation
+	std::string _tokenRefBuffer;
+
 public:
     /**
 	 * Destructor
@@ -391,6 +396,20 @@ public:
      */
      virtual std::string nextToken() = 0;
 
+	/**
+	 * Like nextToken(), but returns a reference to the token instead of a copy.
+	 * Tokenisers holding their input in memory override this to avoid
+	 * allocating a string per token.
+	 *
+	 * @returns
+	 * The next token, valid until the next call to nextTokenRef().
+	 */
+	virtual boost::string_ref nextTokenRef()
+	{
+		_tokenRefBuffer = nextToken();
+		return _tokenRefBuffer;
+	}
+
     /**
      * Assert that the next token in the sequence must be equal to the provided
      * value. A ParseException is thrown if the assert fails.
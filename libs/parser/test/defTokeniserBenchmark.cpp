@@ -0,0 +1,100 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE defTokeniserBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "parser/DefTokeniser.h"
+#include "parser/BufferedDefTokeniser.h"
+
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+
+// Builds some brushDef3 primitives, resembling a real map file
+std::string generateMapText(std::size_t minSize)
+{
+	std::ostringstream str;
+	str << "Version 2\n// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+
+	for (std::size_t brush = 0; static_cast<std::size_t>(str.tellp()) < minSize; ++brush)
+	{
+		str << "// primitive " << brush << "\n{\nbrushDef3\n{\n";
+
+		for (int face = 0; face < 6; ++face)
+		{
+			str << "( 0 0 -1 " << brush * 8 << " ) ( ( 0.0078125 0 " << face * 0.25
+				<< " ) ( 0 0.0078125 0.5 ) ) \"textures/darkmod/stone/brick/blocks_brown\" 0 0 0\n";
+		}
+
+		str << "}\n}\n";
+	}
+
+	str << "}\n";
+
+	return str.str();
+}
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+// Compares the throughput of the tokenisers on a large map file
+BOOST_AUTO_TEST_CASE(tokeniserThroughput)
+{
+	std::string text = generateMapText(16 * 1024 * 1024);
+	double megabytes = text.size() / (1024.0 * 1024.0);
+
+	std::size_t streamTokens = 0;
+
+	Clock::time_point start = Clock::now();
+	{
+		std::istringstream stream(text);
+		parser::BasicDefTokeniser<std::istream> tok(stream);
+
+		for (; tok.hasMoreTokens(); ++streamTokens)
+		{
+			tok.nextToken();
+		}
+	}
+	double streamTime = secondsSince(start);
+
+	std::size_t stringTokens = 0;
+
+	start = Clock::now();
+	{
+		parser::BasicDefTokeniser<std::string> tok(text);
+
+		for (; tok.hasMoreTokens(); ++stringTokens)
+		{
+			tok.nextToken();
+		}
+	}
+	double stringTime = secondsSince(start);
+
+	std::size_t bufferedTokens = 0;
+
+	start = Clock::now();
+	{
+		parser::BufferedDefTokeniser tok(text);
+
+		for (; tok.hasMoreTokens(); ++bufferedTokens)
+		{
+			tok.nextTokenRef();
+		}
+	}
+	double bufferedTime = secondsSince(start);
+
+	BOOST_CHECK_EQUAL(streamTokens, stringTokens);
+	BOOST_CHECK_EQUAL(bufferedTokens, stringTokens);
+
+	BOOST_TEST_MESSAGE(bufferedTokens << " tokens in " << megabytes << " MB: "
+		<< "BasicDefTokeniser<std::istream> " << megabytes / streamTime << " MB/s, "
+		<< "BasicDefTokeniser<std::string> " << megabytes / stringTime << " MB/s, "
+		<< "BufferedDefTokeniser " << megabytes / bufferedTime << " MB/s");
+}
@@ -0,0 +1,191 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE defTokeniserTest
+#include <boost/test/unit_test.hpp>
+
+#include "parser/DefTokeniser.h"
+#include "parser/DefBlockTokeniser.h"
+#include "parser/BufferedDefTokeniser.h"
+#include "parser/BufferedDefBlockTokeniser.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Collects all tokens, plus the message of the exception which stopped the tokeniser
+std::vector<std::string> collectTokens(parser::DefTokeniser& tok)
+{
+	std::vector<std::string> tokens;
+
+	try
+	{
+		while (tok.hasMoreTokens())
+		{
+			tokens.push_back(tok.nextToken());
+		}
+	}
+	catch (parser::ParseException& e)
+	{
+		tokens.push_back(std::string("exception: ") + e.what());
+	}
+
+	return tokens;
+}
+
+std::vector<std::string> tokeniseClassic(const std::string& text)
+{
+	try
+	{
+		parser::BasicDefTokeniser<std::string> tok(text);
+		return collectTokens(tok);
+	}
+	catch (parser::ParseException& e)
+	{
+		return std::vector<std::string>(1, std::string("exception: ") + e.what());
+	}
+}
+
+std::vector<std::string> tokeniseBuffered(const std::string& text)
+{
+	try
+	{
+		parser::BufferedDefTokeniser tok(text);
+		return collectTokens(tok);
+	}
+	catch (parser::ParseException& e)
+	{
+		return std::vector<std::string>(1, std::string("exception: ") + e.what());
+	}
+}
+
+std::vector<std::string> collectBlocks(parser::BlockTokeniser& tok)
+{
+	std::vector<std::string> blocks;
+
+	while (tok.hasMoreBlocks())
+	{
+		parser::BlockTokeniser::Block block = tok.nextBlock();
+		blocks.push_back(block.name + "|" + block.contents);
+	}
+
+	return blocks;
+}
+
+// Random text made of the characters the tokenisers treat specially
+std::string randomText(std::mt19937& rand, std::size_t maxLength)
+{
+	static const char CHARS[] = "ab \t\n\r\"\\/*{}()nt";
+
+	std::uniform_int_distribution<std::size_t> length(0, maxLength);
+	std::uniform_int_distribution<std::size_t> character(0, sizeof(CHARS) - 2);
+
+	std::string text(length(rand), ' ');
+
+	for (char& c : text)
+	{
+		c = CHARS[character(rand)];
+	}
+
+	return text;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(tokeniseSpecialCases)
+{
+	const char* const CASES[] =
+	{
+		"",
+		"   \n\t ",
+		"a b\tc\nd",
+		"{a}(b)c",
+		"\"quoted string\" next",
+		"\"\" \"\"",
+		"\"\"",
+		"prefix\"quoted\"suffix",
+		"\"esc\\\"aped\\n\\t\\x\" after",
+		"\"continued\" \\ \"string\" end",
+		"\"continued\" \\ notquoted",
+		"\"unterminated",
+		"\"ends with backslash\\",
+		"a // comment\nb",
+		"a//comment\nb",
+		"a /* block */ b",
+		"a/*block*/b",
+		"a /* unterminated",
+		"a/b c/ /d",
+		"a/",
+		"/",
+		"textures/common/caulk{",
+		"/* only a comment */",
+		"// only a comment",
+		"a/\"b\"",
+		"x /**/ y /***/ z /* * / */ w",
+	};
+
+	for (const char* text : CASES)
+	{
+		BOOST_CHECK_MESSAGE(tokeniseClassic(text) == tokeniseBuffered(text), "Token mismatch for: " << text);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(tokeniseRandomText)
+{
+	std::mt19937 rand(12345);
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::string text = randomText(rand, 40);
+
+		BOOST_REQUIRE_MESSAGE(tokeniseClassic(text) == tokeniseBuffered(text), "Token mismatch for: " << text);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(tokenReferences)
+{
+	std::string text("brushDef3 { \"esc\\\"aped\" \"plain\" }");
+	parser::BufferedDefTokeniser tok(text);
+
+	// Plain tokens are pointing into the buffer
+	boost::string_ref keyword = tok.nextTokenRef();
+	BOOST_CHECK_EQUAL(keyword, "brushDef3");
+	BOOST_CHECK(keyword.data() == text.data());
+
+	tok.assertNextToken("{");
+
+	BOOST_CHECK_EQUAL(tok.peekRef(), "esc\"aped");
+
+	// The unescaped token must survive reading the next one
+	boost::string_ref escaped = tok.nextTokenRef();
+	BOOST_CHECK_EQUAL(tok.peekRef(), "plain");
+	BOOST_CHECK_EQUAL(escaped, "esc\"aped");
+
+	tok.skipTokens(2);
+	BOOST_CHECK(!tok.hasMoreTokens());
+	BOOST_CHECK_THROW(tok.nextToken(), parser::ParseException);
+}
+
+BOOST_AUTO_TEST_CASE(tokeniseBlocks)
+{
+	std::mt19937 rand(54321);
+
+	std::vector<std::string> texts;
+	texts.push_back("textures/a { contents { nested } }\ntable b { { 0, 1 } }");
+	texts.push_back("// comment\nname /* comment */ { a } name2 // comment\n{ b }");
+	texts.push_back("name with spaces { x } name/slash{ y } unterminated { z");
+	texts.push_back("a/ {b} /");
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		texts.push_back(randomText(rand, 40));
+	}
+
+	for (const std::string& text : texts)
+	{
+		parser::BasicDefBlockTokeniser<std::string> classic(text);
+		parser::BufferedDefBlockTokeniser buffered(text);
+
+		BOOST_REQUIRE_MESSAGE(collectBlocks(classic) == collectBlocks(buffered), "Block mismatch for: " << text);
+	}
+}
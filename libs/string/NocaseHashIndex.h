@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace string
+{
+
+/**
+ * An open-addressed hash table mapping case-insensitive string keys to small
+ * values like indices or pointers, meant to be put on top of an existing
+ * container holding the actual keys.
+ *
+ * The keys are not stored in the index, lookups retrieve them from the
+ * values through a KeyOf functor returning a const std::string reference.
+ * Only ASCII characters are compared case-insensitively.
+ *
+ * There is no removal, owners rebuild the index when they remove elements.
+ * Concurrent find() calls are safe as long as nobody is inserting.
+ */
+template<typename Value>
+class NocaseHashIndex
+{
+private:
+	struct Slot
+	{
+		// The hash of the key, 0 marks an unused slot
+		std::size_t hash;
+		Value value;
+	};
+
+	// Always a power of two in size, at most half of the slots are used
+	std::vector<Slot> _slots;
+	std::size_t _size;
+
+public:
+	NocaseHashIndex() :
+		_size(0)
+	{}
+
+	static char toLower(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+	}
+
+	static bool equal(const std::string& a, const std::string& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (toLower(a[i]) != toLower(b[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// FNV-1a of the lowercase key, never 0
+	static std::size_t hash(const std::string& key)
+	{
+		std::size_t result = 2166136261u;
+
+		for (std::string::const_iterator i = key.begin(); i != key.end(); ++i)
+		{
+			result ^= static_cast<unsigned char>(toLower(*i));
+			result *= 16777619u;
+		}
+
+		return result != 0 ? result : 1;
+	}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	void clear()
+	{
+		_slots.clear();
+		_size = 0;
+	}
+
+	// Adds the given value, the key must not be in the index yet
+	void insert(const std::string& key, const Value& value)
+	{
+		if ((_size + 1) * 2 > _slots.size())
+		{
+			grow();
+		}
+
+		place(hash(key), value);
+		++_size;
+	}
+
+	// Returns the value stored for the given key, or NULL if there is none
+	template<typename KeyOf>
+	const Value* find(const std::string& key, const KeyOf& keyOf) const
+	{
+		if (_size == 0)
+		{
+			return NULL;
+		}
+
+		std::size_t keyHash = hash(key);
+		std::size_t mask = _slots.size() - 1;
+
+		for (std::size_t i = keyHash & mask; ; i = (i + 1) & mask)
+		{
+			const Slot& slot = _slots[i];
+
+			if (slot.hash == 0)
+			{
+				return NULL;
+			}
+
+			if (slot.hash == keyHash && equal(keyOf(slot.value), key))
+			{
+				return &slot.value;
+			}
+		}
+	}
+
+private:
+	void grow()
+	{
+		std::vector<Slot> old;
+		old.swap(_slots);
+
+		Slot unused = { 0, Value() };
+		_slots.resize(old.empty() ? 8 : old.size() * 2, unused);
+
+		for (typename std::vector<Slot>::const_iterator i = old.begin(); i != old.end(); ++i)
+		{
+			if (i->hash != 0)
+			{
+				place(i->hash, i->value);
+			}
+		}
+	}
+
+	void place(std::size_t keyHash, const Value& value)
+	{
+		std::size_t mask = _slots.size() - 1;
+		std::size_t i = keyHash & mask;
+
+		while (_slots[i].hash != 0)
+		{
+			i = (i + 1) & mask;
+		}
+
+		_slots[i].hash = keyHash;
+		_slots[i].value = value;
+	}
+};
+
+} // namespace
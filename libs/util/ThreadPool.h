@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <memory>
+
+namespace util
+{
+
+/**
+ * A fixed-size pool of worker threads processing queued tasks.
+ *
+ * Use this for workloads that are split into many short, independent
+ * pieces (like per-frame culling or per-file parsing), where spawning a
+ * thread for each piece (std::async) would cost more than the work itself.
+ *
+ * The destructor waits for all queued tasks to finish.
+ */
+class ThreadPool
+{
+private:
+	std::vector<std::thread> _workers;
+
+	std::deque<std::function<void()>> _tasks;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	bool _stopping;
+
+public:
+	// Construct a pool with the given amount of threads,
+	// passing 0 will use the number of hardware threads
+	ThreadPool(std::size_t numThreads = 0) :
+		_stopping(false)
+	{
+		if (numThreads == 0)
+		{
+			numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		for (std::size_t i = 0; i < numThreads; ++i)
+		{
+			_workers.push_back(std::thread(std::bind(&ThreadPool::workerLoop, this)));
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+
+		_condition.notify_all();
+
+		for (std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+	}
+
+	// The number of worker threads in this pool
+	std::size_t getNumThreads() const
+	{
+		return _workers.size();
+	}
+
+	// Queue a task, the returned future can be used to wait for its completion
+	// and will re-throw any exception the task has been throwing.
+	std::future<void> enqueue(const std::function<void()>& task)
+	{
+		std::shared_ptr<std::packaged_task<void()>> packaged =
+			std::make_shared<std::packaged_task<void()>>(task);
+
+		std::future<void> result = packaged->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_tasks.push_back([packaged]() { (*packaged)(); });
+		}
+
+		_condition.notify_one();
+
+		return result;
+	}
+
+	/**
+	 * Invokes func(i) for each i in [0..count) using the worker threads,
+	 * the calling thread is processing indices too. Blocks until all
+	 * invocations are done. The first exception thrown by any of the
+	 * invocations is re-thrown in the calling thread.
+	 */
+	void parallelFor(std::size_t count, const std::function<void(std::size_t)>& func)
+	{
+		if (count == 0) return;
+
+		std::atomic<std::size_t> next(0);
+		std::exception_ptr error;
+		std::mutex errorMutex;
+
+		auto process = [&]()
+		{
+			for (std::size_t i = next++; i < count; i = next++)
+			{
+				try
+				{
+					func(i);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(errorMutex);
+
+					if (!error) error = std::current_exception();
+				}
+			}
+		};
+
+		std::size_t numHelpers = std::min(count, _workers.size() + 1) - 1;
+
+		std::vector<std::future<void>> helpers;
+		helpers.reserve(numHelpers);
+
+		for (std::size_t i = 0; i < numHelpers; ++i)
+		{
+			helpers.push_back(enqueue(process));
+		}
+
+		// Lend a hand
+		process();
+
+		for (std::future<void>& helper : helpers)
+		{
+			helper.wait();
+		}
+
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+private:
+	void workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+
+				_condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+
+				if (_tasks.empty())
+				{
+					return; // stopping and nothing left to do
+				}
+
+				task = std::move(_tasks.front());
+				_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+};
+
+}
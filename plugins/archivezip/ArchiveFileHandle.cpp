@@ -0,0 +1,101 @@
+#include "ArchiveFileHandle.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef WIN32
+
+ArchiveFileHandle::ArchiveFileHandle(const std::string& filename) :
+	_handle(CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL))
+{}
+
+ArchiveFileHandle::~ArchiveFileHandle()
+{
+	if (!failed())
+	{
+		CloseHandle(_handle);
+	}
+}
+
+bool ArchiveFileHandle::failed() const
+{
+	return _handle == INVALID_HANDLE_VALUE;
+}
+
+std::size_t ArchiveFileHandle::readAt(std::size_t position, StreamBase::byte_type* buffer, std::size_t length) const
+{
+	std::size_t totalRead = 0;
+
+	while (totalRead < length)
+	{
+		// The offset is passed with each call, the file pointer is not involved
+		OVERLAPPED overlapped = OVERLAPPED();
+		unsigned long long offset = position + totalRead;
+		overlapped.Offset = static_cast<DWORD>(offset & 0xffffffff);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD bytesRead = 0;
+		DWORD toRead = static_cast<DWORD>(std::min<std::size_t>(length - totalRead, 0x40000000));
+
+		if (!ReadFile(_handle, buffer + totalRead, toRead, &bytesRead, &overlapped) || bytesRead == 0)
+		{
+			break;
+		}
+
+		totalRead += bytesRead;
+	}
+
+	return totalRead;
+}
+
+#else
+
+ArchiveFileHandle::ArchiveFileHandle(const std::string& filename) :
+	_fd(open(filename.c_str(), O_RDONLY))
+{}
+
+ArchiveFileHandle::~ArchiveFileHandle()
+{
+	if (!failed())
+	{
+		close(_fd);
+	}
+}
+
+bool ArchiveFileHandle::failed() const
+{
+	return _fd < 0;
+}
+
+std::size_t ArchiveFileHandle::readAt(std::size_t position, StreamBase::byte_type* buffer, std::size_t length) const
+{
+	std::size_t totalRead = 0;
+
+	while (totalRead < length)
+	{
+		ssize_t bytesRead = pread(_fd, buffer + totalRead, length - totalRead,
+			static_cast<off_t>(position + totalRead));
+
+		if (bytesRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (bytesRead <= 0)
+		{
+			break;
+		}
+
+		totalRead += static_cast<std::size_t>(bytesRead);
+	}
+
+	return totalRead;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "idatastream.h"
+
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <vector>
+
+/**
+ * A read-only file handle supporting positional reads, which don't modify
+ * a shared file pointer. Any number of threads can read from the same handle
+ * at the same time without locking, which allows all files opened from a zip
+ * archive to share a single handle.
+ */
+class ArchiveFileHandle
+{
+private:
+#ifdef WIN32
+	void* _handle;
+#else
+	int _fd;
+#endif
+
+public:
+	ArchiveFileHandle(const std::string& filename);
+	~ArchiveFileHandle();
+
+	// Returns true if the file could not be opened
+	bool failed() const;
+
+	// Reads up to length bytes starting at the given absolute file position,
+	// returns the number of bytes stored in the buffer
+	std::size_t readAt(std::size_t position, StreamBase::byte_type* buffer, std::size_t length) const;
+
+private:
+	ArchiveFileHandle(const ArchiveFileHandle& other);
+	ArchiveFileHandle& operator=(const ArchiveFileHandle& other);
+};
+typedef std::shared_ptr<ArchiveFileHandle> ArchiveFileHandlePtr;
+
+/**
+ * InputStream reading a section of an archive file through a shared handle.
+ * The data is read in large chunks, the inflater is asking for 1 KB at a time
+ * which would otherwise cost a system call each.
+ */
+class ArchiveSubStream :
+	public InputStream
+{
+private:
+	ArchiveFileHandlePtr _handle;
+	std::size_t _position;
+	std::size_t _remaining;
+
+	// Data read from the file but not yet passed on, allocated on the first read
+	std::vector<byte_type> _buffer;
+	std::size_t _bufferOffset;
+	std::size_t _bufferSize;
+
+	enum { MAX_BUFFER_SIZE = 64 * 1024 };
+
+public:
+	ArchiveSubStream(const ArchiveFileHandlePtr& handle, std::size_t position, std::size_t size) :
+		_handle(handle),
+		_position(position),
+		_remaining(size),
+		_bufferOffset(0),
+		_bufferSize(0)
+	{}
+
+	size_type read(byte_type* buffer, size_type length)
+	{
+		std::size_t totalRead = 0;
+
+		while (totalRead < length)
+		{
+			if (_bufferOffset == _bufferSize)
+			{
+				if (_remaining == 0)
+				{
+					break;
+				}
+
+				// Large reads don't need to go through the buffer
+				if (length - totalRead >= std::min<std::size_t>(_remaining, MAX_BUFFER_SIZE))
+				{
+					std::size_t bytesRead = _handle->readAt(_position, buffer + totalRead,
+						std::min(length - totalRead, _remaining));
+
+					_position += bytesRead;
+					_remaining -= bytesRead;
+					totalRead += bytesRead;
+
+					if (bytesRead == 0)
+					{
+						break;
+					}
+
+					continue;
+				}
+
+				if (_buffer.empty())
+				{
+					_buffer.resize(std::min<std::size_t>(_remaining, MAX_BUFFER_SIZE));
+				}
+
+				_bufferOffset = 0;
+				_bufferSize = _handle->readAt(_position, &_buffer.front(), std::min(_buffer.size(), _remaining));
+
+				_position += _bufferSize;
+				_remaining -= _bufferSize;
+
+				if (_bufferSize == 0)
+				{
+					break;
+				}
+			}
+
+			std::size_t count = std::min(length - totalRead, _bufferSize - _bufferOffset);
+
+			std::copy(_buffer.begin() + _bufferOffset, _buffer.begin() + _bufferOffset + count, buffer + totalRead);
+
+			_bufferOffset += count;
+			totalRead += count;
+		}
+
+		return totalRead;
+	}
+};
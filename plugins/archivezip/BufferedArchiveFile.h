@@ -0,0 +1,103 @@
+#pragma once
+
+#include "iarchive.h"
+#include "archivelib.h"
+#include "gamelib.h"
+#include "InflatedFileCache.h"
+
+#include <cstring>
+
+/**
+ * InputStream reading from a shared buffer holding the inflated file contents.
+ */
+class SharedBufferInputStream :
+	public InputStream
+{
+	InflatedFileCache::BufferPtr _buffer;
+	std::size_t _position;
+
+public:
+	SharedBufferInputStream(const InflatedFileCache::BufferPtr& buffer) :
+		_buffer(buffer),
+		_position(0)
+	{}
+
+	size_type read(byte_type* buffer, size_type length)
+	{
+		std::size_t bytesRead = std::min(length, _buffer->size() - _position);
+
+		if (bytesRead > 0)
+		{
+			std::memcpy(buffer, &(*_buffer)[_position], bytesRead);
+			_position += bytesRead;
+		}
+
+		return bytesRead;
+	}
+};
+
+/**
+ * ArchiveFile served from the InflatedFileCache, no access to the archive is needed.
+ */
+class BufferedArchiveFile :
+	public ArchiveFile
+{
+	std::string m_name;
+	std::size_t m_size;
+	SharedBufferInputStream m_stream;
+
+public:
+	BufferedArchiveFile(const std::string& name, const InflatedFileCache::BufferPtr& buffer) :
+		m_name(name),
+		m_size(buffer->size()),
+		m_stream(buffer)
+	{}
+
+	std::size_t size() const {
+		return m_size;
+	}
+
+	const std::string& getName() const {
+		return m_name;
+	}
+
+	InputStream& getInputStream() {
+		return m_stream;
+	}
+};
+
+/**
+ * ArchiveTextFile served from the InflatedFileCache.
+ */
+class BufferedArchiveTextFile :
+	public ArchiveTextFile
+{
+	std::string m_name;
+	SharedBufferInputStream m_stream;
+	BinaryToTextInputStream<SharedBufferInputStream> m_textStream;
+
+	// Mod directory containing this file
+	std::string _modDir;
+
+public:
+	BufferedArchiveTextFile(const std::string& name,
+							const std::string& modDir,
+							const InflatedFileCache::BufferPtr& buffer) :
+		m_name(name),
+		m_stream(buffer),
+		m_textStream(m_stream),
+		_modDir(game::current::getModPath(modDir))
+	{}
+
+	const std::string& getName() const {
+		return m_name;
+	}
+
+	TextInputStream& getInputStream() {
+		return m_textStream;
+	}
+
+	std::string getModName() const {
+		return _modDir;
+	}
+};
@@ -3,13 +3,14 @@
 
 #include "iarchive.h"
 #include "stream/filestream.h"
+#include "ArchiveFileHandle.h"
+#include "zlibstream.h"
 
 class DeflatedArchiveFile :
 	public ArchiveFile
 {
 	std::string m_name;
-	FileInputStream m_istream;
-	SubFileInputStream m_substream;
+	ArchiveSubStream m_substream;
 	DeflatedInputStream m_zipstream;
 	FileInputStream::size_type m_size;
 public:
@@ -17,13 +18,12 @@ public:
 	typedef FileInputStream::position_type position_type;
 
 	DeflatedArchiveFile(const std::string& name,
-						const std::string& archiveName,
+						const ArchiveFileHandlePtr& archiveFile,
 						position_type position,
 						size_type stream_size,
 						size_type file_size) :
 		m_name(name),
-		m_istream(archiveName),
-		m_substream(m_istream, position, stream_size),
+		m_substream(archiveFile, position, stream_size),
 		m_zipstream(m_substream), m_size(file_size)
 	{}
 
@@ -3,6 +3,9 @@
 #include "iarchive.h"
 #include "iregistry.h"
 #include "gamelib.h"
+#include "archivelib.h"
+#include "ArchiveFileHandle.h"
+#include "zlibstream.h"
 
 /**
  * ArchiveFile stored in a ZIP in DEFLATE format.
@@ -11,8 +14,7 @@ class DeflatedArchiveTextFile :
 	public ArchiveTextFile
 {
 	std::string m_name;
-	FileInputStream m_istream;
-	SubFileInputStream m_substream;
+	ArchiveSubStream m_substream;
 	DeflatedInputStream m_zipstream;
 	BinaryToTextInputStream<DeflatedInputStream> m_textStream;
 
@@ -31,13 +33,12 @@ public:
      * The name of the mod directory this file's archive is located in.
      */
     DeflatedArchiveTextFile(const std::string& name,
-                            const std::string& archiveName,
+                            const ArchiveFileHandlePtr& archiveFile,
                             const std::string& modDir,
                             position_type position,
                             size_type stream_size)
     : m_name(name),
-      m_istream(archiveName),
-      m_substream(m_istream, position, stream_size),
+      m_substream(archiveFile, position, stream_size),
       m_zipstream(m_substream),
       m_textStream(m_zipstream),
       _modDir(game::current::getModPath(modDir))
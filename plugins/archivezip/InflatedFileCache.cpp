@@ -0,0 +1,99 @@
+#include "InflatedFileCache.h"
+
+InflatedFileCache::InflatedFileCache(std::size_t capacity) :
+	_capacity(capacity),
+	_size(0)
+{}
+
+bool InflatedFileCache::isEnabled() const
+{
+	return _capacity > 0;
+}
+
+void InflatedFileCache::setCapacity(std::size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_capacity = capacity;
+	evict();
+}
+
+std::size_t InflatedFileCache::getMaxFileSize() const
+{
+	return _capacity / 16;
+}
+
+InflatedFileCache::BufferPtr InflatedFileCache::find(const std::string& archiveName, std::size_t recordPosition)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	ItemMap::iterator found = _itemMap.find(Key(archiveName, recordPosition));
+
+	if (found == _itemMap.end())
+	{
+		return BufferPtr();
+	}
+
+	// Move to the front of the list
+	_items.splice(_items.begin(), _items, found->second);
+
+	return found->second->second;
+}
+
+void InflatedFileCache::insert(const std::string& archiveName, std::size_t recordPosition, const BufferPtr& buffer)
+{
+	if (buffer->size() > getMaxFileSize())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_lock);
+
+	Key key(archiveName, recordPosition);
+
+	if (_itemMap.find(key) != _itemMap.end())
+	{
+		return; // another thread has been faster
+	}
+
+	_items.push_front(Item(key, buffer));
+	_itemMap[key] = _items.begin();
+	_size += buffer->size();
+
+	evict();
+}
+
+void InflatedFileCache::removeArchive(const std::string& archiveName)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	ItemMap::iterator i = _itemMap.lower_bound(Key(archiveName, 0));
+
+	while (i != _itemMap.end() && i->first.first == archiveName)
+	{
+		_size -= i->second->second->size();
+		_items.erase(i->second);
+		_itemMap.erase(i++);
+	}
+}
+
+void InflatedFileCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_items.clear();
+	_itemMap.clear();
+	_size = 0;
+}
+
+void InflatedFileCache::evict()
+{
+	while (_size > _capacity && !_items.empty())
+	{
+		const Item& last = _items.back();
+
+		_size -= last.second->size();
+		_itemMap.erase(last.first);
+		_items.pop_back();
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A bounded cache of the contents of recently opened archive files, evicting
+ * the least recently used files when the total size exceeds the capacity.
+ * Repeated opens of the same small file (materials, defs, skins) are served
+ * from memory without reading and inflating the archive data again.
+ *
+ * Files are identified by the archive path and the position of their record.
+ * All methods are thread-safe.
+ */
+class InflatedFileCache
+{
+public:
+	typedef std::vector<unsigned char> Buffer;
+	typedef std::shared_ptr<const Buffer> BufferPtr;
+
+private:
+	typedef std::pair<std::string, std::size_t> Key;
+	typedef std::pair<Key, BufferPtr> Item;
+
+	// Most recently used items at the front
+	typedef std::list<Item> Items;
+	Items _items;
+
+	typedef std::map<Key, Items::iterator> ItemMap;
+	ItemMap _itemMap;
+
+	std::size_t _capacity;
+	std::size_t _size;
+
+	std::mutex _lock;
+
+public:
+	// Construct a cache holding up to capacity bytes, 0 disables the cache
+	InflatedFileCache(std::size_t capacity);
+
+	bool isEnabled() const;
+
+	// Changes the capacity, evicting files if necessary. 0 disables the cache.
+	void setCapacity(std::size_t capacity);
+
+	// Files larger than this are not cached, to not evict everything else at once
+	std::size_t getMaxFileSize() const;
+
+	// Returns the cached contents of the given file, or an empty pointer
+	BufferPtr find(const std::string& archiveName, std::size_t recordPosition);
+
+	// Adds the contents of the given file, evicting the least recently used ones if necessary
+	void insert(const std::string& archiveName, std::size_t recordPosition, const BufferPtr& buffer);
+
+	// Removes the cached files of the given archive, to be called when it is opened again
+	void removeArchive(const std::string& archiveName);
+
+	// Removes all cached files
+	void clear();
+
+private:
+	// Removes the least recently used files until the size fits the capacity, lock must be held
+	void evict();
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "iarchive.h"
+#include "archivelib.h"
+#include "gamelib.h"
+#include "ArchiveFileHandle.h"
+
+/**
+ * ArchiveFile stored uncompressed in a ZIP, read through the archive's shared file handle.
+ */
+class StoredZipArchiveFile :
+	public ArchiveFile
+{
+	std::string m_name;
+	ArchiveSubStream m_substream;
+	std::size_t m_size;
+
+public:
+	StoredZipArchiveFile(const std::string& name,
+						 const ArchiveFileHandlePtr& archiveFile,
+						 std::size_t position,
+						 std::size_t stream_size,
+						 std::size_t file_size) :
+		m_name(name),
+		m_substream(archiveFile, position, stream_size),
+		m_size(file_size)
+	{}
+
+	std::size_t size() const {
+		return m_size;
+	}
+
+	const std::string& getName() const {
+		return m_name;
+	}
+
+	InputStream& getInputStream() {
+		return m_substream;
+	}
+};
+
+/**
+ * ArchiveTextFile stored uncompressed in a ZIP, read through the archive's shared file handle.
+ */
+class StoredZipArchiveTextFile :
+	public ArchiveTextFile
+{
+	std::string m_name;
+	ArchiveSubStream m_substream;
+	BinaryToTextInputStream<ArchiveSubStream> m_textStream;
+
+	// Mod directory containing this file
+	std::string _modDir;
+
+public:
+	StoredZipArchiveTextFile(const std::string& name,
+							 const ArchiveFileHandlePtr& archiveFile,
+							 const std::string& modDir,
+							 std::size_t position,
+							 std::size_t stream_size) :
+		m_name(name),
+		m_substream(archiveFile, position, stream_size),
+		m_textStream(m_substream),
+		_modDir(game::current::getModPath(modDir))
+	{}
+
+	const std::string& getName() const {
+		return m_name;
+	}
+
+	TextInputStream& getInputStream() {
+		return m_textStream;
+	}
+
+	std::string getModName() const {
+		return _modDir;
+	}
+};
@@ -8,18 +8,47 @@
 
 #include "DeflatedArchiveFile.h"
 #include "DeflatedArchiveTextFile.h"
+#include "StoredZipArchiveFile.h"
+#include "BufferedArchiveFile.h"
 
-ZipArchive::ZipArchive(const std::string& name) :
+#include <vector>
+
+ZipArchive::ZipArchive(const std::string& name, InflatedFileCache* cache) :
 	m_name(name),
-	m_istream(name)
+	_file(new ArchiveFileHandle(name)),
+	_cache(cache),
+	_valid(false)
 {
-	if (!m_istream.failed()) {
-		if (!read_pkzip()) {
+	if (!_file->failed()) {
+		FileInputStream istream(name);
+		_valid = !istream.failed() && read_pkzip(istream);
+
+		if (!_valid) {
 			rError() << "ERROR: invalid zip-file " << name.c_str() << '\n';
 		}
 	}
 }
 
+ZipArchive::ZipArchive(const std::string& name, const Directory& directory, InflatedFileCache* cache) :
+	m_name(name),
+	_file(new ArchiveFileHandle(name)),
+	_cache(cache),
+	_valid(!_file->failed())
+{
+	for (Directory::const_iterator i = directory.begin(); i != directory.end(); ++i)
+	{
+		if (i->isDirectory)
+		{
+			m_filesystem[i->path] = 0;
+		}
+		else
+		{
+			m_filesystem[i->path] = new ZipRecord(i->position,
+				i->compressedSize, i->uncompressedSize, i->mode);
+		}
+	}
+}
+
 ZipArchive::~ZipArchive() {
 	for (ZipFileSystem::iterator i = m_filesystem.begin();
 		 i != m_filesystem.end(); ++i)
@@ -30,88 +59,208 @@ ZipArchive::~ZipArchive() {
 
 bool ZipArchive::failed() 
 {
-	return m_istream.failed();
+	return _file->failed();
 }
 
-ArchiveFilePtr ZipArchive::openFile(const std::string& name)
+bool ZipArchive::isValid() const
+{
+	return _valid;
+}
+
+void ZipArchive::getDirectory(Directory& directory)
+{
+	for (ZipFileSystem::iterator i = m_filesystem.begin(); i != m_filesystem.end(); ++i)
+	{
+		DirectoryEntry entry;
+
+		entry.path = i->first.string();
+		entry.isDirectory = i->second.is_directory();
+
+		if (entry.isDirectory)
+		{
+			entry.position = entry.compressedSize = entry.uncompressedSize = 0;
+			entry.mode = ZipRecord::eStored;
+		}
+		else
+		{
+			const ZipRecord& record = *i->second.file();
+
+			entry.position = record.m_position;
+			entry.compressedSize = record.m_stream_size;
+			entry.uncompressedSize = record.m_file_size;
+			entry.mode = record.m_mode;
+		}
+
+		directory.push_back(entry);
+	}
+}
+
+ZipRecord* ZipArchive::findRecord(const std::string& name)
 {
 	ZipFileSystem::iterator i = m_filesystem.find(name);
 
 	if (i != m_filesystem.end() && !i->second.is_directory())
-    {
-		ZipRecord* file = i->second.file();
-
-        FileInputStream::size_type position = 0;
-
-        {
-            // Guard against concurrent access
-            std::lock_guard<std::mutex> lock(_streamLock);
-
-            m_istream.seek(file->m_position);
-            zip_file_header file_header;
-            istream_read_zip_file_header(m_istream, file_header);
-            position = m_istream.tell();
-
-            if (file_header.z_magic != zip_file_header_magic)
-            {
-                rError() << "error reading zip file " << m_name << std::endl;
-                return ArchiveFilePtr();
-            }
-        }
-
-		switch (file->m_mode)
-        {
-			case ZipRecord::eStored:
-                return ArchiveFilePtr(new StoredArchiveFile(name, m_name, position, file->m_stream_size, file->m_file_size));
-			case ZipRecord::eDeflated:
-                return ArchiveFilePtr(new DeflatedArchiveFile(name, m_name, position, file->m_stream_size, file->m_file_size));
+	{
+		return i->second.file();
+	}
+
+	return NULL;
+}
+
+bool ZipArchive::getDataPosition(const ZipRecord& record, std::size_t& position)
+{
+	// Positional read, no need to guard against concurrent access
+	unsigned char buffer[zip_file_header_length];
+
+	if (_file->readAt(record.m_position, buffer, zip_file_header_length) != zip_file_header_length)
+	{
+		rError() << "error reading zip file " << m_name << std::endl;
+		return false;
+	}
+
+	zip_file_header file_header;
+	buffer_read_zip_file_header(buffer, file_header);
+
+	if (file_header.z_magic != zip_file_header_magic)
+	{
+		rError() << "error reading zip file " << m_name << std::endl;
+		return false;
+	}
+
+	position = record.m_position + zip_file_header_length + file_header.z_namlen + file_header.z_extras;
+
+	return true;
+}
+
+InflatedFileCache::BufferPtr ZipArchive::getCachedContents(const ZipRecord& record)
+{
+	if (_cache == NULL || !_cache->isEnabled() || record.m_file_size > _cache->getMaxFileSize())
+	{
+		return InflatedFileCache::BufferPtr();
+	}
+
+	InflatedFileCache::BufferPtr cached = _cache->find(m_name, record.m_position);
+
+	if (cached)
+	{
+		return cached;
+	}
+
+	std::size_t position = 0;
+
+	if (!getDataPosition(record, position))
+	{
+		return InflatedFileCache::BufferPtr();
+	}
+
+	std::shared_ptr<InflatedFileCache::Buffer> contents(new InflatedFileCache::Buffer(record.m_file_size));
+
+	if (!contents->empty())
+	{
+		ArchiveSubStream substream(_file, position, record.m_stream_size);
+		std::size_t bytesRead = 0;
+
+		switch (record.m_mode)
+		{
+		case ZipRecord::eStored:
+			bytesRead = substream.read(&contents->front(), contents->size());
+			break;
+
+		case ZipRecord::eDeflated:
+			{
+				DeflatedInputStream inflated(substream);
+				bytesRead = inflated.read(&contents->front(), contents->size());
+			}
+			break;
+		}
+
+		if (bytesRead != contents->size())
+		{
+			rError() << "error reading zip file " << m_name << std::endl;
+			return InflatedFileCache::BufferPtr();
 		}
 	}
+
+	_cache->insert(m_name, record.m_position, contents);
+
+	return contents;
+}
+
+ArchiveFilePtr ZipArchive::openFile(const std::string& name)
+{
+	ZipRecord* file = findRecord(name);
+
+	if (file == NULL)
+	{
+		return ArchiveFilePtr();
+	}
+
+	// Small files are served from memory
+	InflatedFileCache::BufferPtr contents = getCachedContents(*file);
+
+	if (contents)
+	{
+		return ArchiveFilePtr(new BufferedArchiveFile(name, contents));
+	}
+
+	std::size_t position = 0;
+
+	if (!getDataPosition(*file, position))
+	{
+		return ArchiveFilePtr();
+	}
+
+	switch (file->m_mode)
+	{
+		case ZipRecord::eStored:
+			return ArchiveFilePtr(new StoredZipArchiveFile(name, _file, position, file->m_stream_size, file->m_file_size));
+		case ZipRecord::eDeflated:
+			return ArchiveFilePtr(new DeflatedArchiveFile(name, _file, position, file->m_stream_size, file->m_file_size));
+	}
+
 	return ArchiveFilePtr();
 }
 
 ArchiveTextFilePtr ZipArchive::openTextFile(const std::string& name)
 {
-	ZipFileSystem::iterator i = m_filesystem.find(name);
+	ZipRecord* file = findRecord(name);
 
-	if (i != m_filesystem.end() && !i->second.is_directory())
-    {
-		ZipRecord* file = i->second.file();
-
-        FileInputStream::size_type position = 0;
-
-        {
-            // Guard against concurrent access
-            std::lock_guard<std::mutex> lock(_streamLock);
-
-            m_istream.seek(file->m_position);
-            zip_file_header file_header;
-            istream_read_zip_file_header(m_istream, file_header);
-
-            if (file_header.z_magic != zip_file_header_magic)
-            {
-                rError() << "error reading zip file " << m_name << std::endl;
-                return ArchiveTextFilePtr();
-            }
-        }
-
-		switch (file->m_mode)
-        {
-			case ZipRecord::eStored:
-				return ArchiveTextFilePtr(new StoredArchiveTextFile(name,
-					m_name,
-					m_name,
-					m_istream.tell(),
-					file->m_stream_size));
-
-			case ZipRecord::eDeflated:
-				return ArchiveTextFilePtr(new DeflatedArchiveTextFile(name,
-					m_name,
-					m_name,
-					m_istream.tell(),
-					file->m_stream_size));
-		}
+	if (file == NULL)
+	{
+		return ArchiveTextFilePtr();
 	}
+
+	InflatedFileCache::BufferPtr contents = getCachedContents(*file);
+
+	if (contents)
+	{
+		return ArchiveTextFilePtr(new BufferedArchiveTextFile(name, m_name, contents));
+	}
+
+	std::size_t position = 0;
+
+	if (!getDataPosition(*file, position))
+	{
+		return ArchiveTextFilePtr();
+	}
+
+	switch (file->m_mode)
+	{
+		case ZipRecord::eStored:
+			return ArchiveTextFilePtr(new StoredZipArchiveTextFile(name,
+				_file,
+				m_name,
+				position,
+				file->m_stream_size));
+
+		case ZipRecord::eDeflated:
+			return ArchiveTextFilePtr(new DeflatedArchiveTextFile(name,
+				_file,
+				m_name,
+				position,
+				file->m_stream_size));
+	}
+
 	return ArchiveTextFilePtr();
 }
 
@@ -124,60 +273,33 @@ void ZipArchive::forEachFile(VisitorFunc visitor, const std::string& root) {
 	m_filesystem.traverse(visitor, root);
 }
 
-bool ZipArchive::read_record() {
-	zip_magic magic;
-	istream_read_zip_magic(m_istream, magic);
-
-	if (!(magic == zip_root_dirent_magic)) {
+bool ZipArchive::read_record(const unsigned char*& position, const unsigned char* end)
+{
+	if (static_cast<std::size_t>(end - position) < zip_root_dirent_length) {
 		return false;
 	}
-	zip_version version_encoder;
-	istream_read_zip_version(m_istream, version_encoder);
-	zip_version version_extract;
-	istream_read_zip_version(m_istream, version_extract);
-	//unsigned short flags =
-	istream_read_int16_le(m_istream);
-	unsigned short compression_mode = istream_read_int16_le(m_istream);
 
-	if (compression_mode != Z_DEFLATED && compression_mode != 0) {
+	zip_root_dirent dirent;
+	buffer_read_zip_root_dirent(position, dirent);
+
+	if (!(dirent.z_magic == zip_root_dirent_magic)) {
 		return false;
 	}
 
-	zip_dostime dostime;
-	istream_read_zip_dostime(m_istream, dostime);
-
-	//unsigned int crc32 =
-	istream_read_int32_le(m_istream);
-
-	unsigned int compressed_size = istream_read_uint32_le(m_istream);
-	unsigned int uncompressed_size = istream_read_uint32_le(m_istream);
-	unsigned int namelength = istream_read_uint16_le(m_istream);
-	unsigned short extras = istream_read_uint16_le(m_istream);
-	unsigned short comment = istream_read_uint16_le(m_istream);
-
-	//unsigned short diskstart =
-	istream_read_int16_le(m_istream);
-	//unsigned short filetype =
-	istream_read_int16_le(m_istream);
-	//unsigned int filemode =
-	istream_read_int32_le(m_istream);
-
-	unsigned int position = istream_read_int32_le(m_istream);
-
-	// greebo: Read the filename directly into a newly constructed std::string.
+	if (dirent.z_compr != Z_DEFLATED && dirent.z_compr != 0) {
+		return false;
+	}
 
-	// I'm not entirely happy about this brute-force casting, but I wanted to
-	// avoid reading the filename into a temporary char[] array
-	// only to let its contents end up being copied by the std::string anyway.
-	// Alternative: use a static boost::shared_array here, resized to fit?
+	const unsigned char* name = position + zip_root_dirent_length;
+	std::size_t recordLength = zip_root_dirent_length + dirent.z_namlen + dirent.z_extras + dirent.z_comment;
 
-	std::string path(namelength, '\0');
+	if (static_cast<std::size_t>(end - position) < recordLength) {
+		return false;
+	}
 
-	m_istream.read(
-		reinterpret_cast<FileInputStream::byte_type*>(const_cast<char*>(path.data())),
-		namelength);
+	position += recordLength;
 
-	m_istream.seek(extras + comment, FileInputStream::cur);
+	std::string path(reinterpret_cast<const char*>(name), dirent.z_namlen);
 
 	if (path_is_directory(path.c_str())) {
 		m_filesystem[path] = 0;
@@ -190,32 +312,45 @@ bool ZipArchive::read_record() {
 				<< path << std::endl;
 		}
 		else {
-			file = new ZipRecord(position,
-								 compressed_size,
-								 uncompressed_size,
-								 (compression_mode == Z_DEFLATED) ? ZipRecord::eDeflated : ZipRecord::eStored);
+			file = new ZipRecord(dirent.z_off,
+								 dirent.z_csize,
+								 dirent.z_usize,
+								 (dirent.z_compr == Z_DEFLATED) ? ZipRecord::eDeflated : ZipRecord::eStored);
 		}
 	}
 
 	return true;
 }
 
-bool ZipArchive::read_pkzip() {
-	SeekableStream::position_type pos = pkzip_find_disk_trailer(m_istream);
+bool ZipArchive::read_pkzip(FileInputStream& istream) {
+	SeekableStream::position_type pos = pkzip_find_disk_trailer(istream);
 	if (pos != 0) {
 		zip_disk_trailer disk_trailer;
 
-		m_istream.seek(pos);
-		istream_read_zip_disk_trailer(m_istream, disk_trailer);
+		istream.seek(pos);
+		istream_read_zip_disk_trailer(istream, disk_trailer);
 
 		if (!(disk_trailer.z_magic == zip_disk_trailer_magic)) {
 			return false;
 		}
 
-		m_istream.seek(disk_trailer.z_rootseek);
+		// Read the whole central directory at once, the records are parsed from memory
+		std::vector<unsigned char> directory(disk_trailer.z_rootsize);
+
+		istream.seek(disk_trailer.z_rootseek);
+
+		if (directory.empty() || istream.read(
+				reinterpret_cast<FileInputStream::byte_type*>(&directory.front()),
+				directory.size()) != directory.size())
+		{
+			return disk_trailer.z_entries == 0;
+		}
+
+		const unsigned char* position = &directory.front();
+		const unsigned char* end = position + directory.size();
 
 		for (unsigned int i = 0; i < disk_trailer.z_entries; ++i) {
-			if (!read_record()) {
+			if (!read_record(position, end)) {
 				return false;
 			}
 		}
@@ -3,7 +3,9 @@
 #include "iarchive.h"
 #include "fs_filesystem.h"
 #include "stream/filestream.h"
-#include <mutex>
+#include "ArchiveFileHandle.h"
+#include "InflatedFileCache.h"
+#include <vector>
 
 class ZipRecord {
 public:
@@ -33,17 +35,49 @@ typedef GenericFileSystem<ZipRecord> ZipFileSystem;
 class ZipArchive :
 	public Archive
 {
+public:
+	// A flat copy of the parsed central directory, which can be
+	// stored to open the same archive again without parsing it
+	struct DirectoryEntry
+	{
+		std::string path;
+		bool isDirectory;
+		unsigned int position;
+		unsigned int compressedSize;
+		unsigned int uncompressedSize;
+		ZipRecord::ECompressionMode mode;
+	};
+	typedef std::vector<DirectoryEntry> Directory;
+
+private:
 	ZipFileSystem m_filesystem;
 	std::string m_name;
-	FileInputStream m_istream;
-    std::mutex _streamLock;
+
+	// The handle shared by all files opened from this archive
+	ArchiveFileHandlePtr _file;
+
+	// The cache for the contents of small files, can be NULL
+	InflatedFileCache* _cache;
+
+	// True if the central directory could be read
+	bool _valid;
 
 public:
-	ZipArchive(const std::string& name);
+	ZipArchive(const std::string& name, InflatedFileCache* cache = NULL);
+
+	// Opens the archive with the given directory instead of reading it from the file
+	ZipArchive(const std::string& name, const Directory& directory, InflatedFileCache* cache = NULL);
+
 	virtual ~ZipArchive();
 
 	bool failed();
 
+	// Returns false if the archive could not be opened or its directory is invalid
+	bool isValid() const;
+
+	// Copies the central directory into the given list
+	void getDirectory(Directory& directory);
+
 	virtual ArchiveFilePtr openFile(const std::string& name);
 	virtual ArchiveTextFilePtr openTextFile(const std::string& name);
 
@@ -51,7 +85,19 @@ public:
 	void forEachFile(VisitorFunc visitor, const std::string& root);
 
 private:
-	bool read_record();
-	bool read_pkzip();
+	// Parses the directory file header at the given position of the central
+	// directory buffer, advancing the position to the next header
+	bool read_record(const unsigned char*& position, const unsigned char* end);
+	bool read_pkzip(FileInputStream& istream);
+
+	// Returns the record of the given file, or NULL if not found
+	ZipRecord* findRecord(const std::string& name);
+
+	// Reads the local file header to find the position of the file data
+	bool getDataPosition(const ZipRecord& record, std::size_t& position);
+
+	// Returns the (inflated) contents of the given file, looking into the cache first.
+	// Returns an empty pointer if the file should not be cached or can't be read.
+	InflatedFileCache::BufferPtr getCachedContents(const ZipRecord& record);
 };
 typedef std::shared_ptr<ZipArchive> ZipArchivePtr;
@@ -0,0 +1,277 @@
+#include "ZipDirectoryCache.h"
+
+#include "itextstream.h"
+#include "os/fs.h"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const char CACHE_MAGIC[4] = { 'D', 'R', 'Z', 'C' };
+
+	// Increase this when changing the file layout, older files will be ignored
+	const std::uint32_t CACHE_VERSION = 1;
+
+	// Writes integers in little-endian order, like the zip format itself
+	class CacheWriter
+	{
+	private:
+		std::vector<char> _buffer;
+
+	public:
+		void writeUInt(std::uint64_t value, std::size_t numBytes)
+		{
+			for (std::size_t i = 0; i < numBytes; ++i)
+			{
+				_buffer.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+			}
+		}
+
+		void writeString(const std::string& str)
+		{
+			writeUInt(str.size(), 4);
+			_buffer.insert(_buffer.end(), str.begin(), str.end());
+		}
+
+		const std::vector<char>& getBuffer() const
+		{
+			return _buffer;
+		}
+	};
+
+	// Reads the values written by the CacheWriter, with bounds checks
+	class CacheReader
+	{
+	private:
+		const char* _pos;
+		const char* _end;
+		bool _failed;
+
+	public:
+		CacheReader(const char* begin, const char* end) :
+			_pos(begin),
+			_end(end),
+			_failed(false)
+		{}
+
+		bool failed() const
+		{
+			return _failed;
+		}
+
+		bool atEnd() const
+		{
+			return _pos == _end;
+		}
+
+		std::uint64_t readUInt(std::size_t numBytes)
+		{
+			if (static_cast<std::size_t>(_end - _pos) < numBytes)
+			{
+				_failed = true;
+				return 0;
+			}
+
+			std::uint64_t value = 0;
+
+			for (std::size_t i = 0; i < numBytes; ++i)
+			{
+				value |= static_cast<std::uint64_t>(static_cast<unsigned char>(*_pos++)) << (i * 8);
+			}
+
+			return value;
+		}
+
+		std::string readString()
+		{
+			std::size_t length = static_cast<std::size_t>(readUInt(4));
+
+			if (_failed || static_cast<std::size_t>(_end - _pos) < length)
+			{
+				_failed = true;
+				return std::string();
+			}
+
+			std::string str(_pos, length);
+			_pos += length;
+
+			return str;
+		}
+	};
+}
+
+ZipDirectoryCache::ZipDirectoryCache() :
+	_changed(false)
+{}
+
+void ZipDirectoryCache::load(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_filename = filename;
+	_archives.clear();
+	_changed = false;
+
+	std::ifstream stream(filename.c_str(), std::ios::binary);
+
+	if (!stream)
+	{
+		return; // no cache yet
+	}
+
+	// Read the whole file at once and parse it from memory
+	std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	if (buffer.size() < sizeof(CACHE_MAGIC) ||
+		!std::equal(CACHE_MAGIC, CACHE_MAGIC + sizeof(CACHE_MAGIC), buffer.begin()))
+	{
+		rWarning() << "[archivezip] Ignoring invalid directory cache " << filename << std::endl;
+		return;
+	}
+
+	CacheReader reader(&buffer.front() + sizeof(CACHE_MAGIC), &buffer.front() + buffer.size());
+
+	if (reader.readUInt(4) != CACHE_VERSION)
+	{
+		return; // written by a different version, will be replaced on save
+	}
+
+	std::size_t numArchives = static_cast<std::size_t>(reader.readUInt(4));
+
+	for (std::size_t a = 0; a < numArchives && !reader.failed(); ++a)
+	{
+		std::string path = reader.readString();
+
+		CachedArchive archive;
+		archive.size = reader.readUInt(8);
+		archive.modificationTime = static_cast<std::int64_t>(reader.readUInt(8));
+
+		std::shared_ptr<ZipArchive::Directory> directory(new ZipArchive::Directory);
+
+		std::size_t numEntries = static_cast<std::size_t>(reader.readUInt(4));
+
+		for (std::size_t e = 0; e < numEntries && !reader.failed(); ++e)
+		{
+			ZipArchive::DirectoryEntry entry;
+
+			entry.path = reader.readString();
+			entry.isDirectory = reader.readUInt(1) != 0;
+			entry.mode = reader.readUInt(1) != 0 ? ZipRecord::eDeflated : ZipRecord::eStored;
+			entry.position = static_cast<unsigned int>(reader.readUInt(4));
+			entry.compressedSize = static_cast<unsigned int>(reader.readUInt(4));
+			entry.uncompressedSize = static_cast<unsigned int>(reader.readUInt(4));
+
+			directory->push_back(entry);
+		}
+
+		archive.directory = directory;
+		_archives[path] = archive;
+	}
+
+	if (reader.failed() || !reader.atEnd())
+	{
+		rWarning() << "[archivezip] Ignoring corrupt directory cache " << filename << std::endl;
+		_archives.clear();
+		return;
+	}
+
+	rMessage() << "[archivezip] Loaded cached directories of " << _archives.size()
+		<< " archives" << std::endl;
+}
+
+void ZipDirectoryCache::save()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (!_changed || _filename.empty())
+	{
+		return;
+	}
+
+	CacheWriter writer;
+
+	// Drop the archives which don't exist anymore
+	std::vector<CachedArchives::const_iterator> archives;
+
+	for (CachedArchives::const_iterator i = _archives.begin(); i != _archives.end(); ++i)
+	{
+		boost::system::error_code ec;
+
+		if (fs::exists(i->first, ec))
+		{
+			archives.push_back(i);
+		}
+	}
+
+	writer.writeUInt(CACHE_VERSION, 4);
+	writer.writeUInt(archives.size(), 4);
+
+	for (std::size_t a = 0; a < archives.size(); ++a)
+	{
+		const CachedArchive& archive = archives[a]->second;
+
+		writer.writeString(archives[a]->first);
+		writer.writeUInt(archive.size, 8);
+		writer.writeUInt(static_cast<std::uint64_t>(archive.modificationTime), 8);
+		writer.writeUInt(archive.directory->size(), 4);
+
+		for (ZipArchive::Directory::const_iterator e = archive.directory->begin();
+			 e != archive.directory->end(); ++e)
+		{
+			writer.writeString(e->path);
+			writer.writeUInt(e->isDirectory ? 1 : 0, 1);
+			writer.writeUInt(e->mode == ZipRecord::eDeflated ? 1 : 0, 1);
+			writer.writeUInt(e->position, 4);
+			writer.writeUInt(e->compressedSize, 4);
+			writer.writeUInt(e->uncompressedSize, 4);
+		}
+	}
+
+	std::ofstream stream(_filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+	{
+		rWarning() << "[archivezip] Cannot write directory cache " << _filename << std::endl;
+		return;
+	}
+
+	const std::vector<char>& buffer = writer.getBuffer();
+
+	stream.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	stream.write(&buffer.front(), buffer.size());
+
+	_changed = false;
+}
+
+ZipDirectoryCache::DirectoryPtr ZipDirectoryCache::lookup(const std::string& archivePath,
+	std::uint64_t size, std::int64_t modificationTime)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	CachedArchives::const_iterator found = _archives.find(archivePath);
+
+	if (found == _archives.end() ||
+		found->second.size != size || found->second.modificationTime != modificationTime)
+	{
+		return DirectoryPtr(); // not cached or stale
+	}
+
+	return found->second.directory;
+}
+
+void ZipDirectoryCache::store(const std::string& archivePath, std::uint64_t size,
+	std::int64_t modificationTime, const DirectoryPtr& directory)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	CachedArchive& archive = _archives[archivePath];
+
+	archive.size = size;
+	archive.modificationTime = modificationTime;
+	archive.directory = directory;
+
+	_changed = true;
+}
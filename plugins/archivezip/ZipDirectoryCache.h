@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ZipArchive.h"
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+/**
+ * A persistent cache of the central directories of the opened zip archives,
+ * stored in a binary file in the user's settings folder. Each directory is
+ * keyed by the archive path and stored together with the file size and
+ * modification time of the archive, so changed archives are detected
+ * (and parsed again) when they are looked up.
+ *
+ * Lookups and insertions are thread-safe, archives are opened in parallel.
+ */
+class ZipDirectoryCache
+{
+public:
+	typedef std::shared_ptr<const ZipArchive::Directory> DirectoryPtr;
+
+private:
+	struct CachedArchive
+	{
+		std::uint64_t size;
+		std::int64_t modificationTime;
+		DirectoryPtr directory;
+	};
+
+	typedef std::map<std::string, CachedArchive> CachedArchives;
+	CachedArchives _archives;
+
+	std::mutex _lock;
+
+	// The file this cache has been loaded from
+	std::string _filename;
+
+	// True if entries have been added or replaced since loading
+	bool _changed;
+
+public:
+	ZipDirectoryCache();
+
+	// Loads the cache from the given file, an invalid or outdated file is ignored
+	void load(const std::string& filename);
+
+	// Writes the cache back to the file it has been loaded from, if it has been changed
+	void save();
+
+	// Returns the cached directory of the given archive, or an empty pointer if the
+	// archive is not cached or has been modified since it has been stored
+	DirectoryPtr lookup(const std::string& archivePath, std::uint64_t size, std::int64_t modificationTime);
+
+	// Stores the directory of the given archive, replacing any previous entry
+	void store(const std::string& archivePath, std::uint64_t size, std::int64_t modificationTime,
+			   const DirectoryPtr& directory);
+};
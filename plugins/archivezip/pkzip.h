@@ -116,6 +116,9 @@ inline void istream_read_zip_file_header(SeekableInputStream& istream, zip_file_
   istream.seek(file_header.z_namlen + file_header.z_extras, SeekableInputStream::cur);
 };
 
+/* the fixed-size part of a local file header, the filename and extra field follow */
+const unsigned int zip_file_header_length = 30;
+
 /* B. data descriptor
  * the data descriptor exists only if bit 3 of z_flags is set. It is byte aligned
  * and immediately follows the last byte of compressed data. It is only used if
@@ -194,6 +197,61 @@ inline void istream_read_zip_root_dirent(SeekableInputStream& istream, zip_root_
   istream.seek(root_dirent.z_namlen + root_dirent.z_extras + root_dirent.z_comment, SeekableInputStream::cur);
 }
 
+/* the fixed-size part of a directory file header, the filename follows */
+const unsigned int zip_root_dirent_length = 46;
+
+inline unsigned int buffer_read_uint16_le(const unsigned char* buffer)
+{
+  return buffer[0] | (buffer[1] << 8);
+}
+
+inline unsigned int buffer_read_uint32_le(const unsigned char* buffer)
+{
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<unsigned int>(buffer[3]) << 24);
+}
+
+/* reads the fixed-size part of a directory file header from a buffer holding
+ * at least zip_root_dirent_length bytes, e.g. a central directory read in one go */
+inline void buffer_read_zip_root_dirent(const unsigned char* buffer, zip_root_dirent& root_dirent)
+{
+  std::copy(buffer, buffer + 4, root_dirent.z_magic.m_value);
+  root_dirent.z_encoder.version = buffer[4];
+  root_dirent.z_encoder.ostype = buffer[5];
+  root_dirent.z_extract.version = buffer[6];
+  root_dirent.z_extract.ostype = buffer[7];
+  root_dirent.z_flags = buffer_read_uint16_le(buffer + 8);
+  root_dirent.z_compr = buffer_read_uint16_le(buffer + 10);
+  root_dirent.z_dostime.time = buffer_read_uint16_le(buffer + 12);
+  root_dirent.z_dostime.date = buffer_read_uint16_le(buffer + 14);
+  root_dirent.z_crc32 = buffer_read_uint32_le(buffer + 16);
+  root_dirent.z_csize = buffer_read_uint32_le(buffer + 20);
+  root_dirent.z_usize = buffer_read_uint32_le(buffer + 24);
+  root_dirent.z_namlen = buffer_read_uint16_le(buffer + 28);
+  root_dirent.z_extras = buffer_read_uint16_le(buffer + 30);
+  root_dirent.z_comment = buffer_read_uint16_le(buffer + 32);
+  root_dirent.z_diskstart = buffer_read_uint16_le(buffer + 34);
+  root_dirent.z_filetype = buffer_read_uint16_le(buffer + 36);
+  root_dirent.z_filemode = buffer_read_uint32_le(buffer + 38);
+  root_dirent.z_off = buffer_read_uint32_le(buffer + 42);
+}
+
+/* reads a local file header from a buffer holding at least zip_file_header_length bytes */
+inline void buffer_read_zip_file_header(const unsigned char* buffer, zip_file_header& file_header)
+{
+  std::copy(buffer, buffer + 4, file_header.z_magic.m_value);
+  file_header.z_extract.version = buffer[4];
+  file_header.z_extract.ostype = buffer[5];
+  file_header.z_flags = buffer_read_uint16_le(buffer + 6);
+  file_header.z_compr = buffer_read_uint16_le(buffer + 8);
+  file_header.z_dostime.time = buffer_read_uint16_le(buffer + 10);
+  file_header.z_dostime.date = buffer_read_uint16_le(buffer + 12);
+  file_header.z_crc32 = buffer_read_uint32_le(buffer + 14);
+  file_header.z_csize = buffer_read_uint32_le(buffer + 18);
+  file_header.z_usize = buffer_read_uint32_le(buffer + 22);
+  file_header.z_namlen = buffer_read_uint16_le(buffer + 26);
+  file_header.z_extras = buffer_read_uint16_le(buffer + 28);
+}
+
   /* end of central dir record */
 const zip_magic zip_disk_trailer_magic('P', 'K', 0x05, 0x06);
 const unsigned int disk_trailer_length = 22;
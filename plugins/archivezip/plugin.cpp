@@ -25,18 +25,79 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "iarchive.h"
 #include "debugging/debugging.h"
 #include "iregistry.h"
+#include "registry/registry.h"
 
 #include <iostream>
 
 #include "ZipArchive.h"
+#include "ZipDirectoryCache.h"
+#include "os/fs.h"
+
+namespace
+{
+	const char* const DIRECTORY_CACHE_FILE = "pk4cache.bin";
+
+	// The memory in MB used to keep the contents of recently opened files, 0 disables the cache
+	const char* const RKEY_FILE_CACHE_SIZE = "user/vfs/fileCacheSize";
+
+	// Returns the size and modification time of the given file, used to detect changed archives
+	bool getArchiveFileInfo(const std::string& name, std::uint64_t& size, std::int64_t& modificationTime)
+	{
+		boost::system::error_code ec;
+
+		size = fs::file_size(name, ec);
+		if (ec) return false;
+
+		modificationTime = fs::last_write_time(name, ec);
+		return !ec;
+	}
+}
 
 class ArchivePK4API :
 	public ArchiveLoader
 {
+private:
+	// The central directories of the archives opened in previous sessions
+	ZipDirectoryCache _directoryCache;
+
+	// Recently opened files, shared by all archives
+	InflatedFileCache _fileCache;
+
 public:
+	// The cache is enabled once the registry is available
+	ArchivePK4API() :
+		_fileCache(0)
+	{}
+
 	// greebo: Returns the opened file or NULL if failed.
 	virtual ArchivePtr openArchive(const std::string& name) {
-		return ZipArchivePtr(new ZipArchive(name));
+		// The archive might have been changed since it has been opened before
+		_fileCache.removeArchive(name);
+
+		std::uint64_t size = 0;
+		std::int64_t modificationTime = 0;
+
+		if (!getArchiveFileInfo(name, size, modificationTime)) {
+			return ZipArchivePtr(new ZipArchive(name, &_fileCache));
+		}
+
+		// Unchanged archives don't need to be parsed again
+		ZipDirectoryCache::DirectoryPtr cached = _directoryCache.lookup(name, size, modificationTime);
+
+		if (cached) {
+			return ZipArchivePtr(new ZipArchive(name, *cached, &_fileCache));
+		}
+
+		ZipArchivePtr archive(new ZipArchive(name, &_fileCache));
+
+		if (archive->isValid()) {
+			std::shared_ptr<ZipArchive::Directory> directory(new ZipArchive::Directory);
+			archive->getDirectory(*directory);
+
+			_directoryCache.store(name, size, modificationTime, directory);
+		}
+
+		return archive;
 	}
 
 	virtual const std::string& getExtension() {
@@ -63,6 +124,16 @@ public:
 
 	virtual void initialiseModule(const ApplicationContext& ctx) {
 		rMessage() << "ArchivePK4::initialiseModule called\n";
+
+		_directoryCache.load(ctx.getSettingsPath() + DIRECTORY_CACHE_FILE);
+
+		int cacheSize = registry::getValue<int>(RKEY_FILE_CACHE_SIZE);
+		_fileCache.setCapacity(cacheSize > 0 ? static_cast<std::size_t>(cacheSize) * 1024 * 1024 : 0);
+	}
+
+	virtual void shutdownModule() {
+		_directoryCache.save();
+		_fileCache.clear();
 	}
 };
 typedef std::shared_ptr<ArchivePK4API> ArchivePK4APIPtr;
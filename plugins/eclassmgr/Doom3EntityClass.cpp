@@ -327,7 +327,12 @@ void Doom3EntityClass::addAttribute(const EntityClassAttribute& attribute)
         EntityAttributeMap::value_type(attribute.getNameRef(), attribute)
     );
 
-    if (!result.second)
+    if (result.second)
+    {
+        // Map nodes don't move, the index can point to the new attribute
+        _attributeIndex.insert(attribute.getName(), &result.first->second);
+    }
+    else
     {
         EntityClassAttribute& existing = result.first->second;
 
@@ -478,24 +483,28 @@ bool Doom3EntityClass::isOfType(const std::string& className)
 	return false;
 }
 
+EntityClassAttribute* Doom3EntityClass::findAttribute(const std::string& name) const
+{
+    EntityClassAttribute* const* found = _attributeIndex.find(name,
+        [] (EntityClassAttribute* attr) -> const std::string& { return attr->getName(); });
+
+    return found != NULL ? *found : NULL;
+}
+
 // Find a single attribute
 EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name)
 {
-    StringPtr ref(new std::string(name));
+    EntityClassAttribute* found = findAttribute(name);
 
-    EntityAttributeMap::iterator f = _attributes.find(ref);
-
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+    return found != NULL ? *found : _emptyAttribute;
 }
 
 // Find a single attribute
 const EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name) const
 {
-    StringPtr ref(new std::string(name));
-
-    EntityAttributeMap::const_iterator f = _attributes.find(ref);
+    const EntityClassAttribute* found = findAttribute(name);
 
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+    return found != NULL ? *found : _emptyAttribute;
 }
 
 void Doom3EntityClass::clear()
@@ -510,6 +519,7 @@ void Doom3EntityClass::clear()
     _fixedSize = false;
 
     _attributes.clear();
+    _attributeIndex.clear();
     _model.clear();
     _skin.clear();
     _inheritanceResolved = false;
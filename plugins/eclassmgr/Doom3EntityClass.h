@@ -6,6 +6,7 @@
 #include "math/Vector3.h"
 #include "math/AABB.h"
 #include "string/string.h"
+#include "string/NocaseHashIndex.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -78,6 +79,12 @@ class Doom3EntityClass
     typedef std::map<StringPtr, EntityClassAttribute, StringCompareFunctor> EntityAttributeMap;
     EntityAttributeMap _attributes;
 
+    // Hash index on top of the above map, used by getAttribute(). Since
+    // resolveInheritance() copies the parent attributes into this class,
+    // inherited keys are found with a single lookup as well.
+    typedef string::NocaseHashIndex<EntityClassAttribute*> AttributeIndex;
+    AttributeIndex _attributeIndex;
+
     // The model and skin for this entity class (if it has one)
     std::string _model;
     std::string _skin;
@@ -106,6 +113,7 @@ class Doom3EntityClass
 private:
     // Clear all contents (done before parsing from tokens)
     void clear();
+    EntityClassAttribute* findAttribute(const std::string& name) const;
     void parseEditorSpawnarg(const std::string& key, const std::string& value);
     void setIsLight(bool val);
 
@@ -10,13 +10,14 @@
 #include "iuimanager.h"
 #include "ifilesystem.h"
 #include "archivelib.h"
-#include "parser/DefTokeniser.h"
+#include "parser/BufferedDefTokeniser.h"
 
 #include "Doom3EntityClass.h"
 #include "Doom3ModelDef.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <functional>
+#include <iterator>
 
 #include "debugging/ScopedDebugTimer.h"
 
@@ -346,9 +347,11 @@ void EClassManager::onFileSystemShutdown()
 // Extract all entitydefs and create objects accordingly.
 void EClassManager::parse(TextInputStream& inStr, const std::string& modDir)
 {
-	// Construct a tokeniser for the stream
+	// Read the file at once and construct a tokeniser working on the buffer
 	std::istream is(&inStr);
-    parser::BasicDefTokeniser<std::istream> tokeniser(is);
+	std::string contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+    parser::BufferedDefTokeniser tokeniser(contents);
 
     while (tokeniser.hasMoreTokens())
 	{
@@ -270,6 +270,8 @@ void Doom3Entity::insert(const std::string& key, const KeyValuePtr& keyValue)
 		KeyValuePair(key, keyValue)
 	);
 
+	_keyIndex.insert(key, _keyValues.size() - 1);
+
 	// Dereference the iterator to get a KeyValue& reference and notify the observers
 	notifyInsert(key, *i->second);
 
@@ -317,8 +319,9 @@ void Doom3Entity::erase(const KeyValues::iterator& i)
 	std::string key(i->first);
 	KeyValuePtr value(i->second);
 
-	// Actually delete the object from the list
+	// Actually delete the object from the list, this moves the keys behind it
 	_keyValues.erase(i);
+	rebuildKeyIndex();
 
 	// Notify about the deletion
 	notifyErase(key, *value);
@@ -341,34 +344,32 @@ void Doom3Entity::erase(const std::string& key)
 
 Doom3Entity::KeyValues::const_iterator Doom3Entity::find(const std::string& key) const
 {
-	for (KeyValues::const_iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
+	const std::size_t* index = _keyIndex.find(key, [this] (std::size_t i) -> const std::string&
 	{
-		if (boost::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+		return _keyValues[i].first;
+	});
 
-	// Not found
-	return _keyValues.end();
+	return index != NULL ? _keyValues.begin() + *index : _keyValues.end();
 }
 
 Doom3Entity::KeyValues::iterator Doom3Entity::find(const std::string& key)
 {
-	for (KeyValues::iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
+	const std::size_t* index = _keyIndex.find(key, [this] (std::size_t i) -> const std::string&
 	{
-		if (boost::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+		return _keyValues[i].first;
+	});
+
+	return index != NULL ? _keyValues.begin() + *index : _keyValues.end();
+}
 
-	// Not found
-	return _keyValues.end();
+void Doom3Entity::rebuildKeyIndex()
+{
+	_keyIndex.clear();
+
+	for (std::size_t i = 0; i < _keyValues.size(); ++i)
+	{
+		_keyIndex.insert(_keyValues[i].first, i);
+	}
 }
 
 } // namespace entity
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "KeyValue.h"
+#include "string/NocaseHashIndex.h"
 #include <memory>
 
 /** greebo: This is the implementation of the class Entity.
@@ -34,6 +35,10 @@ class Doom3Entity :
 	typedef std::vector<KeyValuePair> KeyValues;
 	KeyValues _keyValues;
 
+	// Positions of the keys in the above list, for the lookups by key
+	typedef string::NocaseHashIndex<std::size_t> KeyIndex;
+	KeyIndex _keyIndex;
+
 	typedef std::set<Observer*> Observers;
 	Observers _observers;
 
@@ -108,6 +113,9 @@ private:
 
 	KeyValues::iterator find(const std::string& key);
 	KeyValues::const_iterator find(const std::string& key) const;
+
+	// Re-creates the key index after keys have been removed
+	void rebuildKeyIndex();
 };
 
 } // namespace entity
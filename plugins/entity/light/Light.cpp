@@ -760,6 +760,55 @@ AABB Light::lightAABB() const
     return AABB(_originTransformed, m_doom3Radius.m_radiusTransformed);
 }
 
+AABB Light::lightVolumeAABB() const
+{
+    if (isProjected())
+    {
+        // The frustum is a pyramid with its tip in the light origin, spanned
+        // by the target, right and up vectors. Instead of calculating the
+        // rotated corners, take the largest distance of any point in the
+        // pyramid to the tip, which doesn't depend on the rotation.
+        double targetLength = _lightTargetTransformed.getLength();
+
+        double maxLength = targetLength;
+
+        if (useStartEnd())
+        {
+            maxLength = std::max<double>(maxLength, _lightStartTransformed.getLength());
+            maxLength = std::max<double>(maxLength, _lightEndTransformed.getLength());
+        }
+
+        if (targetLength <= 0)
+        {
+            return AABB(); // degenerate
+        }
+
+        // The pyramid widens proportionally beyond the target
+        double radius = (targetLength + _lightRightTransformed.getLength() +
+            _lightUpTransformed.getLength()) * maxLength / targetLength;
+
+        return AABB(worldOrigin(), Vector3(radius, radius, radius));
+    }
+
+    AABB bounds = localAABB();
+    bounds.origin += worldOrigin();
+
+    return AABB(
+        bounds.origin,
+        Vector3(
+            static_cast<float>(fabs(m_rotation[0] * bounds.extents[0])
+                                + fabs(m_rotation[3] * bounds.extents[1])
+                                + fabs(m_rotation[6] * bounds.extents[2])),
+            static_cast<float>(fabs(m_rotation[1] * bounds.extents[0])
+                                + fabs(m_rotation[4] * bounds.extents[1])
+                                + fabs(m_rotation[7] * bounds.extents[2])),
+            static_cast<float>(fabs(m_rotation[2] * bounds.extents[0])
+                                + fabs(m_rotation[5] * bounds.extents[1])
+                                + fabs(m_rotation[8] * bounds.extents[2]))
+        )
+    );
+}
+
 bool Light::intersectsAABB(const AABB& other) const
 {
     bool returnVal;
@@ -787,23 +836,7 @@ bool Light::intersectsAABB(const AABB& other) const
     else
     {
         // test against an AABB which contains the rotated bounds of this light.
-        AABB bounds = localAABB();
-        bounds.origin += worldOrigin();
-
-        returnVal = other.intersects(AABB(
-            bounds.origin,
-            Vector3(
-                static_cast<float>(fabs(m_rotation[0] * bounds.extents[0])
-                                    + fabs(m_rotation[3] * bounds.extents[1])
-                                    + fabs(m_rotation[6] * bounds.extents[2])),
-                static_cast<float>(fabs(m_rotation[1] * bounds.extents[0])
-                                    + fabs(m_rotation[4] * bounds.extents[1])
-                                    + fabs(m_rotation[7] * bounds.extents[2])),
-                static_cast<float>(fabs(m_rotation[2] * bounds.extents[0])
-                                    + fabs(m_rotation[5] * bounds.extents[1])
-                                    + fabs(m_rotation[8] * bounds.extents[2]))
-            )
-        ));
+        returnVal = other.intersects(lightVolumeAABB());
     }
 
     return returnVal;
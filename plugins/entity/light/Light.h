@@ -262,6 +262,11 @@ public:
 
     Matrix4 getLightTextureTransformation() const;
   	bool intersectsAABB(const AABB& other) const;
+
+	// World-space bounds enclosing the whole (rotated or projected) light volume,
+	// returns an invalid AABB if the volume is degenerate
+	AABB lightVolumeAABB() const;
+
 	const Matrix4& rotation() const;
 	Vector3 getLightOrigin() const;
 	const Vector3& colour() const;
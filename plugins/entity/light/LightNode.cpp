@@ -488,6 +488,11 @@ bool LightNode::intersectsAABB(const AABB& aabb) const
 	return _light.intersectsAABB(aabb);
 }
 
+AABB LightNode::lightAABB() const
+{
+	return _light.lightVolumeAABB();
+}
+
 Vector3 LightNode::getLightOrigin() const {
 	return _light.getLightOrigin();
 }
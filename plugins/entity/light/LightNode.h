@@ -124,6 +124,7 @@ public:
     Matrix4 getLightTextureTransformation() const;
     const ShaderPtr& getShader() const;
 	bool intersectsAABB(const AABB& other) const;
+	AABB lightAABB() const override;
 
 	Vector3 getLightOrigin() const;
 	const Matrix4& rotation() const;
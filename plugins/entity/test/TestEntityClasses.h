@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../Doom3Entity.h"
+#include "../../eclassmgr/Doom3EntityClass.h"
+#include "ieclass.h"
+
+#include <boost/format.hpp>
+
+/**
+ * Entity classes and spawnargs shared by the entity tests and benchmarks.
+ */
+namespace test
+{
+
+// Resembles an AI class with its inherited attributes
+inline eclass::Doom3EntityClassPtr createAIClass()
+{
+	eclass::Doom3EntityClassPtr eclass(new eclass::Doom3EntityClass("atdm:ai_guard"));
+
+	for (int i = 0; i < 600; ++i)
+	{
+		eclass->addAttribute(EntityClassAttribute("text",
+			(boost::format("def_attach_%d") % i).str(), std::to_string(i)));
+	}
+
+	eclass->addAttribute(EntityClassAttribute("text", "model", "models/guard.md5mesh"));
+	eclass->addAttribute(EntityClassAttribute("text", "editor_color", "1 .5 0"));
+	eclass->addAttribute(EntityClassAttribute("text", "health", "100"));
+
+	return eclass;
+}
+
+inline std::string spawnarg(int i)
+{
+	return (boost::format("Spawnarg_Key_%d") % i).str();
+}
+
+} // namespace test
@@ -0,0 +1,147 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE doom3EntityBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "TestEntityClasses.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <chrono>
+#include <map>
+
+using namespace entity;
+using namespace test;
+
+namespace
+{
+
+// The class attributes by name, ignoring case
+struct NocaseLess
+{
+	bool operator()(const std::string& lhs, const std::string& rhs) const
+	{
+		return string_less_nocase(lhs.c_str(), rhs.c_str());
+	}
+};
+
+typedef std::map<std::string, std::string, NocaseLess> AttributeValues;
+
+AttributeValues getAttributeValues(const IEntityClass& eclass)
+{
+	AttributeValues values;
+
+	eclass.forEachClassAttribute([&] (const EntityClassAttribute& attribute)
+	{
+		values[attribute.getName()] = attribute.getValue();
+	}, true);
+
+	return values;
+}
+
+// The previous lookups: a linear search through the spawnargs,
+// followed by a search of the class attribute map
+class ReferenceEntity
+{
+	std::vector<std::pair<std::string, std::string> > _keyValues;
+	const AttributeValues& _attributes;
+	std::string _empty;
+
+public:
+	ReferenceEntity(const AttributeValues& attributes) :
+		_attributes(attributes)
+	{}
+
+	void setKeyValue(const std::string& key, const std::string& value)
+	{
+		_keyValues.push_back(std::make_pair(key, value));
+	}
+
+	std::string getKeyValue(const std::string& key) const
+	{
+		for (std::size_t i = 0; i < _keyValues.size(); ++i)
+		{
+			if (boost::iequals(_keyValues[i].first, key))
+			{
+				return _keyValues[i].second;
+			}
+		}
+
+		AttributeValues::const_iterator f = _attributes.find(key);
+
+		return (f != _attributes.end()) ? f->second : _empty;
+	}
+};
+
+}
+
+// Compares the lookups on a map full of AI entities
+BOOST_AUTO_TEST_CASE(keyLookups)
+{
+	eclass::Doom3EntityClassPtr eclass = createAIClass();
+
+	const int numEntities = 4000;
+	const int numSpawnargs = 120;
+
+	AttributeValues attributeValues = getAttributeValues(*eclass);
+
+	std::vector<std::shared_ptr<Doom3Entity> > entities;
+	std::vector<std::shared_ptr<ReferenceEntity> > references;
+
+	for (int e = 0; e < numEntities; ++e)
+	{
+		entities.push_back(std::make_shared<Doom3Entity>(eclass));
+		references.push_back(std::make_shared<ReferenceEntity>(attributeValues));
+
+		for (int i = 0; i < numSpawnargs; ++i)
+		{
+			std::string value = std::to_string(e * i);
+			entities.back()->setKeyValue(spawnarg(i), value);
+			references.back()->setKeyValue(spawnarg(i), value);
+		}
+	}
+
+	// Keys of the spawnargs, then the typical queries of renderers and filters
+	std::vector<std::string> queries;
+
+	for (int i = 0; i < numSpawnargs; i += 7)
+	{
+		queries.push_back(spawnarg(i));
+	}
+
+	queries.push_back("model");
+	queries.push_back("health");
+	queries.push_back("editor_color");
+	queries.push_back("name");
+	queries.push_back("_color");
+	queries.push_back("light_radius");
+
+	std::size_t matches = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int e = 0; e < numEntities; ++e)
+	{
+		for (const std::string& key : queries)
+		{
+			matches += references[e]->getKeyValue(key).size();
+		}
+	}
+
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	for (int e = 0; e < numEntities; ++e)
+	{
+		for (const std::string& key : queries)
+		{
+			matches -= entities[e]->getKeyValue(key).size();
+		}
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_CHECK_EQUAL(matches, 0);
+
+	BOOST_TEST_MESSAGE(numEntities * queries.size() << " lookups on " << numEntities
+		<< " entities with " << numSpawnargs << " spawnargs: linear search "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count() << " ms, hashed "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count() << " ms");
+}
@@ -0,0 +1,115 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE doom3EntityTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestEntityClasses.h"
+
+using namespace entity;
+using namespace test;
+
+BOOST_AUTO_TEST_CASE(classAttributesAreFoundIgnoringCase)
+{
+	eclass::Doom3EntityClassPtr eclass = createAIClass();
+
+	BOOST_CHECK_EQUAL(eclass->getAttribute("Health").getValue(), "100");
+	BOOST_CHECK_EQUAL(eclass->getAttribute("DEF_ATTACH_599").getValue(), "599");
+	BOOST_CHECK(eclass->getAttribute("unknown").getName().empty());
+
+	// Adding an existing attribute keeps the value, but picks up the type and description
+	eclass->addAttribute(EntityClassAttribute("entity", "MODEL", "models/other.md5mesh", "The model"));
+
+	const EntityClassAttribute& model = eclass->getAttribute("model");
+	BOOST_CHECK_EQUAL(model.getValue(), "models/guard.md5mesh");
+	BOOST_CHECK_EQUAL(model.getType(), "entity");
+	BOOST_CHECK_EQUAL(model.getDescription(), "The model");
+
+	// Inherited attributes end up in the index of the subclass
+	eclass::Doom3EntityClassPtr subclass(new eclass::Doom3EntityClass("atdm:ai_guard_captain"));
+	subclass->addAttribute(EntityClassAttribute("text", "inherit", eclass->getName()));
+	subclass->addAttribute(EntityClassAttribute("text", "Health", "150"));
+
+	eclass::Doom3EntityClass::EntityClasses classes;
+	classes[eclass->getName()] = eclass;
+	classes[subclass->getName()] = subclass;
+
+	subclass->resolveInheritance(classes);
+
+	BOOST_CHECK_EQUAL(subclass->getParent(), eclass.get());
+	BOOST_CHECK_EQUAL(subclass->getAttribute("health").getValue(), "150");
+	BOOST_CHECK(!subclass->getAttribute("health").inherited);
+	BOOST_CHECK_EQUAL(subclass->getAttribute("Def_Attach_10").getValue(), "10");
+	BOOST_CHECK(subclass->getAttribute("Def_Attach_10").inherited);
+	BOOST_CHECK_EQUAL(subclass->getModelPath(), "models/guard.md5mesh");
+}
+
+BOOST_AUTO_TEST_CASE(keysAreFoundIgnoringCase)
+{
+	eclass::Doom3EntityClassPtr eclass = createAIClass();
+	Doom3Entity entity(eclass);
+
+	entity.setKeyValue("Name", "guard_1");
+	entity.setKeyValue("origin", "0 0 0");
+
+	BOOST_CHECK_EQUAL(entity.getKeyValue("name"), "guard_1");
+	BOOST_CHECK_EQUAL(entity.getKeyValue("NAME"), "guard_1");
+	BOOST_CHECK_EQUAL(entity.getKeyValue("ORIGIN"), "0 0 0");
+
+	// Setting a differently cased key changes the existing one
+	entity.setKeyValue("NaMe", "guard_2");
+	BOOST_CHECK_EQUAL(entity.getKeyValue("name"), "guard_2");
+	BOOST_CHECK_EQUAL(entity.getKeyValuePairs("").size(), 2);
+
+	// Class attributes are found regardless of case too
+	BOOST_CHECK_EQUAL(entity.getKeyValue("HEALTH"), "100");
+	BOOST_CHECK(entity.isInherited("Model"));
+	BOOST_CHECK_EQUAL(entity.getKeyValue("unknown"), "");
+}
+
+BOOST_AUTO_TEST_CASE(insertionOrderIsKept)
+{
+	eclass::Doom3EntityClassPtr eclass = createAIClass();
+	Doom3Entity entity(eclass);
+
+	for (int i = 0; i < 150; ++i)
+	{
+		entity.setKeyValue(spawnarg(i), std::to_string(i));
+	}
+
+	// Remove every third key, the others must still be found
+	for (int i = 0; i < 150; i += 3)
+	{
+		entity.setKeyValue(spawnarg(i), "");
+	}
+
+	for (int i = 0; i < 150; ++i)
+	{
+		BOOST_CHECK_EQUAL(entity.getKeyValue(spawnarg(i)), i % 3 == 0 ? "" : std::to_string(i));
+		BOOST_CHECK_EQUAL(entity.getEntityKeyValue(spawnarg(i)) != NULL, i % 3 != 0);
+	}
+
+	// Re-added keys go to the end
+	entity.setKeyValue(spawnarg(0), "again");
+
+	std::vector<std::string> keys;
+	entity.forEachKeyValue([&] (const std::string& key, const std::string& value)
+	{
+		keys.push_back(key);
+	});
+
+	BOOST_REQUIRE_EQUAL(keys.size(), 101);
+	BOOST_CHECK_EQUAL(keys.front(), spawnarg(1));
+	BOOST_CHECK_EQUAL(keys[1], spawnarg(2));
+	BOOST_CHECK_EQUAL(keys.back(), spawnarg(0));
+
+	// A copy has the same keys in the same order
+	Doom3Entity copy(entity);
+
+	std::vector<std::string> copiedKeys;
+	copy.forEachKeyValue([&] (const std::string& key, const std::string& value)
+	{
+		copiedKeys.push_back(key);
+	});
+
+	BOOST_CHECK(keys == copiedKeys);
+	BOOST_CHECK_EQUAL(copy.getKeyValue(spawnarg(0)), "again");
+}
@@ -10,6 +10,7 @@
 #include "igame.h"
 #include "ishaders.h"
 
+#include "util/ThreadPool.h"
 #include <functional>
 
 namespace filters
@@ -27,8 +28,17 @@ namespace {
 
 	// Registry key for persistent filter setting
 	const std::string RKEY_USER_ACTIVE_FILTERS = RKEY_USER_FILTER_BASE + "//activeFilter";
+
+	// Smaller subgraphs are updated in the calling thread
+	const std::size_t MIN_PARALLEL_UPDATE_NODES = 256;
 }
 
+BasicFilterSystem::BasicFilterSystem()
+{}
+
+BasicFilterSystem::~BasicFilterSystem()
+{}
+
 void BasicFilterSystem::setAllFilterStates(bool state)
 {
 	if (state)
@@ -476,7 +486,9 @@ bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string
 {
 	// Check if this item is in the visibility cache, returning
 	// its cached value if found
-	StringFlagCache::iterator cacheIter = _visibilityCache.find(name);
+	StringFlagCache::key_type key(type, name);
+
+	StringFlagCache::iterator cacheIter = _visibilityCache.find(key);
 	if (cacheIter != _visibilityCache.end())
 		return cacheIter->second;
 
@@ -499,7 +511,7 @@ bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string
 	}
 
 	// Cache the result and return to caller
-	_visibilityCache.insert(StringFlagCache::value_type(name, visFlag));
+	_visibilityCache.insert(StringFlagCache::value_type(key, visFlag));
 
 	return visFlag;
 }
@@ -558,10 +570,35 @@ bool BasicFilterSystem::setFilterRules(const std::string& filter,
 }
 
 void BasicFilterSystem::updateSubgraph(const scene::INodePtr& root) {
-	// Construct an InstanceUpdateWalker and traverse the scenegraph to update
+	// Construct an InstanceUpdateWalker and traverse the scenegraph to collect
 	// all instances
 	InstanceUpdateWalker walker;
 	root->traverse(walker);
+
+	// Run the filter checks in parallel, this is what takes the time.
+	// The active filters are not changed during this call.
+	if (walker.getNumItems() >= MIN_PARALLEL_UPDATE_NODES)
+	{
+		if (!_updatePool)
+		{
+			_updatePool.reset(new util::ThreadPool);
+		}
+
+		_updatePool->parallelFor(walker.getNumItems(), [&] (std::size_t i)
+		{
+			walker.evaluate(i);
+		});
+	}
+	else
+	{
+		for (std::size_t i = 0; i < walker.getNumItems(); ++i)
+		{
+			walker.evaluate(i);
+		}
+	}
+
+	// Update the nodes in this thread
+	walker.apply();
 }
 
 // Update scenegraph instances with filtered status
@@ -10,6 +10,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
+
+namespace util { class ThreadPool; }
 
 namespace filters
 {
@@ -27,11 +30,14 @@ class BasicFilterSystem
 	// Second table containing just the active filters
 	FilterTable _activeFilters;
 
-	// Cache of visibility flags for item names, to avoid having to
+	// Cache of visibility flags for item types and names, to avoid having to
 	// traverse the active filter list for each lookup
-	typedef std::map<std::string, bool> StringFlagCache;
+	typedef std::map<std::pair<FilterRule::Type, std::string>, bool> StringFlagCache;
 	StringFlagCache _visibilityCache;
 
+	// Evaluates the filters of the scene nodes in parallel, created on demand
+	std::unique_ptr<util::ThreadPool> _updatePool;
+
     sigc::signal<void> _filtersChangedSignal;
 
 private:
@@ -47,7 +53,8 @@ private:
 	void addFiltersFromXML(const xml::NodeList& nodes, bool readOnly);
 
 public:
-    virtual ~BasicFilterSystem() {}
+    BasicFilterSystem();
+    virtual ~BasicFilterSystem();
 
     // FilterSystem implementation
     sigc::signal<void> filtersChangedSignal() const;
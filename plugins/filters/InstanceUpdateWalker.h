@@ -42,11 +42,39 @@ public:
 /**
  * Scenegraph walker to update filtered status of Instances based on the
  * status of their parent entity class.
+ *
+ * The update runs in three steps: the traversal only collects the nodes,
+ * evaluate() runs the filter checks of all nodes (possibly in several
+ * threads) and apply() sets the filtered flags and deselects the hidden
+ * nodes in traversal order, which must happen in the main thread.
  */
 class InstanceUpdateWalker :
 	public scene::NodeVisitor
 {
 private:
+	static const std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+	struct Item
+	{
+		scene::INodePtr node;
+
+		// One of these is non-NULL for entities, patches and brushes
+		Entity* entity;
+		IPatch* patch;
+		IBrush* brush;
+
+		// Index of the closest entity above this node
+		std::size_t parent;
+
+		// The outcome of evaluate()
+		bool visible;
+	};
+
+	std::vector<Item> _items;
+
+	// Indices of the entities above the current node
+	std::vector<std::size_t> _entityStack;
+
 	// Helper visitors to update subgraphs
 	NodeVisibilityUpdater _hideWalker;
 	NodeVisibilityUpdater _showWalker;
@@ -66,63 +94,123 @@ public:
 	// Pre-descent walker function
 	bool pre(const scene::INodePtr& node)
 	{
-		// Retrieve the parent entity and check its entity class.
-		Entity* entity = Node_getEntity(node);
+		Item item;
 
-		if (entity != NULL)
-		{
-			// Check the eclass first
-			bool entityIsVisible = GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *entity) &&
-								   GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, *entity);
+		item.node = node;
+		item.entity = Node_getEntity(node);
+		item.patch = NULL;
+		item.brush = NULL;
+		item.parent = _entityStack.empty() ? NO_PARENT : _entityStack.back();
+		item.visible = true;
 
-			node->traverse(entityIsVisible ? _showWalker : _hideWalker);
+		if (item.entity == NULL)
+		{
+			IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
 
-			if (!entityIsVisible)
+			if (patchNode != NULL)
 			{
-				// de-select this node and all children
-				Deselector deselector;
-				node->traverse(deselector);
+				item.patch = &patchNode->getPatch();
 			}
 
-			// If the entity is hidden, don't traverse the child nodes
-			return entityIsVisible;
+			item.brush = Node_getIBrush(node);
 		}
+		else
+		{
+			_entityStack.push_back(_items.size());
+		}
+
+		_items.push_back(item);
 
-		// greebo: Update visibility of Patches
-		IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
+		return true;
+	}
 
-		if (patchNode != NULL)
+	void post(const scene::INodePtr& node)
+	{
+		if (!_entityStack.empty() && _items[_entityStack.back()].node == node)
 		{
-			bool isVisible = _patchesAreVisible && patchNode->getPatch().hasVisibleMaterial();
+			_entityStack.pop_back();
+		}
+	}
+
+	std::size_t getNumItems() const
+	{
+		return _items.size();
+	}
 
-			node->traverse(isVisible ? _showWalker : _hideWalker);
+	// Runs the filter checks for the item with the given index.
+	// Items can be evaluated concurrently, nothing is changed in the scene.
+	void evaluate(std::size_t index)
+	{
+		Item& item = _items[index];
+
+		if (item.entity != NULL)
+		{
+			// Check the eclass first
+			item.visible = GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *item.entity) &&
+						   GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, *item.entity);
+		}
+		else if (item.patch != NULL)
+		{
+			// greebo: Update visibility of Patches
+			item.visible = _patchesAreVisible && item.patch->hasVisibleMaterial();
+		}
+		else if (item.brush != NULL)
+		{
+			// greebo: Update visibility of Brushes
+			item.visible = _brushesAreVisible && item.brush->hasVisibleMaterial();
 		}
+	}
 
-		// greebo: Update visibility of Brushes
-		IBrush* brush = Node_getIBrush(node);
+	// Applies the evaluated visibility to the scene
+	void apply()
+	{
+		// Nodes below hidden entities are already taken care of
+		std::vector<bool> skipped(_items.size(), false);
 
-		if (brush != NULL)
+		for (std::size_t i = 0; i < _items.size(); ++i)
 		{
-			bool isVisible = _brushesAreVisible && brush->hasVisibleMaterial();
+			const Item& item = _items[i];
+
+			if (item.parent != NO_PARENT && (skipped[item.parent] || !_items[item.parent].visible))
+			{
+				skipped[i] = true;
+				continue;
+			}
 
-			node->traverse(isVisible ? _showWalker : _hideWalker);
+			if (item.entity != NULL)
+			{
+				item.node->traverse(item.visible ? _showWalker : _hideWalker);
+
+				if (!item.visible)
+				{
+					// de-select this node and all children
+					Deselector deselector;
+					item.node->traverse(deselector);
+				}
+
+				continue;
+			}
 
-			// In case the brush has at least one visible material trigger a fine-grained update
-			if (isVisible)
+			if (item.patch != NULL || item.brush != NULL)
 			{
-				brush->updateFaceVisibility();
+				item.node->traverse(item.visible ? _showWalker : _hideWalker);
+
+				// In case the brush has at least one visible material trigger a fine-grained update
+				if (item.brush != NULL && item.visible)
+				{
+					item.brush->updateFaceVisibility();
+				}
 			}
-		}
 
-		if (!node->visible())
-		{
-			// de-select this node and all children
-			Deselector deselector;
-			node->traverse(deselector);
+			if (!item.node->visible())
+			{
+				// de-select this node and all children
+				Deselector deselector;
+				item.node->traverse(deselector);
+			}
 		}
 
-		// Continue the traversal
-		return true;
+		_items.clear();
 	}
 };
 
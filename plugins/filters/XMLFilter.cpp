@@ -3,7 +3,7 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "ifilter.h"
-#include <boost/regex.hpp>
+#include "itextstream.h"
 #include <boost/algorithm/string/erase.hpp>
 
 namespace filters {
@@ -18,75 +18,99 @@ XMLFilter::XMLFilter(const std::string& name, bool readOnly) :
 // Test visibility of an item against all rules
 bool XMLFilter::isVisible(const FilterRule::Type type, const std::string& name) const
 {
-	// Iterate over the rules in this filter, checking if each one is a rule for
-	// the chosen item. If so, test the match expression and retrieve the visibility
-	// flag if there is a match.
+	bool visible = true;
+
+	if (!_cache.find(type, name, visible))
+	{
+		visible = matchRules(type, name);
+		_cache.insert(type, name, visible);
+	}
+
+	return visible;
+}
+
+bool XMLFilter::isEntityVisible(const FilterRule::Type type, const Entity& entity) const
+{
+	if (type == FilterRule::TYPE_ENTITYCLASS)
+	{
+		// Only the class name is involved, go through the cache
+		return isVisible(type, entity.getEntityClass()->getName());
+	}
 
 	bool visible = true; // default if unmodified by rules
 
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	if (type != FilterRule::TYPE_ENTITYKEYVALUE)
 	{
-		// Check the item type.
-		if (ruleIter->type != type)
+		return visible;
+	}
+
+	for (std::size_t i = 0; i < _rules.size(); ++i)
+	{
+		const FilterRule& rule = _rules[i];
+
+		if (rule.type != type || _ruleExpressions[i].empty())
 		{
 			continue;
 		}
 
-		// If we have a rule for this item, use boost's regex to match the query name
-		// against the "match" parameter
-		boost::regex ex(ruleIter->match);
-
-		if (boost::regex_match(name, ex))
+		if (boost::regex_match(entity.getKeyValue(rule.entityKey), _ruleExpressions[i]))
 		{
-			// Overwrite the visible flag with the value from the rule.
-			visible = ruleIter->show;
+			visible = rule.show;
 		}
 	}
 
-	// Pass back the current visibility value
 	return visible;
 }
 
-bool XMLFilter::isEntityVisible(const FilterRule::Type type, const Entity& entity) const
+bool XMLFilter::matchRules(const FilterRule::Type type, const std::string& name) const
 {
+	// Iterate over the rules in this filter, checking if each one is a rule for
+	// the chosen item. If so, test the match expression and retrieve the visibility
+	// flag if there is a match.
+
 	bool visible = true; // default if unmodified by rules
 
-	IEntityClassConstPtr eclass = entity.getEntityClass();
-	
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
-		if (ruleIter->type != type)
+		const FilterRule& rule = _rules[i];
+
+		// Check the item type.
+		if (rule.type != type || _ruleExpressions[i].empty())
 		{
 			continue;
 		}
 
-		if (type == FilterRule::TYPE_ENTITYCLASS)
+		if (boost::regex_match(name, _ruleExpressions[i]))
 		{
-			boost::regex ex(ruleIter->match);
-
-			if (boost::regex_match(eclass->getName(), ex))
-			{
-				visible = ruleIter->show;
-			}
-		}
-		else if (type == FilterRule::TYPE_ENTITYKEYVALUE)
-		{
-			boost::regex ex(ruleIter->match);
-
-			if (boost::regex_match(entity.getKeyValue(ruleIter->entityKey), ex))
-			{
-				visible = ruleIter->show;
-			}
+			// Overwrite the visible flag with the value from the rule.
+			visible = rule.show;
 		}
 	}
 
+	// Pass back the current visibility value
 	return visible;
 }
 
+void XMLFilter::compileRule(const FilterRule& rule)
+{
+	boost::regex ex;
+
+	try
+	{
+		ex.assign(rule.match);
+	}
+	catch (boost::regex_error& e)
+	{
+		rWarning() << "Filter " << _name << ": invalid match expression "
+			<< rule.match << ": " << e.what() << std::endl;
+	}
+
+	_ruleExpressions.push_back(ex);
+
+	// The results depend on the rules
+	_cache.clear();
+}
+
 // The command target
 void XMLFilter::toggle(bool newState)
 {
@@ -115,6 +139,14 @@ FilterRules XMLFilter::getRuleSet() {
 
 void XMLFilter::setRules(const FilterRules& rules) {
 	_rules = rules;
+
+	_ruleExpressions.clear();
+	_cache.clear();
+
+	for (FilterRules::const_iterator i = _rules.begin(); i != _rules.end(); ++i)
+	{
+		compileRule(*i);
+	}
 }
 
 void XMLFilter::updateEventName() {
@@ -124,4 +156,33 @@ void XMLFilter::updateEventName() {
 	_eventName = "Filter" + _eventName;
 }
 
+bool XMLFilter::ResultCache::find(FilterRule::Type type, const std::string& name, bool& visible)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	std::map<Key, bool>::const_iterator i = _results.find(Key(type, name));
+
+	if (i == _results.end())
+	{
+		return false;
+	}
+
+	visible = i->second;
+	return true;
+}
+
+void XMLFilter::ResultCache::insert(FilterRule::Type type, const std::string& name, bool visible)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_results.insert(std::make_pair(Key(type, name), visible));
+}
+
+void XMLFilter::ResultCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_results.clear();
+}
+
 } // namespace filters
@@ -3,6 +3,9 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <mutex>
+#include <boost/regex.hpp>
 #include "ifilter.h"
 
 namespace filters
@@ -16,6 +19,36 @@ namespace filters
 class XMLFilter {
 private:
 
+	/**
+	 * Thread-safe cache of the visibility results for item names, such that
+	 * textures and entity classes are matched only once against the rules.
+	 * Copies of a filter start with an empty cache.
+	 */
+	class ResultCache
+	{
+	private:
+		typedef std::pair<FilterRule::Type, std::string> Key;
+		std::map<Key, bool> _results;
+		std::mutex _lock;
+
+	public:
+		ResultCache() {}
+		ResultCache(const ResultCache& other) {}
+
+		ResultCache& operator=(const ResultCache& other)
+		{
+			clear();
+			return *this;
+		}
+
+		// Returns true and fills in the result if the item is known
+		bool find(FilterRule::Type type, const std::string& name, bool& visible);
+
+		void insert(FilterRule::Type type, const std::string& name, bool visible);
+
+		void clear();
+	};
+
 	// Text name of filter (from game.xml)
 	std::string _name;
 
@@ -25,6 +58,12 @@ private:
 	// Ordered list of rule objects
 	FilterRules _rules;
 
+	// The compiled match expressions of the rules, same order as _rules.
+	// Invalid expressions are left empty and never match.
+	std::vector<boost::regex> _ruleExpressions;
+
+	mutable ResultCache _cache;
+
 	// True if this filter can't be changed
 	bool _readonly;
 
@@ -51,6 +90,7 @@ public:
 	void addRule(const FilterRule::Type type, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::Create(type, match, show));
+		compileRule(_rules.back());
 	}
 
 	/** Add an entitykeyvalue rule to this filter.
@@ -68,10 +108,12 @@ public:
 	void addEntityKeyValueRule(const std::string& key, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::CreateEntityKeyValueRule(key, match, show));
+		compileRule(_rules.back());
 	}
 
 	/** Test a given item for visibility against all of the rules
-	 * in this XMLFilter.
+	 * in this XMLFilter. The result is cached until the rules change.
+	 * This method can be called from several threads at once.
 	 *
 	 * @param type
 	 * Class of the item to test - "texture", "entityclass" etc
@@ -82,7 +124,8 @@ public:
 	bool isVisible(const FilterRule::Type type, const std::string& name) const;
 
 	/** Test a given entity for visibility against all of the rules
-	 * in this XMLFilter.
+	 * in this XMLFilter. Entity class results are cached per class name.
+	 * This method can be called from several threads at once.
 	 *
 	 * @param type
 	 * Class of the item to test - "texture", "entityclass" etc
@@ -116,6 +159,12 @@ public:
 
 private:
 	void updateEventName();
+
+	// Appends the compiled match expression of the given rule
+	void compileRule(const FilterRule& rule);
+
+	// Matches the given name against the rules of the given type
+	bool matchRules(const FilterRule::Type type, const std::string& name) const;
 };
 
 
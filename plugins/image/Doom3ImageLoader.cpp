@@ -22,26 +22,32 @@ namespace
 // Registry key holding texture types
 const char* RKEY_IMAGE_TYPES = "/filetypes/texture//extension";
 
-ImageTypeLoader::Extensions getGameFileImageExtensions()
+ImageTypeLoader::Extensions loadGameFileImageExtensions()
 {
-	static ImageTypeLoader::Extensions _extensions;
+	ImageTypeLoader::Extensions extensions;
 
-	if (_extensions.empty())
+	// Load the texture types from the .game file
+	xml::NodeList texTypes = GlobalGameManager().currentGame()->getLocalXPath(RKEY_IMAGE_TYPES);
+
+	for (xml::NodeList::const_iterator i = texTypes.begin();
+		 i != texTypes.end();
+		 ++i)
 	{
-		// Load the texture types from the .game file
-		xml::NodeList texTypes = GlobalGameManager().currentGame()->getLocalXPath(RKEY_IMAGE_TYPES);
-
-		for (xml::NodeList::const_iterator i = texTypes.begin();
-			 i != texTypes.end();
-			 ++i)
-		{
-			// Get the file extension
-			std::string extension = i->getContent();
-			boost::algorithm::to_lower(extension);
-            _extensions.push_back(extension);
-		}
+		// Get the file extension
+		std::string extension = i->getContent();
+		boost::algorithm::to_lower(extension);
+		extensions.push_back(extension);
 	}
 
+	return extensions;
+}
+
+// Images are loaded from the texture decoder threads too, the
+// initialisation of the local static is thread-safe
+const ImageTypeLoader::Extensions& getGameFileImageExtensions()
+{
+	static const ImageTypeLoader::Extensions _extensions = loadGameFileImageExtensions();
+
 	return _extensions;
 }
 
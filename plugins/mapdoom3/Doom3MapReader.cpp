@@ -5,10 +5,14 @@
 #include "igame.h"
 #include "ientity.h"
 #include "string/string.h"
+#include "util/ThreadPool.h"
+#include "parser/BufferedDefTokeniser.h"
 
 #include "Doom3MapFormat.h"
 
 #include "i18n.h"
+#include <deque>
+#include <iterator>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -19,6 +23,212 @@
 
 namespace map {
 
+namespace
+{
+	// The map text is cut into chunks of (at least) this size
+	const std::size_t CHUNK_SIZE = 256 * 1024;
+
+	// The number of parsed chunks per worker thread waiting for insertion
+	const std::size_t CHUNKS_PER_THREAD = 4;
+
+	// Returns the position of the next curly brace at or after the given position,
+	// skipping quoted strings and comments the same way the DefTokeniser does
+	std::size_t findBrace(const std::string& text, std::size_t pos)
+	{
+		const std::size_t size = text.size();
+
+		while (pos < size)
+		{
+			switch (text[pos])
+			{
+			case '{':
+			case '}':
+				return pos;
+
+			case '"':
+				// Skip to the closing quote, stepping over escaped characters
+				for (++pos; pos < size && text[pos] != '"'; ++pos)
+				{
+					if (text[pos] == '\\') ++pos;
+				}
+				++pos;
+				break;
+
+			case '/':
+				if (pos + 1 < size && text[pos + 1] == '/')
+				{
+					pos = text.find_first_of("\r\n", pos + 2);
+				}
+				else if (pos + 1 < size && text[pos + 1] == '*')
+				{
+					pos = text.find("*/", pos + 2);
+					if (pos != std::string::npos) pos += 2;
+				}
+				else
+				{
+					++pos;
+				}
+				break;
+
+			default:
+				++pos;
+			}
+		}
+
+		return std::string::npos;
+	}
+
+	// Hands the chunks over from the splitter thread to the reading thread in
+	// file order, limiting the number of chunks kept in memory
+	template<typename Chunk>
+	class ChunkQueue
+	{
+	private:
+		struct Entry
+		{
+			std::shared_ptr<Chunk> chunk;
+			std::future<void> result;
+		};
+		std::deque<Entry> _entries;
+
+		std::size_t _capacity;
+		bool _finished;
+		bool _aborted;
+
+		// An exception which stopped the splitter thread
+		std::exception_ptr _error;
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+
+	public:
+		ChunkQueue(std::size_t capacity) :
+			_capacity(capacity),
+			_finished(false),
+			_aborted(false)
+		{}
+
+		// Blocks until there's room for another chunk, returns false if the queue has been aborted
+		bool waitForSpace()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			_condition.wait(lock, [this]() { return _aborted || _entries.size() < _capacity; });
+
+			return !_aborted;
+		}
+
+		void push(const std::shared_ptr<Chunk>& chunk, std::future<void>&& result)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+
+				Entry entry = { chunk, std::move(result) };
+				_entries.push_back(std::move(entry));
+			}
+
+			_condition.notify_all();
+		}
+
+		// Called by the splitter thread after the last chunk, passing the exception it might have run into
+		void finish(const std::exception_ptr& error)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+
+				_finished = true;
+				_error = error;
+			}
+
+			_condition.notify_all();
+		}
+
+		// Blocks until the next chunk is available, returns false after the last one
+		bool pop(std::shared_ptr<Chunk>& chunk, std::future<void>& result)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+
+				_condition.wait(lock, [this]() { return _finished || !_entries.empty(); });
+
+				if (_entries.empty())
+				{
+					if (_error)
+					{
+						std::rethrow_exception(_error);
+					}
+
+					return false;
+				}
+
+				chunk = _entries.front().chunk;
+				result = std::move(_entries.front().result);
+
+				_entries.pop_front();
+			}
+
+			_condition.notify_all();
+
+			return true;
+		}
+
+		// Tells the splitter thread to stop
+		void abort()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_aborted = true;
+			}
+
+			_condition.notify_all();
+		}
+	};
+
+	// Replays the tokens a worker thread collected for a primitive
+	class TokenListTokeniser :
+		public parser::DefTokeniser
+	{
+	private:
+		const std::vector<std::string>& _tokens;
+		std::size_t _next;
+
+	public:
+		TokenListTokeniser(const std::vector<std::string>& tokens) :
+			_tokens(tokens),
+			_next(0)
+		{}
+
+		bool hasMoreTokens() const
+		{
+			return _next < _tokens.size();
+		}
+
+		std::string nextToken()
+		{
+			std::string token = peek();
+			++_next;
+
+			return token;
+		}
+
+		boost::string_ref nextTokenRef() override
+		{
+			peek();
+			return _tokens[_next++];
+		}
+
+		std::string peek() const
+		{
+			if (!hasMoreTokens())
+			{
+				throw parser::ParseException("DefTokeniser: no more tokens");
+			}
+
+			return _tokens[_next];
+		}
+	};
+}
+
 Doom3MapReader::Doom3MapReader(IMapImportFilter& importFilter) : 
 	_importFilter(importFilter),
 	_entityCount(0),
@@ -30,32 +240,114 @@ void Doom3MapReader::readFromStream(std::istream& stream)
 	// Call the virtual method to initialise the primitve parser map (if not done yet)
 	initPrimitiveParsers();
 
-	// The tokeniser used to split the stream into pieces
-	parser::BasicDefTokeniser<std::istream> tok(stream);
+	// The stream is read at once, remember where we started to report the progress
+	std::streamoff streamStart = stream.tellg();
+
+	std::string mapText((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	// The version tag is everything before the first entity
+	std::size_t headerEnd = findBrace(mapText, 0);
+
+	if (headerEnd == std::string::npos)
+	{
+		headerEnd = mapText.size();
+	}
+
+	parser::BufferedDefTokeniser headerTok(mapText.data(), headerEnd);
 
 	// Try to parse the map version (throws on failure)
-	parseMapVersion(tok);
+	parseMapVersion(headerTok);
+
+	util::ThreadPool workers;
+	ChunkQueue<ParsedChunk> queue(workers.getNumThreads() * CHUNKS_PER_THREAD);
 
-	// Read each entity in the map, until EOF is reached
-	while (tok.hasMoreTokens())
+	// Cut the map text after complete entities or primitives (the worldspawn
+	// usually contains most of the primitives), and hand the chunks to the workers
+	std::thread splitter([&]()
 	{
-		// Create an entity node by parsing from the stream. If there is an
-		// exception, display it and return
 		try
 		{
-			parseEntity(tok);
+			std::shared_ptr<ParsedChunk> chunk = std::make_shared<ParsedChunk>();
+			chunk->start = headerEnd;
+			chunk->depth = 0;
+
+			auto submitChunk = [&](std::size_t end, bool isLast)
+			{
+				chunk->end = end;
+				chunk->isLast = isLast;
+
+				std::shared_ptr<ParsedChunk> parsed = chunk;
+				queue.push(parsed, workers.enqueue([this, &mapText, parsed]() { parseChunk(mapText, *parsed); }));
+			};
+
+			std::size_t depth = 0;
+
+			for (std::size_t pos = findBrace(mapText, headerEnd);
+				 pos != std::string::npos;
+				 pos = findBrace(mapText, pos + 1))
+			{
+				if (mapText[pos] == '{')
+				{
+					++depth;
+					continue;
+				}
+
+				if (depth > 0) --depth;
+
+				if (depth <= 1 && pos + 1 - chunk->start >= CHUNK_SIZE)
+				{
+					if (!queue.waitForSpace()) return; // reading has been aborted
+
+					submitChunk(pos + 1, false);
+
+					chunk = std::make_shared<ParsedChunk>();
+					chunk->start = pos + 1;
+					chunk->depth = depth;
+				}
+			}
+
+			if (!queue.waitForSpace()) return;
+
+			submitChunk(mapText.size(), true);
+
+			queue.finish(std::exception_ptr());
 		}
-		catch (FailureException& e)
+		catch (...)
 		{
-			std::string text = (boost::format(_("Failed parsing entity %d:\n%s")) % _entityCount % e.what()).str();
-
-			// Re-throw with more text
-			throw FailureException(text);
+			queue.finish(std::current_exception());
 		}
+	});
+
+	try
+	{
+		std::shared_ptr<ParsedChunk> chunk;
+		std::future<void> result;
+
+		while (queue.pop(chunk, result))
+		{
+			// Parse errors are stored in the chunk, this will only re-throw unexpected ones
+			result.get();
+
+			// Keep the stream position in sync for the import filter's progress display
+			if (streamStart != -1)
+			{
+				stream.clear();
+				stream.seekg(streamStart + static_cast<std::streamoff>(chunk->end));
+			}
 
-		_entityCount++;
+			insertChunk(*chunk);
+		}
+	}
+	catch (...)
+	{
+		// The workers are finishing their chunks before the pool is destroyed
+		queue.abort();
+		splitter.join();
+		throw;
 	}
 
+	splitter.join();
+
 	// EOF reached, success
 }
 
@@ -118,26 +410,208 @@ void Doom3MapReader::parseMapVersion(parser::DefTokeniser& tok)
 	// success
 }
 
-void Doom3MapReader::parsePrimitive(parser::DefTokeniser& tok, const scene::INodePtr& parentEntity)
+void Doom3MapReader::parseChunk(const std::string& mapText, ParsedChunk& chunk) const
 {
-    _primitiveCount++;
+	parser::BufferedDefTokeniser tok(mapText.data() + chunk.start, chunk.end - chunk.start);
+
+	// Chunks can start in the middle of an entity
+	bool insideEntity = chunk.depth > 0;
+
+	try
+	{
+		while (tok.hasMoreTokens())
+		{
+			if (!insideEntity)
+			{
+				// Start parsing, first token must be an open brace
+				tok.assertNextToken("{");
+
+				chunk.items.push_back(ParsedItem(ParsedItem::EntityStart));
+				insideEntity = true;
+				continue;
+			}
 
-	std::string primitiveKeyword = tok.nextToken();
+			// Token must be either a key, a "{" to indicate the start of a
+			// primitive, or a "}" to indicate the end of the entity
+			boost::string_ref token = tok.nextTokenRef();
 
-	// Get a parser for this keyword
-	PrimitiveParsers::const_iterator p = _primitiveParsers.find(primitiveKeyword);
+			if (token == "{") // PRIMITIVE
+			{
+				parsePrimitive(tok, chunk);
 
-	if (p == _primitiveParsers.end())
+				// Stop at the first failing primitive
+				if (chunk.items.back().error)
+				{
+					return;
+				}
+			}
+			else if (token == "}") // END OF ENTITY
+			{
+				chunk.items.push_back(ParsedItem(ParsedItem::EntityEnd));
+				insideEntity = false;
+			}
+			else // KEY
+			{
+				std::string key = token.to_string();
+				std::string value = tok.nextToken();
+
+				// Sanity check (invalid number of tokens will get us out of sync)
+				if (value == "{" || value == "}")
+				{
+					std::string text = (boost::format(_("Parsed invalid value '%s' for key '%s'")) % value % key).str();
+					throw FailureException(text);
+				}
+
+				chunk.items.push_back(ParsedItem(ParsedItem::KeyValue));
+				chunk.items.back().key = key;
+				chunk.items.back().value = value;
+			}
+		}
+
+		// Unless the map file ends here, the entity is continued in the next chunk
+		if (insideEntity && chunk.isLast)
+		{
+			throw parser::ParseException("DefTokeniser: no more tokens");
+		}
+	}
+	catch (...)
 	{
-		throw FailureException("Unknown primitive type: " + primitiveKeyword);
+		// Errors are reported once the reading thread arrives at this chunk
+		chunk.error = std::current_exception();
 	}
+}
 
-	const PrimitiveParserPtr& parser = p->second;
+void Doom3MapReader::parsePrimitive(parser::DefTokeniser& tok, ParsedChunk& chunk) const
+{
+	chunk.items.push_back(ParsedItem(ParsedItem::Primitive));
+	ParsedItem& item = chunk.items.back();
 
-	// Try to parse the primitive, throwing exception if failed
 	try
 	{
-		scene::INodePtr primitive = parser->parse(tok);
+		std::string primitiveKeyword = tok.nextToken();
+
+		// Get a parser for this keyword
+		PrimitiveParsers::const_iterator p = _primitiveParsers.find(primitiveKeyword);
+
+		if (p == _primitiveParsers.end())
+		{
+			throw FailureException("Unknown primitive type: " + primitiveKeyword);
+		}
+
+		const PrimitiveParserPtr& parser = p->second;
+
+		if (parser->canParseDeferred())
+		{
+			item.primitive = parser->parseDeferred(tok);
+			return;
+		}
+
+		// Collect the tokens up to the primitive's closing brace, the parser will see them on the main thread
+		item.parser = parser;
+
+		for (std::size_t depth = 1; depth > 0 && tok.hasMoreTokens();)
+		{
+			item.tokens.push_back(tok.nextToken());
+
+			if (item.tokens.back() == "{")
+			{
+				++depth;
+			}
+			else if (item.tokens.back() == "}")
+			{
+				--depth;
+			}
+		}
+	}
+	catch (...)
+	{
+		item.error = std::current_exception();
+	}
+}
+
+void Doom3MapReader::insertChunk(const ParsedChunk& chunk)
+{
+	try
+	{
+		for (const ParsedItem& item : chunk.items)
+		{
+			switch (item.type)
+			{
+			case ParsedItem::EntityStart:
+				// The entity is created when primitives start or the end of the entity is reached
+				_keyValues.clear();
+				_entity.reset();
+
+				// Reset the primitive counter, we're starting a new entity
+				_primitiveCount = 0;
+				break;
+
+			case ParsedItem::KeyValue:
+				_keyValues.insert(EntityKeyValues::value_type(item.key, item.value));
+				break;
+
+			case ParsedItem::Primitive:
+				// Create the entity right now, if not yet done
+				if (!_entity)
+				{
+					_entity = createEntity(_keyValues);
+				}
+
+				insertPrimitive(item, _entity);
+				break;
+
+			case ParsedItem::EntityEnd:
+				// Create the entity if necessary and insert it
+				if (!_entity)
+				{
+					_entity = createEntity(_keyValues);
+				}
+
+				_importFilter.addEntity(_entity);
+				_entity.reset();
+
+				_entityCount++;
+				break;
+			}
+		}
+
+		if (chunk.error)
+		{
+			std::rethrow_exception(chunk.error);
+		}
+	}
+	catch (FailureException& e)
+	{
+		std::string text = (boost::format(_("Failed parsing entity %d:\n%s")) % _entityCount % e.what()).str();
+
+		// Re-throw with more text
+		throw FailureException(text);
+	}
+}
+
+void Doom3MapReader::insertPrimitive(const ParsedItem& item, const scene::INodePtr& parentEntity)
+{
+    _primitiveCount++;
+
+	// Try to create the primitive, throwing exception if failed
+	try
+	{
+		if (item.error)
+		{
+			std::rethrow_exception(item.error);
+		}
+
+		scene::INodePtr primitive;
+
+		if (item.parser)
+		{
+			TokenListTokeniser tok(item.tokens);
+			primitive = item.parser->parse(tok);
+		}
+		else if (item.primitive)
+		{
+			primitive = item.primitive->createNode();
+		}
 
 		if (!primitive)
 		{
@@ -192,70 +666,4 @@ scene::INodePtr Doom3MapReader::createEntity(const EntityKeyValues& keyValues)
     return node;
 }
 
-void Doom3MapReader::parseEntity(parser::DefTokeniser& tok)
-{
-    // Map of keyvalues for this entity
-    EntityKeyValues keyValues;
-
-    // The actual entity. This is initially null, and will be created when
-    // primitives start or the end of the entity is reached
-    scene::INodePtr entity;
-
-	// Start parsing, first token must be an open brace
-	tok.assertNextToken("{");
-
-	std::string token = tok.nextToken();
-
-	// Reset the primitive counter, we're starting a new entity
-	_primitiveCount = 0;
-
-	while (true)
-	{
-	    // Token must be either a key, a "{" to indicate the start of a
-	    // primitive, or a "}" to indicate the end of the entity
-
-	    if (token == "{") // PRIMITIVE
-		{ 
-			// Create the entity right now, if not yet done
-			if (entity == NULL)
-			{
-				entity = createEntity(keyValues);
-			}
-
-			// Parse the primitive block, and pass the parent entity
-			parsePrimitive(tok, entity);
-	    }
-	    else if (token == "}") // END OF ENTITY
-		{
-            // Create the entity if necessary and return it
-	        if (entity == NULL)
-			{
-	            entity = createEntity(keyValues);
-	        }
-
-			break;
-	    }
-	    else // KEY
-		{ 
-	        std::string value = tok.nextToken();
-
-	        // Sanity check (invalid number of tokens will get us out of sync)
-	        if (value == "{" || value == "}")
-			{
-				std::string text = (boost::format(_("Parsed invalid value '%s' for key '%s'")) % value % token).str();
-	            throw FailureException(text);
-	        }
-
-	        // Otherwise add the keyvalue pair to our map
-	        keyValues.insert(EntityKeyValues::value_type(token, value));
-	    }
-
-	    // Get the next token
-	    token = tok.nextToken();
-	}
-
-	// Insert the entity
-	_importFilter.addEntity(entity);
-}
-
 } // namespace map
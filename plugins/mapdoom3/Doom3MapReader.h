@@ -2,12 +2,25 @@
 #define NODE_IMPORTER_H_
 
 #include <map>
+#include <vector>
+#include <exception>
 #include "inode.h"
 #include "imapformat.h"
 #include "parser/DefTokeniser.h"
 
 namespace map {
 
+/**
+ * Reader for Doom 3 map files.
+ *
+ * Large maps are read in a pipeline: after the version header has been
+ * parsed, a splitter thread cuts the map text into chunks of whole entities
+ * or primitives. These are tokenised by a pool of worker threads, which are
+ * parsing all primitives supporting PrimitiveParser::parseDeferred() into
+ * intermediate objects. The calling thread processes the parsed chunks in
+ * file order: it creates the entities and primitive nodes and sends them to
+ * the import filter, exactly like a sequential parser would.
+ */
 class Doom3MapReader :
 	public IMapReader
 {
@@ -27,6 +40,56 @@ protected:
 	typedef std::map<std::string, PrimitiveParserPtr> PrimitiveParsers;
 	PrimitiveParsers _primitiveParsers;
 
+	// One element of the map file, as read by the worker threads
+	struct ParsedItem
+	{
+		enum Type
+		{
+			EntityStart,
+			KeyValue,
+			Primitive,
+			EntityEnd,
+		};
+
+		Type type;
+
+		// The keyvalue pair (KeyValue)
+		std::string key;
+		std::string value;
+
+		// The result of PrimitiveParser::parseDeferred() (Primitive)
+		ParsedPrimitivePtr primitive;
+
+		// Primitives whose parser doesn't support deferred parsing are
+		// parsed on the main thread, using the collected tokens (Primitive)
+		PrimitiveParserPtr parser;
+		std::vector<std::string> tokens;
+
+		// Set if parsing this primitive failed (Primitive)
+		std::exception_ptr error;
+
+		ParsedItem(Type type_) :
+			type(type_)
+		{}
+	};
+
+	// A piece of the map file, cut at entity or primitive boundaries
+	struct ParsedChunk
+	{
+		// The offset of the chunk within the map text and the brace depth at its start
+		std::size_t start;
+		std::size_t end;
+		std::size_t depth;
+
+		// Whether this chunk reaches up to the end of the map file
+		bool isLast;
+
+		std::vector<ParsedItem> items;
+
+		// Set if parsing stopped with an error outside of a primitive, after the above items
+		std::exception_ptr error;
+	};
+
 public:
 	Doom3MapReader(IMapImportFilter& importFilter);
 
@@ -43,14 +106,27 @@ protected:
 	// Parse the version tag at the beginning, throws on failure
 	virtual void parseMapVersion(parser::DefTokeniser& tok);
 
-	// Parses an entity plus all child primitives, throws on failure
-	virtual void parseEntity(parser::DefTokeniser& tok);
+	// Reads the entities and primitives of the given chunk of the map text,
+	// errors are stored in the chunk. Invoked by the worker threads.
+	void parseChunk(const std::string& mapText, ParsedChunk& chunk) const;
 
-	// Parse the primitive block and insert the child into the given parent
-	virtual void parsePrimitive(parser::DefTokeniser& tok, const scene::INodePtr& parentEntity);
+	// Parse the primitive block following the opening brace, throws on failure
+	void parsePrimitive(parser::DefTokeniser& tok, ParsedChunk& chunk) const;
+
+	// Creates the entities and primitives of the given chunk and passes them
+	// to the import filter, throws on failure
+	void insertChunk(const ParsedChunk& chunk);
+
+	// Create the primitive node of the given item and insert it into the given parent
+	void insertPrimitive(const ParsedItem& item, const scene::INodePtr& parentEntity);
 
 	// Create an entity with the given properties and layers
 	scene::INodePtr createEntity(const EntityKeyValues& keyValues);
+
+private:
+	// The entity currently being inserted by insertChunk(), which might span multiple chunks
+	EntityKeyValues _keyValues;
+	scene::INodePtr _entity;
 };
 
 } // namespace map
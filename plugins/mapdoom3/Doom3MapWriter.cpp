@@ -1,7 +1,6 @@
 #include "Doom3MapWriter.h"
 
 #include "igame.h"
-#include "ientity.h"
 
 #include "primitivewriters/BrushDef3Exporter.h"
 #include "primitivewriters/PatchDefExporter.h"
@@ -27,7 +26,7 @@ void Doom3MapWriter::endWriteMap(std::ostream& stream)
 	// nothing
 }
 
-void Doom3MapWriter::beginWriteEntity(const Entity& entity, std::ostream& stream)
+void Doom3MapWriter::beginWriteEntity(const EntitySnapshot& entity, std::ostream& stream)
 {
 	// Write out the entity number comment
 	stream << "// entity " << _entityCount++ << std::endl;
@@ -39,16 +38,16 @@ void Doom3MapWriter::beginWriteEntity(const Entity& entity, std::ostream& stream
 	writeEntityKeyValues(entity, stream);
 }
 
-void Doom3MapWriter::writeEntityKeyValues(const Entity& entity, std::ostream& stream)
+void Doom3MapWriter::writeEntityKeyValues(const EntitySnapshot& entity, std::ostream& stream)
 {
 	// Export the entity key values
-    entity.forEachKeyValue([&](const std::string& key, const std::string& value)
+    for (const auto& pair : entity.keyValues)
     {
-        stream << "\"" << key << "\" \"" << value << "\"" << std::endl;
-    });
+        stream << "\"" << pair.first << "\" \"" << pair.second << "\"" << std::endl;
+    }
 }
 
-void Doom3MapWriter::endWriteEntity(const Entity& entity, std::ostream& stream)
+void Doom3MapWriter::endWriteEntity(const EntitySnapshot& entity, std::ostream& stream)
 {
 	// Write the closing brace for the entity
 	stream << "}" << std::endl;
@@ -57,7 +56,7 @@ void Doom3MapWriter::endWriteEntity(const Entity& entity, std::ostream& stream)
 	_primitiveCount = 0;
 }
 
-void Doom3MapWriter::beginWriteBrush(const IBrush& brush, std::ostream& stream)
+void Doom3MapWriter::beginWriteBrush(const BrushSnapshot& brush, std::ostream& stream)
 {
 	// Primitive count comment
 	stream << "// primitive " << _primitiveCount++ << std::endl;
@@ -66,12 +65,12 @@ void Doom3MapWriter::beginWriteBrush(const IBrush& brush, std::ostream& stream)
 	BrushDef3Exporter::exportBrush(stream, brush);
 }
 
-void Doom3MapWriter::endWriteBrush(const IBrush& brush, std::ostream& stream)
+void Doom3MapWriter::endWriteBrush(const BrushSnapshot& brush, std::ostream& stream)
 {
 	// nothing
 }
 
-void Doom3MapWriter::beginWritePatch(const IPatch& patch, std::ostream& stream)
+void Doom3MapWriter::beginWritePatch(const PatchSnapshot& patch, std::ostream& stream)
 {
 	// Primitive count comment
 	stream << "// primitive " << _primitiveCount++ << std::endl;
@@ -80,7 +79,7 @@ void Doom3MapWriter::beginWritePatch(const IPatch& patch, std::ostream& stream)
 	PatchDefExporter::exportPatch(stream, patch);
 }
 
-void Doom3MapWriter::endWritePatch(const IPatch& patch, std::ostream& stream)
+void Doom3MapWriter::endWritePatch(const PatchSnapshot& patch, std::ostream& stream)
 {
 	// nothing
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "imapformat.h"
+#include "imapsnapshot.h"
 
 namespace map
 {
@@ -25,19 +26,19 @@ public:
 	virtual void endWriteMap(std::ostream& stream);
 
 	// Entity export methods
-	virtual void beginWriteEntity(const Entity& entity, std::ostream& stream);
-	virtual void endWriteEntity(const Entity& entity, std::ostream& stream);
+	virtual void beginWriteEntity(const EntitySnapshot& entity, std::ostream& stream);
+	virtual void endWriteEntity(const EntitySnapshot& entity, std::ostream& stream);
 
 	// Brush export methods
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream);
-	virtual void endWriteBrush(const IBrush& brush, std::ostream& stream);
+	virtual void beginWriteBrush(const BrushSnapshot& brush, std::ostream& stream);
+	virtual void endWriteBrush(const BrushSnapshot& brush, std::ostream& stream);
 
 	// Patch export methods
-	virtual void beginWritePatch(const IPatch& patch, std::ostream& stream);
-	virtual void endWritePatch(const IPatch& patch, std::ostream& stream);
+	virtual void beginWritePatch(const PatchSnapshot& patch, std::ostream& stream);
+	virtual void endWritePatch(const PatchSnapshot& patch, std::ostream& stream);
 
 protected:
-	void writeEntityKeyValues(const Entity& entity, std::ostream& stream);
+	void writeEntityKeyValues(const EntitySnapshot& entity, std::ostream& stream);
 };
 
 } // namespace
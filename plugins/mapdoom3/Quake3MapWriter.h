@@ -21,7 +21,7 @@ public:
 		stream << std::endl;
 	}
 
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream)
+	virtual void beginWriteBrush(const BrushSnapshot& brush, std::ostream& stream)
 	{
 		// Primitive count comment
 		stream << "// brush " << _primitiveCount++ << std::endl;
@@ -30,7 +30,7 @@ public:
 		BrushDefExporter::exportBrush(stream, brush);
 	}
 
-	virtual void beginWritePatch(const IPatch& patch, std::ostream& stream)
+	virtual void beginWritePatch(const PatchSnapshot& patch, std::ostream& stream)
 	{
 		// Primitive count comment, not a typo, patches also seem to have "brush" in their comments
 		stream << "// brush " << _primitiveCount++ << std::endl;
@@ -20,7 +20,7 @@ public:
 		stream << "Version " << MAP_VERSION_Q4 << std::endl;
 	}
 
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream)
+	virtual void beginWriteBrush(const BrushSnapshot& brush, std::ostream& stream)
 	{
 		// Primitive count comment
 		stream << "// primitive " << _primitiveCount++ << std::endl;
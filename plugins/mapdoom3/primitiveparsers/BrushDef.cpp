@@ -1,7 +1,5 @@
-// greebo: Specialise the boost::lexical_cast<float>() function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "BrushDef.h"
+#include "FloatScanner.h"
 
 #include "string/convert.h"
 #include "imap.h"
@@ -62,25 +60,25 @@ scene::INodePtr BrushDefParser::parse(parser::DefTokeniser& tok) const
 		else if (token == "(") // FACE
 		{
 			// Parse three 3D points to construct a plane
-			double x = string::to_float(tok.nextToken());
-			double y = string::to_float(tok.nextToken());
-			double z = string::to_float(tok.nextToken());
+			double x = nextFloat(tok);
+			double y = nextFloat(tok);
+			double z = nextFloat(tok);
 			Vector3 p1(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = nextFloat(tok);
+			y = nextFloat(tok);
+			z = nextFloat(tok);
 			Vector3 p2(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = nextFloat(tok);
+			y = nextFloat(tok);
+			z = nextFloat(tok);
 			Vector3 p3(x, y, z);
 
 			tok.assertNextToken(")");
@@ -93,15 +91,15 @@ scene::INodePtr BrushDefParser::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = nextFloat(tok);
+			texdef.yx() = nextFloat(tok);
+			texdef.tx() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = nextFloat(tok);
+			texdef.yy() = nextFloat(tok);
+			texdef.ty() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
@@ -178,25 +176,25 @@ scene::INodePtr LegacyBrushDefParser::parse(parser::DefTokeniser& tok) const
 		else if (token == "(") // FACE
 		{
 			// Parse three 3D points to construct a plane
-			double x = string::to_float(tok.nextToken());
-			double y = string::to_float(tok.nextToken());
-			double z = string::to_float(tok.nextToken());
+			double x = nextFloat(tok);
+			double y = nextFloat(tok);
+			double z = nextFloat(tok);
 			Vector3 p1(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = nextFloat(tok);
+			y = nextFloat(tok);
+			z = nextFloat(tok);
 			Vector3 p2(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = nextFloat(tok);
+			y = nextFloat(tok);
+			z = nextFloat(tok);
 			Vector3 p3(x, y, z);
 
 			tok.assertNextToken(")");
@@ -208,13 +206,13 @@ scene::INodePtr LegacyBrushDefParser::parse(parser::DefTokeniser& tok) const
 			std::string shader = GlobalTexturePrefix_get() + tok.nextToken();
 
 			// Parse texture (shift rotation scale)
-            float shiftS = string::to_float(tok.nextToken());
-            float shiftT = string::to_float(tok.nextToken());
+            float shiftS = nextFloat(tok);
+            float shiftT = nextFloat(tok);
 
-            float rotation = string::to_float(tok.nextToken());
+            float rotation = nextFloat(tok);
 
-            float scaleS = string::to_float(tok.nextToken());
-            float scaleT = string::to_float(tok.nextToken());
+            float scaleS = nextFloat(tok);
+            float scaleT = nextFloat(tok);
 
             Matrix4 texdef = getTexDef(shiftS, shiftT, rotation, scaleS, scaleT);
 
@@ -1,7 +1,5 @@
-// greebo: Specialise the boost::lexical_cast<float>() function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "BrushDef3.h"
+#include "FloatScanner.h"
 #include "string/convert.h"
 #include "imap.h"
 #include "ibrush.h"
@@ -10,6 +8,7 @@
 #include "math/Plane3.h"
 #include "shaderlib.h"
 #include "i18n.h"
+#include <vector>
 #include <boost/format.hpp>
 
 namespace map
@@ -36,6 +35,36 @@ brushDef3
 }
 */
 
+namespace
+{
+
+// The faces of a brushDef3 primitive, as read by parseDeferred()
+class ParsedBrush :
+	public ParsedPrimitive
+{
+public:
+	struct Face
+	{
+		Plane3 plane;
+		Matrix4 texdef;
+		std::string shader;
+		IBrush::DetailFlag detailFlag;
+	};
+
+	std::vector<Face> faces;
+
+	// Quake 4 brushes don't carry any face flags
+	bool hasDetailFlags;
+
+	ParsedBrush(bool hasDetailFlags_) :
+		hasDetailFlags(hasDetailFlags_)
+	{}
+
+	scene::INodePtr createNode() const;
+};
+
+}
+
 // greebo: switch off optimisations for this section - the symptom is that brushes don't get a 
 // valid d value assigned after the first call to addFace() - the callback triggers a series
 // of calls in the DarkRadiant main module (up to the Texture Tool), and after return the plane
@@ -44,7 +73,7 @@ brushDef3
 #pragma optimize( "", off )
 #endif
 
-scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
+scene::INodePtr ParsedBrush::createNode() const
 {
 	// Create a new brush
 	scene::INodePtr node = GlobalBrushCreator().createBrush();
@@ -55,6 +84,34 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 
 	IBrush& brush = brushNode->getIBrush();
 
+	for (const Face& face : faces)
+	{
+		if (hasDetailFlags)
+		{
+			brush.setDetailFlag(face.detailFlag);
+		}
+
+		// Finally, add the new face to the brush
+		/*IFace& face = */brush.addFace(face.plane, face.texdef, face.shader);
+	}
+
+	return node;
+}
+
+scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
+{
+	return parseDeferred(tok)->createNode();
+}
+
+bool BrushDef3Parser::canParseDeferred() const
+{
+	return true;
+}
+
+ParsedPrimitivePtr BrushDef3Parser::parseDeferred(parser::DefTokeniser& tok) const
+{
+	std::shared_ptr<ParsedBrush> brush = std::make_shared<ParsedBrush>(true);
+
 	tok.assertNextToken("{");
 
 	// Parse face tokens until a closing brace is encountered
@@ -69,47 +126,46 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			brush->faces.push_back(ParsedBrush::Face());
+			ParsedBrush::Face& face = brush->faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
-			plane.normal().x() = string::to_float(tok.nextToken());
-			plane.normal().y() = string::to_float(tok.nextToken());
-			plane.normal().z() = string::to_float(tok.nextToken());
-			plane.dist() = -string::to_float(tok.nextToken()); // negate d
+			plane.normal().x() = nextFloat(tok);
+			plane.normal().y() = nextFloat(tok);
+			plane.normal().z() = nextFloat(tok);
+			plane.dist() = -nextFloat(tok); // negate d
 
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = nextFloat(tok);
+			texdef.yx() = nextFloat(tok);
+			texdef.tx() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = nextFloat(tok);
+			texdef.yy() = nextFloat(tok);
+			texdef.ty() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
+			face.shader = tok.nextToken();
 
 			// Parse Flags (usually each brush has all faces detail or all faces structural)
-			IBrush::DetailFlag flag = static_cast<IBrush::DetailFlag>(
+			face.detailFlag = static_cast<IBrush::DetailFlag>(
 				string::convert<std::size_t>(tok.nextToken(), IBrush::Structural));
-			brush.setDetailFlag(flag);
 
 			// Ignore the other two flags
 			tok.skipTokens(2);
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
 		}
 		else {
 			std::string text = (boost::format(_("BrushDef3Parser: invalid token '%s'")) % token).str();
@@ -120,19 +176,12 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 	// Final outer "}"
 	tok.assertNextToken("}");
 
-	return node;
+	return brush;
 }
 
-scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
+ParsedPrimitivePtr BrushDef3ParserQuake4::parseDeferred(parser::DefTokeniser& tok) const
 {
-	// Create a new brush
-	scene::INodePtr node = GlobalBrushCreator().createBrush();
-
-	// Cast the node, this must succeed
-	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(node);
-	assert(brushNode != NULL);
-
-	IBrush& brush = brushNode->getIBrush();
+	std::shared_ptr<ParsedBrush> brush = std::make_shared<ParsedBrush>(false);
 
 	tok.assertNextToken("{");
 
@@ -148,39 +197,40 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			brush->faces.push_back(ParsedBrush::Face());
+			ParsedBrush::Face& face = brush->faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
-			plane.normal().x() = string::to_float(tok.nextToken());
-			plane.normal().y() = string::to_float(tok.nextToken());
-			plane.normal().z() = string::to_float(tok.nextToken());
-			plane.dist() = -string::to_float(tok.nextToken()); // negate d
+			plane.normal().x() = nextFloat(tok);
+			plane.normal().y() = nextFloat(tok);
+			plane.normal().z() = nextFloat(tok);
+			plane.dist() = -nextFloat(tok); // negate d
 
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = nextFloat(tok);
+			texdef.yx() = nextFloat(tok);
+			texdef.tx() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = nextFloat(tok);
+			texdef.yy() = nextFloat(tok);
+			texdef.ty() = nextFloat(tok);
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
+			face.shader = tok.nextToken();
+			face.detailFlag = IBrush::Structural;
 		}
 		else {
 			std::string text = (boost::format(_("BrushDef3ParserQuake4: invalid token '%s'")) % token).str();
@@ -191,7 +241,7 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 	// Final outer "}"
 	tok.assertNextToken("}");
 
-	return node;
+	return brush;
 }
 
 #if _MSC_VER >= 1600
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <boost/utility/string_ref.hpp>
+#include "parser/DefTokeniser.h"
+
+namespace map
+{
+
+namespace detail
+{
+	// The powers of ten which are exactly representable as double
+	const double EXACT_POWERS_OF_TEN[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const int MAX_EXACT_POWER_OF_TEN = 22;
+
+	// Largest integer which can be stored in a double without loss (2^53)
+	const std::uint64_t MAX_EXACT_MANTISSA = std::uint64_t(1) << 53;
+
+	// Converts the token using the C library, with the same result as std::atof()
+	inline double scanFloatSlow(const boost::string_ref& token)
+	{
+		char buffer[64];
+
+		if (token.size() < sizeof(buffer))
+		{
+			std::copy(token.begin(), token.end(), buffer);
+			buffer[token.size()] = '\0';
+
+			return std::strtod(buffer, nullptr);
+		}
+
+		return std::strtod(token.to_string().c_str(), nullptr);
+	}
+}
+
+/**
+ * Converts the given token to a floating point number, returning exactly
+ * the same value as string::to_float() with SPECIALISE_STR_TO_FLOAT set,
+ * which is using std::atof(), but without copying the token into a string.
+ *
+ * Decimal numbers like the ones written by the map exporters are converted
+ * directly: if all their digits fit into the mantissa of a double and the
+ * power of ten is exactly representable, a single division or multiplication
+ * yields the correctly rounded result. Anything else (long numbers, large
+ * exponents, trailing garbage, hex or inf/nan notation) is passed to strtod().
+ */
+inline double scanFloat(const boost::string_ref& token)
+{
+	const char* p = token.begin();
+	const char* end = token.end();
+
+	bool negative = false;
+
+	if (p != end && (*p == '-' || *p == '+'))
+	{
+		negative = *p++ == '-';
+	}
+
+	std::uint64_t mantissa = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+
+	// Integer part
+	for (; p != end && *p >= '0' && *p <= '9'; ++p)
+	{
+		if (mantissa >= detail::MAX_EXACT_MANTISSA)
+		{
+			return detail::scanFloatSlow(token);
+		}
+
+		mantissa = mantissa * 10 + (*p - '0');
+		hasDigits = true;
+	}
+
+	// Fractional part
+	if (p != end && *p == '.')
+	{
+		for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+		{
+			if (mantissa >= detail::MAX_EXACT_MANTISSA)
+			{
+				return detail::scanFloatSlow(token);
+			}
+
+			mantissa = mantissa * 10 + (*p - '0');
+			--exponent;
+			hasDigits = true;
+		}
+	}
+
+	if (!hasDigits)
+	{
+		return detail::scanFloatSlow(token);
+	}
+
+	// Exponent, as written by std::ostream for very small or large values
+	if (p != end && (*p == 'e' || *p == 'E'))
+	{
+		++p;
+
+		bool negativeExponent = false;
+
+		if (p != end && (*p == '-' || *p == '+'))
+		{
+			negativeExponent = *p++ == '-';
+		}
+
+		if (p == end)
+		{
+			return detail::scanFloatSlow(token);
+		}
+
+		int value = 0;
+
+		for (; p != end && *p >= '0' && *p <= '9'; ++p)
+		{
+			if (value > 1000)
+			{
+				return detail::scanFloatSlow(token);
+			}
+
+			value = value * 10 + (*p - '0');
+		}
+
+		exponent += negativeExponent ? -value : value;
+	}
+
+	if (p != end || mantissa > detail::MAX_EXACT_MANTISSA)
+	{
+		return detail::scanFloatSlow(token);
+	}
+
+	double result;
+
+	if (mantissa == 0)
+	{
+		result = 0.0;
+	}
+	else if (exponent < 0 && exponent >= -detail::MAX_EXACT_POWER_OF_TEN)
+	{
+		result = static_cast<double>(mantissa) / detail::EXACT_POWERS_OF_TEN[-exponent];
+	}
+	else if (exponent >= 0 && exponent <= detail::MAX_EXACT_POWER_OF_TEN)
+	{
+		result = static_cast<double>(mantissa) * detail::EXACT_POWERS_OF_TEN[exponent];
+	}
+	else
+	{
+		return detail::scanFloatSlow(token);
+	}
+
+	return negative ? -result : result;
+}
+
+// Reads the next token of the given tokeniser as floating point number
+inline double nextFloat(parser::DefTokeniser& tok)
+{
+	return scanFloat(tok.nextTokenRef());
+}
+
+} // namespace map
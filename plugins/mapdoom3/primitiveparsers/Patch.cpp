@@ -1,36 +1,84 @@
-// greebo: Specialise the boost::lexical_cast<float>() function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "Patch.h"
+#include "FloatScanner.h"
 
-#include "string/convert.h"
+#include "imap.h"
 #include "parser/DefTokeniser.h"
 
+#include <algorithm>
+
 namespace map
 {
 
-void PatchParser::parseMatrix(parser::DefTokeniser& tok, IPatch& patch) const
+scene::INodePtr ParsedPatch::createNode() const
 {
+	scene::INodePtr node = GlobalPatchCreator(patchDefType).createPatch();
+
+	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
+	assert(patchNode != NULL);
+
+	IPatch& patch = patchNode->getPatch();
+
+	patch.setShader(shader);
+	patch.setDims(cols, rows);
+
+	if (fixedSubdivisions)
+	{
+		patch.setFixedSubdivisions(true, subdivisions);
+	}
+
+	// The patch might have corrected invalid dimensions, don't exceed either one
+	std::size_t width = std::min(patch.getWidth(), cols);
+	std::size_t height = std::min(patch.getHeight(), rows);
+
+	for (std::size_t c = 0; c < width; c++)
+	{
+		for (std::size_t r = 0; r < height; r++)
+		{
+			patch.ctrlAt(r, c) = controlPoints[c * rows + r];
+		}
+	}
+
+	patch.controlPointsChanged();
+
+	return node;
+}
+
+scene::INodePtr PatchParser::parse(parser::DefTokeniser& tok) const
+{
+	return parseDeferred(tok)->createNode();
+}
+
+bool PatchParser::canParseDeferred() const
+{
+	return true;
+}
+
+void PatchParser::parseMatrix(parser::DefTokeniser& tok, ParsedPatch& patch) const
+{
+	patch.controlPoints.resize(patch.cols * patch.rows);
+
 	tok.assertNextToken("(");
 
 	// For each row
-	for (std::size_t c = 0; c < patch.getWidth(); c++)
+	for (std::size_t c = 0; c < patch.cols; c++)
 	{
 		tok.assertNextToken("(");
 
 		// For each column
-		for (std::size_t r=0; r < patch.getHeight(); r++)
+		for (std::size_t r=0; r < patch.rows; r++)
 		{
 			tok.assertNextToken("(");
 
+			PatchControl& ctrl = patch.controlPoints[c * patch.rows + r];
+
 			// Parse vertex coordinates
-			patch.ctrlAt(r, c).vertex[0] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).vertex[1] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).vertex[2] = string::to_float(tok.nextToken());
+			ctrl.vertex[0] = nextFloat(tok);
+			ctrl.vertex[1] = nextFloat(tok);
+			ctrl.vertex[2] = nextFloat(tok);
 
 			// Parse texture coordinates
-			patch.ctrlAt(r, c).texcoord[0] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).texcoord[1] = string::to_float(tok.nextToken());
+			ctrl.texcoord[0] = nextFloat(tok);
+			ctrl.texcoord[1] = nextFloat(tok);
 
 			tok.assertNextToken(")");
 		}
@@ -4,16 +4,55 @@
 #include "imapformat.h"
 #include "ipatch.h"
 
+#include <vector>
+
 namespace map
 {
 
+// The data of a patchDef2/patchDef3 primitive, as read by PatchParser::parseDeferred()
+class ParsedPatch :
+	public ParsedPrimitive
+{
+public:
+	// The patch type to request from the patch creator (DEF2 or DEF3)
+	std::string patchDefType;
+
+	std::string shader;
+
+	std::size_t cols;
+	std::size_t rows;
+
+	// Only patchDef3 primitives specify fixed subdivisions
+	bool fixedSubdivisions;
+	Subdivisions subdivisions;
+
+	// The control points, stored column by column
+	std::vector<PatchControl> controlPoints;
+
+	ParsedPatch(const std::string& patchDefType_) :
+		patchDefType(patchDefType_),
+		cols(0),
+		rows(0),
+		fixedSubdivisions(false),
+		subdivisions(0, 0)
+	{}
+
+	scene::INodePtr createNode() const;
+};
+
 // Common base class for PatchDef2Parser and PatchDef3Parser
 class PatchParser :
 	public PrimitiveParser
 {
+public:
+	// Both patch parsers create the node from their parseDeferred() result
+	virtual scene::INodePtr parse(parser::DefTokeniser& tok) const;
+
+	virtual bool canParseDeferred() const;
+
 protected:
 	// Parses the control point matrix. The given patch must have its dimensions set before this call.
-	void parseMatrix(parser::DefTokeniser& tok, IPatch& patch) const;
+	void parseMatrix(parser::DefTokeniser& tok, ParsedPatch& patch) const;
 };
 
 } // namespace map
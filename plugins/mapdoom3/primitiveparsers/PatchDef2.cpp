@@ -35,28 +35,21 @@ patchDef2
 }
 }
 */
-scene::INodePtr PatchDef2Parser::parse(parser::DefTokeniser& tok) const
+ParsedPrimitivePtr PatchDef2Parser::parseDeferred(parser::DefTokeniser& tok) const
 {
-	scene::INodePtr node = GlobalPatchCreator(DEF2).createPatch();
-
-	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
-	assert(patchNode != NULL);
-
-	IPatch& patch = patchNode->getPatch();
+	std::shared_ptr<ParsedPatch> patch = std::make_shared<ParsedPatch>(DEF2);
 
 	tok.assertNextToken("{");
 
 	// Parse shader
-	setShader(patch, tok.nextToken()); 
+	setShader(*patch, tok.nextToken()); 
 
 	// Parse parameters
 	tok.assertNextToken("(");
 
 	// parse matrix dimensions
-	std::size_t cols = string::convert<std::size_t>(tok.nextToken());
-	std::size_t rows = string::convert<std::size_t>(tok.nextToken());
-
-	patch.setDims(cols, rows);
+	patch->cols = string::convert<std::size_t>(tok.nextToken());
+	patch->rows = string::convert<std::size_t>(tok.nextToken());
 
 	// ignore contents/flags values
 	tok.skipTokens(3);
@@ -64,25 +57,28 @@ scene::INodePtr PatchDef2Parser::parse(parser::DefTokeniser& tok) const
 	tok.assertNextToken(")");
 
 	// Parse Patch Matrix
-	parseMatrix(tok, patch);
+	parseMatrix(tok, *patch);
 
 	// Parse Footer
 	tok.assertNextToken("}");
 	tok.assertNextToken("}");
 
-	patch.controlPointsChanged();
-
-	return node;
+	return patch;
 }
 
-void PatchDef2Parser::setShader(IPatch& patch, const std::string& shader) const
+void PatchDef2Parser::setShader(ParsedPatch& patch, const std::string& shader) const
 {
 	// Regular behaviour: just set the incoming shader name
-	patch.setShader(shader);
+	patch.shader = shader;
 }
 
 // Quake3-parser
-void PatchDef2ParserQ3::setShader(IPatch& patch, const std::string& shader) const
+bool PatchDef2ParserQ3::canParseDeferred() const
+{
+	return false;
+}
+
+void PatchDef2ParserQ3::setShader(ParsedPatch& patch, const std::string& shader) const
 {
 	// Add the global texture prefix for each parsed shader
 	PatchDef2Parser::setShader(patch, GlobalTexturePrefix_get() + shader);
@@ -11,10 +11,10 @@ class PatchDef2Parser :
 public:
 	const std::string& getKeyword() const;
 
-    scene::INodePtr parse(parser::DefTokeniser& tok) const;
+	virtual ParsedPrimitivePtr parseDeferred(parser::DefTokeniser& tok) const;
 
 protected:
-	virtual void setShader(IPatch& patch, const std::string& shader) const;
+	virtual void setShader(ParsedPatch& patch, const std::string& shader) const;
 };
 typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 
@@ -22,8 +22,12 @@ typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 class PatchDef2ParserQ3 :
 	public PatchDef2Parser
 {
+public:
+	// The texture prefix is read from the registry, this must happen on the main thread
+	virtual bool canParseDeferred() const;
+
 protected:
-	virtual void setShader(IPatch& patch, const std::string& shader) const;
+	virtual void setShader(ParsedPatch& patch, const std::string& shader) const;
 };
 typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 
@@ -1,9 +1,7 @@
 #ifndef BrushDef3Exporter_h__
 #define BrushDef3Exporter_h__
 
-#include "ibrush.h"
-#include "math/Plane3.h"
-#include "math/Matrix4.h"
+#include "imapsnapshot.h"
 
 namespace map
 {
@@ -37,7 +35,7 @@ class BrushDef3Exporter
 public:
 
 	// Writes a brushDef3 definition from the given brush to the given stream
-	static void exportBrush(std::ostream& stream, const IBrush& brush, bool writeContentsFlags = true)
+	static void exportBrush(std::ostream& stream, const BrushSnapshot& brush, bool writeContentsFlags = true)
 	{
 		// Brush decl header
 		stream << "{" << std::endl;
@@ -45,9 +43,9 @@ public:
 		stream << "{" << std::endl;
 
 		// Iterate over each brush face, exporting the tokens from all faces
-		for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+		for (const BrushSnapshot::Face& face : brush.faces)
 		{
-			writeFace(stream, brush.getFace(i), writeContentsFlags, brush.getDetailFlag());
+			writeFace(stream, face, writeContentsFlags, brush.detailFlag);
 		}
 
 		// Close brush contents and header
@@ -56,16 +54,11 @@ public:
 
 private:
 
-	static void writeFace(std::ostream& stream, const IFace& face, bool writeContentsFlags, IBrush::DetailFlag detailFlag)
+	// Faces with degenerate or empty windings are not part of the snapshot
+	static void writeFace(std::ostream& stream, const BrushSnapshot::Face& face, bool writeContentsFlags, IBrush::DetailFlag detailFlag)
 	{
-		// greebo: Don't export faces with degenerate or empty windings (they are "non-contributing")
-		if (face.getWinding().size() <= 2)
-		{
-			return;
-		}
-
 		// Write the plane equation
-		const Plane3& plane = face.getPlane3();
+		const Plane3& plane = face.plane;
 
 		stream << "( ";
 		writeDoubleSafe(plane.normal().x(), stream);
@@ -79,7 +72,7 @@ private:
 		stream << ") ";
 
 		// Write TexDef
-		Matrix4 texdef = face.getTexDefMatrix();
+		const Matrix4& texdef = face.texdef;
 		stream << "( ";
 
 		stream << "( ";
@@ -101,7 +94,7 @@ private:
 		stream << ") ";
 
 		// Write Shader
-		const std::string& shaderName = face.getShader();
+		const std::string& shaderName = face.shader;
 
 		if (shaderName.empty()) {
 			stream << "\"_default\" ";
@@ -1,8 +1,6 @@
 #pragma once
 
-#include "ibrush.h"
-#include "math/Plane3.h"
-#include "math/Matrix4.h"
+#include "imapsnapshot.h"
 #include "shaderlib.h"
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -39,7 +37,7 @@ class BrushDefExporter
 public:
 
 	// Writes a Q3-style brushDef definition from the given brush to the given stream
-	static void exportBrush(std::ostream& stream, const IBrush& brush)
+	static void exportBrush(std::ostream& stream, const BrushSnapshot& brush)
 	{
 		// Brush decl header
 		stream << "{" << std::endl;
@@ -47,9 +45,9 @@ public:
 		stream << "{" << std::endl;
 
 		// Iterate over each brush face, exporting the tokens from all faces
-		for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+		for (const BrushSnapshot::Face& face : brush.faces)
 		{
-			writeFace(stream, brush.getFace(i), brush.getDetailFlag());
+			writeFace(stream, face, brush.detailFlag);
 		}
 
 		// Close brush contents and header
@@ -70,47 +68,41 @@ public:
 
 private:
 
-	static void writeFace(std::ostream& stream, const IFace& face, IBrush::DetailFlag detailFlag)
+	// Faces with degenerate or empty windings are not part of the snapshot
+	static void writeFace(std::ostream& stream, const BrushSnapshot::Face& face, IBrush::DetailFlag detailFlag)
 	{
-		// greebo: Don't export faces with degenerate or empty windings (they are "non-contributing")
-		const IWinding& winding = face.getWinding();
-
-		if (winding.size() <= 2)
-		{
-			return;
-		}
-
 		// Each face plane is defined by three points
+		const Vector3 (&points)[3] = face.points;
 
 		stream << "( ";
-		writeDoubleSafe(winding[2].vertex.x(), stream);
+		writeDoubleSafe(points[2].x(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[2].vertex.y(), stream);
+		writeDoubleSafe(points[2].y(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[2].vertex.z(), stream);
+		writeDoubleSafe(points[2].z(), stream);
 		stream << " ";
 		stream << ") ";
 
 		stream << "( ";
-		writeDoubleSafe(winding[0].vertex.x(), stream);
+		writeDoubleSafe(points[0].x(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[0].vertex.y(), stream);
+		writeDoubleSafe(points[0].y(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[0].vertex.z(), stream);
+		writeDoubleSafe(points[0].z(), stream);
 		stream << " ";
 		stream << ") ";
 
 		stream << "( ";
-		writeDoubleSafe(winding[1].vertex.x(), stream);
+		writeDoubleSafe(points[1].x(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[1].vertex.y(), stream);
+		writeDoubleSafe(points[1].y(), stream);
 		stream << " ";
-		writeDoubleSafe(winding[1].vertex.z(), stream);
+		writeDoubleSafe(points[1].z(), stream);
 		stream << " ";
 		stream << ") ";
 
 		// Write TexDef
-		Matrix4 texdef = face.getTexDefMatrix();
+		const Matrix4& texdef = face.texdef;
 		stream << "( ";
 
 		stream << "( ";
@@ -132,7 +124,7 @@ private:
 		stream << ") ";
 
 		// Write Shader (without quotes)
-		const std::string& shaderName = face.getShader();
+		const std::string& shaderName = face.shader;
 
 		if (shaderName.empty())
 		{
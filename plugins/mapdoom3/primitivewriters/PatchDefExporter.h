@@ -1,7 +1,7 @@
 #pragma once
 
 #include "shaderlib.h"
-#include "ipatch.h"
+#include "imapsnapshot.h"
 
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -36,9 +36,9 @@ class PatchDefExporter
 public:
 
 	// Writes a patchDef2/3 definition from the given patch to the given stream
-	static void exportPatch(std::ostream& stream, const IPatch& patch)
+	static void exportPatch(std::ostream& stream, const PatchSnapshot& patch)
 	{
-		if (patch.subdivionsFixed())
+		if (patch.subdivisionsFixed)
 		{
 			exportPatchDef3(stream, patch);
 		}
@@ -49,7 +49,7 @@ public:
 	}
 
 	// Export a patchDef2 declaration, Q3-style
-	static void exportQ3PatchDef2(std::ostream& stream, const IPatch& patch)
+	static void exportQ3PatchDef2(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export patch declaration
 		stream << "{\n";
@@ -60,8 +60,8 @@ public:
 
 		// Export patch dimension / parameters
 		stream << "( ";
-		stream << patch.getWidth() << " ";
-		stream << patch.getHeight() << " ";
+		stream << patch.width << " ";
+		stream << patch.height << " ";
 
 		// empty contents/flags
 		stream << "0 0 0 )\n";
@@ -73,7 +73,7 @@ public:
 
 private:
 	// Export a patchDef3 declaration (fixed subdivisions)
-	static void exportPatchDef3(std::ostream& stream, const IPatch& patch)
+	static void exportPatchDef3(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export patch declaration
 		stream << "{\n";
@@ -84,12 +84,12 @@ private:
 
 		// Export patch dimension / parameters
 		stream << "( ";
-		stream << patch.getWidth() << " ";
-		stream << patch.getHeight() << " ";
+		stream << patch.width << " ";
+		stream << patch.height << " ";
 
-		assert(patch.subdivionsFixed());
+		assert(patch.subdivisionsFixed);
 
-		Subdivisions divisions = patch.getSubdivisions();
+		const Subdivisions& divisions = patch.subdivisions;
 		stream << divisions.x() << " ";
 		stream << divisions.y() << " ";
 
@@ -102,7 +102,7 @@ private:
 	}
 
 	// Export a patchDef2 declaration, D3-style
-	static void exportPatchDef2(std::ostream& stream, const IPatch& patch)
+	static void exportPatchDef2(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export patch declaration
 		stream << "{\n";
@@ -113,8 +113,8 @@ private:
 
 		// Export patch dimension / parameters
 		stream << "( ";
-		stream << patch.getWidth() << " ";
-		stream << patch.getHeight() << " ";
+		stream << patch.width << " ";
+		stream << patch.height << " ";
 
 		// empty contents/flags
 		stream << "0 0 0 )\n";
@@ -124,10 +124,10 @@ private:
 		stream << "}\n}\n";
 	}
 
-	static void exportShader(std::ostream& stream, const IPatch& patch)
+	static void exportShader(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export shader
-		const std::string& shaderName = patch.getShader();
+		const std::string& shaderName = patch.shader;
 
 		if (shaderName.empty())
 		{
@@ -141,10 +141,10 @@ private:
 	}
 
 	// Q3 shader declarations are missing their textures/ prefix and don't use quotes
-	static void exportQ3Shader(std::ostream& stream, const IPatch& patch)
+	static void exportQ3Shader(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export shader
-		const std::string& shaderName = patch.getShader();
+		const std::string& shaderName = patch.shader;
 
 		if (shaderName.empty())
 		{
@@ -165,16 +165,16 @@ private:
 		stream << "\n";
 	}
 
-	static void exportPatchControlMatrix(std::ostream& stream, const IPatch& patch)
+	static void exportPatchControlMatrix(std::ostream& stream, const PatchSnapshot& patch)
 	{
 		// Export the control point matrix
 		stream << "(\n";
 
-		for (std::size_t c = 0; c < patch.getWidth(); c++)
+		for (std::size_t c = 0; c < patch.width; c++)
 		{
 			stream << "( ";
 
-			for (std::size_t r = 0; r < patch.getHeight(); r++)
+			for (std::size_t r = 0; r < patch.height; r++)
 			{
 				stream << "( ";
 				writePatchDouble(patch.ctrlAt(r,c).vertex[0], stream);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "parser/BufferedDefTokeniser.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Generated brush text shared by the float scanner tests and benchmarks.
+ */
+namespace test
+{
+
+// Writes a brushDef3 primitive with the given plane and texture matrix values
+inline void writeFace(std::ostream& stream, const double (&values)[10])
+{
+	stream << "( " << values[0] << " " << values[1] << " " << values[2] << " " << values[3] << " ) ";
+	stream << "( ( " << values[4] << " " << values[5] << " " << values[6] << " ) ";
+	stream << "( " << values[7] << " " << values[8] << " " << values[9] << " ) ) ";
+	stream << "\"textures/common/caulk\" 0 0 0" << std::endl;
+}
+
+// Generates a map like brush text with the face values written like the exporters do
+inline std::string generateBrushes(std::size_t numFaces, std::mt19937& random)
+{
+	std::uniform_real_distribution<double> normal(-1.0, 1.0);
+	std::uniform_int_distribution<int> grid(-8192, 8192);
+	std::uniform_real_distribution<double> shift(-1024.0, 1024.0);
+
+	std::ostringstream stream;
+
+	stream << "{" << std::endl << "brushDef3" << std::endl << "{" << std::endl;
+
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		// Alternate between axis-aligned and arbitrary planes
+		double values[10] =
+		{
+			i % 2 == 0 ? 0 : normal(random),
+			i % 2 == 0 ? -1 : normal(random),
+			i % 2 == 0 ? 0 : normal(random),
+			i % 3 == 0 ? grid(random) : grid(random) / 64.0,
+			0.015625, 0, shift(random),
+			0, i % 5 == 0 ? 1e-7 : 0.0078125, shift(random) / 3
+		};
+
+		writeFace(stream, values);
+	}
+
+	stream << "}" << std::endl << "}" << std::endl;
+
+	return stream.str();
+}
+
+// Reads the numbers of the brush faces generated above
+template<typename ReadFunc>
+inline std::vector<double> readFaceValues(const std::string& text, ReadFunc readFloat)
+{
+	parser::BufferedDefTokeniser tok(text);
+	std::vector<double> values;
+
+	tok.skipTokens(3);
+
+	while (tok.peek() == "(")
+	{
+		tok.assertNextToken("(");
+
+		for (int i = 0; i < 4; ++i) values.push_back(readFloat(tok));
+
+		tok.skipTokens(3);
+
+		for (int i = 0; i < 3; ++i) values.push_back(readFloat(tok));
+
+		tok.skipTokens(2);
+
+		for (int i = 0; i < 3; ++i) values.push_back(readFloat(tok));
+
+		tok.skipTokens(6);
+	}
+
+	return values;
+}
+
+} // namespace test
@@ -0,0 +1,44 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE floatScannerBenchmark
+#include <boost/test/unit_test.hpp>
+
+// The primitive parsers used to convert their numbers like this
+#define SPECIALISE_STR_TO_FLOAT
+#include "string/convert.h"
+
+#include "../primitiveparsers/FloatScanner.h"
+#include "TestBrushes.h"
+
+#include <chrono>
+
+// Compares string::to_float and map::nextFloat reading the face values of a large brush
+BOOST_AUTO_TEST_CASE(scanThroughput)
+{
+	std::mt19937 random(7);
+	std::string text = test::generateBrushes(200000, random);
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	Clock::time_point start = Clock::now();
+
+	std::vector<double> expected = test::readFaceValues(text, [](parser::DefTokeniser& tok)
+	{
+		return string::to_float(tok.nextToken());
+	});
+
+	Clock::time_point middle = Clock::now();
+
+	std::vector<double> scanned = test::readFaceValues(text, [](parser::DefTokeniser& tok)
+	{
+		return map::nextFloat(tok);
+	});
+
+	Clock::time_point end = Clock::now();
+
+	BOOST_CHECK(expected == scanned);
+
+	BOOST_TEST_MESSAGE("Reading " << expected.size() << " numbers: to_float "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count()
+		<< " ms, scanFloat "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << " ms");
+}
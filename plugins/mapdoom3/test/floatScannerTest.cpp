@@ -0,0 +1,125 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE floatScannerTest
+#include <boost/test/unit_test.hpp>
+
+// The primitive parsers used to convert their numbers like this
+#define SPECIALISE_STR_TO_FLOAT
+#include "string/convert.h"
+
+#include "../primitiveparsers/FloatScanner.h"
+#include "TestBrushes.h"
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <sstream>
+
+namespace
+{
+
+// Compares the bit patterns, which distinguishes -0 from 0 as well
+bool isBitIdentical(double a, double b)
+{
+	return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+void checkToken(const std::string& token)
+{
+	double expected = string::to_float(token);
+	double scanned = map::scanFloat(token);
+
+	BOOST_CHECK_MESSAGE(isBitIdentical(expected, scanned),
+		"Token \"" << token << "\": expected " << std::setprecision(17) << expected
+		<< ", scanned " << scanned);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(scanSpecialCases)
+{
+	const char* tokens[] =
+	{
+		"0", "-0", "+0", "0.0", "-0.0", "00000", ".5", "-.5", "5.", "-5.",
+		"1", "-1", "1524", "-1264", "255.9375", "0.015625", "0.0078125",
+		"0.1", "0.2", "0.3", "-0.7071067811865476", "0.70710678118654757",
+		"1e-05", "1.2e-07", "-3.5e+10", "1E3", "1e22", "1e23", "1e-22", "1e-23",
+		"9007199254740992", "9007199254740993", "18014398509481984",
+		"123456789012345678901234567890", "0.000000000000000000000000001",
+		"1.7976931348623157e308", "1e309", "4.9e-324", "1e-400",
+		"2.2250738585072011e-308", "0.3000000000000000444089209850062616169452667236328125",
+		"", "-", "+", ".", "-.", "e5", "1e", "1e+", "1e-", "1.5abc", "abc", "--1", "1..2",
+		"0x1p3", "inf", "-inf", "nan", " 1", "1 ", "1,5", "1e99999999999",
+	};
+
+	for (const char* token : tokens)
+	{
+		checkToken(token);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scanRandomNumbers)
+{
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<double> values(-65536.0, 65536.0);
+	std::uniform_int_distribution<int> exponents(-30, 30);
+	std::uniform_int_distribution<int> precisions(1, 20);
+
+	for (int i = 0; i < 200000; ++i)
+	{
+		double value = values(random) * std::pow(10.0, exponents(random));
+
+		std::ostringstream stream;
+
+		switch (i % 4)
+		{
+		case 0: // Like the map exporters are writing them
+			break;
+		case 1:
+			stream << std::setprecision(precisions(random));
+			break;
+		case 2:
+			stream << std::fixed << std::setprecision(precisions(random));
+			break;
+		case 3:
+			stream << std::scientific << std::setprecision(precisions(random));
+			break;
+		}
+
+		stream << value;
+
+		checkToken(stream.str());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(parseBrushPlanesBitIdentical)
+{
+	std::mt19937 random(42);
+	std::string text = test::generateBrushes(50000, random);
+
+	std::vector<double> expected = test::readFaceValues(text, [](parser::DefTokeniser& tok)
+	{
+		return string::to_float(tok.nextToken());
+	});
+
+	std::vector<double> scanned = test::readFaceValues(text, [](parser::DefTokeniser& tok)
+	{
+		return map::nextFloat(tok);
+	});
+
+	BOOST_REQUIRE_EQUAL(expected.size(), scanned.size());
+	BOOST_REQUIRE_EQUAL(expected.size(), 50000u * 10);
+
+	std::size_t mismatches = 0;
+
+	for (std::size_t i = 0; i < expected.size(); ++i)
+	{
+		if (!isBitIdentical(expected[i], scanned[i]))
+		{
+			++mismatches;
+		}
+	}
+
+	BOOST_CHECK_EQUAL(mismatches, 0u);
+}
@@ -86,6 +86,11 @@ bool MD5ModelNode::intersectsLight(const RendererLight& light) const
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB MD5ModelNode::litObjectAABB() const
+{
+	return worldAABB();
+}
+
 void MD5ModelNode::insertLight(const RendererLight& light) {
 	const Matrix4& l2w = localToWorld();
 
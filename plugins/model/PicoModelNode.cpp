@@ -70,6 +70,11 @@ bool PicoModelNode::intersectsLight(const RendererLight& light) const
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB PicoModelNode::litObjectAABB() const
+{
+	return worldAABB();
+}
+
 // Add a light to this model instance
 void PicoModelNode::insertLight(const RendererLight& light)
 {
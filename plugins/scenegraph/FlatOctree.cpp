@@ -0,0 +1,573 @@
+#include "FlatOctree.h"
+
+#include "inode.h"
+#include "OctreeNode.h"
+
+#include <limits>
+
+namespace scene
+{
+
+namespace
+{
+	const float START_SIZE = 512.0f;
+	const float MAX_WORLD_COORD = 65536;
+
+	const AABB START_AABB(Vector3(0,0,0), Vector3(START_SIZE, START_SIZE, START_SIZE));
+
+	// Number of octants per pool block (a multiple of 8, blocks hold whole broods)
+	const std::size_t BLOCK_SHIFT = 9;
+	const std::size_t BLOCK_SIZE = 1 << BLOCK_SHIFT;
+	const std::size_t BLOCK_MASK = BLOCK_SIZE - 1;
+
+	// The lookup table is kept at most half full
+	const std::size_t INITIAL_MAPPING_CAPACITY = 1024;
+
+	inline std::size_t hashNode(const INode* node)
+	{
+		// Fibonacci hashing, the lowest bits of heap addresses are always zero
+		std::uint64_t value = reinterpret_cast<std::uintptr_t>(node) >> 4;
+		return static_cast<std::size_t>((value * 11400714819323198485ull) >> 32);
+	}
+}
+
+const FlatOctree::OctantIndex FlatOctree::INVALID_OCTANT = std::numeric_limits<FlatOctree::OctantIndex>::max();
+
+FlatOctree::Octant::Octant() :
+	_owner(nullptr),
+	_parent(INVALID_OCTANT),
+	_firstChild(INVALID_OCTANT)
+{}
+
+ISPNodePtr FlatOctree::Octant::getParent() const
+{
+	if (_parent == INVALID_OCTANT)
+	{
+		return ISPNodePtr();
+	}
+
+	return ISPNodePtr(_owner->_anchor, &_owner->octant(_parent));
+}
+
+FlatOctree::FlatOctree() :
+	_poolEnd(0),
+	_anchor(std::make_shared<char>(0)),
+	_mapping(INITIAL_MAPPING_CAPACITY),
+	_mappingSize(0)
+{
+	_root = allocateBrood();
+	initialiseOctant(_root, START_AABB, INVALID_OCTANT);
+}
+
+FlatOctree::~FlatOctree()
+{
+	_mapping.clear();
+	_blocks.clear();
+}
+
+FlatOctree::Octant& FlatOctree::octant(OctantIndex index) const
+{
+	assert(index < _poolEnd);
+	return _blocks[index >> BLOCK_SHIFT][index & BLOCK_MASK];
+}
+
+FlatOctree::OctantIndex FlatOctree::allocateBrood()
+{
+	if (!_freeBroods.empty())
+	{
+		OctantIndex first = _freeBroods.back();
+		_freeBroods.pop_back();
+		return first;
+	}
+
+	if ((_poolEnd & BLOCK_MASK) == 0)
+	{
+		_blocks.push_back(OctantBlock(new Octant[BLOCK_SIZE]));
+	}
+
+	OctantIndex first = _poolEnd;
+	_poolEnd += 8;
+
+	return first;
+}
+
+void FlatOctree::releaseBrood(OctantIndex first)
+{
+	for (OctantIndex i = first; i < first + 8; ++i)
+	{
+		Octant& o = octant(i);
+
+		assert(o._members.empty());
+
+		o._members.clear();
+		o._childNodes.clear();
+		o._firstChild = INVALID_OCTANT;
+		o._parent = INVALID_OCTANT;
+	}
+
+	_freeBroods.push_back(first);
+}
+
+void FlatOctree::initialiseOctant(OctantIndex index, const AABB& bounds, OctantIndex parent)
+{
+	assert(bounds.isValid()); // require valid bounds
+
+	Octant& o = octant(index);
+
+	o._owner = this;
+	o._bounds = bounds;
+	o._parent = parent;
+	o._firstChild = INVALID_OCTANT;
+	o._childNodes.clear();
+	o._members.clear();
+}
+
+void FlatOctree::subdivide(OctantIndex index)
+{
+	// Allocate first, this might append a new block to the pool
+	OctantIndex first = allocateBrood();
+
+	Octant& o = octant(index);
+	assert(o.isLeaf());
+
+	// Each child node has half the extents of this node
+	Vector3 childExtents = o._bounds.extents * 0.5;
+
+	// Construct delta-vectors, pointing in each room direction
+	Vector3 x(childExtents.x(), 0, 0);
+	Vector3 y(0, childExtents.y(), 0);
+	Vector3 z(0, 0, childExtents.z());
+
+	Vector3 baseUpper = o._bounds.origin + z;
+	Vector3 baseLower = o._bounds.origin - z;
+
+	// Same octant order as OctreeNode::subdivide()
+	initialiseOctant(first + 0, AABB(baseUpper + x + y, childExtents), index);
+	initialiseOctant(first + 1, AABB(baseUpper + x - y, childExtents), index);
+	initialiseOctant(first + 2, AABB(baseUpper - x - y, childExtents), index);
+	initialiseOctant(first + 3, AABB(baseUpper - x + y, childExtents), index);
+
+	initialiseOctant(first + 4, AABB(baseLower + x + y, childExtents), index);
+	initialiseOctant(first + 5, AABB(baseLower + x - y, childExtents), index);
+	initialiseOctant(first + 6, AABB(baseLower - x - y, childExtents), index);
+	initialiseOctant(first + 7, AABB(baseLower - x + y, childExtents), index);
+
+	o._firstChild = first;
+	o._childNodes.resize(8);
+
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		o._childNodes[i] = ISPNodePtr(_anchor, &octant(first + static_cast<OctantIndex>(i)));
+	}
+}
+
+void FlatOctree::link(const scene::INodePtr& sceneNode)
+{
+	// Make sure we don't do double-links
+	assert(findMappingSlot(sceneNode.get()) == _mapping.size());
+
+	// Make sure the root node is large enough
+	ensureRootSize(sceneNode);
+
+	// Root node size is adjusted, let's link the node into the smallest encompassing octant
+	linkRecursively(_root, sceneNode);
+}
+
+bool FlatOctree::unlink(const scene::INodePtr& sceneNode)
+{
+	std::size_t position = findMappingSlot(sceneNode.get());
+
+	if (position == _mapping.size())
+	{
+		return false;
+	}
+
+	removeMember(position);
+
+	return true;
+}
+
+bool FlatOctree::relink(const scene::INodePtr& sceneNode)
+{
+	// Evaluate the bounds before looking at the table, this might re-enter
+	const AABB& bounds = sceneNode->worldAABB();
+
+	std::size_t position = findMappingSlot(sceneNode.get());
+
+	if (position == _mapping.size())
+	{
+		return false;
+	}
+
+	OctantIndex current = _mapping[position].octant;
+
+	// Nodes with invalid bounds are always linked to the root
+	if (!bounds.isValid())
+	{
+		if (current != _root)
+		{
+			removeMember(position);
+			addMember(_root, sceneNode);
+		}
+
+		return true;
+	}
+
+	// Walk up to the nearest octant which is able to contain the new bounds
+	OctantIndex target = current;
+
+	while (target != INVALID_OCTANT && !octant(target)._bounds.contains(bounds))
+	{
+		target = octant(target)._parent;
+	}
+
+	if (target == INVALID_OCTANT)
+	{
+		// Not even the root is large enough, take the regular route
+		removeMember(position);
+		link(sceneNode);
+		return true;
+	}
+
+	if (target == current && !childContains(current, bounds))
+	{
+		return true; // the node is still linked to the smallest encompassing octant
+	}
+
+	removeMember(position);
+	linkRecursively(target, sceneNode);
+
+	return true;
+}
+
+ISPNodePtr FlatOctree::getRoot() const
+{
+	return ISPNodePtr(_anchor, &octant(_root));
+}
+
+void FlatOctree::ensureRootSize(const scene::INodePtr& sceneNode)
+{
+	// Check if sceneNode exceeds the root node's bounds
+	const AABB& aabb = sceneNode->worldAABB();
+
+	if (!aabb.isValid()) return; // skip this for invalid bounds
+
+	while (!octant(_root)._bounds.contains(aabb))
+	{
+		// The bounding box of this node exceeds the root node's bounds, we need to extend the tree bounds
+		AABB newBounds = octant(_root)._bounds;
+		newBounds.extents *= 2;
+
+		// Don't go beyond the map limits
+		if (newBounds.extents.x() > MAX_WORLD_COORD)
+		{
+			break;
+		}
+
+		OctantIndex oldRoot = _root;
+		OctantIndex newRoot = allocateBrood();
+		initialiseOctant(newRoot, newBounds, INVALID_OCTANT);
+
+		// Re-link the members of the old root node, see Octree::ensureRootSize()
+		// why they are not passed through link() again.
+		relocateMembers(oldRoot, newRoot);
+
+		// Now, subdivide the new root node, after we moved the members
+		subdivide(newRoot);
+
+		OctantIndex oldChildren = octant(oldRoot)._firstChild;
+
+		if (oldChildren != INVALID_OCTANT)
+		{
+			// Move the children of the old root into the new root
+			// Each octant of the old root will be added to one child of the new root
+			for (OctantIndex i = 0; i < 8; ++i)
+			{
+				OctantIndex newChild = octant(newRoot)._firstChild + i;
+
+				subdivide(newChild);
+
+				// Find out which of the new subdivisions is matching the children of the old root
+				for (OctantIndex j = 0; j < 8; ++j)
+				{
+					OctantIndex newNode = octant(newChild)._firstChild + j;
+
+					for (OctantIndex old = oldChildren; old < oldChildren + 8; ++old)
+					{
+						if (octant(newNode)._bounds == octant(old)._bounds)
+						{
+							relocateMembers(old, newNode);
+							relocateChildren(old, newNode);
+							break;
+						}
+					}
+				}
+			}
+
+			octant(oldRoot)._firstChild = INVALID_OCTANT;
+			octant(oldRoot)._childNodes.clear();
+
+			releaseBrood(oldChildren);
+		}
+
+		releaseBrood(oldRoot);
+
+		_root = newRoot;
+	}
+}
+
+void FlatOctree::linkRecursively(OctantIndex start, const scene::INodePtr& sceneNode)
+{
+	const AABB& bounds = sceneNode->worldAABB();
+
+	OctantIndex index = start;
+
+	// If the AABB is not valid, just link it here, otherwise descend as far as possible
+	if (bounds.isValid())
+	{
+		while (!octant(index).isLeaf())
+		{
+			OctantIndex first = octant(index)._firstChild;
+			OctantIndex fitting = INVALID_OCTANT;
+
+			for (OctantIndex child = first; child < first + 8; ++child)
+			{
+				if (octant(child)._bounds.contains(bounds))
+				{
+					fitting = child;
+					break;
+				}
+			}
+
+			if (fitting == INVALID_OCTANT)
+			{
+				break; // Node didn't fit into any of the children, link it here
+			}
+
+			index = fitting;
+		}
+	}
+
+	addMember(index, sceneNode);
+
+	if (!bounds.isValid())
+	{
+		return;
+	}
+
+	// If this is a leaf, check if we exceeded the subdivision threshold and are large enough
+	Octant& o = octant(index);
+
+	if (o.isLeaf() &&
+		o._members.size() >= SUBDIVISION_THRESHOLD &&
+		o._bounds.extents.x() > MIN_NODE_EXTENTS)
+	{
+		// This leaf has enough members to justify a further subdivision, create 8 child nodes
+		subdivide(index);
+
+		// To avoid concurrent nodeBoundsChanged() calls during this operation, evaluate all
+		// child bounds before trying to re-distribute them over the new child nodes.
+		{
+			ISPNode::MemberList temp = octant(index)._members;
+
+			for (const INodePtr& member : temp)
+			{
+				member->worldAABB();
+			}
+		}
+
+		// Some members might have re-located themselves in the meantime,
+		// take the remaining ones and distribute them over the children
+		ISPNode::MemberList oldList;
+		oldList.swap(octant(index)._members);
+
+		for (const INodePtr& member : oldList)
+		{
+			std::size_t position = findMappingSlot(member.get());
+			assert(position != _mapping.size());
+
+			eraseMapping(position);
+
+			// The fact that we have 8 children now ensures that we won't be
+			// going down the same code path here again
+			linkRecursively(index, member);
+		}
+	}
+}
+
+void FlatOctree::addMember(OctantIndex index, const scene::INodePtr& sceneNode)
+{
+	ISPNode::MemberList& members = octant(index)._members;
+
+	insertMapping(sceneNode.get(), index, static_cast<std::uint32_t>(members.size()));
+	members.push_back(sceneNode);
+}
+
+void FlatOctree::removeMember(std::size_t position)
+{
+	MappingEntry entry = _mapping[position];
+	eraseMapping(position);
+
+	// Remove the member by moving the last one into its slot
+	ISPNode::MemberList& members = octant(entry.octant)._members;
+	assert(entry.slot < members.size() && members[entry.slot].get() == entry.node);
+
+	if (entry.slot + 1 != members.size())
+	{
+		members[entry.slot] = members.back();
+
+		std::size_t moved = findMappingSlot(members[entry.slot].get());
+		assert(moved != _mapping.size());
+
+		_mapping[moved].slot = entry.slot;
+	}
+
+	members.pop_back();
+}
+
+bool FlatOctree::childContains(OctantIndex index, const AABB& bounds) const
+{
+	OctantIndex first = octant(index)._firstChild;
+
+	if (first == INVALID_OCTANT)
+	{
+		return false;
+	}
+
+	for (OctantIndex child = first; child < first + 8; ++child)
+	{
+		if (octant(child)._bounds.contains(bounds))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FlatOctree::relocateMembers(OctantIndex source, OctantIndex target)
+{
+	ISPNode::MemberList& sourceMembers = octant(source)._members;
+	ISPNode::MemberList& targetMembers = octant(target)._members;
+
+	for (const INodePtr& member : sourceMembers)
+	{
+		std::size_t position = findMappingSlot(member.get());
+		assert(position != _mapping.size());
+
+		_mapping[position].octant = target;
+		_mapping[position].slot = static_cast<std::uint32_t>(targetMembers.size());
+
+		targetMembers.push_back(member);
+	}
+
+	sourceMembers.clear();
+}
+
+void FlatOctree::relocateChildren(OctantIndex source, OctantIndex target)
+{
+	Octant& sourceOctant = octant(source);
+	Octant& targetOctant = octant(target);
+
+	assert(targetOctant.isLeaf());
+
+	targetOctant._firstChild = sourceOctant._firstChild;
+	targetOctant._childNodes.swap(sourceOctant._childNodes);
+
+	sourceOctant._firstChild = INVALID_OCTANT;
+	sourceOctant._childNodes.clear();
+
+	// Tell each child who their parent is
+	if (targetOctant._firstChild != INVALID_OCTANT)
+	{
+		for (OctantIndex i = targetOctant._firstChild; i < targetOctant._firstChild + 8; ++i)
+		{
+			octant(i)._parent = target;
+		}
+	}
+}
+
+std::size_t FlatOctree::findMappingSlot(const INode* node) const
+{
+	std::size_t mask = _mapping.size() - 1;
+
+	for (std::size_t i = hashNode(node) & mask; ; i = (i + 1) & mask)
+	{
+		const INode* candidate = _mapping[i].node;
+
+		if (candidate == node)
+		{
+			return i;
+		}
+
+		if (candidate == nullptr)
+		{
+			return _mapping.size(); // not found
+		}
+	}
+}
+
+void FlatOctree::insertMapping(const INode* node, OctantIndex octant, std::uint32_t slot)
+{
+	if ((_mappingSize + 1) * 2 > _mapping.size())
+	{
+		growMapping();
+	}
+
+	std::size_t mask = _mapping.size() - 1;
+	std::size_t i = hashNode(node) & mask;
+
+	while (_mapping[i].node != nullptr)
+	{
+		assert(_mapping[i].node != node);
+		i = (i + 1) & mask;
+	}
+
+	_mapping[i].node = node;
+	_mapping[i].octant = octant;
+	_mapping[i].slot = slot;
+
+	++_mappingSize;
+}
+
+void FlatOctree::eraseMapping(std::size_t position)
+{
+	std::size_t mask = _mapping.size() - 1;
+
+	// Backward-shift deletion, this keeps the probe sequences intact without tombstones
+	std::size_t hole = position;
+
+	for (std::size_t i = (position + 1) & mask; _mapping[i].node != nullptr; i = (i + 1) & mask)
+	{
+		std::size_t home = hashNode(_mapping[i].node) & mask;
+
+		// Move the entry into the hole if its home slot is not within (hole, i]
+		if (((i - home) & mask) >= ((i - hole) & mask))
+		{
+			_mapping[hole] = _mapping[i];
+			hole = i;
+		}
+	}
+
+	_mapping[hole].node = nullptr;
+
+	--_mappingSize;
+}
+
+void FlatOctree::growMapping()
+{
+	std::vector<MappingEntry> old(_mapping.size() * 2);
+	old.swap(_mapping);
+
+	_mappingSize = 0;
+
+	for (const MappingEntry& entry : old)
+	{
+		if (entry.node != nullptr)
+		{
+			insertMapping(entry.node, entry.octant, entry.slot);
+		}
+	}
+}
+
+} // namespace scene
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ispacepartition.h"
+#include "math/AABB.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace scene
+{
+
+/**
+ * greebo: The FlatOctree is an alternative implementation of the Octree
+ * space partition, using the same subdivision rules, but a different
+ * memory layout tuned for large maps with many moving nodes.
+ *
+ * Instead of allocating each octant separately on the heap, all octants are
+ * stored in a block pool and referenced by their 32-bit index. The 8 children
+ * of an octant are always allocated as one contiguous "brood", so descending
+ * the tree touches neighbouring memory only.
+ *
+ * The lookup table mapping scene::INodes to octants is an open-addressing
+ * hash table (linear probing, keyed by the node's address), which stores
+ * the octant index together with the slot of the node in the octant's
+ * member array. This makes unlink() an O(1) operation: the member is removed
+ * by swapping the last member into its slot.
+ *
+ * Note: the ISPNodePtrs handed out by getRoot(), getParent() and getChildNodes()
+ * don't own the octants, they are only valid as long as this FlatOctree is alive.
+ */
+class FlatOctree :
+	public ISpacePartitionSystem
+{
+public:
+	class Octant;
+
+private:
+	typedef std::uint32_t OctantIndex;
+	static const OctantIndex INVALID_OCTANT;
+
+	// Octants are allocated in blocks, indices are stable as long as the tree lives
+	typedef std::unique_ptr<Octant[]> OctantBlock;
+	std::vector<OctantBlock> _blocks;
+
+	// The index of the next unused brood at the end of the pool
+	OctantIndex _poolEnd;
+
+	// Broods released during root growth, ready to be re-used
+	std::vector<OctantIndex> _freeBroods;
+
+	// The index of the root octant
+	OctantIndex _root;
+
+	// Sentinel used as control block for the non-owning ISPNodePtrs
+	std::shared_ptr<char> _anchor;
+
+	// Open-addressing lookup table (scene::INode => octant + member slot)
+	struct MappingEntry
+	{
+		const INode* node;
+		OctantIndex octant;
+		std::uint32_t slot;
+	};
+	std::vector<MappingEntry> _mapping;
+	std::size_t _mappingSize;
+
+public:
+	FlatOctree();
+
+	~FlatOctree();
+
+	// Links this node into the SP tree.
+	void link(const scene::INodePtr& sceneNode) override;
+
+	// Unlink this node from the SP tree, returns true if found
+	bool unlink(const scene::INodePtr& sceneNode) override;
+
+	// Re-links this node after its bounds changed, returns true if found
+	bool relink(const scene::INodePtr& sceneNode) override;
+
+	// Returns the root node of this SP tree
+	ISPNodePtr getRoot() const override;
+
+private:
+	Octant& octant(OctantIndex index) const;
+
+	// Returns the index of the first octant of a fresh brood of 8 octants
+	OctantIndex allocateBrood();
+	void releaseBrood(OctantIndex first);
+
+	void initialiseOctant(OctantIndex index, const AABB& bounds, OctantIndex parent);
+
+	// Creates the 8 children of the given octant
+	void subdivide(OctantIndex index);
+
+	// Grow the root octant until it encompasses the given node's bounds
+	void ensureRootSize(const scene::INodePtr& sceneNode);
+
+	void linkRecursively(OctantIndex start, const scene::INodePtr& sceneNode);
+	void addMember(OctantIndex index, const scene::INodePtr& sceneNode);
+
+	// Removes the member referenced by the given lookup table position
+	void removeMember(std::size_t position);
+
+	// Returns true if one of the children of the given octant can contain the bounds
+	bool childContains(OctantIndex index, const AABB& bounds) const;
+
+	// Moves all members (and their mapping entries) from source to target
+	void relocateMembers(OctantIndex source, OctantIndex target);
+
+	// Hands the children of source over to target (which must be a leaf)
+	void relocateChildren(OctantIndex source, OctantIndex target);
+
+	// Lookup table helpers
+	std::size_t findMappingSlot(const INode* node) const;
+	void insertMapping(const INode* node, OctantIndex octant, std::uint32_t slot);
+	void eraseMapping(std::size_t position);
+	void growMapping();
+};
+
+/**
+ * The octant type of the FlatOctree. Octants only know the indices of
+ * their parent and their first child, the ISPNode interface is implemented
+ * on top of that using non-owning pointers into the pool.
+ */
+class FlatOctree::Octant :
+	public ISPNode
+{
+private:
+	friend class FlatOctree;
+
+	FlatOctree* _owner;
+
+	AABB _bounds;
+
+	OctantIndex _parent;
+
+	// The first of the 8 children, INVALID_OCTANT for leaves
+	OctantIndex _firstChild;
+
+	// The list of children as required by the ISPNode interface
+	NodeList _childNodes;
+
+	MemberList _members;
+
+public:
+	Octant();
+
+	ISPNodePtr getParent() const override;
+
+	const AABB& getBounds() const override
+	{
+		return _bounds;
+	}
+
+	const NodeList& getChildNodes() const override
+	{
+		return _childNodes;
+	}
+
+	bool isLeaf() const override
+	{
+		return _firstChild == INVALID_OCTANT;
+	}
+
+	const MemberList& getMembers() const override
+	{
+		return _members;
+	}
+};
+
+} // namespace scene
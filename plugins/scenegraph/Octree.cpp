@@ -120,6 +120,59 @@ bool Octree::unlink(const scene::INodePtr& sceneNode)
 	return false;
 }
 
+bool Octree::relink(const scene::INodePtr& sceneNode)
+{
+	// Evaluate the bounds before looking at the mapping, this might re-enter
+	const AABB& bounds = sceneNode->worldAABB();
+
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode);
+
+	if (found == _nodeMapping.end())
+	{
+		return false;
+	}
+
+	OctreeNode* current = found->second;
+
+	// Nodes with invalid bounds are always linked to the root
+	if (!bounds.isValid())
+	{
+		if (current != _root.get())
+		{
+			current->unlink(sceneNode);
+			_root->linkRecursively(sceneNode);
+		}
+
+		return true;
+	}
+
+	// Walk up to the nearest octant which is able to contain the new bounds
+	OctreeNode* target = current;
+
+	while (target != nullptr && !target->getBounds().contains(bounds))
+	{
+		target = target->getParentNode();
+	}
+
+	if (target == nullptr)
+	{
+		// Not even the root is large enough, take the regular route
+		current->unlink(sceneNode);
+		link(sceneNode);
+		return true;
+	}
+
+	if (target == current && !current->childContains(bounds))
+	{
+		return true; // the node is still linked to the smallest encompassing octant
+	}
+
+	current->unlink(sceneNode);
+	target->linkRecursively(sceneNode);
+
+	return true;
+}
+
 // Returns the root node of this SP tree
 ISPNodePtr Octree::getRoot() const
 {
@@ -60,6 +60,9 @@ public:
 	// Unlink this node from the SP tree, returns true if found
 	bool unlink(const scene::INodePtr& sceneNode);
 
+	// Re-links this node after its bounds changed, returns true if found
+	bool relink(const scene::INodePtr& sceneNode);
+
 	// Returns the root node of this SP tree
 	ISPNodePtr getRoot() const;
 
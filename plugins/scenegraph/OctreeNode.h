@@ -83,6 +83,12 @@ public:
 		return _parent.lock();
 	}
 
+	// The parent node as OctreeNode (NULL for the root node)
+	OctreeNode* getParentNode() const
+	{
+		return static_cast<OctreeNode*>(_parent.lock().get());
+	}
+
 	// The maximum bounds of this node
 	const AABB& getBounds() const
 	{
@@ -107,6 +113,20 @@ public:
 		return _children.empty();
 	}
 
+	// Returns true if one of the child nodes is able to contain the given bounds
+	bool childContains(const AABB& bounds) const
+	{
+		for (std::size_t i = 0, size = _children.size(); i < size; ++i)
+		{
+			if (_children[i]->getBounds().contains(bounds))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	// Subdivide this octree node (adding 8 child nodes)
 	void subdivide()
 	{
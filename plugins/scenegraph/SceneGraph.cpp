@@ -8,14 +8,28 @@
 
 #include "math/AABB.h"
 #include "Octree.h"
+#include "FlatOctree.h"
 #include "SceneGraphFactory.h"
 #include "util/ScopedBoolLock.h"
+#include "util/ThreadPool.h"
+#include "registry/registry.h"
 
 namespace scene
 {
 
-SceneGraph::SceneGraph() :
-	_spacePartition(new Octree),
+namespace
+{
+	const char* const RKEY_SPACE_PARTITION_TYPE = "debug/scenegraph/spacePartition";
+	const char* const RKEY_PARALLEL_TRAVERSAL = "user/ui/scenegraph/parallelTraversal";
+
+	// The tree levels above this depth are culled by the calling thread,
+	// the subtrees below are distributed over the worker threads (up to 8^depth)
+	const std::size_t PARALLEL_SPLIT_DEPTH = 2;
+}
+
+SceneGraph::SceneGraph(SpacePartitionType spacePartitionType) :
+	_spacePartitionType(spacePartitionType),
+	_spacePartition(createSpacePartition()),
 	_visitedSPNodes(0),
 	_skippedSPNodes(0),
     _traversalOngoing(false)
@@ -85,7 +99,8 @@ void SceneGraph::setRoot(const IMapRootNodePtr& newRoot)
 	_root = newRoot;
 
 	// Refresh the space partition class
-	_spacePartition = ISpacePartitionSystemPtr(new Octree);
+	_pendingBoundsChanges.clear();
+	_spacePartition = createSpacePartition();
 
 	if (_root)
 	{
@@ -138,6 +153,7 @@ void SceneGraph::erase(const INodePtr& node)
         return;
     }
 
+	_pendingBoundsChanges.erase(node);
 	_spacePartition->unlink(node);
 
 	// Fire the onRemove event on the Node
@@ -155,17 +171,33 @@ void SceneGraph::erase(const INodePtr& node)
 
 void SceneGraph::nodeBoundsChanged(const INodePtr& node)
 {
+    // Don't touch the partition right now, bounds tend to change in bulk
+    // (think of a selection of several thousand brushes being dragged around),
+    // the re-link happens before the partition is accessed the next time.
+    // During traversal the set is left alone until flushActionBuffer().
+    _pendingBoundsChanges.insert(node);
+}
+
+void SceneGraph::flushBoundsChanges()
+{
+    // Don't touch the partition while a walk is iterating over its members
     if (_traversalOngoing)
     {
-        _actionBuffer.push_back(NodeAction(BoundsChange, node));
         return;
     }
 
-	if (_spacePartition->unlink(node))
-	{
-		// unlink returned true, so the given node was linked before => re-link it
-		_spacePartition->link(node);
-	}
+    // Re-linking evaluates the node bounds which might report further
+    // changes, so keep going until no more nodes are left
+    while (!_pendingBoundsChanges.empty())
+    {
+        NodeSet pending;
+        pending.swap(_pendingBoundsChanges);
+
+        for (const INodePtr& node : pending)
+        {
+            _spacePartition->relink(node);
+        }
+    }
 }
 
 void SceneGraph::foreachNode(const INode::VisitorFunc& functor)
@@ -215,6 +247,12 @@ void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::Visi
     // changes during traversal so let's call this now. If nothing got changed, this call is very cheap.
     if (_root != nullptr) _root->worldAABB();
 
+    // Bring the partition up to date with all the bounds changes collected so far
+    flushBoundsChanges();
+
+    // Walks started by a functor of another walk leave the buffers to the outer one
+    bool nested = _traversalOngoing;
+
     {
         // Buffer any calls that might happen in between
         util::ScopedBoolLock traversal(_traversalOngoing);
@@ -224,11 +262,25 @@ void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::Visi
 
         _visitedSPNodes = _skippedSPNodes = 0;
 
-        foreachNodeInVolume_r(*root, volume, functor, visitHidden);
+        if (_cullingPool)
+        {
+            foreachNodeInVolumeParallel(*root, volume, functor, visitHidden);
+        }
+        else
+        {
+            foreachNodeInVolume_r(*root, volume, functor, visitHidden);
+        }
 
         _visitedSPNodes = _skippedSPNodes = 0;
     }
 
+    if (nested)
+    {
+        // The lock has been reset, but the outer walk is still going on
+        _traversalOngoing = true;
+        return;
+    }
+
     // Traversal finished, flush the action buffer
     flushActionBuffer();
 }
@@ -297,11 +349,153 @@ bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& vo
 	return true; // continue traversal
 }
 
+void SceneGraph::foreachNodeInVolumeParallel(const ISPNode& root, const VolumeTest& volume,
+											 const INode::VisitorFunc& functor, bool visitHidden)
+{
+	typedef std::vector<INodePtr> NodeList;
+
+	// Cull the upper levels in this thread, collecting their members and the subtrees below
+	NodeList topMembers;
+	std::vector<const ISPNode*> subtrees;
+
+	std::vector<const ISPNode*> level(1, &root);
+
+	for (std::size_t depth = 0; depth <= PARALLEL_SPLIT_DEPTH && !level.empty(); ++depth)
+	{
+		std::vector<const ISPNode*> nextLevel;
+
+		for (const ISPNode* node : level)
+		{
+			if (depth == PARALLEL_SPLIT_DEPTH)
+			{
+				subtrees.push_back(node);
+				continue;
+			}
+
+			for (const INodePtr& member : node->getMembers())
+			{
+				if (visitHidden || member->visible())
+				{
+					topMembers.push_back(member);
+				}
+			}
+
+			for (const ISPNodePtr& child : node->getChildNodes())
+			{
+				if (volume.TestAABB(child->getBounds()) != VOLUME_OUTSIDE)
+				{
+					nextLevel.push_back(child.get());
+				}
+			}
+		}
+
+		level.swap(nextLevel);
+	}
+
+	// Each subtree gets its own result list, such that the merge order is deterministic
+	std::vector<NodeList> subtreeMembers(subtrees.size());
+
+	_cullingPool->parallelFor(subtrees.size(), [&] (std::size_t index)
+	{
+		NodeList& result = subtreeMembers[index];
+		std::vector<const ISPNode*> stack(1, subtrees[index]);
+
+		while (!stack.empty())
+		{
+			const ISPNode* node = stack.back();
+			stack.pop_back();
+
+			for (const INodePtr& member : node->getMembers())
+			{
+				if (visitHidden || member->visible())
+				{
+					result.push_back(member);
+				}
+			}
+
+			for (const ISPNodePtr& child : node->getChildNodes())
+			{
+				if (volume.TestAABB(child->getBounds()) != VOLUME_OUTSIDE)
+				{
+					stack.push_back(child.get());
+				}
+			}
+		}
+	});
+
+	// Culling is done, visit the nodes in this thread
+	for (const INodePtr& node : topMembers)
+	{
+		if (!functor(node)) return;
+	}
+
+	for (const NodeList& list : subtreeMembers)
+	{
+		for (const INodePtr& node : list)
+		{
+			if (!functor(node)) return;
+		}
+	}
+}
+
+void SceneGraph::setParallelTraversal(bool enabled)
+{
+	if (enabled && !_cullingPool)
+	{
+		_cullingPool.reset(new util::ThreadPool);
+	}
+	else if (!enabled)
+	{
+		_cullingPool.reset();
+	}
+}
+
 ISpacePartitionSystemPtr SceneGraph::getSpacePartition()
 {
+	flushBoundsChanges();
+
 	return _spacePartition;
 }
 
+void SceneGraph::setSpacePartitionType(SpacePartitionType type)
+{
+	if (_spacePartitionType == type)
+	{
+		return;
+	}
+
+	_spacePartitionType = type;
+
+	flushBoundsChanges();
+
+	ISpacePartitionSystemPtr newPartition = createSpacePartition();
+
+	// Move all nodes currently in the scene over to the new partition
+	foreachNode([&] (const INodePtr& node)->bool
+	{
+		if (_spacePartition->unlink(node))
+		{
+			newPartition->link(node);
+		}
+
+		return true;
+	});
+
+	_spacePartition = newPartition;
+}
+
+ISpacePartitionSystemPtr SceneGraph::createSpacePartition() const
+{
+	switch (_spacePartitionType)
+	{
+	case SpacePartitionType::FlatOctree:
+		return ISpacePartitionSystemPtr(new FlatOctree);
+	case SpacePartitionType::Octree:
+	default:
+		return ISpacePartitionSystemPtr(new Octree);
+	};
+}
+
 void SceneGraph::flushActionBuffer()
 {
     // Do any actions now, in the same order they came in
@@ -315,13 +509,13 @@ void SceneGraph::flushActionBuffer()
         case Erase:
             erase(action.second);
             break;
-        case BoundsChange:
-            nodeBoundsChanged(action.second);
-            break;
         };
     }
 
     _actionBuffer.clear();
+
+    // Re-link the nodes which changed their bounds during traversal
+    flushBoundsChanges();
 }
 
 // RegisterableModule implementation
@@ -333,13 +527,37 @@ const std::string& SceneGraphModule::getName() const
 
 const StringSet& SceneGraphModule::getDependencies() const
 {
-	static StringSet _dependencies; // no deps
+	static StringSet _dependencies;
+
+	if (_dependencies.empty())
+	{
+		_dependencies.insert(MODULE_XMLREGISTRY);
+	}
+
 	return _dependencies;
 }
 
 void SceneGraphModule::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
+
+	// The main scenegraph can be switched to the flat octree through the registry
+	if (registry::getValue<std::string>(RKEY_SPACE_PARTITION_TYPE) == "flatOctree")
+	{
+		rMessage() << getName() << ": using flat octree space partition" << std::endl;
+		setSpacePartitionType(SpacePartitionType::FlatOctree);
+	}
+
+	GlobalRegistry().signalForKey(RKEY_PARALLEL_TRAVERSAL).connect(
+		sigc::mem_fun(this, &SceneGraphModule::onParallelTraversalKeyChanged)
+	);
+
+	onParallelTraversalKeyChanged();
+}
+
+void SceneGraphModule::onParallelTraversalKeyChanged()
+{
+	setParallelTraversal(registry::getValue<bool>(RKEY_PARALLEL_TRAVERSAL));
 }
 
 } // namespace scene
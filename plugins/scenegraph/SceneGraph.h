@@ -2,13 +2,20 @@
 
 #include <map>
 #include <list>
+#include <unordered_set>
 #include <sigc++/signal.h>
 
 #include "iscenegraph.h"
+#include "iscenegraphfactory.h"
 #include "imodule.h"
 #include "ispacepartition.h"
 #include "imap.h"
 
+#include <vector>
+#include <memory>
+
+namespace util { class ThreadPool; }
+
 namespace scene
 {
 
@@ -32,6 +39,7 @@ private:
     IMapRootNodePtr _root;
 
 	// The space partitioning system
+	SpacePartitionType _spacePartitionType;
 	ISpacePartitionSystemPtr _spacePartition;
 
 	std::size_t _visitedSPNodes;
@@ -43,7 +51,6 @@ private:
     {
         Insert,
         Erase,
-        BoundsChange,
     };
     typedef std::pair<ActionType, scene::INodePtr> NodeAction;
     typedef std::list<NodeAction> BufferedActions;
@@ -51,8 +58,17 @@ private:
 
     bool _traversalOngoing;
 
+    // Nodes whose bounds changed since the last partition query. These are
+    // collected (e.g. during a transform of many nodes) and re-linked in one
+    // pass right before the space partition is accessed the next time.
+    typedef std::unordered_set<INodePtr> NodeSet;
+    NodeSet _pendingBoundsChanges;
+
+    // Worker threads for the parallel culling mode, NULL if disabled
+    std::unique_ptr<util::ThreadPool> _cullingPool;
+
 public:
-	SceneGraph();
+	SceneGraph(SpacePartitionType spacePartitionType = SpacePartitionType::Octree);
 
 	~SceneGraph();
 
@@ -92,14 +108,32 @@ public:
     void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) override;
 
     ISpacePartitionSystemPtr getSpacePartition() override;
+
+    void setParallelTraversal(bool enabled) override;
+
+protected:
+	// Switches to a different space partition implementation, 
+	// all linked nodes are transferred to the new one
+	void setSpacePartitionType(SpacePartitionType type);
+
 private:
+	ISpacePartitionSystemPtr createSpacePartition() const;
+
 	void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden);
 
 	// Recursive method used to descend the SpacePartition tree, returns FALSE if the walker signaled stop
 	bool foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& volume, 
 							   const INode::VisitorFunc& functor, bool visitHidden);
 
+	// Parallel variant: the upper levels of the tree are split into subtrees which are
+	// culled by the worker pool, the functor is invoked on the resulting lists afterwards
+	void foreachNodeInVolumeParallel(const ISPNode& root, const VolumeTest& volume,
+									 const INode::VisitorFunc& functor, bool visitHidden);
+
     void flushActionBuffer();
+
+    // Re-links all nodes with pending bounds changes, does nothing during traversal
+    void flushBoundsChanges();
 };
 typedef std::shared_ptr<SceneGraph> SceneGraphPtr;
 
@@ -113,6 +147,9 @@ public:
 	const std::string& getName() const;
 	const StringSet& getDependencies() const;
 	void initialiseModule(const ApplicationContext& ctx);
+
+private:
+	void onParallelTraversalKeyChanged();
 };
 typedef std::shared_ptr<SceneGraphModule> SceneGraphModulePtr;
 
@@ -11,6 +11,11 @@ GraphPtr SceneGraphFactory::createSceneGraph()
 	return GraphPtr(new SceneGraph);
 }
 
+GraphPtr SceneGraphFactory::createSceneGraph(SpacePartitionType spacePartitionType)
+{
+	return GraphPtr(new SceneGraph(spacePartitionType));
+}
+
 const std::string& SceneGraphFactory::getName() const
 {
 	static std::string _name(MODULE_SCENEGRAPHFACTORY);
@@ -10,6 +10,7 @@ class SceneGraphFactory :
 {
 public:
 	GraphPtr createSceneGraph();
+	GraphPtr createSceneGraph(SpacePartitionType spacePartitionType);
 
 	// RegisterableModule implementation
 	const std::string& getName() const;
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "scene/Node.h"
+#include "ivolumetest.h"
+#include "ispacepartition.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+/**
+ * Randomly placed scene nodes and space partition queries, shared by the
+ * space partition tests and benchmarks.
+ */
+namespace test
+{
+
+// Minimal scene node with fixed local bounds, positioned through its AABB
+class BoundedTestNode :
+	public scene::Node
+{
+private:
+	AABB _localBounds;
+
+public:
+	BoundedTestNode(const AABB& bounds) :
+		_localBounds(bounds)
+	{}
+
+	void setBounds(const AABB& bounds)
+	{
+		_localBounds = bounds;
+		boundsChanged();
+	}
+
+	const AABB& localAABB() const override
+	{
+		return _localBounds;
+	}
+
+	Type getNodeType() const override
+	{
+		return Type::Brush;
+	}
+
+	void renderSolid(RenderableCollector& collector, const VolumeTest& volume) const override
+	{}
+
+	void renderWireframe(RenderableCollector& collector, const VolumeTest& volume) const override
+	{}
+
+	bool isHighlighted() const override
+	{
+		return false;
+	}
+};
+typedef std::shared_ptr<BoundedTestNode> BoundedTestNodePtr;
+
+typedef std::vector<BoundedTestNodePtr> TestNodes;
+
+inline AABB getRandomBounds(std::mt19937& rng)
+{
+	std::uniform_real_distribution<double> position(-16384, 16384);
+	std::uniform_real_distribution<double> size(4, 256);
+
+	return AABB(Vector3(position(rng), position(rng), position(rng)),
+				Vector3(size(rng), size(rng), size(rng)));
+}
+
+inline TestNodes createTestNodes(std::size_t count)
+{
+	std::mt19937 rng(1234);
+	TestNodes nodes;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		nodes.push_back(std::make_shared<BoundedTestNode>(getRandomBounds(rng)));
+	}
+
+	return nodes;
+}
+
+// Collects all members intersecting the given query bounds
+inline void collectMembers(const scene::ISPNode& node, const AABB& query, std::set<scene::INode*>& result)
+{
+	for (const scene::INodePtr& member : node.getMembers())
+	{
+		if (member->worldAABB().intersects(query))
+		{
+			result.insert(member.get());
+		}
+	}
+
+	for (const scene::ISPNodePtr& child : node.getChildNodes())
+	{
+		if (child->getBounds().intersects(query))
+		{
+			collectMembers(*child, query, result);
+		}
+	}
+}
+
+inline std::size_t countMembers(const scene::ISPNode& node)
+{
+	std::size_t count = node.getMembers().size();
+
+	for (const scene::ISPNodePtr& child : node.getChildNodes())
+	{
+		count += countMembers(*child);
+	}
+
+	return count;
+}
+
+} // namespace test
@@ -0,0 +1,110 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE spacePartitionBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "TestNodes.h"
+
+#include "../Octree.h"
+#include "../FlatOctree.h"
+
+#include <chrono>
+
+using namespace test;
+
+namespace
+{
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double millisecondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Times a link / move / query / unlink cycle, returns the query results for comparison
+std::vector<std::size_t> runBenchmark(scene::ISpacePartitionSystem& partition, const TestNodes& nodes, const std::string& name)
+{
+	std::mt19937 rng(5678);
+	std::vector<std::size_t> queryResults;
+
+	Clock::time_point start = Clock::now();
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		partition.link(node);
+	}
+
+	double linkTime = millisecondsSince(start);
+
+	// Move every node to a new location, re-linking it like SceneGraph::nodeBoundsChanged does
+	start = Clock::now();
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		partition.unlink(node);
+
+		node->setBounds(getRandomBounds(rng));
+		partition.link(node);
+	}
+
+	double relinkTime = millisecondsSince(start);
+
+	// Nudge every node by one grid unit, most of them will stay in their octant
+	start = Clock::now();
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		AABB bounds = node->localAABB();
+		bounds.origin += Vector3(1, 0, 0);
+
+		node->setBounds(bounds);
+		partition.relink(node);
+	}
+
+	double nudgeTime = millisecondsSince(start);
+
+	start = Clock::now();
+
+	for (std::size_t i = 0; i < 1000; ++i)
+	{
+		std::set<scene::INode*> result;
+		collectMembers(*partition.getRoot(), getRandomBounds(rng), result);
+
+		queryResults.push_back(result.size());
+	}
+
+	double queryTime = millisecondsSince(start);
+
+	start = Clock::now();
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		partition.unlink(node);
+	}
+
+	double unlinkTime = millisecondsSince(start);
+
+	BOOST_TEST_MESSAGE(name << ": " << nodes.size() << " nodes, link " << linkTime << " ms, "
+		<< "unlink+link " << relinkTime << " ms, relink " << nudgeTime << " ms, "
+		<< "1000 queries " << queryTime << " ms, unlink " << unlinkTime << " ms");
+
+	return queryResults;
+}
+
+}
+
+// Compares the Octree and FlatOctree on a large number of nodes
+BOOST_AUTO_TEST_CASE(linkCycle)
+{
+	TestNodes nodes = createTestNodes(40000);
+
+	scene::Octree octree;
+	std::vector<std::size_t> octreeResults = runBenchmark(octree, nodes, "Octree");
+
+	TestNodes flatNodes = createTestNodes(40000);
+
+	scene::FlatOctree flatOctree;
+	std::vector<std::size_t> flatResults = runBenchmark(flatOctree, flatNodes, "FlatOctree");
+
+	BOOST_CHECK(octreeResults == flatResults);
+}
@@ -0,0 +1,180 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE spacePartitionTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestNodes.h"
+
+#include "../Octree.h"
+#include "../FlatOctree.h"
+
+using namespace test;
+
+namespace
+{
+
+// Each member must be linked to an octant fully containing its bounds
+void checkContainment(const scene::ISPNode& node, bool isRoot)
+{
+	for (const scene::INodePtr& member : node.getMembers())
+	{
+		BOOST_CHECK(isRoot || node.getBounds().contains(member->worldAABB()));
+	}
+
+	for (const scene::ISPNodePtr& child : node.getChildNodes())
+	{
+		BOOST_CHECK(child->getParent().get() == &node);
+		checkContainment(*child, false);
+	}
+}
+
+// Runs a link / move / query / unlink cycle, returns the query results for comparison
+std::vector<std::size_t> runLinkCycle(scene::ISpacePartitionSystem& partition, const TestNodes& nodes)
+{
+	std::mt19937 rng(5678);
+	std::vector<std::size_t> queryResults;
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		partition.link(node);
+	}
+
+	BOOST_CHECK_EQUAL(countMembers(*partition.getRoot()), nodes.size());
+	checkContainment(*partition.getRoot(), true);
+
+	// Move every node to a new location, re-linking it like SceneGraph::nodeBoundsChanged does
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		BOOST_CHECK(partition.unlink(node));
+
+		node->setBounds(getRandomBounds(rng));
+		partition.link(node);
+	}
+
+	BOOST_CHECK_EQUAL(countMembers(*partition.getRoot()), nodes.size());
+	checkContainment(*partition.getRoot(), true);
+
+	// Nudge every node by one grid unit, most of them will stay in their octant
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		AABB bounds = node->localAABB();
+		bounds.origin += Vector3(1, 0, 0);
+
+		node->setBounds(bounds);
+		BOOST_CHECK(partition.relink(node));
+	}
+
+	BOOST_CHECK_EQUAL(countMembers(*partition.getRoot()), nodes.size());
+	checkContainment(*partition.getRoot(), true);
+
+	for (std::size_t i = 0; i < 1000; ++i)
+	{
+		std::set<scene::INode*> result;
+		collectMembers(*partition.getRoot(), getRandomBounds(rng), result);
+
+		queryResults.push_back(result.size());
+	}
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		BOOST_CHECK(partition.unlink(node));
+	}
+
+	BOOST_CHECK_EQUAL(countMembers(*partition.getRoot()), 0);
+
+	// Unlinking twice is safe, but returns false
+	BOOST_CHECK(!partition.unlink(nodes.front()));
+
+	// Relinking an unlinked node is a no-op
+	BOOST_CHECK(!partition.relink(nodes.front()));
+	BOOST_CHECK_EQUAL(countMembers(*partition.getRoot()), 0);
+
+	return queryResults;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(flatOctreeMatchesOctree)
+{
+	TestNodes nodes = createTestNodes(40000);
+
+	scene::Octree octree;
+	std::vector<std::size_t> octreeResults = runLinkCycle(octree, nodes);
+
+	// Reset the node positions, so that both partitions see the same sequence
+	TestNodes flatNodes = createTestNodes(40000);
+
+	scene::FlatOctree flatOctree;
+	std::vector<std::size_t> flatResults = runLinkCycle(flatOctree, flatNodes);
+
+	BOOST_CHECK(octreeResults == flatResults);
+}
+
+BOOST_AUTO_TEST_CASE(relinkFindsSmallestOctant)
+{
+	scene::Octree octree;
+	scene::FlatOctree flatOctree;
+
+	TestNodes nodes = createTestNodes(1000);
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		octree.link(node);
+		flatOctree.link(node);
+	}
+
+	// Move the nodes far away and back to a tiny box, both trees must follow
+	std::mt19937 rng(42);
+
+	for (const BoundedTestNodePtr& node : nodes)
+	{
+		node->setBounds(getRandomBounds(rng));
+		BOOST_CHECK(octree.relink(node));
+		BOOST_CHECK(flatOctree.relink(node));
+
+		node->setBounds(AABB(node->localAABB().origin, Vector3(1, 1, 1)));
+		BOOST_CHECK(octree.relink(node));
+		BOOST_CHECK(flatOctree.relink(node));
+	}
+
+	checkContainment(*octree.getRoot(), true);
+	checkContainment(*flatOctree.getRoot(), true);
+
+	for (std::size_t i = 0; i < 100; ++i)
+	{
+		AABB query = getRandomBounds(rng);
+
+		std::set<scene::INode*> octreeResult;
+		std::set<scene::INode*> flatResult;
+
+		collectMembers(*octree.getRoot(), query, octreeResult);
+		collectMembers(*flatOctree.getRoot(), query, flatResult);
+
+		BOOST_CHECK(octreeResult == flatResult);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(flatOctreeGrowsRoot)
+{
+	scene::FlatOctree octree;
+
+	AABB small(Vector3(10, 10, 10), Vector3(8, 8, 8));
+	AABB huge(Vector3(20000, -20000, 0), Vector3(64, 64, 64));
+
+	BoundedTestNodePtr first = std::make_shared<BoundedTestNode>(small);
+	BoundedTestNodePtr second = std::make_shared<BoundedTestNode>(huge);
+
+	octree.link(first);
+	BOOST_CHECK(octree.getRoot()->getBounds().contains(small));
+
+	octree.link(second);
+	BOOST_CHECK(octree.getRoot()->getBounds().contains(huge));
+	BOOST_CHECK(octree.getRoot()->getBounds().contains(small));
+	BOOST_CHECK(!octree.getRoot()->getParent());
+
+	BOOST_CHECK_EQUAL(countMembers(*octree.getRoot()), 2);
+	checkContainment(*octree.getRoot(), true);
+
+	BOOST_CHECK(octree.unlink(first));
+	BOOST_CHECK(octree.unlink(second));
+	BOOST_CHECK_EQUAL(countMembers(*octree.getRoot()), 0);
+}
@@ -63,7 +63,7 @@ TexturePtr CShader::getEditorImage()
 
 bool CShader::isEditorImageNoTex()
 {
-	return (getEditorImage() == GetTextureManager().getShaderNotFound());
+	return GetTextureManager().isShaderNotFound(getEditorImage());
 }
 
 // Return the falloff texture name
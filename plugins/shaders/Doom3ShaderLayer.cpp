@@ -81,6 +81,7 @@ const IShaderExpressionPtr Doom3ShaderLayer::NULL_EXPRESSION;
 Doom3ShaderLayer::Doom3ShaderLayer(ShaderTemplate& material, ShaderLayer::Type type, const NamedBindablePtr& btex)
 :	_material(material),
 	_registers(NUM_RESERVED_REGISTERS),
+	_programIsValid(true),
 	_condition(REG_ONE),
 	_bindableTex(btex),
 	_type(type),
@@ -153,9 +154,7 @@ Colour4 Doom3ShaderLayer::getColour() const
 void Doom3ShaderLayer::setColourExpression(ColourComponentSelector comp, const IShaderExpressionPtr& expr)
 {
 	// Store the expression and link it to our registers
-	_expressions.push_back(expr);
-
-	std::size_t index = expr->linkToRegister(_registers);
+	std::size_t index = linkExpression(expr);
 
 	// Now assign the index to our colour components
 	switch (comp)
@@ -186,6 +185,49 @@ void Doom3ShaderLayer::setColourExpression(ColourComponentSelector comp, const I
 	};
 }
 
+std::size_t Doom3ShaderLayer::linkExpression(const IShaderExpressionPtr& expr)
+{
+	_expressions.push_back(expr);
+
+	std::size_t index = expr->linkToRegister(_registers);
+	_expressionRegisters.push_back(index);
+
+	return index;
+}
+
+void Doom3ShaderLayer::evaluateExpressions(std::size_t time, const IRenderEntity* entity)
+{
+	// Compile the expressions added since the last evaluation
+	while (_programIsValid && _program.getNumExpressions() < _expressions.size())
+	{
+		std::size_t i = _program.getNumExpressions();
+
+		if (!_program.addExpression(_expressions[i], _expressionRegisters[i]))
+		{
+			_program.clear();
+			_programIsValid = false;
+		}
+	}
+
+	if (_programIsValid)
+	{
+		_program.execute(time, entity, _registers);
+		return;
+	}
+
+	for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
+	{
+		if (entity != NULL)
+		{
+			(*i)->evaluate(time, *entity);
+		}
+		else
+		{
+			(*i)->evaluate(time);
+		}
+	}
+}
+
 void Doom3ShaderLayer::setColour(const Vector4& col)
 {
 	// Assign all 3 components of the colour, allocating new registers on the fly where needed
@@ -5,6 +5,7 @@
 
 #include "math/Vector4.h"
 #include "NamedBindable.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -43,6 +44,13 @@ private:
     typedef std::vector<IShaderExpressionPtr> Expressions;
     Expressions _expressions;
 
+    // The register index each expression is writing to
+    std::vector<std::size_t> _expressionRegisters;
+
+    // The compiled expressions, rebuilt when new expressions have been added
+    ExpressionProgram _program;
+    bool _programIsValid;
+
     static const IShaderExpressionPtr NULL_EXPRESSION;
 
     // The condition register for this stage. Points to a register to be interpreted as bool.
@@ -133,27 +141,18 @@ public:
 
     void setCondition(const IShaderExpressionPtr& conditionExpr)
     {
-        // Store the expression in our list
-        _expressions.push_back(conditionExpr);
-
-        // Link the result to our local registers
-        _condition = conditionExpr->linkToRegister(_registers);
+        // Store the expression in our list and link the result to our local registers
+        _condition = linkExpression(conditionExpr);
     }
 
     void evaluateExpressions(std::size_t time) 
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time);
-        }
+        evaluateExpressions(time, NULL);
     }
 
     void evaluateExpressions(std::size_t time, const IRenderEntity& entity)
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time, entity);
-        }
+        evaluateExpressions(time, &entity);
     }
 
     /**
@@ -296,11 +295,8 @@ public:
      */
     void setScale(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _scale[0] = xExpr->linkToRegister(_registers);
-        _scale[1] = yExpr->linkToRegister(_registers);
+        _scale[0] = linkExpression(xExpr);
+        _scale[1] = linkExpression(yExpr);
     }
 
     Vector2 getTranslation() 
@@ -313,11 +309,8 @@ public:
      */
     void setTranslation(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _translation[0] = xExpr->linkToRegister(_registers);
-        _translation[1] = yExpr->linkToRegister(_registers);
+        _translation[0] = linkExpression(xExpr);
+        _translation[1] = linkExpression(yExpr);
     }
 
     float getRotation() 
@@ -330,9 +323,7 @@ public:
      */
     void setRotation(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-
-        _rotation = expr->linkToRegister(_registers);
+        _rotation = linkExpression(expr);
     }
 
     Vector2 getShear() 
@@ -345,11 +336,8 @@ public:
      */
     void setShear(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _shear[0] = xExpr->linkToRegister(_registers);
-        _shear[1] = yExpr->linkToRegister(_registers);
+        _shear[0] = linkExpression(xExpr);
+        _shear[1] = linkExpression(yExpr);
     }
 
     /**
@@ -367,8 +355,7 @@ public:
      */
     void setAlphaTest(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-        _alphaTest = expr->linkToRegister(_registers);
+        _alphaTest = linkExpression(expr);
     }
 
     // Returns the value of the given register
@@ -382,6 +369,9 @@ public:
     {
         assert(index < _registers.size());
         _registers[index] = value;
+
+        // The register might be overwritten by an expression
+        _program.invalidate();
     }
 
     // Allocates a new register, initialised with the given value
@@ -422,25 +412,21 @@ public:
     {
         assert(parm0);
 
-        _expressions.push_back(parm0);
-        std::size_t parm0Reg = parm0->linkToRegister(_registers);
+        std::size_t parm0Reg = linkExpression(parm0);
 
         _vertexParms.push_back(parm0Reg);
 
         if (parm1)
         {
-            _expressions.push_back(parm1);
-            _vertexParms.push_back(parm1->linkToRegister(_registers));
+            _vertexParms.push_back(linkExpression(parm1));
 
             if (parm2)
             {
-                _expressions.push_back(parm2);
-                _vertexParms.push_back(parm2->linkToRegister(_registers));
+                _vertexParms.push_back(linkExpression(parm2));
 
                 if (parm3)
                 {
-                    _expressions.push_back(parm3);
-                    _vertexParms.push_back(parm3->linkToRegister(_registers));
+                    _vertexParms.push_back(linkExpression(parm3));
                 }
                 else
                 {
@@ -504,6 +490,13 @@ public:
     {
         _privatePolygonOffset = value;
     }
+
+private:
+    // Stores the expression and links it to a new register, returns the register index
+    std::size_t linkExpression(const IShaderExpressionPtr& expr);
+
+    // Runs the compiled expressions, or the expression trees if they can't be compiled
+    void evaluateExpressions(std::size_t time, const IRenderEntity* entity);
 };
 
 /**
@@ -36,6 +36,9 @@ in game descriptor";
 	const std::string IMAGE_FLAT = "_flat.bmp";
 	const std::string IMAGE_BLACK = "_black.bmp";
 
+	// Time per frame spent on uploading textures decoded in the background
+	const std::size_t TEXTURE_UPLOAD_MSEC_PER_FRAME = 5;
+
 }
 
 namespace shaders
@@ -301,6 +304,16 @@ TexturePtr Doom3ShaderSystem::loadTextureFromFile(const std::string& filename)
     return _textureManager->getBinding(filename);
 }
 
+void Doom3ShaderSystem::processPendingTextureUploads()
+{
+	_textureManager->processPendingUploads(TEXTURE_UPLOAD_MSEC_PER_FRAME);
+}
+
+void Doom3ShaderSystem::beginFrame()
+{
+	ExpressionProgram::beginFrame();
+}
+
 IShaderExpressionPtr Doom3ShaderSystem::createShaderExpressionFromString(const std::string& exprStr)
 {
 	return ShaderExpression::createFromString(exprStr);
@@ -529,6 +542,9 @@ void Doom3ShaderSystem::shutdownModule()
 {
 	rMessage() << "Doom3ShaderSystem::shutdownModule called" << std::endl;
 
+	// Stop the texture decoder threads
+	_textureManager->cancelPendingTextures();
+
 	destroy();
 	unrealise();
 }
@@ -106,6 +106,10 @@ public:
 	 */
     TexturePtr loadTextureFromFile(const std::string& filename) override;
 
+    void processPendingTextureUploads() override;
+
+    void beginFrame() override;
+
 	GLTextureManager& getTextureManager();
 
     // Get default textures for D,B,S layers
@@ -0,0 +1,257 @@
+#include "ExpressionProgram.h"
+
+#include "irender.h"
+#include "ShaderExpression.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace shaders
+{
+
+namespace
+{
+
+const unsigned int NO_SLOT = static_cast<unsigned int>(-1);
+
+// Used by the constant folding, the results must match the evaluation loop
+inline float applyOperator(ExpressionProgram::OpCode op, float a, float b)
+{
+	switch (op)
+	{
+	case ExpressionProgram::OP_ADD:					return a + b;
+	case ExpressionProgram::OP_SUBTRACT:			return a - b;
+	case ExpressionProgram::OP_MULTIPLY:			return a * b;
+	case ExpressionProgram::OP_DIVIDE:				return a / b;
+	case ExpressionProgram::OP_MODULO:				return std::fmod(a, b);
+	case ExpressionProgram::OP_LESSER:				return a < b ? 1.0f : 0;
+	case ExpressionProgram::OP_LESSER_OR_EQUAL:		return a <= b ? 1.0f : 0;
+	case ExpressionProgram::OP_GREATER:				return a > b ? 1.0f : 0;
+	case ExpressionProgram::OP_GREATER_OR_EQUAL:	return a >= b ? 1.0f : 0;
+	case ExpressionProgram::OP_EQUAL:				return a == b ? 1.0f : 0;
+	case ExpressionProgram::OP_NOT_EQUAL:			return a != b ? 1.0f : 0;
+	case ExpressionProgram::OP_AND:					return (a != 0 && b != 0) ? 1.0f : 0;
+	case ExpressionProgram::OP_OR:					return (a != 0 || b != 0) ? 1.0f : 0;
+	default:
+		return 0;
+	};
+}
+
+}
+
+std::size_t ExpressionProgram::_currentFrame = 0;
+
+ExpressionProgram::ExpressionProgram()
+{
+	clear();
+}
+
+void ExpressionProgram::clear()
+{
+	_code.clear();
+	_tables.clear();
+	_slots.clear();
+	_timeSlot = NO_SLOT;
+	_shaderParmSlots.clear();
+	_operands.clear();
+	_numExpressions = 0;
+	_usesTime = false;
+	_evaluated = false;
+	_lastTime = 0;
+	_lastEntity = NULL;
+	_lastFrame = 0;
+}
+
+bool ExpressionProgram::addExpression(const IShaderExpressionPtr& expr, std::size_t registerIndex)
+{
+	if (!emitExpression(expr))
+	{
+		return false;
+	}
+
+	assert(_operands.size() == 1);
+
+	Instruction store = { OP_STORE, static_cast<unsigned int>(registerIndex), getSlot(popOperand()), 0 };
+	_code.push_back(store);
+
+	++_numExpressions;
+
+	// New code needs to run at least once
+	_evaluated = false;
+
+	return true;
+}
+
+void ExpressionProgram::execute(std::size_t time, const IRenderEntity* entity, Registers& registers)
+{
+	if (_evaluated &&
+		(!_usesTime || time == _lastTime) &&
+		(_shaderParmSlots.empty() || (entity == _lastEntity && _lastFrame == _currentFrame)))
+	{
+		return; // registers are up to date
+	}
+
+	float* slots = _slots.empty() ? NULL : &_slots.front();
+
+	// Fill in the inputs
+	if (_usesTime)
+	{
+		slots[_timeSlot] = time / 1000.0f; // convert msecs to secs
+	}
+
+	for (const ShaderParmSlot& parm : _shaderParmSlots)
+	{
+		// parmNN is 0 without entity
+		slots[parm.slot] = entity != NULL ? entity->getShaderParm(parm.parmNum) : 0.0f;
+	}
+
+	for (const Instruction& i : _code)
+	{
+		switch (i.op)
+		{
+		case OP_TABLE:
+			slots[i.dest] = _tables[i.a]->getValue(slots[i.b]);
+			break;
+		case OP_STORE:
+			registers[i.dest] = slots[i.a];
+			break;
+		case OP_ADD:
+			slots[i.dest] = slots[i.a] + slots[i.b];
+			break;
+		case OP_SUBTRACT:
+			slots[i.dest] = slots[i.a] - slots[i.b];
+			break;
+		case OP_MULTIPLY:
+			slots[i.dest] = slots[i.a] * slots[i.b];
+			break;
+		case OP_DIVIDE:
+			slots[i.dest] = slots[i.a] / slots[i.b];
+			break;
+		case OP_MODULO:
+			slots[i.dest] = std::fmod(slots[i.a], slots[i.b]);
+			break;
+		default:
+			slots[i.dest] = applyOperator(i.op, slots[i.a], slots[i.b]);
+			break;
+		};
+	}
+
+	_evaluated = true;
+	_lastTime = time;
+	_lastEntity = entity;
+	_lastFrame = _currentFrame;
+}
+
+void ExpressionProgram::beginFrame()
+{
+	++_currentFrame;
+}
+
+bool ExpressionProgram::emitExpression(const IShaderExpressionPtr& expr)
+{
+	const ShaderExpression* shaderExpr = dynamic_cast<const ShaderExpression*>(expr.get());
+
+	return shaderExpr != NULL && shaderExpr->compile(*this);
+}
+
+void ExpressionProgram::emitConstant(float value)
+{
+	Operand operand = { true, value, NO_SLOT };
+	_operands.push_back(operand);
+}
+
+void ExpressionProgram::emitTime()
+{
+	if (_timeSlot == NO_SLOT)
+	{
+		_timeSlot = allocateSlot(0);
+		_usesTime = true;
+	}
+
+	pushSlot(_timeSlot);
+}
+
+void ExpressionProgram::emitShaderParm(int parmNum)
+{
+	// Each shaderparm is looked up once per execution
+	for (const ShaderParmSlot& parm : _shaderParmSlots)
+	{
+		if (parm.parmNum == parmNum)
+		{
+			pushSlot(parm.slot);
+			return;
+		}
+	}
+
+	ShaderParmSlot parm = { parmNum, allocateSlot(0) };
+	_shaderParmSlots.push_back(parm);
+
+	pushSlot(parm.slot);
+}
+
+void ExpressionProgram::emitTableLookup(const TableDefinitionPtr& table)
+{
+	Operand index = popOperand();
+
+	if (index.isConstant)
+	{
+		// Look up constant indices right away
+		emitConstant(table->getValue(index.value));
+		return;
+	}
+
+	_tables.push_back(table);
+
+	Instruction instr = { OP_TABLE, allocateSlot(0), static_cast<unsigned int>(_tables.size() - 1), index.slot };
+	_code.push_back(instr);
+
+	pushSlot(instr.dest);
+}
+
+void ExpressionProgram::emitOperator(OpCode op)
+{
+	Operand b = popOperand();
+	Operand a = popOperand();
+
+	if (a.isConstant && b.isConstant)
+	{
+		// Both operands are known, replace them with the result
+		emitConstant(applyOperator(op, a.value, b.value));
+		return;
+	}
+
+	Instruction instr = { op, 0, getSlot(a), getSlot(b) };
+	instr.dest = allocateSlot(0);
+	_code.push_back(instr);
+
+	pushSlot(instr.dest);
+}
+
+ExpressionProgram::Operand ExpressionProgram::popOperand()
+{
+	assert(!_operands.empty());
+
+	Operand operand = _operands.back();
+	_operands.pop_back();
+
+	return operand;
+}
+
+unsigned int ExpressionProgram::getSlot(const Operand& operand)
+{
+	return operand.isConstant ? allocateSlot(operand.value) : operand.slot;
+}
+
+unsigned int ExpressionProgram::allocateSlot(float value)
+{
+	_slots.push_back(value);
+	return static_cast<unsigned int>(_slots.size() - 1);
+}
+
+void ExpressionProgram::pushSlot(unsigned int slot)
+{
+	Operand operand = { false, 0, slot };
+	_operands.push_back(operand);
+}
+
+} // namespace
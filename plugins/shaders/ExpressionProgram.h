@@ -0,0 +1,154 @@
+#pragma once
+
+#include "ishaderexpression.h"
+#include "TableDefinition.h"
+
+#include <vector>
+
+namespace shaders
+{
+
+/**
+ * The compiled form of the shader expressions of a material stage.
+ *
+ * The expression trees are flattened into register instructions working on
+ * an array of value slots. Constants, the time and the shaderparms are not
+ * instructions but slots, filled once per execution, so only the operators,
+ * table lookups and the final stores into the material registers remain.
+ * Operators on constants only are folded at compile time.
+ *
+ * The results are cached: programs depending on neither time nor entity
+ * are executed once, time-dependent programs once per time value and
+ * entity-dependent programs once per time, entity and render frame.
+ */
+class ExpressionProgram
+{
+public:
+	enum OpCode
+	{
+		OP_TABLE,		// slot[dest] = table[a] lookup of slot[b]
+		OP_STORE,		// register[dest] = slot[a]
+
+		// Binary operators, slot[dest] = slot[a] <op> slot[b]
+		OP_ADD,
+		OP_SUBTRACT,
+		OP_MULTIPLY,
+		OP_DIVIDE,
+		OP_MODULO,
+		OP_LESSER,
+		OP_LESSER_OR_EQUAL,
+		OP_GREATER,
+		OP_GREATER_OR_EQUAL,
+		OP_EQUAL,
+		OP_NOT_EQUAL,
+		OP_AND,
+		OP_OR,
+	};
+
+private:
+	struct Instruction
+	{
+		OpCode op;
+		unsigned int dest;
+		unsigned int a;
+		unsigned int b;
+	};
+
+	// An intermediate value during compilation, either known or held in a slot
+	struct Operand
+	{
+		bool isConstant;
+		float value;
+		unsigned int slot;
+	};
+
+	struct ShaderParmSlot
+	{
+		int parmNum;
+		unsigned int slot;
+	};
+
+	std::vector<Instruction> _code;
+	std::vector<TableDefinitionPtr> _tables;
+
+	// Constants, inputs and intermediate results
+	std::vector<float> _slots;
+
+	// The inputs, filled in before running the instructions
+	unsigned int _timeSlot;
+	std::vector<ShaderParmSlot> _shaderParmSlots;
+
+	// The operands of the expression being compiled
+	std::vector<Operand> _operands;
+
+	// Number of expressions added so far
+	std::size_t _numExpressions;
+
+	bool _usesTime;
+
+	// The key of the results currently held in the registers
+	bool _evaluated;
+	std::size_t _lastTime;
+	const IRenderEntity* _lastEntity;
+	std::size_t _lastFrame;
+
+	static std::size_t _currentFrame;
+
+public:
+	ExpressionProgram();
+
+	// Removes all instructions
+	void clear();
+
+	/**
+	 * Compiles the given expression, storing its result into the given register.
+	 * Returns false if the expression cannot be compiled, the program is
+	 * left in an undefined state in that case and should be cleared.
+	 */
+	bool addExpression(const IShaderExpressionPtr& expr, std::size_t registerIndex);
+
+	std::size_t getNumExpressions() const
+	{
+		return _numExpressions;
+	}
+
+	std::size_t getNumInstructions() const
+	{
+		return _code.size();
+	}
+
+	/**
+	 * Runs the program, writing the results into the given registers.
+	 * Does nothing if the registers already hold the results for these arguments.
+	 * The entity may be NULL, in which case all shaderparms evaluate to 0.
+	 */
+	void execute(std::size_t time, const IRenderEntity* entity, Registers& registers);
+
+	// Forces the next execute() call to run the program
+	void invalidate()
+	{
+		_evaluated = false;
+	}
+
+	// Starts a new render frame, invalidating the results cached per entity
+	static void beginFrame();
+
+	// Code generation, used by the ShaderExpression classes
+
+	// Compiles the given sub-expression, returns false if that's not possible
+	bool emitExpression(const IShaderExpressionPtr& expr);
+
+	void emitConstant(float value);
+	void emitTime();
+	void emitShaderParm(int parmNum);
+	void emitTableLookup(const TableDefinitionPtr& table);
+	void emitOperator(OpCode op);
+
+private:
+	Operand popOperand();
+	unsigned int getSlot(const Operand& operand);
+	unsigned int allocateSlot(float value);
+	void pushSlot(unsigned int slot);
+};
+
+} // namespace
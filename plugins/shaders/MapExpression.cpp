@@ -2,9 +2,11 @@
 
 #include "itextstream.h"
 #include "ifilesystem.h"
+#include "iregistry.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <iostream>
+#include <map>
 
 #include "os/path.h"
 #include "string/convert.h"
@@ -13,6 +15,7 @@
 
 #include "RGBAImage.h"
 #include "textures/HeightmapCreator.h"
+#include "textures/ImageKernels.h"
 #include "textures/TextureManipulator.h"
 
 /* CONSTANTS */
@@ -171,40 +174,10 @@ ImagePtr AddNormalsExpression::getImage() const {
 
     ImagePtr result (new RGBAImage(width, height));
 
-    byte* pixOne = imgOne->getMipMapPixels(0);
-    byte* pixTwo = imgTwo->getMipMapPixels(0);
-    byte* pixOut = result->getMipMapPixels(0);
+    // Take the mean value of the two normal vectors
+    kernels::addNormals(imgOne->getMipMapPixels(0), imgTwo->getMipMapPixels(0),
+                        result->getMipMapPixels(0), width * height);
 
-    // iterate through the pixels
-    for( std::size_t y = 0; y < height; y++ )
-	{
-		for( std::size_t x = 0; x < width; x++ )
-		{
-			// create the two vectors
-			Vector3 vectorOne(
-    			static_cast<double>(pixOne[0]),
-    			static_cast<double>(pixOne[1]),
-    			static_cast<double>(pixOne[2])
-			);
-			Vector3 vectorTwo(
-    			static_cast<double>(pixTwo[0]),
-    			static_cast<double>(pixTwo[1]),
-    			static_cast<double>(pixTwo[2])
-			);
-			// Take the mean value of the two vectors
-			Vector3 vectorOut = (vectorOne + vectorTwo) * 0.5;
-
-			pixOut[0] = float_to_integer(vectorOut.x());
-			pixOut[1] = float_to_integer(vectorOut.y());
-			pixOut[2] = float_to_integer(vectorOut.z());
-			pixOut[3] = 255;
-
-			// advance the pixel pointer
-			pixOne += 4;
-			pixTwo += 4;
-			pixOut += 4;
-		}
-    }
     return result;
 }
 
@@ -240,53 +213,19 @@ ImagePtr SmoothNormalsExpression::getImage() const {
 	byte* in = normalMap->getMipMapPixels(0);
 	byte* out = result->getMipMapPixels(0);
 
-	struct KernelElement {
-		// offset to the current pixel
-		int dx, dy;
-	};
-
-	// a 3x3 kernel with the surrounding pixels including the pixel itself
-	const int kernelSize = 9;
-	KernelElement kernel[kernelSize] = {
-		{-1, -1 },
-		{ 0, -1 },
-		{ 1, -1 },
-		{ 1,  0 },
-		{ 1,  1 },
-		{ 0,  1 },
-		{-1,  1 },
-		{-1,  0 },
-		{ 0,  0 }
-	};
-	const float perKernelSize = 1.0f/kernelSize;
-
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; y++) {
-		for( std::size_t x = 0; x < width; x++) {
-			//the new normal vector for this pixel
-			Vector3 smoothVector(0,0,0);
-
-			// calculate the average direction of the surrounding vectors
-			for (KernelElement* i = kernel; i != kernel + kernelSize; ++i) {
-				// temporary vector to represent one of the surrounding pixels
-				byte* pixel = getPixel(in, width, height, x + i->dx, y + i->dy);
-				Vector3 temp(pixel[0], pixel[1], pixel[2]);
-
-				smoothVector += temp;
-			}
+	std::size_t rowSize = width * 4;
 
-			// Take the average normal vector as result
-			smoothVector *= perKernelSize;
-
-			out[0] = float_to_integer(smoothVector.x());
-			out[1] = float_to_integer(smoothVector.y());
-			out[2] = float_to_integer(smoothVector.z());
-			out[3] = 255;
-
-			// advance the pixel pointer
-			out += 4;
-	    }
+	// Average the 3x3 neighbourhood of each pixel, wrapping around at the borders
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		kernels::smoothNormalsRow(
+			in + ((y + height - 1) % height) * rowSize,
+			in + y * rowSize,
+			in + ((y + 1) % height) * rowSize,
+			out + y * rowSize, width
+		);
 	}
+
     return result;
 }
 
@@ -327,27 +266,10 @@ ImagePtr AddExpression::getImage() const {
 
     ImagePtr result (new RGBAImage(width, height));
 
-    byte* pixOne = imgOne->getMipMapPixels(0);
-    byte* pixTwo = imgTwo->getMipMapPixels(0);
-    byte* pixOut = result->getMipMapPixels(0);
+    // add the colors
+    kernels::add(imgOne->getMipMapPixels(0), imgTwo->getMipMapPixels(0),
+                 result->getMipMapPixels(0), width * height);
 
-    // iterate through the pixels
-    for( std::size_t y = 0; y < height; y++)
-	{
-		for( std::size_t x = 0; x < width; x++)
-		{
-			// add the colors
-			pixOut[0] = float_to_integer((static_cast<float>(pixOne[0]) + pixTwo[0]) * 0.5f);
-			pixOut[1] = float_to_integer((static_cast<float>(pixOne[1]) + pixTwo[1]) * 0.5f);
-			pixOut[2] = float_to_integer((static_cast<float>(pixOne[2]) + pixTwo[2]) * 0.5f);
-			pixOut[3] = float_to_integer((static_cast<float>(pixOne[3]) + pixTwo[3]) * 0.5f);
-
-			//advance the pixel pointer
-			pixOne += 4;
-			pixTwo += 4;
-			pixOut += 4;
-		}
-    }
 	return result;
 }
 
@@ -455,24 +377,7 @@ ImagePtr InvertAlphaExpression::getImage() const {
 
 	ImagePtr result (new RGBAImage(width, height));
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
-
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; ++y)
-	{
-		for( std::size_t x = 0; x < width; ++x)
-		{
-			out[0] = in[0];
-			out[1] = in[1];
-			out[2] = in[2];
-			out[3] = 255 - in[3];
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
-	}
+	kernels::invertAlpha(img->getMipMapPixels(0), result->getMipMapPixels(0), width * height);
 
 	return result;
 }
@@ -505,22 +410,7 @@ ImagePtr InvertColorExpression::getImage() const {
 
 	ImagePtr result (new RGBAImage(width, height));
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
-
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; y++) {
-		for( std::size_t x = 0; x < width; x++) {
-			out[0] = 255 - in[0];
-			out[1] = 255 - in[1];
-			out[2] = 255 - in[2];
-			out[3] = in[3];
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
-	}
+	kernels::invertColor(img->getMipMapPixels(0), result->getMipMapPixels(0), width * height);
 
 	return result;
 }
@@ -553,24 +443,7 @@ ImagePtr MakeIntensityExpression::getImage() const {
 
 	ImagePtr result (new RGBAImage(width, height));
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
-
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; ++y)
-	{
-		for( std::size_t x = 0; x < width; ++x)
-		{
-			out[0] = in[0];
-			out[1] = in[0];
-			out[2] = in[0];
-			out[3] = in[0];
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
-	}
+	kernels::makeIntensity(img->getMipMapPixels(0), result->getMipMapPixels(0), width * height);
 
 	return result;
 }
@@ -639,86 +512,43 @@ ImageExpression::ImageExpression(const std::string& imgName)
 	// the file extension of the provided token, and store
 	// the result in the provided string.
 	_imgName = os::standardPath(imgName).substr(0, imgName.rfind("."));
+
+	// Check for some image keywords, these are loaded from the bitmaps folder
+	static const std::map<std::string, std::string> builtinImages =
+	{
+		{ "_black", IMAGE_BLACK },
+		{ "_cubiclight", IMAGE_CUBICLIGHT },
+		{ "_currentRender", IMAGE_CURRENTRENDER },
+		{ "_default", IMAGE_DEFAULT },
+		{ "_flat", IMAGE_FLAT },
+		{ "_fog", IMAGE_FOG },
+		{ "_nofalloff", IMAGE_NOFALLOFF },
+		{ "_pointlight1", IMAGE_POINTLIGHT1 },
+		{ "_pointlight2", IMAGE_POINTLIGHT2 },
+		{ "_pointlight3", IMAGE_POINTLIGHT3 },
+		{ "_quadratic", IMAGE_QUADRATIC },
+		{ "_scratch", IMAGE_SCRATCH },
+		{ "_spotlight", IMAGE_SPOTLIGHT },
+		{ "_white", IMAGE_WHITE },
+	};
+
+	std::map<std::string, std::string>::const_iterator builtin = builtinImages.find(_imgName);
+
+	if (builtin != builtinImages.end())
+	{
+		_builtinImagePath = GlobalRegistry().get("user/paths/bitmapsPath") + builtin->second;
+	}
 }
 
 ImagePtr ImageExpression::getImage() const
 {
-	// Check for some image keywords and load the correct file
-	if (_imgName == "_black") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_BLACK
-        );
-	}
-	else if (_imgName == "_cubiclight") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_CUBICLIGHT
-        );
-	}
-	else if (_imgName == "_currentRender") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_CURRENTRENDER
-        );
-	}
-	else if (_imgName == "_default") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_DEFAULT
-        );
-	}
-	else if (_imgName == "_flat") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_FLAT
-        );
-	}
-	else if (_imgName == "_fog") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_FOG
-        );
-	}
-	else if (_imgName == "_nofalloff") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_NOFALLOFF
-        );
-	}
-	else if (_imgName == "_pointlight1") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_POINTLIGHT1
-        );
-	}
-	else if (_imgName == "_pointlight2") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_POINTLIGHT2
-        );
-	}
-	else if (_imgName == "_pointlight3") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_POINTLIGHT3
-        );
-	}
-	else if (_imgName == "_quadratic") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_QUADRATIC
-        );
-	}
-	else if (_imgName == "_scratch") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_SCRATCH
-        );
-	}
-	else if (_imgName == "_spotlight") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_SPOTLIGHT
-        );
-	}
-	else if (_imgName == "_white") {
-		return GlobalImageLoader().imageFromFile(
-            GlobalRegistry().get("user/paths/bitmapsPath") + IMAGE_WHITE
-        );
-	}
-	else
-    {
-        // this is a normal material image, so we load the image from VFS
-		return GlobalImageLoader().imageFromVFS(_imgName);
+	if (!_builtinImagePath.empty())
+	{
+		return GlobalImageLoader().imageFromFile(_builtinImagePath);
 	}
+
+	// this is a normal material image, so we load the image from VFS
+	return GlobalImageLoader().imageFromVFS(_imgName);
 }
 
 std::string ImageExpression::getIdentifier() const
@@ -173,6 +173,10 @@ class ImageExpression
 {
 	std::string _imgName;
 
+	// The bitmap file of the built-in images like "_white", empty for VFS images.
+	// Resolved by the constructor, getImage() runs on the texture decoder threads.
+	std::string _builtinImagePath;
+
 public:
 
     /* MapExpression interface */
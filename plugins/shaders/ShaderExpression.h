@@ -4,6 +4,7 @@
 #include "irender.h"
 #include "parser/DefTokeniser.h"
 #include "TableDefinition.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -64,6 +65,12 @@ public:
 		return _index;
 	}
 
+	/**
+	 * Appends the instructions calculating the value of this expression
+	 * to the given program. Returns false if this is not possible.
+	 */
+	virtual bool compile(ExpressionProgram& program) const = 0;
+
 	static IShaderExpressionPtr createFromString(const std::string& exprStr);
 
 	static IShaderExpressionPtr createFromTokens(parser::DefTokeniser& tokeniser);
@@ -97,6 +104,12 @@ public:
 	{
 		return entity.getShaderParm(_parmNum);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		program.emitShaderParm(_parmNum);
+		return true;
+	}
 };
 
 class GlobalShaderParmExpression :
@@ -121,6 +134,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		program.emitConstant(0.0f);
+		return true;
+	}
 };
 
 // An expression returning the current (game) time as result
@@ -141,6 +160,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		program.emitTime();
+		return true;
+	}
 };
 
 // An expression representing a constant floating point number
@@ -165,6 +190,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		program.emitConstant(_value);
+		return true;
+	}
 };
 
 // An expression looking up a value in a table def
@@ -198,6 +229,17 @@ public:
 		float lookupVal = _lookupExpr->getValue(time, entity);
 		return _tableDef->getValue(lookupVal);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		if (!program.emitExpression(_lookupExpr))
+		{
+			return false;
+		}
+
+		program.emitTableLookup(_tableDef);
+		return true;
+	}
 };
 
 // Abstract base class for an expression taking two sub-expression as arguments
@@ -249,6 +291,19 @@ public:
 	{
 		_b = b;
 	}
+
+protected:
+	// Compiles both operands followed by the given operator
+	bool compileOperator(ExpressionProgram& program, ExpressionProgram::OpCode op) const
+	{
+		if (!program.emitExpression(_a) || !program.emitExpression(_b))
+		{
+			return false;
+		}
+
+		program.emitOperator(op);
+		return true;
+	}
 };
 typedef std::shared_ptr<BinaryExpression> BinaryExpressionPtr;
 
@@ -271,6 +326,11 @@ public:
 	{
 		return _a->getValue(time, entity) + _b->getValue(time, entity);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_ADD);
+	}
 };
 
 // An expression subtracting the value of two expressions
@@ -292,6 +352,11 @@ public:
 	{
 		return _a->getValue(time, entity) - _b->getValue(time, entity);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_SUBTRACT);
+	}
 };
 
 // An expression multiplying the value of two expressions
@@ -313,6 +378,11 @@ public:
 	{
 		return _a->getValue(time, entity) * _b->getValue(time, entity);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_MULTIPLY);
+	}
 };
 
 // An expression dividing the value of two expressions
@@ -334,6 +404,11 @@ public:
 	{
 		return _a->getValue(time, entity) / _b->getValue(time, entity);
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_DIVIDE);
+	}
 };
 
 // An expression returning modulo of A % B
@@ -355,6 +430,11 @@ public:
 	{
 		return fmod(_a->getValue(time, entity), _b->getValue(time, entity));
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_MODULO);
+	}
 };
 
 // An expression returning 1 if A < B, otherwise 0
@@ -376,6 +456,11 @@ public:
 	{
 		return _a->getValue(time, entity) < _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_LESSER);
+	}
 };
 
 // An expression returning 1 if A <= B, otherwise 0
@@ -397,6 +482,11 @@ public:
 	{
 		return _a->getValue(time, entity) <= _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_LESSER_OR_EQUAL);
+	}
 };
 
 // An expression returning 1 if A > B, otherwise 0
@@ -418,6 +508,11 @@ public:
 	{
 		return _a->getValue(time, entity) > _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_GREATER);
+	}
 };
 
 // An expression returning 1 if A >= B, otherwise 0
@@ -439,6 +534,11 @@ public:
 	{
 		return _a->getValue(time, entity) >= _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_GREATER_OR_EQUAL);
+	}
 };
 
 // An expression returning 1 if A == B, otherwise 0
@@ -460,6 +560,11 @@ public:
 	{
 		return _a->getValue(time, entity) == _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_EQUAL);
+	}
 };
 
 // An expression returning 1 if A != B, otherwise 0
@@ -481,6 +586,11 @@ public:
 	{
 		return _a->getValue(time, entity) != _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_NOT_EQUAL);
+	}
 };
 
 // An expression returning 1 if both A and B are true (non-zero), otherwise 0
@@ -502,6 +612,11 @@ public:
 	{
 		return (_a->getValue(time, entity) != 0 && _b->getValue(time, entity) != 0) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_AND);
+	}
 };
 
 // An expression returning 1 if either A or B are true (non-zero), otherwise 0
@@ -523,6 +638,11 @@ public:
 	{
 		return (_a->getValue(time, entity) != 0 || _b->getValue(time, entity) != 0) ? 1.0f : 0;
 	}
+
+	virtual bool compile(ExpressionProgram& program) const
+	{
+		return compileOperator(program, ExpressionProgram::OP_OR);
+	}
 };
 
 } // namespace
@@ -4,12 +4,15 @@
 #include "iarchive.h"
 #include "i18n.h"
 #include "parser/DefTokeniser.h"
-#include "parser/DefBlockTokeniser.h"
+#include "parser/BufferedDefBlockTokeniser.h"
 #include "ShaderDefinition.h"
 #include "Doom3ShaderSystem.h"
 #include "TableDefinition.h"
+#include "util/ThreadPool.h"
 
 #include <iostream>
+#include <future>
+#include <iterator>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 
@@ -22,11 +25,15 @@ namespace shaders
  * DefTokeniser.
  */
 void ShaderFileLoader::parseShaderFile(std::istream& inStr,
-									   const std::string& filename)
+									   const std::string& filename,
+									   ParsedBlocks& blocks) const
 {
+	// Read the file at once, the tokeniser can then copy whole blocks out of it
+	std::string contents((std::istreambuf_iterator<char>(inStr)), std::istreambuf_iterator<char>());
+
 	// Parse the file with a blocktokeniser, the actual block contents
 	// will be parsed separately.
-	parser::BasicDefBlockTokeniser<std::istream> tokeniser(inStr);
+	parser::BufferedDefBlockTokeniser tokeniser(contents);
 
 	while (tokeniser.hasMoreBlocks())
 	{
@@ -44,13 +51,10 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 				continue;
 			}
 
-			TableDefinitionPtr table(new TableDefinition(tableName, block.contents));
-
-			if (!_library.addTableDefinition(table))
-			{
-				rError() << "[shaders] " << filename
-					<< ": table " << tableName << " already defined." << std::endl;
-			}
+			ParsedBlock parsed;
+			parsed.name = tableName;
+			parsed.table.reset(new TableDefinition(tableName, block.contents));
+			blocks.push_back(parsed);
 
 			continue;
 		}
@@ -65,16 +69,52 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 
 		boost::algorithm::replace_all(block.name, "\\", "/"); // use forward slashes
 
-		ShaderTemplatePtr shaderTemplate(new ShaderTemplate(block.name, block.contents));
+		ParsedBlock parsed;
+		parsed.name = block.name;
+		parsed.shaderTemplate.reset(new ShaderTemplate(block.name, block.contents));
+		blocks.push_back(parsed);
+	}
+}
+
+void ShaderFileLoader::parseFile(const std::string& fullPath, ParsedBlocks& blocks) const
+{
+	// Open the file
+	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullPath);
+
+	if (file != NULL)
+	{
+		std::istream is(&(file->getInputStream()));
+		parseShaderFile(is, fullPath, blocks);
+	}
+	else
+	{
+		throw std::runtime_error("Unable to read shaderfile: " + fullPath);
+	}
+}
+
+void ShaderFileLoader::insertDefinitions(const std::string& fullPath, const ParsedBlocks& blocks)
+{
+	for (ParsedBlocks::const_iterator i = blocks.begin(); i != blocks.end(); ++i)
+	{
+		if (i->table)
+		{
+			if (!_library.addTableDefinition(i->table))
+			{
+				rError() << "[shaders] " << fullPath
+					<< ": table " << i->name << " already defined." << std::endl;
+			}
+
+			continue;
+		}
 
 		// Construct the ShaderDefinition wrapper class
-		ShaderDefinition def(shaderTemplate, filename);
+		ShaderDefinition def(i->shaderTemplate, fullPath);
 
 		// Insert into the definitions map, if not already present
-		if (!_library.addDefinition(block.name, def))
+		if (!_library.addDefinition(i->name, def))
 		{
-    		rError() << "[shaders] " << filename
-				<< ": shader " << block.name << " already defined." << std::endl;
+    		rError() << "[shaders] " << fullPath
+				<< ": shader " << i->name << " already defined." << std::endl;
 		}
 	}
 }
@@ -87,6 +127,22 @@ void ShaderFileLoader::addFile(const std::string& filename)
 
 void ShaderFileLoader::parseFiles()
 {
+	std::vector<ParsedBlocks> parsedFiles(_files.size());
+	std::vector<std::future<void>> results;
+	results.reserve(_files.size());
+
+	// Declared last, the destructor waits for any remaining tasks referencing the vectors above
+	util::ThreadPool pool;
+
+	for (std::size_t i = 0; i < _files.size(); ++i)
+	{
+		results.push_back(pool.enqueue([this, i, &parsedFiles]()
+		{
+			parseFile(_files[i], parsedFiles[i]);
+		}));
+	}
+
+	// Merge the files in their original order, this thread is reporting the progress
 	for (std::size_t i = 0; i < _files.size(); ++i)
 	{
 		const std::string& fullPath = _files[i];
@@ -99,18 +155,13 @@ void ShaderFileLoader::parseFiles()
 			_currentOperation->setProgress(progress);
 		}
 
-		// Open the file
-		ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullPath);
+		// Re-throws the exception of a file which couldn't be read
+		results[i].get();
 
-		if (file != NULL)
-		{
-			std::istream is(&(file->getInputStream()));
-			parseShaderFile(is, fullPath);
-		}
-		else
-		{
-			throw std::runtime_error("Unable to read shaderfile: " + fullPath);
-		}
+		insertDefinitions(fullPath, parsedFiles[i]);
+
+		// The templates are owned by the library now
+		ParsedBlocks().swap(parsedFiles[i]);
 	}
 }
 
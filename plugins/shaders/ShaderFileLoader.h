@@ -3,10 +3,12 @@
 #include "ifilesystem.h"
 #include "iradiant.h"
 #include "ShaderTemplate.h"
+#include "TableDefinition.h"
 
 #include "parser/DefTokeniser.h"
 
 #include <string>
+#include <vector>
 
 namespace shaders
 {
@@ -15,6 +17,10 @@ class ShaderLibrary;
 
 /**
  * VFS functor class which loads material (mtr) files.
+ *
+ * The files are parsed in parallel, the resulting definitions are added
+ * to the library file by file in the order the files have been added.
+ * The first definition of a name wins, like in a sequential load.
  */
 class ShaderFileLoader
 {
@@ -28,10 +34,29 @@ private:
 
 	std::vector<std::string> _files;
 
+	// A table or material block of a parsed file
+	struct ParsedBlock
+	{
+		std::string name;
+
+		// Either the table or the shader template is set
+		TableDefinitionPtr table;
+		ShaderTemplatePtr shaderTemplate;
+	};
+
+	// The blocks of a single file, in file order
+	typedef std::vector<ParsedBlock> ParsedBlocks;
+
 private:
 
 	// Parse a shader file with the given contents and filename
-	void parseShaderFile(std::istream& inStr, const std::string& filename);
+	void parseShaderFile(std::istream& inStr, const std::string& filename, ParsedBlocks& blocks) const;
+
+	// Open and parse the given file, called on a worker thread
+	void parseFile(const std::string& fullPath, ParsedBlocks& blocks) const;
+
+	// Add the parsed definitions of a file to the library
+	void insertDefinitions(const std::string& fullPath, const ParsedBlocks& blocks);
 
 public:
 	// Constructor. Set the basepath to prepend onto shader filenames.
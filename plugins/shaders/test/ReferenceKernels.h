@@ -0,0 +1,161 @@
+#pragma once
+
+#include "../textures/ImageKernels.h"
+#include "math/FloatTools.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * Random test images and the per-pixel code replaced by the image kernels,
+ * shared by the kernel tests and benchmarks.
+ */
+namespace reference
+{
+
+typedef std::vector<byte> Pixels;
+
+inline Pixels randomPixels(std::size_t numBytes, std::mt19937& rng)
+{
+	std::uniform_int_distribution<int> dist(0, 255);
+
+	Pixels pixels(numBytes);
+
+	for (byte& b : pixels)
+	{
+		b = static_cast<byte>(dist(rng));
+	}
+
+	return pixels;
+}
+
+// The original per-pixel code of the map expressions
+
+inline const byte* getPixel(const byte* pixels, std::size_t width, std::size_t height, long x, long y)
+{
+	return pixels + (((((y + height) % height) * width) + ((x + width) % width)) * 4);
+}
+
+inline void referenceAddNormals(const byte* pixOne, const byte* pixTwo, byte* pixOut, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels; ++i, pixOne += 4, pixTwo += 4, pixOut += 4)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			double mean = (static_cast<double>(pixOne[c]) + static_cast<double>(pixTwo[c])) * 0.5;
+			pixOut[c] = float_to_integer(mean);
+		}
+
+		pixOut[3] = 255;
+	}
+}
+
+inline void referenceAdd(const byte* pixOne, const byte* pixTwo, byte* pixOut, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels * 4; ++i)
+	{
+		pixOut[i] = float_to_integer((static_cast<float>(pixOne[i]) + pixTwo[i]) * 0.5f);
+	}
+}
+
+inline void referenceSmoothNormals(const byte* in, byte* out, std::size_t width, std::size_t height)
+{
+	const int offsets[9][2] = {
+		{-1, -1 }, { 0, -1 }, { 1, -1 }, { 1,  0 }, { 1,  1 },
+		{ 0,  1 }, {-1,  1 }, {-1,  0 }, { 0,  0 }
+	};
+	const float perKernelSize = 1.0f/9;
+
+	for (std::size_t y = 0; y < height; y++)
+	{
+		for (std::size_t x = 0; x < width; x++, out += 4)
+		{
+			double sum[3] = { 0, 0, 0 };
+
+			for (const int* o : offsets)
+			{
+				const byte* pixel = getPixel(in, width, height, x + o[0], y + o[1]);
+
+				for (int c = 0; c < 3; ++c) sum[c] += pixel[c];
+			}
+
+			for (int c = 0; c < 3; ++c)
+			{
+				out[c] = float_to_integer(sum[c] * perKernelSize);
+			}
+
+			out[3] = 255;
+		}
+	}
+}
+
+inline void referenceHeightMap(const byte* in, byte* out, std::size_t width, std::size_t height, float scale)
+{
+	struct KernelElement
+	{
+		int x, y;
+		float w;
+	};
+
+	const int kernelSize = 6;
+	KernelElement kernel_du[kernelSize] = {
+		{-1, 1,-1.0f }, {-1, 0,-1.0f }, {-1,-1,-1.0f },
+		{ 1, 1, 1.0f }, { 1, 0, 1.0f }, { 1,-1, 1.0f }
+	};
+	KernelElement kernel_dv[kernelSize] = {
+		{-1, 1, 1.0f }, { 0, 1, 1.0f }, { 1, 1, 1.0f },
+		{-1,-1,-1.0f }, { 0,-1,-1.0f }, { 1,-1,-1.0f }
+	};
+
+	for (std::size_t y = 0; y < height; y++)
+	{
+		for (std::size_t x = 0; x < width; x++, out += 4)
+		{
+			float du = 0;
+			for (KernelElement* i = kernel_du; i != kernel_du + kernelSize; ++i) {
+				du += (getPixel(in, width, height, x + i->x, y + i->y)[0] / 255.0f) * i->w;
+			}
+			float dv = 0;
+			for (KernelElement* i = kernel_dv; i != kernel_dv + kernelSize; ++i) {
+				dv += (getPixel(in, width, height, x + i->x, y + i->y)[0] / 255.0f) * i->w;
+			}
+
+			float nx = -du * scale;
+			float ny = -dv * scale;
+			float nz = 1.0;
+
+			// The unqualified sqrt() of the original resolved to the float or the double
+			// overload depending on the standard library, the kernels use the float one
+			float norm = 1.0f/std::sqrt(nx*nx + ny*ny + nz*nz);
+			out[0] = float_to_integer(((nx * norm) + 1) * 127.5);
+			out[1] = float_to_integer(((ny * norm) + 1) * 127.5);
+			out[2] = float_to_integer(((nz * norm) + 1) * 127.5);
+			out[3] = 255;
+		}
+	}
+}
+
+// The LERPBYTE macro of TextureManipulator::resampleTexture
+inline void referenceLerpRows(const byte* row1, const byte* row2, byte* out, std::size_t numBytes, std::size_t lerp)
+{
+	for (std::size_t i = 0; i < numBytes; ++i)
+	{
+		out[i] = (byte) ((((row2[i] - row1[i]) * lerp) >> 16) + row1[i]);
+	}
+}
+
+// Runs a row kernel over all rows with wrapped neighbours
+template<typename RowKernel>
+void forEachRow(const byte* in, byte* out, std::size_t width, std::size_t height, RowKernel kernel)
+{
+	std::size_t rowSize = width * 4;
+
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		kernel(in + ((y + height - 1) % height) * rowSize, in + y * rowSize,
+			in + ((y + 1) % height) * rowSize, out + y * rowSize, width);
+	}
+}
+
+} // namespace reference
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../ShaderExpression.h"
+
+#include <vector>
+
+/**
+ * Helpers to build shader expressions and evaluate them, shared by the
+ * expression program tests and benchmarks.
+ */
+namespace test
+{
+
+using namespace shaders;
+using namespace shaders::expressions;
+
+class TestEntity :
+	public IRenderEntity
+{
+public:
+	float parms[12];
+	mutable int lookups;
+
+	TestEntity() :
+		lookups(0)
+	{
+		for (int i = 0; i < 12; ++i) parms[i] = i * 0.25f + 0.1f;
+	}
+
+	float getShaderParm(int parmNum) const
+	{
+		++lookups;
+		return parms[parmNum];
+	}
+
+	const Vector3& getDirection() const
+	{
+		static Vector3 direction(0, 0, 1);
+		return direction;
+	}
+
+	const ShaderPtr& getWireShader() const
+	{
+		static ShaderPtr shader;
+		return shader;
+	}
+};
+
+inline IShaderExpressionPtr constant(float value)
+{
+	return IShaderExpressionPtr(new ConstantExpression(value));
+}
+
+inline IShaderExpressionPtr timeExpr()
+{
+	return IShaderExpressionPtr(new TimeExpression);
+}
+
+inline IShaderExpressionPtr parm(int num)
+{
+	return IShaderExpressionPtr(new ShaderParmExpression(num));
+}
+
+inline IShaderExpressionPtr global()
+{
+	return IShaderExpressionPtr(new GlobalShaderParmExpression(3));
+}
+
+template<typename Op>
+inline IShaderExpressionPtr op(const IShaderExpressionPtr& a, const IShaderExpressionPtr& b)
+{
+	return IShaderExpressionPtr(new Op(a, b));
+}
+
+inline TableDefinitionPtr sinTable()
+{
+	return TableDefinitionPtr(new TableDefinition("sintable",
+		"{ 0, 0.309017, 0.587785, 0.809017, 0.951057, 1, 0.951057, 0.809017, "
+		"0.587785, 0.309017, 0, -0.309017, -0.587785, -0.809017, -0.951057, -1, "
+		"-0.951057, -0.809017, -0.587785, -0.309017 }"));
+}
+
+inline IShaderExpressionPtr lookup(const TableDefinitionPtr& table, const IShaderExpressionPtr& expr)
+{
+	return IShaderExpressionPtr(new TableLookupExpression(table, expr));
+}
+
+// A selection of expressions like the ones found in the stock materials
+inline std::vector<IShaderExpressionPtr> createExpressions()
+{
+	TableDefinitionPtr table = sinTable();
+
+	std::vector<IShaderExpressionPtr> exprs;
+
+	exprs.push_back(constant(0.5f));
+	exprs.push_back(global());
+	exprs.push_back(op<MultiplyExpression>(timeExpr(), constant(0.3f)));
+	exprs.push_back(op<AddExpression>(constant(0.5f), op<MultiplyExpression>(constant(0.5f),
+		lookup(table, op<MultiplyExpression>(timeExpr(), constant(0.15f))))));
+	exprs.push_back(op<MultiplyExpression>(parm(0), op<SubtractExpression>(constant(1), parm(3))));
+	exprs.push_back(op<DivideExpression>(parm(1), op<ModuloExpression>(timeExpr(), constant(7))));
+	exprs.push_back(op<LogicalOrExpression>(op<GreaterThanExpression>(parm(4), constant(0.5f)),
+		op<LesserThanOrEqualExpression>(timeExpr(), parm(2))));
+	exprs.push_back(op<LogicalAndExpression>(op<EqualityExpression>(parm(5), parm(5)),
+		op<InequalityExpression>(op<ModuloExpression>(timeExpr(), constant(2)), constant(0))));
+	exprs.push_back(op<GreaterThanOrEqualExpression>(op<LesserThanExpression>(timeExpr(), constant(3)), constant(1)));
+	exprs.push_back(lookup(table, op<AddExpression>(op<MultiplyExpression>(parm(7), timeExpr()), parm(11))));
+	exprs.push_back(op<SubtractExpression>(constant(10), lookup(table, constant(0.3f))));
+
+	return exprs;
+}
+
+} // namespace test
@@ -0,0 +1,76 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE expressionProgramBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "TestExpressions.h"
+
+#include <chrono>
+
+using namespace test;
+
+// Compares the evaluation speed of trees and programs
+BOOST_AUTO_TEST_CASE(evaluation)
+{
+	std::vector<IShaderExpressionPtr> exprs = createExpressions();
+
+	Registers registers(NUM_RESERVED_REGISTERS);
+	ExpressionProgram program;
+
+	for (const IShaderExpressionPtr& expr : exprs)
+	{
+		expr->linkToRegister(registers);
+		program.addExpression(expr, registers.size() - 1);
+	}
+
+	// A stage rendered in 100 batches per frame, for 4 entities
+	TestEntity entities[4];
+	const std::size_t frames = 2000;
+	const std::size_t batches = 100;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::size_t frame = 0; frame < frames; ++frame)
+	{
+		for (std::size_t batch = 0; batch < batches; ++batch)
+		{
+			for (const IShaderExpressionPtr& expr : exprs)
+			{
+				expr->evaluate(frame * 16, entities[batch % 4]);
+			}
+		}
+	}
+
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	for (std::size_t frame = 0; frame < frames; ++frame)
+	{
+		ExpressionProgram::beginFrame();
+
+		for (std::size_t batch = 0; batch < batches; ++batch)
+		{
+			// Without the cache, every batch has another time
+			program.invalidate();
+			program.execute(frame * 16, &entities[batch % 4], registers);
+		}
+	}
+
+	std::chrono::steady_clock::time_point cached = std::chrono::steady_clock::now();
+
+	for (std::size_t frame = 0; frame < frames; ++frame)
+	{
+		ExpressionProgram::beginFrame();
+
+		for (std::size_t batch = 0; batch < batches; ++batch)
+		{
+			program.execute(frame * 16, &entities[batch / 25], registers);
+		}
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_TEST_MESSAGE(frames * batches << " evaluations of " << exprs.size() << " expressions: trees "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count() << " ms, program "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(cached - mid).count() << " ms, "
+		<< "program with batches sorted by entity "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - cached).count() << " ms");
+}
@@ -0,0 +1,158 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE expressionProgramTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestExpressions.h"
+
+using namespace shaders;
+using namespace shaders::expressions;
+using namespace test;
+
+namespace
+{
+
+// An expression the program doesn't know how to compile
+class ForeignExpression :
+	public IShaderExpression
+{
+public:
+	float getValue(std::size_t time) { return 1; }
+	float getValue(std::size_t time, const IRenderEntity& entity) { return 1; }
+	float evaluate(std::size_t time) { return 1; }
+	float evaluate(std::size_t time, const IRenderEntity& entity) { return 1; }
+	std::size_t linkToRegister(Registers& registers) { return 0; }
+};
+
+// Bitwise equality, such that 0/0 results compare equal
+bool sameValue(float a, float b)
+{
+	return a == b || (a != a && b != b);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(compiledExpressionsMatchTrees)
+{
+	std::vector<IShaderExpressionPtr> exprs = createExpressions();
+
+	Registers registers(NUM_RESERVED_REGISTERS);
+	ExpressionProgram program;
+
+	for (const IShaderExpressionPtr& expr : exprs)
+	{
+		registers.push_back(0);
+		BOOST_REQUIRE(program.addExpression(expr, registers.size() - 1));
+	}
+
+	BOOST_CHECK_EQUAL(program.getNumExpressions(), exprs.size());
+
+	TestEntity entity;
+
+	for (std::size_t time = 0; time < 20000; time += 37)
+	{
+		entity.parms[2] = time * 0.0001f;
+
+		ExpressionProgram::beginFrame();
+
+		program.execute(time, &entity, registers);
+
+		for (std::size_t i = 0; i < exprs.size(); ++i)
+		{
+			BOOST_CHECK(sameValue(registers[NUM_RESERVED_REGISTERS + i], exprs[i]->getValue(time, entity)));
+		}
+
+		program.execute(time, NULL, registers);
+
+		for (std::size_t i = 0; i < exprs.size(); ++i)
+		{
+			BOOST_CHECK(sameValue(registers[NUM_RESERVED_REGISTERS + i], exprs[i]->getValue(time)));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(constantsAreFolded)
+{
+	TableDefinitionPtr table = sinTable();
+	Registers registers(NUM_RESERVED_REGISTERS + 1);
+
+	// 10 - sintable[0.3 * 2] * -1 => just the store of a constant
+	ExpressionProgram program;
+	IShaderExpressionPtr expr = op<SubtractExpression>(constant(10),
+		op<MultiplyExpression>(lookup(table, op<MultiplyExpression>(constant(0.3f), constant(2))), constant(-1)));
+
+	BOOST_REQUIRE(program.addExpression(expr, NUM_RESERVED_REGISTERS));
+	BOOST_CHECK_EQUAL(program.getNumInstructions(), 1);
+
+	program.execute(0, NULL, registers);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS], expr->getValue(0));
+
+	// Only the constant part of time * (2 + 3) is folded
+	ExpressionProgram timeProgram;
+	BOOST_REQUIRE(timeProgram.addExpression(op<MultiplyExpression>(timeExpr(),
+		op<AddExpression>(constant(2), constant(3))), NUM_RESERVED_REGISTERS));
+	BOOST_CHECK_EQUAL(timeProgram.getNumInstructions(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(resultsAreCachedPerFrame)
+{
+	Registers registers(NUM_RESERVED_REGISTERS + 2);
+
+	ExpressionProgram program;
+	BOOST_REQUIRE(program.addExpression(parm(0), NUM_RESERVED_REGISTERS));
+	BOOST_REQUIRE(program.addExpression(op<MultiplyExpression>(parm(1), timeExpr()), NUM_RESERVED_REGISTERS + 1));
+
+	TestEntity a;
+	TestEntity b;
+
+	ExpressionProgram::beginFrame();
+
+	program.execute(1000, &a, registers);
+	BOOST_CHECK_EQUAL(a.lookups, 2);
+
+	// Same arguments in the same frame, nothing to do
+	program.execute(1000, &a, registers);
+	BOOST_CHECK_EQUAL(a.lookups, 2);
+
+	// Other entity or time
+	program.execute(1000, &b, registers);
+	BOOST_CHECK_EQUAL(b.lookups, 2);
+	program.execute(2000, &b, registers);
+	BOOST_CHECK_EQUAL(b.lookups, 4);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS + 1], b.parms[1] * 2.0f);
+
+	// Parm changes are not seen within the frame
+	program.execute(1000, &a, registers);
+	a.parms[0] = 5;
+	program.execute(1000, &a, registers);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS], 0.1f);
+
+	// The next frame picks up the changed parm
+	ExpressionProgram::beginFrame();
+	program.execute(1000, &a, registers);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS], 5);
+
+	// Entity-independent programs ignore frames and entities
+	ExpressionProgram timeProgram;
+	BOOST_REQUIRE(timeProgram.addExpression(timeExpr(), NUM_RESERVED_REGISTERS));
+
+	timeProgram.execute(3000, &a, registers);
+	registers[NUM_RESERVED_REGISTERS] = 0;
+
+	ExpressionProgram::beginFrame();
+	timeProgram.execute(3000, &b, registers);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS], 0);
+
+	timeProgram.invalidate();
+	timeProgram.execute(3000, &b, registers);
+	BOOST_CHECK_EQUAL(registers[NUM_RESERVED_REGISTERS], 3);
+}
+
+BOOST_AUTO_TEST_CASE(unknownExpressionsAreRejected)
+{
+	ExpressionProgram program;
+
+	BOOST_CHECK(!program.addExpression(IShaderExpressionPtr(new ForeignExpression), NUM_RESERVED_REGISTERS));
+	program.clear();
+
+	BOOST_CHECK(!program.addExpression(op<AddExpression>(constant(1), IShaderExpressionPtr()), NUM_RESERVED_REGISTERS));
+}
@@ -0,0 +1,46 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE imageKernelsBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "ReferenceKernels.h"
+
+#include <chrono>
+
+using namespace shaders;
+using namespace reference;
+
+// Compares the speed of the kernels to the per-pixel code
+BOOST_AUTO_TEST_CASE(normalMapExpressions)
+{
+	const std::size_t size = 2048;
+
+	std::mt19937 rng(5);
+	Pixels heightMap = randomPixels(size * size * 4, rng);
+	Pixels bumpMap = randomPixels(size * size * 4, rng);
+	Pixels normals(heightMap.size());
+	Pixels expected(heightMap.size());
+	Pixels result(heightMap.size());
+
+	// addnormals(bumpmap, heightmap(heightmap, 4))
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	referenceHeightMap(heightMap.data(), normals.data(), size, size, 4.0f);
+	referenceAddNormals(bumpMap.data(), normals.data(), expected.data(), size * size);
+
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	forEachRow(heightMap.data(), normals.data(), size, size,
+		[](const byte* prev, const byte* row, const byte* next, byte* out, std::size_t width)
+	{
+		kernels::heightMapRow(prev, row, next, out, width, 4.0f);
+	});
+	kernels::addNormals(bumpMap.data(), normals.data(), result.data(), size * size);
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_CHECK(result == expected);
+
+	BOOST_TEST_MESSAGE("addnormals(heightmap) " << size << "x" << size << ": per-pixel "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count() << " ms, kernels "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count() << " ms");
+}
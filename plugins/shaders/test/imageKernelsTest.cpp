@@ -0,0 +1,163 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE imageKernelsTest
+#include <boost/test/unit_test.hpp>
+
+#include "ReferenceKernels.h"
+
+using namespace shaders;
+using namespace reference;
+
+namespace
+{
+
+struct Size
+{
+	std::size_t width, height;
+};
+
+const Size SIZES[] = {
+	{ 1, 1 }, { 2, 1 }, { 1, 3 }, { 3, 5 }, { 5, 7 }, { 6, 4 },
+	{ 7, 7 }, { 8, 2 }, { 9, 3 }, { 17, 9 }, { 33, 5 }, { 64, 64 }, { 256, 256 }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(pixelKernelsMatchReference)
+{
+	std::mt19937 rng(17);
+
+	for (const Size& size : SIZES)
+	{
+		std::size_t numPixels = size.width * size.height;
+
+		Pixels one = randomPixels(numPixels * 4, rng);
+		Pixels two = randomPixels(numPixels * 4, rng);
+
+		Pixels expected(numPixels * 4);
+		Pixels result(numPixels * 4);
+		Pixels scalarResult(numPixels * 4);
+
+		referenceAddNormals(one.data(), two.data(), expected.data(), numPixels);
+		kernels::addNormals(one.data(), two.data(), result.data(), numPixels);
+		kernels::scalar::addNormals(one.data(), two.data(), scalarResult.data(), numPixels);
+		BOOST_CHECK(result == expected);
+		BOOST_CHECK(scalarResult == expected);
+
+		referenceAdd(one.data(), two.data(), expected.data(), numPixels);
+		kernels::add(one.data(), two.data(), result.data(), numPixels);
+		kernels::scalar::add(one.data(), two.data(), scalarResult.data(), numPixels);
+		BOOST_CHECK(result == expected);
+		BOOST_CHECK(scalarResult == expected);
+
+		for (std::size_t i = 0; i < numPixels * 4; i += 4)
+		{
+			expected[i] = 255 - one[i];
+			expected[i + 1] = 255 - one[i + 1];
+			expected[i + 2] = 255 - one[i + 2];
+			expected[i + 3] = one[i + 3];
+		}
+
+		kernels::invertColor(one.data(), result.data(), numPixels);
+		BOOST_CHECK(result == expected);
+
+		for (std::size_t i = 0; i < numPixels * 4; i += 4)
+		{
+			expected[i] = 255 - expected[i];
+			expected[i + 1] = 255 - expected[i + 1];
+			expected[i + 2] = 255 - expected[i + 2];
+			expected[i + 3] = 255 - expected[i + 3];
+		}
+
+		kernels::invertAlpha(one.data(), result.data(), numPixels);
+		BOOST_CHECK(result == expected);
+
+		for (std::size_t i = 0; i < numPixels * 4; i += 4)
+		{
+			expected[i] = expected[i + 1] = expected[i + 2] = expected[i + 3] = one[i];
+		}
+
+		kernels::makeIntensity(one.data(), result.data(), numPixels);
+		BOOST_CHECK(result == expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(smoothNormalsMatchesReference)
+{
+	std::mt19937 rng(23);
+
+	for (const Size& size : SIZES)
+	{
+		Pixels in = randomPixels(size.width * size.height * 4, rng);
+		Pixels expected(in.size());
+		Pixels result(in.size());
+		Pixels scalarResult(in.size());
+
+		referenceSmoothNormals(in.data(), expected.data(), size.width, size.height);
+		forEachRow(in.data(), result.data(), size.width, size.height, kernels::smoothNormalsRow);
+		forEachRow(in.data(), scalarResult.data(), size.width, size.height, kernels::scalar::smoothNormalsRow);
+
+		BOOST_CHECK_MESSAGE(result == expected, "smoothnormals " << size.width << "x" << size.height);
+		BOOST_CHECK(scalarResult == expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(heightMapMatchesReference)
+{
+	std::mt19937 rng(31);
+
+	const float scales[] = { 0.0f, 0.5f, 1.0f, 3.0f, 10.0f };
+
+	for (const Size& size : SIZES)
+	{
+		Pixels in = randomPixels(size.width * size.height * 4, rng);
+		Pixels expected(in.size());
+		Pixels result(in.size());
+		Pixels scalarResult(in.size());
+
+		for (float scale : scales)
+		{
+			referenceHeightMap(in.data(), expected.data(), size.width, size.height, scale);
+
+			forEachRow(in.data(), result.data(), size.width, size.height,
+				[=](const byte* prev, const byte* row, const byte* next, byte* out, std::size_t width)
+			{
+				kernels::heightMapRow(prev, row, next, out, width, scale);
+			});
+
+			forEachRow(in.data(), scalarResult.data(), size.width, size.height,
+				[=](const byte* prev, const byte* row, const byte* next, byte* out, std::size_t width)
+			{
+				kernels::scalar::heightMapRow(prev, row, next, out, width, scale);
+			});
+
+			BOOST_CHECK_MESSAGE(result == expected, "heightmap " << size.width << "x" << size.height << " scale " << scale);
+			BOOST_CHECK(scalarResult == expected);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lerpRowsMatchesReference)
+{
+	std::mt19937 rng(47);
+
+	const std::size_t lengths[] = { 1, 3, 4, 15, 16, 17, 33, 100 };
+
+	for (std::size_t length : lengths)
+	{
+		Pixels row1 = randomPixels(length, rng);
+		Pixels row2 = randomPixels(length, rng);
+		Pixels expected(length);
+		Pixels result(length);
+		Pixels scalarResult(length);
+
+		for (std::size_t lerp = 0; lerp <= 0xFFFF; lerp += (lerp < 4 || lerp > 0xFFF8 || (lerp > 0x7FF8 && lerp < 0x8008)) ? 1 : 97)
+		{
+			referenceLerpRows(row1.data(), row2.data(), expected.data(), length, lerp);
+			kernels::lerpRows(row1.data(), row2.data(), result.data(), length, lerp);
+			kernels::scalar::lerpRows(row1.data(), row2.data(), scalarResult.data(), length, lerp);
+
+			BOOST_CHECK_MESSAGE(result == expected, "lerp " << lerp << " length " << length);
+			BOOST_CHECK(scalarResult == expected);
+		}
+	}
+}
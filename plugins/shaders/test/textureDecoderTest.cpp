@@ -0,0 +1,278 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE textureDecoderTest
+#include <boost/test/unit_test.hpp>
+
+#include "../textures/TextureDecoder.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using shaders::TextureDecoder;
+
+namespace
+{
+
+// Image without pixels, the decoder never looks at them
+class FakeImage :
+	public Image
+{
+	std::size_t _width;
+
+public:
+	FakeImage(std::size_t width) :
+		_width(width)
+	{}
+
+	byte* getMipMapPixels(std::size_t) const { return nullptr; }
+	std::size_t getWidth(std::size_t) const { return _width; }
+	std::size_t getHeight(std::size_t) const { return 1; }
+	TexturePtr bindTexture(const std::string&) const { return TexturePtr(); }
+};
+
+// Lets the test hold back the decoder threads
+class Gate
+{
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _open;
+
+public:
+	Gate() :
+		_open(false)
+	{}
+
+	void open()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_open = true;
+		}
+
+		_condition.notify_all();
+	}
+
+	void pass()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_condition.wait(lock, [this]() { return _open; });
+	}
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(decodedImagesAreTakenOnce)
+{
+	TextureDecoder decoder(4);
+
+	const std::size_t count = 200;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		decoder.request("textures/test/" + std::to_string(i), [i]()
+		{
+			return ImagePtr(new FakeImage(i));
+		});
+	}
+
+	std::set<std::string> taken;
+	std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (taken.size() < count && std::chrono::steady_clock::now() < timeout)
+	{
+		TextureDecoder::Result result;
+
+		if (!decoder.takeCompleted(result))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		BOOST_REQUIRE(result.image);
+		BOOST_CHECK_EQUAL(result.identifier, "textures/test/" + std::to_string(result.image->getWidth(0)));
+		BOOST_CHECK(taken.insert(result.identifier).second);
+	}
+
+	BOOST_CHECK_EQUAL(taken.size(), count);
+	BOOST_CHECK_EQUAL(decoder.getNumPending(), 0);
+	BOOST_CHECK(!decoder.hasCompleted());
+}
+
+BOOST_AUTO_TEST_CASE(duplicateRequestsAreDecodedOnce)
+{
+	Gate gate;
+	std::atomic<int> decodes(0);
+
+	TextureDecoder decoder(2);
+
+	TextureDecoder::DecodeFunction decode = [&]()
+	{
+		gate.pass();
+		++decodes;
+		return ImagePtr(new FakeImage(1));
+	};
+
+	decoder.request("textures/test/a", decode);
+	decoder.request("textures/test/a", decode);
+	decoder.request("textures/test/a", decode);
+
+	BOOST_CHECK(decoder.isPending("textures/test/a"));
+	BOOST_CHECK_EQUAL(decoder.getNumPending(), 1);
+
+	gate.open();
+
+	BOOST_CHECK(decoder.wait("textures/test/a"));
+	BOOST_CHECK_EQUAL(decodes.load(), 1);
+	BOOST_CHECK(!decoder.isPending("textures/test/a"));
+
+	// Nothing is left to take after waiting
+	TextureDecoder::Result result;
+	BOOST_CHECK(!decoder.takeCompleted(result));
+}
+
+BOOST_AUTO_TEST_CASE(waitDecodesQueuedRequestsOnTheCallingThread)
+{
+	Gate gate;
+	std::thread::id decodingThread;
+
+	// Block the only worker
+	TextureDecoder decoder(1);
+
+	decoder.request("textures/test/blocker", [&]()
+	{
+		gate.pass();
+		return ImagePtr(new FakeImage(1));
+	});
+
+	decoder.request("textures/test/waited", [&]()
+	{
+		decodingThread = std::this_thread::get_id();
+		return ImagePtr(new FakeImage(2));
+	});
+
+	ImagePtr image = decoder.wait("textures/test/waited");
+
+	BOOST_REQUIRE(image);
+	BOOST_CHECK_EQUAL(image->getWidth(0), 2);
+	BOOST_CHECK(decodingThread == std::this_thread::get_id());
+
+	gate.open();
+
+	BOOST_CHECK(decoder.wait("textures/test/blocker"));
+	BOOST_CHECK_EQUAL(decoder.getNumPending(), 0);
+
+	// Unknown identifiers don't block
+	BOOST_CHECK(!decoder.wait("textures/test/unknown"));
+}
+
+BOOST_AUTO_TEST_CASE(failedDecodesYieldEmptyImages)
+{
+	TextureDecoder decoder(2);
+
+	decoder.request("textures/test/throws", []() -> ImagePtr
+	{
+		throw std::runtime_error("corrupt image");
+	});
+
+	decoder.request("textures/test/missing", []()
+	{
+		return ImagePtr();
+	});
+
+	BOOST_CHECK(!decoder.wait("textures/test/throws"));
+	BOOST_CHECK(!decoder.wait("textures/test/missing"));
+	BOOST_CHECK_EQUAL(decoder.getNumPending(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(completionCallbackIsInvoked)
+{
+	std::atomic<int> notifications(0);
+
+	TextureDecoder decoder(2);
+	decoder.setCompletionCallback([&]() { ++notifications; });
+
+	for (int i = 0; i < 10; ++i)
+	{
+		decoder.request("textures/test/" + std::to_string(i), []()
+		{
+			return ImagePtr(new FakeImage(1));
+		});
+	}
+
+	std::size_t taken = 0;
+	std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (taken < 10 && std::chrono::steady_clock::now() < timeout)
+	{
+		TextureDecoder::Result result;
+
+		if (decoder.takeCompleted(result))
+		{
+			++taken;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// The callback runs right after the image has been queued for taking
+	while (notifications < 10 && std::chrono::steady_clock::now() < timeout)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	BOOST_CHECK_EQUAL(taken, 10);
+	BOOST_CHECK_EQUAL(notifications.load(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(clearedAndCancelledRequestsAreDropped)
+{
+	Gate gate;
+	std::atomic<int> decodes(0);
+	std::thread opener;
+
+	{
+		TextureDecoder decoder(1);
+
+		decoder.request("textures/test/blocker", [&]()
+		{
+			gate.pass();
+			return ImagePtr(new FakeImage(1));
+		});
+
+		for (int i = 0; i < 10; ++i)
+		{
+			decoder.request("textures/test/" + std::to_string(i), [&]()
+			{
+				++decodes;
+				return ImagePtr(new FakeImage(1));
+			});
+		}
+
+		decoder.clear();
+		BOOST_CHECK_EQUAL(decoder.getNumPending(), 0);
+
+		// Queued again after clearing, to be skipped by the destructor
+		decoder.request("textures/test/0", [&]()
+		{
+			++decodes;
+			return ImagePtr(new FakeImage(1));
+		});
+
+		// Let the blocker finish once the decoder is being destroyed
+		opener = std::thread([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			gate.open();
+		});
+	}
+
+	opener.join();
+
+	BOOST_CHECK_EQUAL(decodes.load(), 0);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <functional>
+
+namespace shaders
+{
+
+/**
+ * \brief
+ * Texture whose image is decoded in the background.
+ *
+ * Until the decoded image has been uploaded, the GL texture number of the
+ * placeholder texture is returned. The dimensions are those of the real
+ * image, so asking for them completes the loading immediately.
+ */
+class DeferredTexture :
+	public Texture
+{
+public:
+	// Completes the loading of the given texture by calling setTexture()
+	typedef std::function<void(DeferredTexture&)> LoadFunction;
+
+private:
+	std::string _name;
+
+	TexturePtr _placeholder;
+
+	// The uploaded texture, empty while loading
+	TexturePtr _texture;
+
+	LoadFunction _finishLoading;
+
+public:
+	DeferredTexture(const std::string& name, const TexturePtr& placeholder,
+					const LoadFunction& finishLoading) :
+		_name(name),
+		_placeholder(placeholder),
+		_finishLoading(finishLoading)
+	{}
+
+	bool isLoaded() const
+	{
+		return static_cast<bool>(_texture);
+	}
+
+	// Returns the uploaded texture, completing the loading if necessary
+	const TexturePtr& getTexture()
+	{
+		if (!_texture && _finishLoading)
+		{
+			_finishLoading(*this);
+		}
+
+		return _texture ? _texture : _placeholder;
+	}
+
+	// Called on the GL thread once the image has been uploaded
+	void setTexture(const TexturePtr& texture)
+	{
+		_texture = texture;
+		_finishLoading = LoadFunction();
+	}
+
+	/* Texture implementation */
+	std::string getName() const
+	{
+		return _name;
+	}
+
+	GLuint getGLTexNum() const
+	{
+		return _texture ? _texture->getGLTexNum() : _placeholder->getGLTexNum();
+	}
+
+	std::size_t getWidth() const
+	{
+		return const_cast<DeferredTexture&>(*this).getTexture()->getWidth();
+	}
+
+	std::size_t getHeight() const
+	{
+		return const_cast<DeferredTexture&>(*this).getTexture()->getHeight();
+	}
+};
+typedef std::shared_ptr<DeferredTexture> DeferredTexturePtr;
+
+} // namespace
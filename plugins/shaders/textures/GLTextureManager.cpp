@@ -4,9 +4,15 @@
 #include "itextstream.h"
 #include "texturelib.h"
 #include "igl.h"
+#include "imainframe.h"
 #include "../MapExpression.h"
 #include "TextureManipulator.h"
 #include "parser/DefTokeniser.h"
+#include "registry/registry.h"
+#include "RGBAImage.h"
+
+#include <chrono>
+#include <wx/app.h>
 
 namespace {
     const int MAX_TEXTURE_QUALITY = 3;
@@ -16,6 +22,26 @@ namespace {
 
 namespace shaders {
 
+GLTextureManager::GLTextureManager() :
+    _asyncLoading(registry::getValue<bool>(RKEY_TEXTURES_ASYNC_LOADING)),
+    _idleHandlerConnected(false)
+{
+    GlobalRegistry().signalForKey(RKEY_TEXTURES_ASYNC_LOADING).connect(
+        sigc::mem_fun(this, &GLTextureManager::keyChanged)
+    );
+}
+
+GLTextureManager::~GLTextureManager()
+{
+    cancelPendingTextures();
+}
+
+void GLTextureManager::keyChanged()
+{
+    // Textures which are already being decoded will still be uploaded
+    _asyncLoading = registry::getValue<bool>(RKEY_TEXTURES_ASYNC_LOADING);
+}
+
 void GLTextureManager::checkBindings() {
     // Check the TextureMap for unique pointers and release them
     // as they aren't used by anyone else than this class.
@@ -52,6 +78,15 @@ TexturePtr GLTextureManager::getBinding(NamedBindablePtr bindable)
         // Found, return
         return i->second;
     }
+
+    // In async mode the image is decoded in the background, cube maps
+    // are not handled by the decoder and get loaded right away
+    MapExpressionPtr expression = std::dynamic_pointer_cast<MapExpression>(bindable);
+
+    if (_asyncLoading && expression && !expression->isCubeMap())
+    {
+        return requestTexture(identifier, expression);
+    }
     else
     {
         // Create and insert texture object, if it is valid
@@ -70,6 +105,141 @@ TexturePtr GLTextureManager::getBinding(NamedBindablePtr bindable)
     }
 }
 
+TexturePtr GLTextureManager::requestTexture(const std::string& identifier,
+                                            const MapExpressionPtr& expression)
+{
+    if (!_decoder)
+    {
+        _decoder.reset(new TextureDecoder);
+
+        // Wake up the main loop, the idle handler will trigger a redraw
+        _decoder->setCompletionCallback([]() { wxWakeUpIdle(); });
+    }
+
+    // The map expressions are resampling images through this singleton,
+    // make sure it is constructed on this thread
+    TextureManipulator::instance();
+
+    _decoder->request(identifier, [expression]() { return expression->getImage(); });
+
+    TexturePtr texture = std::make_shared<DeferredTexture>(
+        identifier, getPlaceholder(),
+        std::bind(&GLTextureManager::finishLoading, this, expression, std::placeholders::_1)
+    );
+
+    _textures.insert(TextureMap::value_type(identifier, texture));
+
+    connectIdleHandler();
+
+    return texture;
+}
+
+void GLTextureManager::finishLoading(const MapExpressionPtr& expression, DeferredTexture& texture)
+{
+    const std::string identifier = texture.getName();
+
+    // The request has been dropped if the decoder has been cancelled
+    ImagePtr image = _decoder && _decoder->isPending(identifier) ?
+        _decoder->wait(identifier) : expression->getImage();
+
+    uploadTexture(texture, image);
+}
+
+void GLTextureManager::uploadTexture(DeferredTexture& texture, const ImagePtr& image)
+{
+    TexturePtr uploaded = image ? image->bindTexture(texture.getName()) : TexturePtr();
+
+    if (uploaded)
+    {
+        texture.setTexture(uploaded);
+    }
+    else
+    {
+        rError() << "[shaders] Unable to load texture: "
+                            << texture.getName() << std::endl;
+        texture.setTexture(getShaderNotFound());
+    }
+}
+
+void GLTextureManager::processPendingUploads(std::size_t maxMsec)
+{
+    if (!_decoder)
+    {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    TextureDecoder::Result result;
+
+    while (_decoder->takeCompleted(result))
+    {
+        // Textures which have been released in the meantime are not uploaded
+        TextureMap::iterator i = _textures.find(result.identifier);
+
+        if (i != _textures.end())
+        {
+            DeferredTexturePtr texture = std::dynamic_pointer_cast<DeferredTexture>(i->second);
+
+            if (texture && !texture->isLoaded())
+            {
+                uploadTexture(*texture, result.image);
+            }
+        }
+
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >=
+            static_cast<long long>(maxMsec))
+        {
+            break; // continue in the next frame
+        }
+    }
+}
+
+void GLTextureManager::cancelPendingTextures()
+{
+    // The remaining textures will be decoded when they are asked for their size
+    _decoder.reset();
+
+    disconnectIdleHandler();
+}
+
+void GLTextureManager::onIdle(wxIdleEvent& ev)
+{
+    if (!_decoder || _decoder->getNumPending() == 0)
+    {
+        disconnectIdleHandler();
+        return;
+    }
+
+    // The uploads happen while rendering, with the GL context being current
+    if (_decoder->hasCompleted())
+    {
+        GlobalMainFrame().updateAllWindows();
+    }
+}
+
+void GLTextureManager::connectIdleHandler()
+{
+    if (_idleHandlerConnected || !wxTheApp) return;
+
+    wxTheApp->Connect(wxEVT_IDLE, wxIdleEventHandler(GLTextureManager::onIdle), NULL, this);
+    _idleHandlerConnected = true;
+}
+
+void GLTextureManager::disconnectIdleHandler()
+{
+    if (!_idleHandlerConnected) return;
+
+    if (wxTheApp)
+    {
+        wxTheApp->Disconnect(wxEVT_IDLE, wxIdleEventHandler(GLTextureManager::onIdle), NULL, this);
+    }
+
+    _idleHandlerConnected = false;
+}
+
 TexturePtr GLTextureManager::getBinding(const std::string& fullPath)
 {
     // check if the texture has to be loaded
@@ -111,6 +281,29 @@ TexturePtr GLTextureManager::getShaderNotFound()
     return _shaderNotFound;
 }
 
+bool GLTextureManager::isShaderNotFound(const TexturePtr& texture)
+{
+    DeferredTexturePtr deferred = std::dynamic_pointer_cast<DeferredTexture>(texture);
+
+    return (deferred ? deferred->getTexture() : texture) == getShaderNotFound();
+}
+
+TexturePtr GLTextureManager::getPlaceholder()
+{
+    if (!_placeholder)
+    {
+        // A neutral grey, to not flash in the camera view
+        RGBAImage image(1, 1);
+
+        image.pixels[0].red = image.pixels[0].green = image.pixels[0].blue = 128;
+        image.pixels[0].alpha = 255;
+
+        _placeholder = image.bindTexture("_placeholder");
+    }
+
+    return _placeholder;
+}
+
 TexturePtr GLTextureManager::loadStandardTexture(const std::string& filename)
 {
     // Create the texture path
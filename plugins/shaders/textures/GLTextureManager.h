@@ -3,13 +3,24 @@
 
 #include "ishaders.h"
 #include <map>
+#include <memory>
 #include "../MapExpression.h"
 #include "texturelib.h"
+#include "TextureDecoder.h"
+#include "DeferredTexture.h"
+
+#include <wx/event.h>
+#include <sigc++/trackable.h>
 
 namespace shaders
 {
 
-class GLTextureManager
+// Registry key enabling the background decoding of textures
+const char* const RKEY_TEXTURES_ASYNC_LOADING = "user/ui/textures/asyncLoading";
+
+class GLTextureManager :
+	public wxEvtHandler,
+	public sigc::trackable
 {
 	// The mapping between texturekeys and Texture instances
 	typedef std::map<std::string, TexturePtr> TextureMap;
@@ -18,12 +29,46 @@ class GLTextureManager
 	// The fallback textures in case a texture is empty or broken
 	TexturePtr _shaderNotFound;
 
+	// Shown while the actual image is decoded in the background
+	TexturePtr _placeholder;
+
+	// Whether map expressions are evaluated by the decoder threads
+	bool _asyncLoading;
+
+	// Created on first use, decodes the images in async mode
+	std::unique_ptr<TextureDecoder> _decoder;
+
+	// TRUE while the idle handler waiting for decoded images is connected
+	bool _idleHandlerConnected;
+
 private:
 
 	// Constructs the fallback textures like "Shader Image Missing"
 	TexturePtr loadStandardTexture(const std::string& filename);
 
+	// Returns the 1x1 texture used while images are decoded
+	TexturePtr getPlaceholder();
+
+	// Queues the given map expression for decoding, returns a DeferredTexture
+	TexturePtr requestTexture(const std::string& identifier, const MapExpressionPtr& expression);
+
+	// Blocks until the image of the given texture is decoded, then uploads it
+	void finishLoading(const MapExpressionPtr& expression, DeferredTexture& texture);
+
+	// Uploads the given image (on failure the "shader not found" texture is used)
+	void uploadTexture(DeferredTexture& texture, const ImagePtr& image);
+
+	void keyChanged();
+
+	// Triggers a redraw as soon as decoded images are waiting to be uploaded
+	void onIdle(wxIdleEvent& ev);
+
+	void connectIdleHandler();
+	void disconnectIdleHandler();
+
 public:
+	GLTextureManager();
+	~GLTextureManager();
 
     /**
      * \brief
@@ -45,12 +90,28 @@ public:
      */
 	TexturePtr getShaderNotFound();
 
+	/**
+	 * Returns true if the given texture is the "shader not found" texture,
+	 * textures which are still being decoded are finished first.
+	 */
+	bool isShaderNotFound(const TexturePtr& texture);
+
 	/* greebo: This is some sort of "cleanup" call, which causes
 	 * the TextureManager to go through the list of textures and
 	 * remove the unused ones.
 	 */
 	void checkBindings();
 
+	/**
+	 * Uploads the images which have been decoded in the background. This
+	 * needs to be called with a current GL context and stops after
+	 * maxMsec milliseconds, at least one image is uploaded per call.
+	 */
+	void processPendingUploads(std::size_t maxMsec);
+
+	// Stops the background decoding, pending textures will be loaded on demand
+	void cancelPendingTextures();
+
 };
 
 typedef std::shared_ptr<GLTextureManager> GLTextureManagerPtr;
@@ -0,0 +1,536 @@
+#include "ImageKernels.h"
+
+#include "math/FloatTools.h"
+
+#include <cmath>
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU, no runtime detection is needed.
+// FreeBSD's lrint() is rounding ties upwards, use the scalar code there
+// to stay identical to the other float_to_integer() users.
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(__FreeBSD__)
+#define IMAGE_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace shaders
+{
+
+namespace kernels
+{
+
+namespace
+{
+	// The 3x3 smoothing kernel averages nine pixels
+	const float PER_KERNEL_SIZE = 1.0f / 9;
+
+	inline std::size_t wrap(std::size_t x, int dx, std::size_t width)
+	{
+		return (x + width + dx) % width;
+	}
+
+	inline const byte* selectRow(const byte* prev, const byte* row, const byte* next, int dy)
+	{
+		return dy < 0 ? prev : (dy > 0 ? next : row);
+	}
+
+	inline byte smoothChannel(int sum)
+	{
+		// The sum is scaled in double precision, like the Vector3 the original code used
+		return static_cast<byte>(float_to_integer(static_cast<double>(sum) * static_cast<double>(PER_KERNEL_SIZE)));
+	}
+
+	void smoothNormalsPixel(const byte* prev, const byte* row, const byte* next,
+							byte* out, std::size_t width, std::size_t x)
+	{
+		int sum[3] = { 0, 0, 0 };
+
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			const byte* source = selectRow(prev, row, next, dy);
+
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				const byte* pixel = source + wrap(x, dx, width) * 4;
+
+				sum[0] += pixel[0];
+				sum[1] += pixel[1];
+				sum[2] += pixel[2];
+			}
+		}
+
+		out[0] = smoothChannel(sum[0]);
+		out[1] = smoothChannel(sum[1]);
+		out[2] = smoothChannel(sum[2]);
+		out[3] = 255;
+	}
+
+	struct KernelElement
+	{
+		int x, y;
+		float w;
+	};
+
+	// 3x3 Prewitt filtering, see http://en.wikipedia.org/wiki/Edge_detection
+	const int PREWITT_SIZE = 6;
+
+	const KernelElement PREWITT_DU[PREWITT_SIZE] = {
+		{-1, 1,-1.0f },
+		{-1, 0,-1.0f },
+		{-1,-1,-1.0f },
+		{ 1, 1, 1.0f },
+		{ 1, 0, 1.0f },
+		{ 1,-1, 1.0f }
+	};
+
+	const KernelElement PREWITT_DV[PREWITT_SIZE] = {
+		{-1, 1, 1.0f },
+		{ 0, 1, 1.0f },
+		{ 1, 1, 1.0f },
+		{-1,-1,-1.0f },
+		{ 0,-1,-1.0f },
+		{ 1,-1,-1.0f }
+	};
+
+	// Keeps the evaluation order of the original code, the SSE2 version does the same
+	void heightMapPixel(const byte* prev, const byte* row, const byte* next,
+						byte* out, std::size_t width, std::size_t x, float scale)
+	{
+		float du = 0;
+		for (const KernelElement* i = PREWITT_DU; i != PREWITT_DU + PREWITT_SIZE; ++i) {
+			du += (selectRow(prev, row, next, i->y)[wrap(x, i->x, width) * 4] / 255.0f) * i->w;
+		}
+
+		float dv = 0;
+		for (const KernelElement* i = PREWITT_DV; i != PREWITT_DV + PREWITT_SIZE; ++i) {
+			dv += (selectRow(prev, row, next, i->y)[wrap(x, i->x, width) * 4] / 255.0f) * i->w;
+		}
+
+		float nx = -du * scale;
+		float ny = -dv * scale;
+		float nz = 1.0;
+
+		// Normalize
+		float norm = 1.0f / std::sqrt(nx*nx + ny*ny + nz*nz);
+		out[0] = static_cast<byte>(float_to_integer(((nx * norm) + 1) * 127.5));
+		out[1] = static_cast<byte>(float_to_integer(((ny * norm) + 1) * 127.5));
+		out[2] = static_cast<byte>(float_to_integer(((nz * norm) + 1) * 127.5));
+		out[3] = 255;
+	}
+
+#ifdef IMAGE_KERNELS_SSE2
+
+	// (a + b) / 2 per byte, rounding ties to even like lrint()
+	inline __m128i averageRounded(__m128i a, __m128i b)
+	{
+		const __m128i ones = _mm_set1_epi8(1);
+
+		// _mm_avg_epu8 rounds ties upwards, step back if the lower neighbour is even
+		__m128i odd = _mm_and_si128(_mm_xor_si128(a, b), ones);
+		__m128i lower = _mm_sub_epi8(_mm_avg_epu8(a, b), odd);
+
+		return _mm_add_epi8(lower, _mm_and_si128(odd, _mm_and_si128(lower, ones)));
+	}
+
+	// The red channels of four pixels divided by 255
+	inline __m128 loadHeights(const byte* pixels)
+	{
+		__m128i red = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)), _mm_set1_epi32(0xFF));
+		return _mm_div_ps(_mm_cvtepi32_ps(red), _mm_set1_ps(255.0f));
+	}
+
+	// lrint((v + 1) * 127.5) evaluated in double precision like the scalar code
+	inline __m128i toNormalComponent(__m128 v)
+	{
+		const __m128d factor = _mm_set1_pd(127.5);
+
+		__m128i low = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtps_pd(v), factor));
+		__m128i high = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), factor));
+
+		return _mm_unpacklo_epi64(low, high);
+	}
+
+	// Adds the RGBA bytes of four pixels to the 16 bit sums
+	inline void addPixels(__m128i pixels, __m128i& low, __m128i& high)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		low = _mm_add_epi16(low, _mm_unpacklo_epi8(pixels, zero));
+		high = _mm_add_epi16(high, _mm_unpackhi_epi8(pixels, zero));
+	}
+
+	inline __m128i load(const byte* pixels)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+	}
+
+	inline void store(byte* pixels, __m128i value)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+	}
+
+#endif
+}
+
+namespace scalar
+{
+
+void addNormals(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels; ++i, one += 4, two += 4, out += 4)
+	{
+		// Take the mean value of the two vectors
+		out[0] = static_cast<byte>(float_to_integer((static_cast<double>(one[0]) + two[0]) * 0.5));
+		out[1] = static_cast<byte>(float_to_integer((static_cast<double>(one[1]) + two[1]) * 0.5));
+		out[2] = static_cast<byte>(float_to_integer((static_cast<double>(one[2]) + two[2]) * 0.5));
+		out[3] = 255;
+	}
+}
+
+void add(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels * 4; ++i)
+	{
+		out[i] = static_cast<byte>(float_to_integer((static_cast<float>(one[i]) + two[i]) * 0.5f));
+	}
+}
+
+void invertColor(const byte* in, byte* out, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels; ++i, in += 4, out += 4)
+	{
+		out[0] = 255 - in[0];
+		out[1] = 255 - in[1];
+		out[2] = 255 - in[2];
+		out[3] = in[3];
+	}
+}
+
+void invertAlpha(const byte* in, byte* out, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels; ++i, in += 4, out += 4)
+	{
+		out[0] = in[0];
+		out[1] = in[1];
+		out[2] = in[2];
+		out[3] = 255 - in[3];
+	}
+}
+
+void makeIntensity(const byte* in, byte* out, std::size_t numPixels)
+{
+	for (std::size_t i = 0; i < numPixels; ++i, in += 4, out += 4)
+	{
+		out[0] = in[0];
+		out[1] = in[0];
+		out[2] = in[0];
+		out[3] = in[0];
+	}
+}
+
+void smoothNormalsRow(const byte* prev, const byte* row, const byte* next,
+					  byte* out, std::size_t width)
+{
+	for (std::size_t x = 0; x < width; ++x)
+	{
+		smoothNormalsPixel(prev, row, next, out + x * 4, width, x);
+	}
+}
+
+void heightMapRow(const byte* prev, const byte* row, const byte* next,
+				  byte* out, std::size_t width, float scale)
+{
+	for (std::size_t x = 0; x < width; ++x)
+	{
+		heightMapPixel(prev, row, next, out + x * 4, width, x, scale);
+	}
+}
+
+void lerpRows(const byte* row1, const byte* row2, byte* out,
+			  std::size_t numBytes, std::size_t lerp)
+{
+	int factor = static_cast<int>(lerp);
+
+	for (std::size_t i = 0; i < numBytes; ++i)
+	{
+		// The product is negative for falling values, >> is rounding towards -infinity
+		out[i] = static_cast<byte>((((row2[i] - row1[i]) * factor) >> 16) + row1[i]);
+	}
+}
+
+} // namespace scalar
+
+#ifdef IMAGE_KERNELS_SSE2
+
+void addNormals(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+	std::size_t i = 0;
+
+	for (; i + 4 <= numPixels; i += 4)
+	{
+		__m128i average = averageRounded(load(one + i * 4), load(two + i * 4));
+		store(out + i * 4, _mm_or_si128(average, alpha));
+	}
+
+	scalar::addNormals(one + i * 4, two + i * 4, out + i * 4, numPixels - i);
+}
+
+void add(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	std::size_t i = 0;
+
+	for (; i + 4 <= numPixels; i += 4)
+	{
+		store(out + i * 4, averageRounded(load(one + i * 4), load(two + i * 4)));
+	}
+
+	scalar::add(one + i * 4, two + i * 4, out + i * 4, numPixels - i);
+}
+
+void invertColor(const byte* in, byte* out, std::size_t numPixels)
+{
+	const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+
+	std::size_t i = 0;
+
+	for (; i + 4 <= numPixels; i += 4)
+	{
+		store(out + i * 4, _mm_xor_si128(load(in + i * 4), mask));
+	}
+
+	scalar::invertColor(in + i * 4, out + i * 4, numPixels - i);
+}
+
+void invertAlpha(const byte* in, byte* out, std::size_t numPixels)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF000000);
+
+	std::size_t i = 0;
+
+	for (; i + 4 <= numPixels; i += 4)
+	{
+		store(out + i * 4, _mm_xor_si128(load(in + i * 4), mask));
+	}
+
+	scalar::invertAlpha(in + i * 4, out + i * 4, numPixels - i);
+}
+
+void makeIntensity(const byte* in, byte* out, std::size_t numPixels)
+{
+	const __m128i red = _mm_set1_epi32(0xFF);
+
+	std::size_t i = 0;
+
+	for (; i + 4 <= numPixels; i += 4)
+	{
+		__m128i value = _mm_and_si128(load(in + i * 4), red);
+		value = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+		value = _mm_or_si128(value, _mm_slli_epi32(value, 16));
+
+		store(out + i * 4, value);
+	}
+
+	scalar::makeIntensity(in + i * 4, out + i * 4, numPixels - i);
+}
+
+void smoothNormalsRow(const byte* prev, const byte* row, const byte* next,
+					  byte* out, std::size_t width)
+{
+	if (width < 6)
+	{
+		scalar::smoothNormalsRow(prev, row, next, out, width);
+		return;
+	}
+
+	// The border pixels wrap around
+	smoothNormalsPixel(prev, row, next, out, width, 0);
+
+	std::size_t x = 1;
+	unsigned short sums[16];
+
+	// Four pixels at a time, the right neighbours must not wrap
+	for (; x + 5 <= width; x += 4)
+	{
+		__m128i low = _mm_setzero_si128();
+		__m128i high = _mm_setzero_si128();
+
+		const byte* rows[3] = { prev, row, next };
+
+		for (const byte* source : rows)
+		{
+			addPixels(load(source + (x - 1) * 4), low, high);
+			addPixels(load(source + x * 4), low, high);
+			addPixels(load(source + (x + 1) * 4), low, high);
+		}
+
+		store(reinterpret_cast<byte*>(sums), low);
+		store(reinterpret_cast<byte*>(sums + 8), high);
+
+		byte* target = out + x * 4;
+
+		for (int p = 0; p < 4; ++p, target += 4)
+		{
+			target[0] = smoothChannel(sums[p * 4]);
+			target[1] = smoothChannel(sums[p * 4 + 1]);
+			target[2] = smoothChannel(sums[p * 4 + 2]);
+			target[3] = 255;
+		}
+	}
+
+	for (; x < width; ++x)
+	{
+		smoothNormalsPixel(prev, row, next, out + x * 4, width, x);
+	}
+}
+
+void heightMapRow(const byte* prev, const byte* row, const byte* next,
+				  byte* out, std::size_t width, float scale)
+{
+	if (width < 6)
+	{
+		scalar::heightMapRow(prev, row, next, out, width, scale);
+		return;
+	}
+
+	heightMapPixel(prev, row, next, out, width, 0, scale);
+
+	const __m128 scaleFactor = _mm_set1_ps(scale);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+	std::size_t x = 1;
+
+	for (; x + 5 <= width; x += 4)
+	{
+		std::size_t left = (x - 1) * 4;
+		std::size_t centre = x * 4;
+		std::size_t right = (x + 1) * 4;
+
+		// Same order of additions as the kernel tables
+		__m128 du = _mm_sub_ps(_mm_setzero_ps(), loadHeights(next + left));
+		du = _mm_sub_ps(du, loadHeights(row + left));
+		du = _mm_sub_ps(du, loadHeights(prev + left));
+		du = _mm_add_ps(du, loadHeights(next + right));
+		du = _mm_add_ps(du, loadHeights(row + right));
+		du = _mm_add_ps(du, loadHeights(prev + right));
+
+		__m128 dv = _mm_add_ps(_mm_setzero_ps(), loadHeights(next + left));
+		dv = _mm_add_ps(dv, loadHeights(next + centre));
+		dv = _mm_add_ps(dv, loadHeights(next + right));
+		dv = _mm_sub_ps(dv, loadHeights(prev + left));
+		dv = _mm_sub_ps(dv, loadHeights(prev + centre));
+		dv = _mm_sub_ps(dv, loadHeights(prev + right));
+
+		__m128 nx = _mm_mul_ps(_mm_xor_ps(du, signMask), scaleFactor);
+		__m128 ny = _mm_mul_ps(_mm_xor_ps(dv, signMask), scaleFactor);
+
+		__m128 length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), one);
+		__m128 norm = _mm_div_ps(one, _mm_sqrt_ps(length));
+
+		__m128i red = toNormalComponent(_mm_add_ps(_mm_mul_ps(nx, norm), one));
+		__m128i green = toNormalComponent(_mm_add_ps(_mm_mul_ps(ny, norm), one));
+		__m128i blue = toNormalComponent(_mm_add_ps(norm, one));
+
+		__m128i pixels = _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)),
+									  _mm_or_si128(_mm_slli_epi32(blue, 16), alpha));
+
+		store(out + centre, pixels);
+	}
+
+	for (; x < width; ++x)
+	{
+		heightMapPixel(prev, row, next, out + x * 4, width, x, scale);
+	}
+}
+
+void lerpRows(const byte* row1, const byte* row2, byte* out,
+			  std::size_t numBytes, std::size_t lerp)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	// _mm_mulhi_epi16 is signed, factors above 0x7FFF are represented
+	// as lerp - 0x10000 and the missing 0x10000 * d is added separately
+	const __m128i factor = _mm_set1_epi16(static_cast<short>(lerp));
+	const bool addDifference = lerp > 0x7FFF;
+
+	std::size_t i = 0;
+
+	for (; i + 16 <= numBytes; i += 16)
+	{
+		__m128i one = load(row1 + i);
+		__m128i two = load(row2 + i);
+
+		__m128i oneLow = _mm_unpacklo_epi8(one, zero);
+		__m128i oneHigh = _mm_unpackhi_epi8(one, zero);
+
+		__m128i diffLow = _mm_sub_epi16(_mm_unpacklo_epi8(two, zero), oneLow);
+		__m128i diffHigh = _mm_sub_epi16(_mm_unpackhi_epi8(two, zero), oneHigh);
+
+		__m128i low = _mm_mulhi_epi16(diffLow, factor);
+		__m128i high = _mm_mulhi_epi16(diffHigh, factor);
+
+		if (addDifference)
+		{
+			low = _mm_add_epi16(low, diffLow);
+			high = _mm_add_epi16(high, diffHigh);
+		}
+
+		store(out + i, _mm_packus_epi16(_mm_add_epi16(low, oneLow), _mm_add_epi16(high, oneHigh)));
+	}
+
+	scalar::lerpRows(row1 + i, row2 + i, out + i, numBytes - i, lerp);
+}
+
+#else
+
+void addNormals(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	scalar::addNormals(one, two, out, numPixels);
+}
+
+void add(const byte* one, const byte* two, byte* out, std::size_t numPixels)
+{
+	scalar::add(one, two, out, numPixels);
+}
+
+void invertColor(const byte* in, byte* out, std::size_t numPixels)
+{
+	scalar::invertColor(in, out, numPixels);
+}
+
+void invertAlpha(const byte* in, byte* out, std::size_t numPixels)
+{
+	scalar::invertAlpha(in, out, numPixels);
+}
+
+void makeIntensity(const byte* in, byte* out, std::size_t numPixels)
+{
+	scalar::makeIntensity(in, out, numPixels);
+}
+
+void smoothNormalsRow(const byte* prev, const byte* row, const byte* next,
+					  byte* out, std::size_t width)
+{
+	scalar::smoothNormalsRow(prev, row, next, out, width);
+}
+
+void heightMapRow(const byte* prev, const byte* row, const byte* next,
+				  byte* out, std::size_t width, float scale)
+{
+	scalar::heightMapRow(prev, row, next, out, width, scale);
+}
+
+void lerpRows(const byte* row1, const byte* row2, byte* out,
+			  std::size_t numBytes, std::size_t lerp)
+{
+	scalar::lerpRows(row1, row2, out, numBytes, lerp);
+}
+
+#endif
+
+} // namespace kernels
+
+} // namespace shaders
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+typedef unsigned char byte;
+
+namespace shaders
+{
+
+/**
+ * Row-wise pixel kernels used by the map expressions and the texture
+ * resampler. All functions operate on tightly packed RGBA pixels (except
+ * lerpRows, which works on plain bytes) and process whole rows at once.
+ *
+ * The functions in this namespace use SSE2 where available. The results
+ * are bit-identical to the scalar implementations in kernels::scalar,
+ * which reproduce the original per-pixel code including its rounding.
+ */
+namespace kernels
+{
+
+// Averages the RGB channels of two normal maps, alpha is set to 255
+void addNormals(const byte* one, const byte* two, byte* out, std::size_t numPixels);
+
+// Averages all four channels of two images
+void add(const byte* one, const byte* two, byte* out, std::size_t numPixels);
+
+// Inverts the RGB channels, alpha is copied
+void invertColor(const byte* in, byte* out, std::size_t numPixels);
+
+// Inverts the alpha channel, RGB is copied
+void invertAlpha(const byte* in, byte* out, std::size_t numPixels);
+
+// Copies the red channel into all four channels
+void makeIntensity(const byte* in, byte* out, std::size_t numPixels);
+
+/**
+ * Averages the RGB channels of the 3x3 neighbourhood of each pixel of
+ * <row>, wrapping around at the image borders. <prev> and <next> are the
+ * rows above and below (wrapped as well, they may point to <row> itself).
+ * Alpha is set to 255.
+ */
+void smoothNormalsRow(const byte* prev, const byte* row, const byte* next,
+					  byte* out, std::size_t width);
+
+/**
+ * Converts a row of a heightmap (red channel) to normals using a 3x3
+ * Prewitt filter, wrapping around at the image borders like smoothNormalsRow.
+ */
+void heightMapRow(const byte* prev, const byte* row, const byte* next,
+				  byte* out, std::size_t width, float scale);
+
+/**
+ * Linear interpolation between two rows of bytes in 16.16 fixed point:
+ * out = row1 + ((row2 - row1) * lerp >> 16), with lerp in [0..0xFFFF].
+ */
+void lerpRows(const byte* row1, const byte* row2, byte* out,
+			  std::size_t numBytes, std::size_t lerp);
+
+// The reference implementations, also used for the remainders of the vectorised loops
+namespace scalar
+{
+
+void addNormals(const byte* one, const byte* two, byte* out, std::size_t numPixels);
+void add(const byte* one, const byte* two, byte* out, std::size_t numPixels);
+void invertColor(const byte* in, byte* out, std::size_t numPixels);
+void invertAlpha(const byte* in, byte* out, std::size_t numPixels);
+void makeIntensity(const byte* in, byte* out, std::size_t numPixels);
+void smoothNormalsRow(const byte* prev, const byte* row, const byte* next,
+					  byte* out, std::size_t width);
+void heightMapRow(const byte* prev, const byte* row, const byte* next,
+				  byte* out, std::size_t width, float scale);
+void lerpRows(const byte* row1, const byte* row2, byte* out,
+			  std::size_t numBytes, std::size_t lerp);
+
+} // namespace scalar
+
+} // namespace kernels
+
+} // namespace shaders
@@ -0,0 +1,213 @@
+#include "TextureDecoder.h"
+
+#include "itextstream.h"
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+
+namespace shaders
+{
+
+TextureDecoder::TextureDecoder(std::size_t numThreads) :
+	_cancelled(false)
+{
+	if (numThreads == 0)
+	{
+		numThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	_pool.reset(new util::ThreadPool(numThreads));
+}
+
+TextureDecoder::~TextureDecoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_cancelled = true;
+	}
+
+	// Waits for the running decodes, the queued ones will be skipped
+	_pool.reset();
+}
+
+void TextureDecoder::setCompletionCallback(const CompletionCallback& callback)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_onCompleted = callback;
+}
+
+void TextureDecoder::request(const std::string& identifier, const DecodeFunction& decode)
+{
+	RequestPtr request = std::make_shared<Request>();
+	request->decode = decode;
+	request->state = State::Queued;
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		if (!_requests.insert(Requests::value_type(identifier, request)).second)
+		{
+			return; // already pending
+		}
+	}
+
+	_pool->enqueue(std::bind(&TextureDecoder::processRequest, this, identifier, request));
+}
+
+bool TextureDecoder::isPending(const std::string& identifier) const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _requests.find(identifier) != _requests.end();
+}
+
+std::size_t TextureDecoder::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _requests.size();
+}
+
+bool TextureDecoder::hasCompleted() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return !_completed.empty();
+}
+
+bool TextureDecoder::takeCompleted(Result& result)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (_completed.empty())
+	{
+		return false;
+	}
+
+	result.identifier = _completed.front();
+	_completed.pop_front();
+
+	Requests::iterator found = _requests.find(result.identifier);
+	result.image = found->second->image;
+	_requests.erase(found);
+
+	return true;
+}
+
+ImagePtr TextureDecoder::wait(const std::string& identifier)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	Requests::iterator found = _requests.find(identifier);
+
+	if (found == _requests.end())
+	{
+		return ImagePtr();
+	}
+
+	RequestPtr request = found->second;
+
+	if (request->state == State::Queued)
+	{
+		// Don't wait for the workers to get to this one
+		request->state = State::Decoding;
+
+		lock.unlock();
+		ImagePtr image = runDecode(identifier, request->decode);
+		lock.lock();
+
+		request->image = image;
+		request->state = State::Completed;
+		_finished.notify_all();
+	}
+	else
+	{
+		_finished.wait(lock, [&]() { return request->state == State::Completed; });
+	}
+
+	// Remove the request, it might have been dropped by clear() in the meantime
+	found = _requests.find(identifier);
+
+	if (found != _requests.end() && found->second == request)
+	{
+		_requests.erase(found);
+		_completed.erase(std::remove(_completed.begin(), _completed.end(), identifier), _completed.end());
+	}
+
+	return request->image;
+}
+
+void TextureDecoder::clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_requests.clear();
+	_completed.clear();
+}
+
+void TextureDecoder::processRequest(const std::string& identifier, const RequestPtr& request)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		// Skip requests which have been taken over by wait(), dropped or cancelled
+		if (_cancelled || request->state != State::Queued)
+		{
+			return;
+		}
+
+		Requests::iterator found = _requests.find(identifier);
+
+		if (found == _requests.end() || found->second != request)
+		{
+			return;
+		}
+
+		request->state = State::Decoding;
+	}
+
+	finishRequest(identifier, request, runDecode(identifier, request->decode));
+}
+
+void TextureDecoder::finishRequest(const std::string& identifier, const RequestPtr& request, const ImagePtr& image)
+{
+	CompletionCallback callback;
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		request->image = image;
+		request->state = State::Completed;
+
+		Requests::iterator found = _requests.find(identifier);
+
+		if (found != _requests.end() && found->second == request)
+		{
+			_completed.push_back(identifier);
+			callback = _onCompleted;
+		}
+	}
+
+	_finished.notify_all();
+
+	if (callback)
+	{
+		callback();
+	}
+}
+
+ImagePtr TextureDecoder::runDecode(const std::string& identifier, const DecodeFunction& decode)
+{
+	try
+	{
+		return decode();
+	}
+	catch (std::exception& ex)
+	{
+		rError() << "[shaders] Failed to decode texture " << identifier << ": "
+			<< ex.what() << std::endl;
+	}
+
+	return ImagePtr();
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "iimage.h"
+
+#include <map>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+namespace util { class ThreadPool; }
+
+namespace shaders
+{
+
+/**
+ * Runs image decode functions (image loading, map expression evaluation)
+ * on a pool of worker threads and collects the decoded images, so that the
+ * GL thread only needs to upload them.
+ *
+ * Requests are identified by the texture identifier, requesting an image
+ * which is already queued or being decoded does nothing. This class does
+ * not touch OpenGL and can be used without a GL context.
+ */
+class TextureDecoder
+{
+public:
+	typedef std::function<ImagePtr()> DecodeFunction;
+
+	// Invoked on the worker thread after a request has been decoded
+	typedef std::function<void()> CompletionCallback;
+
+	struct Result
+	{
+		std::string identifier;
+		ImagePtr image; // empty if the decode failed
+	};
+
+private:
+	enum class State
+	{
+		Queued,
+		Decoding,
+		Completed
+	};
+
+	struct Request
+	{
+		DecodeFunction decode;
+		State state;
+		ImagePtr image;
+	};
+
+	typedef std::shared_ptr<Request> RequestPtr;
+
+	typedef std::map<std::string, RequestPtr> Requests;
+	Requests _requests;
+
+	// Identifiers of the completed requests, in completion order
+	std::deque<std::string> _completed;
+
+	CompletionCallback _onCompleted;
+
+	bool _cancelled;
+
+	mutable std::mutex _lock;
+	std::condition_variable _finished;
+
+	// Declared last, to let the workers finish before the members above are gone
+	std::unique_ptr<util::ThreadPool> _pool;
+
+public:
+	// Construct a decoder with the given amount of worker threads,
+	// 0 leaves one hardware thread for the GL thread
+	TextureDecoder(std::size_t numThreads = 0);
+
+	// Drops all requests which have not been started yet and waits for the running ones
+	~TextureDecoder();
+
+	void setCompletionCallback(const CompletionCallback& callback);
+
+	// Queues the given decode function, unless the identifier is already pending
+	void request(const std::string& identifier, const DecodeFunction& decode);
+
+	// True if the identifier has been requested and not been taken yet
+	bool isPending(const std::string& identifier) const;
+
+	// The number of requests which have not been taken yet
+	std::size_t getNumPending() const;
+
+	// True if there are decoded images waiting to be taken
+	bool hasCompleted() const;
+
+	/**
+	 * Removes the oldest decoded image from the queue and returns it in
+	 * <result>. Returns false if there is no decoded image available.
+	 */
+	bool takeCompleted(Result& result);
+
+	/**
+	 * Returns the image of the given request, blocking until it is decoded.
+	 * A request which has not been started yet is decoded on the calling
+	 * thread. The request is removed from the decoder.
+	 */
+	ImagePtr wait(const std::string& identifier);
+
+	// Drops all requests which have not been taken yet
+	void clear();
+
+private:
+	void processRequest(const std::string& identifier, const RequestPtr& request);
+
+	// Stores the decoded image, unless the request has been dropped in the meantime
+	void finishRequest(const std::string& identifier, const RequestPtr& request, const ImagePtr& image);
+
+	// Runs the decode function, catching any exceptions it throws
+	ImagePtr runDecode(const std::string& identifier, const DecodeFunction& decode);
+};
+
+} // namespace
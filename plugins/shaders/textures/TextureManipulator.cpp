@@ -8,12 +8,12 @@
 #include "ipreferencesystem.h"
 #include "../Doom3ShaderSystem.h"
 #include "RGBAImage.h"
+#include "ImageKernels.h"
+
+#include <vector>
 
 namespace 
 {
-	static byte *row1 = NULL, *row2 = NULL;
-	static std::size_t rowsize = 0;
-
 	const std::size_t MAX_TEXTURE_QUALITY = 3;
 
 	const std::string RKEY_TEXTURES_QUALITY = "user/ui/textures/quality";
@@ -294,24 +294,18 @@ R_ResampleTexture
 void TextureManipulator::resampleTexture(const void *indata, std::size_t inwidth, std::size_t inheight,
 										 void *outdata,  std::size_t outwidth, std::size_t outheight, int bytesperpixel)
 {
-	if (rowsize < outwidth * bytesperpixel) {
-		if (row1)
-			free(row1);
-		if (row2)
-			free(row2);
-
-		rowsize = outwidth * bytesperpixel;
-		row1 = (byte *)malloc(rowsize);
-		row2 = (byte *)malloc(rowsize);
-	}
+	// Per-call row buffers, map expressions are resampled on the texture decoder threads
+	std::vector<byte> rowBuffer1(outwidth * bytesperpixel);
+	std::vector<byte> rowBuffer2(outwidth * bytesperpixel);
+
+	byte* row1 = &rowBuffer1.front();
+	byte* row2 = &rowBuffer2.front();
 
 	if (bytesperpixel == 4) {
 		std::size_t i, yi, oldy, f, fstep, lerp, endy = (inheight-1), inwidth4 = inwidth*4, outwidth4 = outwidth*4;
-		long j;
 		byte *inrow, *out;
 		out = (byte *)outdata;
 		fstep = (int) (inheight * 65536.0f / outheight);
-#define LERPBYTE(i) out[i] = (byte) ((((row2[i] - row1[i]) * lerp) >> 16) + row1[i])
 
 		inrow = (byte *)indata;
 		oldy = 0;
@@ -332,53 +326,8 @@ void TextureManipulator::resampleTexture(const void *indata, std::size_t inwidth
 					resampleTextureLerpLine(inrow + inwidth4, row2, inwidth, outwidth, bytesperpixel);
 					oldy = yi;
 				}
-				j = static_cast<long>(outwidth - 4);
-				while (j >= 0) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					LERPBYTE( 3);
-					LERPBYTE( 4);
-					LERPBYTE( 5);
-					LERPBYTE( 6);
-					LERPBYTE( 7);
-					LERPBYTE( 8);
-					LERPBYTE( 9);
-					LERPBYTE(10);
-					LERPBYTE(11);
-					LERPBYTE(12);
-					LERPBYTE(13);
-					LERPBYTE(14);
-					LERPBYTE(15);
-					out += 16;
-					row1 += 16;
-					row2 += 16;
-					j -= 4;
-				}
-				if (j & 2) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					LERPBYTE( 3);
-					LERPBYTE( 4);
-					LERPBYTE( 5);
-					LERPBYTE( 6);
-					LERPBYTE( 7);
-					out += 8;
-					row1 += 8;
-					row2 += 8;
-				}
-				if (j & 1) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					LERPBYTE( 3);
-					out += 4;
-					row1 += 4;
-					row2 += 4;
-				}
-				row1 -= outwidth4;
-				row2 -= outwidth4;
+				kernels::lerpRows(row1, row2, out, outwidth4, lerp);
+				out += outwidth4;
 			}
 			else {
 				if (yi != oldy) {
@@ -396,11 +345,9 @@ void TextureManipulator::resampleTexture(const void *indata, std::size_t inwidth
 	}
 	else if (bytesperpixel == 3) {
 		std::size_t i, yi, oldy, f, fstep, lerp, endy = (inheight-1), inwidth3 = inwidth * 3, outwidth3 = outwidth * 3;
-		long j;
 		byte *inrow, *out;
 		out = (byte *)outdata;
 		fstep = (int) (inheight*65536.0f/outheight);
-#define LERPBYTE(i) out[i] = (byte) ((((row2[i] - row1[i]) * lerp) >> 16) + row1[i])
 
 		inrow = (byte *)indata;
 		oldy = 0;
@@ -420,46 +367,8 @@ void TextureManipulator::resampleTexture(const void *indata, std::size_t inwidth
 					resampleTextureLerpLine(inrow + inwidth3, row2, inwidth, outwidth, bytesperpixel);
 					oldy = yi;
 				}
-				j = static_cast<long>(outwidth - 4);
-				while (j >= 0) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					LERPBYTE( 3);
-					LERPBYTE( 4);
-					LERPBYTE( 5);
-					LERPBYTE( 6);
-					LERPBYTE( 7);
-					LERPBYTE( 8);
-					LERPBYTE( 9);
-					LERPBYTE(10);
-					LERPBYTE(11);
-					out += 12;
-					row1 += 12;
-					row2 += 12;
-					j -= 4;
-				}
-				if (j & 2) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					LERPBYTE( 3);
-					LERPBYTE( 4);
-					LERPBYTE( 5);
-					out += 6;
-					row1 += 6;
-					row2 += 6;
-				}
-				if (j & 1) {
-					LERPBYTE( 0);
-					LERPBYTE( 1);
-					LERPBYTE( 2);
-					out += 3;
-					row1 += 3;
-					row2 += 3;
-				}
-				row1 -= outwidth3;
-				row2 -= outwidth3;
+				kernels::lerpRows(row1, row2, out, outwidth3, lerp);
+				out += outwidth3;
 			}
 			else {
 				if (yi != oldy) {
@@ -559,6 +468,8 @@ void TextureManipulator::constructPreferences() {
 
 	// Texture Gamma Settings
 	page->appendSpinner("Texture Gamma", RKEY_TEXTURES_GAMMA, 0.0f, 1.0f, 10);
+
+	page->appendCheckBox("", "Load textures in the background", RKEY_TEXTURES_ASYNC_LOADING);
 }
 
 } // namespace shaders
@@ -3,8 +3,10 @@
 #include "itextstream.h"
 #include "ifilesystem.h"
 #include "iarchive.h"
+#include "parser/BufferedDefTokeniser.h"
 
 #include <iostream>
+#include <iterator>
 
 namespace skins
 {
@@ -90,8 +92,10 @@ void Doom3SkinCache::loadSkinFiles()
 // Parse the contents of a .skin file
 void Doom3SkinCache::parseFile(std::istream& contents, const std::string& filename)
 {
-    // Construct a DefTokeniser to parse the file
-	parser::BasicDefTokeniser<std::istream> tok(contents);
+    // Read the file at once and construct a DefTokeniser working on the buffer
+	std::string buffer((std::istreambuf_iterator<char>(contents)), std::istreambuf_iterator<char>());
+
+	parser::BufferedDefTokeniser tok(buffer);
 
 	// Call the parseSkin() function for each skin decl
 	while (tok.hasMoreTokens())
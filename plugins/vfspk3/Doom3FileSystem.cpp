@@ -16,6 +16,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <chrono>
+#include <vector>
 
 #include "iradiant.h"
 #include "idatastream.h"
@@ -28,6 +30,7 @@
 #include "os/dir.h"
 #include "archivelib.h"
 #include "moduleobservers.h"
+#include "util/ThreadPool.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -92,11 +95,14 @@ void Doom3FileSystem::initDirectory(const std::string& inputPath)
     // Get the ArchiveLoader and try to load each file
     ArchiveLoader& archiveModule = GlobalArchive("PK4");
 
-    // add the entries to the vfs
+    // Assemble the filenames, the archives are added in this order
+    std::vector<std::string> filenames;
+
     for (SortedFilenames::iterator i = filenameList.begin(); i != filenameList.end(); ++i) {
-        // Assemble the filename and try to load the archive
-        initPakFile(archiveModule, path + *i);
+        filenames.push_back(path + *i);
     }
+
+    initPakFiles(archiveModule, filenames);
 }
 
 void Doom3FileSystem::initialise()
@@ -126,6 +132,8 @@ void Doom3FileSystem::initialise()
         initDirectory(*i);
     }
 
+    buildIndex();
+
     for (ObserverList::iterator i = _observers.begin(); i != _observers.end(); ++i)
     {
         (*i)->onFileSystemInitialise();
@@ -140,10 +148,31 @@ void Doom3FileSystem::shutdown() {
 
     rMessage() << "filesystem shutdown" << std::endl;
 
+    _index.clear();
     _archives.clear();
     _numDirectories = 0;
 }
 
+void Doom3FileSystem::buildIndex()
+{
+    _index.clear();
+
+    std::size_t numPakFiles = 0;
+
+    // The loose directories can change at any time, they are searched live
+    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i)
+    {
+        if (i->is_pakfile)
+        {
+            _index.addArchive(*i->archive);
+            ++numPakFiles;
+        }
+    }
+
+    rMessage() << "[vfs] indexed " << _index.size() << " files in "
+        << numPakFiles << " pak files" << std::endl;
+}
+
 void Doom3FileSystem::addObserver(Observer& observer) {
     _observers.insert(&observer);
 }
@@ -153,11 +182,12 @@ void Doom3FileSystem::removeObserver(Observer& observer) {
 }
 
 int Doom3FileSystem::getFileCount(const std::string& filename) {
-    int count = 0;
-    std::string fixedFilename(os::standardPathWithSlash(filename));
+    const FileIndex::Entry* entry = _index.find(filename);
+
+    int count = entry != NULL ? entry->archiveCount : 0;
 
     for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
-        if (i->archive->containsFile(fixedFilename.c_str())) {
+        if (!i->is_pakfile && i->archive->containsFile(filename)) {
             ++count;
         }
     }
@@ -171,7 +201,24 @@ ArchiveFilePtr Doom3FileSystem::openFile(const std::string& filename) {
         return ArchiveFilePtr();
     }
 
+    // The first pak file containing this file, if any
+    const FileIndex::Entry* entry = _index.find(filename);
+
+    // Loose directories before that pak file in the search order take precedence
     for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
+        if (i->is_pakfile) {
+            if (entry == NULL || i->archive.get() != entry->archive) {
+                continue;
+            }
+
+            ArchiveFilePtr file = entry->archive->openFile(entry->name);
+            if (file != NULL) {
+                return file;
+            }
+
+            continue;
+        }
+
         ArchiveFilePtr file = i->archive->openFile(filename);
         if (file != NULL) {
             return file;
@@ -195,7 +242,23 @@ ArchiveFilePtr Doom3FileSystem::openFileInAbsolutePath(const std::string& filena
 }
 
 ArchiveTextFilePtr Doom3FileSystem::openTextFile(const std::string& filename) {
+    const FileIndex::Entry* entry = _index.find(filename);
+
+    // Same search order as openFile()
     for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
+        if (i->is_pakfile) {
+            if (entry == NULL || i->archive.get() != entry->archive) {
+                continue;
+            }
+
+            ArchiveTextFilePtr file = entry->archive->openTextFile(entry->name);
+            if (file != NULL) {
+                return file;
+            }
+
+            continue;
+        }
+
         ArchiveTextFilePtr file = i->archive->openTextFile(filename);
         if (file != NULL) {
             return file;
@@ -250,19 +313,38 @@ void Doom3FileSystem::forEachFile(const std::string& basedir,
                                   const VisitorFunc& visitorFunc,
                                   std::size_t depth)
 {
+    // The indexed pak files, in the order of the archives
+    std::vector<std::pair<std::string, const Archive*> > pakFiles;
+
+    _index.forEachFile(basedir, extension, [&](const std::string& name, const FileIndex::Entry& entry)
+    {
+        pakFiles.push_back(std::make_pair(name, entry.archive));
+    }, depth);
+
     // Set of visited files, to avoid name conflicts
     std::set<std::string> visitedFiles;
 
     // Wrap around the passed visitor
     FileVisitor visitor2(visitorFunc, basedir, extension, visitedFiles);
 
-    // Visit each Archive, applying the FileVisitor to each one (which in
-    // turn calls the callback for each matching file.
-    for (ArchiveList::iterator i = _archives.begin();
-         i != _archives.end();
-         ++i)
+    std::vector<std::pair<std::string, const Archive*> >::const_iterator pakFile = pakFiles.begin();
+
+    // Merge the pak files with the current contents of the loose directories
+    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i)
     {
-        i->archive->forEachFile(Archive::VisitorFunc(visitor2, Archive::eFiles, depth), basedir);
+        if (!i->is_pakfile)
+        {
+            i->archive->forEachFile(Archive::VisitorFunc(visitor2, Archive::eFiles, depth), basedir);
+            continue;
+        }
+
+        for (; pakFile != pakFiles.end() && pakFile->second == i->archive.get(); ++pakFile)
+        {
+            if (visitedFiles.insert(pakFile->first).second)
+            {
+                visitorFunc(pakFile->first);
+            }
+        }
     }
 }
 
@@ -283,6 +365,7 @@ void Doom3FileSystem::forEachFileInAbsolutePath(const std::string& path,
 }
 
 std::string Doom3FileSystem::findFile(const std::string& name) {
+    // Only the loose directories are of interest, search them live
     for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
         if (!i->is_pakfile && i->archive->containsFile(name.c_str())) {
             return i->name;
@@ -302,35 +385,93 @@ std::string Doom3FileSystem::findRoot(const std::string& name) {
     return "";
 }
 
-void Doom3FileSystem::initPakFile(ArchiveLoader& archiveModule, const std::string& filename)
+void Doom3FileSystem::initPakFiles(ArchiveLoader& archiveModule, const std::vector<std::string>& filenames)
 {
-    std::string fileExt(os::getExtension(filename));
-    boost::to_lower(fileExt);
+    typedef std::chrono::steady_clock Clock;
 
-    if (_allowedExtensions.find(fileExt) != _allowedExtensions.end())
+    struct PakFile
     {
-        // Matched extension for archive (e.g. "pk3", "pk4")
-        ArchiveDescriptor entry;
+        ArchivePtr archive;
+        bool isDirectory;
+        Clock::duration loadTime;
+    };
 
-        entry.name = filename;
-        entry.archive = archiveModule.openArchive(filename);
-        entry.is_pakfile = true;
-        _archives.push_back(entry);
+    std::vector<PakFile> pakFiles(filenames.size());
+    std::vector<std::size_t> archivesToOpen;
+
+    for (std::size_t i = 0; i < filenames.size(); ++i)
+    {
+        std::string fileExt(os::getExtension(filenames[i]));
+        boost::to_lower(fileExt);
+
+        pakFiles[i].isDirectory = false;
+
+        if (_allowedExtensions.find(fileExt) != _allowedExtensions.end())
+        {
+            // Matched extension for archive (e.g. "pk3", "pk4"), open it below
+            archivesToOpen.push_back(i);
+        }
+        else if (_allowedExtensionsDir.find(fileExt) != _allowedExtensionsDir.end())
+        {
+            // Matched extension for archive dir (e.g. "pk3dir", "pk4dir")
+            pakFiles[i].archive = DirectoryArchivePtr(
+                new DirectoryArchive(os::standardPathWithSlash(filenames[i])));
+            pakFiles[i].isDirectory = true;
+        }
+    }
+
+    // Reading the central directories is mostly waiting for the disk,
+    // open the archives in parallel
+    Clock::time_point scanStart = Clock::now();
+
+    {
+        util::ThreadPool pool;
+
+        pool.parallelFor(archivesToOpen.size(), [&](std::size_t i)
+        {
+            PakFile& pakFile = pakFiles[archivesToOpen[i]];
 
-        rMessage() << "[vfs] pak file: " << filename << std::endl;
+            Clock::time_point start = Clock::now();
+            pakFile.archive = archiveModule.openArchive(filenames[archivesToOpen[i]]);
+            pakFile.loadTime = Clock::now() - start;
+        });
     }
-    else if (_allowedExtensionsDir.find(fileExt) != _allowedExtensionsDir.end())
+
+    Clock::duration scanTime = Clock::now() - scanStart;
+
+    // Add the archives in the order of their filenames
+    for (std::size_t i = 0; i < filenames.size(); ++i)
     {
-        // Matched extension for archive dir (e.g. "pk3dir", "pk4dir")
+        if (!pakFiles[i].archive)
+        {
+            continue;
+        }
+
         ArchiveDescriptor entry;
 
-        std::string path = os::standardPathWithSlash(filename);
-        entry.name = path;
-        entry.archive = DirectoryArchivePtr(new DirectoryArchive(path));
-        entry.is_pakfile = false;
+        entry.name = pakFiles[i].isDirectory ?
+            os::standardPathWithSlash(filenames[i]) : filenames[i];
+        entry.archive = pakFiles[i].archive;
+        entry.is_pakfile = !pakFiles[i].isDirectory;
         _archives.push_back(entry);
 
-        rMessage() << "[vfs] pak dir:  " << path << std::endl;
+        if (entry.is_pakfile)
+        {
+            rMessage() << "[vfs] pak file: " << entry.name << " ("
+                << std::chrono::duration_cast<std::chrono::milliseconds>(pakFiles[i].loadTime).count()
+                << " ms)" << std::endl;
+        }
+        else
+        {
+            rMessage() << "[vfs] pak dir:  " << entry.name << std::endl;
+        }
+    }
+
+    if (!archivesToOpen.empty())
+    {
+        rMessage() << "[vfs] opened " << archivesToOpen.size() << " pak files in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(scanTime).count()
+            << " ms" << std::endl;
     }
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include "iarchive.h"
 #include "ifilesystem.h"
+#include "FileIndex.h"
 
 #define VFS_MAXDIRS 8
 
@@ -23,6 +25,9 @@ class Doom3FileSystem :
 	typedef std::list<ArchiveDescriptor> ArchiveList;
 	ArchiveList _archives;
 
+	// Path => pak file lookup table, rebuilt on each initialise()
+	FileIndex _index;
+
 	typedef std::set<Observer*> ObserverList;
 	ObserverList _observers;
 
@@ -66,6 +71,10 @@ public:
 	virtual void initialiseModule(const ApplicationContext& ctx);
 
 private:
-	void initPakFile(ArchiveLoader& archiveModule, const std::string& filename);
+	// Opens the given archive files (and archive dirs), adding them in the given order
+	void initPakFiles(ArchiveLoader& archiveModule, const std::vector<std::string>& filenames);
+
+	// Indexes the files of the pak files, after they have been initialised
+	void buildIndex();
 };
 typedef std::shared_ptr<Doom3FileSystem> Doom3FileSystemPtr;
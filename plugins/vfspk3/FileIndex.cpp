@@ -0,0 +1,214 @@
+#include "FileIndex.h"
+
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+
+namespace
+{
+	// Lower-cases the ASCII characters of the given path, the archives are
+	// comparing their names case-insensitively as well
+	inline std::string foldPath(const std::string& path)
+	{
+		std::string folded(path);
+
+		for (std::string::iterator i = folded.begin(); i != folded.end(); ++i)
+		{
+			if (*i >= 'A' && *i <= 'Z')
+			{
+				*i += 'a' - 'A';
+			}
+		}
+
+		return folded;
+	}
+
+	// Collects the file names of an archive traversal
+	class IndexVisitor :
+		public Archive::Visitor
+	{
+	private:
+		std::vector<std::string>& _names;
+
+	public:
+		IndexVisitor(std::vector<std::string>& names) :
+			_names(names)
+		{}
+
+		void visit(const std::string& name)
+		{
+			_names.push_back(name);
+		}
+	};
+}
+
+void FileIndex::addArchive(Archive& archive)
+{
+	std::vector<std::string> names;
+	IndexVisitor visitor(names);
+
+	// Depth 0 never matches a directory level, so the whole tree is traversed
+	archive.forEachFile(Archive::VisitorFunc(visitor, Archive::eFiles, 0), "");
+
+	for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		insertFile(*i, archive);
+	}
+}
+
+void FileIndex::insertFile(const std::string& name, Archive& archive)
+{
+	std::string folded = foldPath(name);
+
+	EntryMap::iterator existing = _entries.find(folded);
+
+	if (existing != _entries.end())
+	{
+		// Shadowed by an archive further up in the search order
+		existing->second.archiveCount++;
+		return;
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.archive = &archive;
+	entry.archiveCount = 1;
+
+	// Pointers to the map values stay valid on rehash
+	const Entry& inserted = _entries.insert(EntryMap::value_type(folded, entry)).first->second;
+
+	std::size_t slash = folded.rfind('/');
+	Directory& dir = findOrInsertDirectory(slash == std::string::npos ? "" : folded.substr(0, slash + 1));
+
+	dir.files.push_back(_files.size());
+	_files.push_back(&inserted);
+}
+
+FileIndex::Directory& FileIndex::findOrInsertDirectory(const std::string& folded)
+{
+	DirectoryMap::iterator found = _directories.find(folded);
+
+	if (found != _directories.end())
+	{
+		return found->second;
+	}
+
+	Directory& dir = _directories[folded];
+
+	if (!folded.empty())
+	{
+		// Register with the parent, cutting off the trailing slash before searching
+		std::size_t slash = folded.rfind('/', folded.length() - 2);
+		std::string parentName = slash == std::string::npos ? "" : folded.substr(0, slash + 1);
+
+		findOrInsertDirectory(parentName).subdirectories.push_back(folded);
+	}
+
+	return dir;
+}
+
+void FileIndex::clear()
+{
+	_entries.clear();
+	_files.clear();
+	_directories.clear();
+}
+
+bool FileIndex::empty() const
+{
+	return _entries.empty();
+}
+
+std::size_t FileIndex::size() const
+{
+	return _files.size();
+}
+
+const FileIndex::Entry* FileIndex::find(const std::string& path) const
+{
+	EntryMap::const_iterator found = _entries.find(foldPath(path));
+
+	return found != _entries.end() ? &found->second : NULL;
+}
+
+void FileIndex::collectFiles(const Directory& dir, std::size_t level, std::size_t depth,
+							 std::vector<std::size_t>& files) const
+{
+	files.insert(files.end(), dir.files.begin(), dir.files.end());
+
+	// Like the archive visitors, a depth of 0 doesn't limit the traversal
+	if (depth != 0 && level + 1 >= depth)
+	{
+		return;
+	}
+
+	for (std::vector<std::string>::const_iterator i = dir.subdirectories.begin();
+		 i != dir.subdirectories.end(); ++i)
+	{
+		DirectoryMap::const_iterator sub = _directories.find(*i);
+
+		if (sub != _directories.end())
+		{
+			collectFiles(sub->second, level + 1, depth, files);
+		}
+	}
+}
+
+void FileIndex::forEachFile(const std::string& basedir, const std::string& extension,
+							const VisitorFunc& visitorFunc, std::size_t depth) const
+{
+	std::string folded = foldPath(basedir);
+
+	if (!folded.empty() && folded[folded.length() - 1] != '/')
+	{
+		folded += '/';
+	}
+
+	DirectoryMap::const_iterator dir = _directories.find(folded);
+
+	if (dir == _directories.end())
+	{
+		return;
+	}
+
+	std::vector<std::size_t> files;
+	collectFiles(dir->second, 0, depth, files);
+
+	// Restore the archive order across the directories
+	std::sort(files.begin(), files.end());
+
+	bool visitAll = extension == "*";
+	std::size_t extLength = extension.length();
+	std::size_t prefixLength = folded.length();
+
+	for (std::vector<std::size_t>::const_iterator i = files.begin(); i != files.end(); ++i)
+	{
+		// Cut off the base directory prefix
+		std::string subname = _files[*i]->name.substr(prefixLength);
+
+		// Check for matching file extension
+		if (!visitAll)
+		{
+			// The dot must be at the right position
+			if (subname.length() <= extLength ||
+				subname[subname.length() - extLength - 1] != '.')
+			{
+				continue;
+			}
+
+			// And the extension must match
+			std::string ext = subname.substr(subname.length() - extLength);
+
+#ifdef OS_CASE_INSENSITIVE
+			// Treat extensions case-insensitively in Windows
+			boost::to_lower(ext);
+#endif
+
+			if (ext != extension)
+			{
+				continue; // extension mismatch
+			}
+		}
+
+		visitorFunc(subname, *_files[*i]);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "iarchive.h"
+#include "ifilesystem.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * A flat index of the files in the pak archives of the VFS, built once after
+ * the archives have been initialised. Every path (case-folded) maps to the
+ * archive providing it, which spares the file system from querying each
+ * archive on every lookup.
+ *
+ * Archives have to be added in search order, the first archive containing
+ * a file wins. Only archives which can't change while the application is
+ * running belong in here, the loose directories are searched live.
+ */
+class FileIndex
+{
+public:
+	struct Entry
+	{
+		// The file name as stored in the winning archive (mixed case)
+		std::string name;
+
+		// The archive providing this file
+		Archive* archive;
+
+		// The number of indexed archives containing this file
+		int archiveCount;
+	};
+
+	// Receives the file name relative to the base directory and the index entry
+	typedef std::function<void(const std::string&, const Entry&)> VisitorFunc;
+
+private:
+	// Case-folded path => Entry
+	typedef std::unordered_map<std::string, Entry> EntryMap;
+	EntryMap _entries;
+
+	// All entries in the order they have been encountered
+	std::vector<const Entry*> _files;
+
+	struct Directory
+	{
+		// Indices into _files, in ascending order
+		std::vector<std::size_t> files;
+
+		// Case-folded names of the immediate subdirectories, including trailing slash
+		std::vector<std::string> subdirectories;
+	};
+
+	// Case-folded directory name (with trailing slash, "" for the root) => Directory
+	typedef std::unordered_map<std::string, Directory> DirectoryMap;
+	DirectoryMap _directories;
+
+public:
+	// Adds all files of the given archive to the index. The archive is
+	// referenced by the index and needs to stay alive.
+	void addArchive(Archive& archive);
+
+	// Removes all entries
+	void clear();
+
+	bool empty() const;
+
+	// The number of unique files
+	std::size_t size() const;
+
+	// Returns the entry for the given path (case-insensitively) or NULL if not indexed
+	const Entry* find(const std::string& path) const;
+
+	// Calls the visitor for each file below the given directory matching the extension,
+	// with the same semantics as VirtualFileSystem::forEachFile(). Every file is visited
+	// only once, in the order of the archives.
+	void forEachFile(const std::string& basedir, const std::string& extension,
+					 const VisitorFunc& visitorFunc, std::size_t depth) const;
+
+private:
+	void insertFile(const std::string& name, Archive& archive);
+
+	// Returns the directory, creating it and its parents if necessary
+	Directory& findOrInsertDirectory(const std::string& folded);
+
+	// Gathers the file indices of the given directory and its subdirectories up to the given depth
+	void collectFiles(const Directory& dir, std::size_t level, std::size_t depth,
+					  std::vector<std::size_t>& files) const;
+};
@@ -10,17 +10,14 @@
 #include "BrushNode.h"
 #include "Face.h"
 #include "FixedWinding.h"
+#include "WindingConnectivity.h"
 #include "math/Ray.h"
 #include "ui/surfaceinspector/SurfaceInspector.h"
+#include "util/ThreadPool.h"
 
 #include <functional>
 
 namespace {
-    /// \brief Returns true if edge (\p x, \p y) is smaller than the epsilon used to classify winding points against a plane.
-    inline bool Edge_isDegenerate(const Vector3& x, const Vector3& y) {
-        return (y - x).getLengthSquared() < (ON_EPSILON * ON_EPSILON);
-    }
-
     inline float max_extent_2d(const Vector3& extents, int axis)
     {
         switch(axis)
@@ -35,6 +32,17 @@ namespace {
     {
         return std::max(std::max(extents[0], extents[1]), extents[2]);
     }
+
+    // Values of Brush::_pendingBRepIndex for brushes not in the pending list
+    const std::size_t NOT_PENDING = static_cast<std::size_t>(-1);
+    const std::size_t IN_EVALUATION = static_cast<std::size_t>(-2);
+
+    // Smaller batches are evaluated in the calling thread
+    const std::size_t MIN_PARALLEL_BREPS = 32;
+
+    // The brushes with changed planes, waiting for evaluatePendingBReps().
+    // Only the main thread creates and modifies brushes, no locking needed.
+    BrushVector pendingBReps;
 }
 
 const std::size_t Brush::PRISM_MIN_SIDES = 3;
@@ -56,6 +64,7 @@ Brush::Brush(BrushNode& owner, const Callback& evaluateTransform) :
     m_evaluateTransform(evaluateTransform),
     m_planeChanged(false),
     m_transformChanged(false),
+    _pendingBRepIndex(NOT_PENDING),
 	_detailFlag(Structural)
 {
     onFacePlaneChanged();
@@ -71,6 +80,7 @@ Brush::Brush(BrushNode& owner, const Brush& other, const Callback& evaluateTrans
     m_evaluateTransform(evaluateTransform),
     m_planeChanged(false),
     m_transformChanged(false),
+    _pendingBRepIndex(NOT_PENDING),
 	_detailFlag(Structural)
 {
     copy(other);
@@ -78,6 +88,8 @@ Brush::Brush(BrushNode& owner, const Brush& other, const Callback& evaluateTrans
 
 Brush::~Brush()
 {
+    unqueueBRepEvaluation();
+
     ASSERT_MESSAGE(m_observers.empty(), "Brush::~Brush: observers still attached");
 }
 
@@ -226,6 +238,86 @@ void Brush::evaluateBRep() const {
     }
 }
 
+void Brush::evaluatePendingBReps(util::ThreadPool& pool)
+{
+    BrushVector brushes;
+
+    brushes.swap(pendingBReps);
+
+    // The brushes stay marked as pending until they're done,
+    // such that plane changes don't queue them again
+    for (Brush* brush : brushes)
+    {
+        brush->_pendingBRepIndex = IN_EVALUATION;
+    }
+
+    // Apply pending transforms first, this notifies the nodes
+    for (Brush* brush : brushes)
+    {
+        brush->evaluateTransform();
+    }
+
+    // Building the windings only involves the brush itself, the brushes
+    // that have been evaluated on demand in the meantime are skipped
+    std::vector<char> degenerate(brushes.size(), 0);
+
+    auto buildWindings = [&] (std::size_t i)
+    {
+        if (brushes[i]->m_planeChanged)
+        {
+            degenerate[i] = brushes[i]->buildWindings();
+        }
+    };
+
+    if (brushes.size() >= MIN_PARALLEL_BREPS)
+    {
+        pool.parallelFor(brushes.size(), buildWindings);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < brushes.size(); ++i)
+        {
+            buildWindings(i);
+        }
+    }
+
+    for (std::size_t i = 0; i < brushes.size(); ++i)
+    {
+        Brush& brush = *brushes[i];
+
+        brush._pendingBRepIndex = NOT_PENDING;
+
+        if (brush.m_planeChanged)
+        {
+            brush.m_planeChanged = false;
+            brush.buildBRepFromWindings(degenerate[i] != 0);
+        }
+    }
+}
+
+void Brush::queueBRepEvaluation()
+{
+    if (_pendingBRepIndex == NOT_PENDING)
+    {
+        _pendingBRepIndex = pendingBReps.size();
+        pendingBReps.push_back(this);
+    }
+}
+
+void Brush::unqueueBRepEvaluation()
+{
+    if (_pendingBRepIndex < pendingBReps.size())
+    {
+        // Move the last brush into our place
+        Brush* last = pendingBReps.back();
+        pendingBReps[_pendingBRepIndex] = last;
+        last->_pendingBRepIndex = _pendingBRepIndex;
+        pendingBReps.pop_back();
+    }
+
+    _pendingBRepIndex = NOT_PENDING;
+}
+
 void Brush::transformChanged() {
     m_transformChanged = true;
     onFacePlaneChanged();
@@ -451,6 +543,11 @@ void Brush::erase(std::size_t index)
 
 void Brush::onFacePlaneChanged()
 {
+    if (!m_planeChanged)
+    {
+        queueBRepEvaluation();
+    }
+
     m_planeChanged = true;
     aabbChanged();
     _owner.lightsChanged();
@@ -949,124 +1046,6 @@ bool Brush::plane_unique(std::size_t index) const {
     return true;
 }
 
-/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
-void Brush::removeDegenerateEdges() {
-    for (std::size_t i = 0;  i < m_faces.size(); ++i) {
-        Winding& winding = m_faces[i]->getWinding();
-
-        for (std::size_t index = 0; index < winding.size();) {
-            //std::size_t index = std::distance(winding.begin(), j);
-            std::size_t next = winding.next(index);
-
-            if (Edge_isDegenerate(winding[index].vertex, winding[next].vertex)) {
-                Winding& other = m_faces[winding[index].adjacent]->getWinding();
-                std::size_t adjacent = other.findAdjacent(i);
-                if (adjacent != c_brush_maxFaces) {
-                    other.erase(other.begin() + adjacent);
-                }
-
-                // Delete and leave index where it is
-                winding.erase(winding.begin() + index);
-            }
-            else {
-                ++index;
-            }
-        }
-    }
-}
-
-/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
-void Brush::removeDegenerateFaces() {
-    // save adjacency info for degenerate faces
-    for (std::size_t i = 0;  i < m_faces.size(); ++i) {
-        Winding& degen = m_faces[i]->getWinding();
-
-        if (degen.size() == 2) {
-            /*rConsole() << "Removed degenerate face: " << Vector3(m_faces[i]->getPlane().plane3().normal())
-                                << " - " << float(m_faces[i]->getPlane().plane3().dist()) << std::endl;*/
-
-            // this is an "edge" face, where the plane touches the edge of the brush
-            {
-                Winding& winding = m_faces[degen[0].adjacent]->getWinding();
-                std::size_t index = winding.findAdjacent(i);
-                if (index != c_brush_maxFaces) {
-                    winding[index].adjacent = degen[1].adjacent;
-                }
-            }
-
-            {
-                Winding& winding = m_faces[degen[1].adjacent]->getWinding();
-                std::size_t index = winding.findAdjacent(i);
-
-                if (index != c_brush_maxFaces) {
-                    winding[index].adjacent = degen[0].adjacent;
-                }
-            }
-
-            degen.resize(0);
-        }
-    }
-}
-
-/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
-void Brush::removeDuplicateEdges() {
-    // verify face connectivity graph
-    for(std::size_t i = 0; i < m_faces.size(); ++i) {
-        //if(m_faces[i]->contributes())
-            {
-                Winding& winding = m_faces[i]->getWinding();
-                for (std::size_t j = 0; j != winding.size();) {
-                    std::size_t next = winding.next(j);
-                    if (winding[j].adjacent == winding[next].adjacent) {
-                        winding.erase(winding.begin() + next);
-                    }
-                    else {
-                        ++j;
-                    }
-                }
-            }
-        }
-    }
-
-/// \brief Removes edges that do not have a matching pair in their adjacent-face.
-void Brush::verifyConnectivityGraph() {
-    // verify face connectivity graph
-    for (std::size_t i = 0; i < m_faces.size(); ++i) {
-        //if(m_faces[i]->contributes())
-        {
-            Winding& winding = m_faces[i]->getWinding();
-
-            for (std::size_t j = 0; j < winding.size();) {
-                WindingVertex& vertex = winding[j];
-
-                // remove unidirectional graph edges
-                if (vertex.adjacent == c_brush_maxFaces
-                    || m_faces[vertex.adjacent]->getWinding().findAdjacent(i) == c_brush_maxFaces)
-                {
-                    // Delete the offending vertex and leave the index j where it is
-                    winding.erase(winding.begin() + j);
-                }
-                else {
-                    ++j;
-                }
-            }
-
-            /*for (Winding::iterator j = winding.begin(); j != winding.end();) {
-                // remove unidirectional graph edges
-                if (j->adjacent == c_brush_maxFaces
-                    || m_faces[j->adjacent]->getWinding().findAdjacent(i) == c_brush_maxFaces)
-                {
-                    // Delete and return the new iterator
-                    j = winding.erase(j);
-                }
-                else {
-                    ++j;
-                }
-            }*/
-        }
-    }
-}
-
 /// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 bool Brush::isBounded() {
     for (const_iterator i = begin(); i != end(); ++i) {
@@ -1112,10 +1091,10 @@ bool Brush::buildWindings() {
     if (!degenerate) {
         // clean up connectivity information.
         // these cleanups must be applied in a specific order.
-        removeDegenerateEdges();
-        removeDegenerateFaces();
-        removeDuplicateEdges();
-        verifyConnectivityGraph();
+        brush::cleanupWindingConnectivity(m_faces.size(), [this] (std::size_t i) -> IWinding&
+        {
+            return m_faces[i]->getWinding();
+        });
     }
 
     return degenerate;
@@ -1166,7 +1145,10 @@ std::size_t ProximalVertexArray_index(const ProximalVertexArray& array, const Pr
 
 /// \brief Constructs the face windings and updates anything that depends on them.
 void Brush::buildBRep() {
-  bool degenerate = buildWindings();
+  buildBRepFromWindings(buildWindings());
+}
+
+void Brush::buildBRepFromWindings(bool degenerate) {
 
   static Vector3 colourVertexVec = ColourSchemes().getColour("brush_vertices");
   static const Colour4b colour_vertex(int(colourVertexVec[0]*255), int(colourVertexVec[1]*255),
@@ -12,6 +12,7 @@
 
 class RenderableCollector;
 class Ray;
+namespace util { class ThreadPool; }
 
 const std::size_t c_brush_maxFaces = 1024;
 
@@ -126,6 +127,9 @@ private:
 
 	mutable bool m_planeChanged; // b-rep evaluation required
 	mutable bool m_transformChanged; // transform evaluation required
+
+	// Position in the list of brushes waiting for evaluatePendingBReps()
+	std::size_t _pendingBRepIndex;
 	// ----
 
 	DetailFlag _detailFlag;
@@ -213,6 +217,15 @@ public:
 
 	void evaluateBRep() const;
 
+	/**
+	 * Rebuilds the b-reps of all brushes whose planes changed since the last
+	 * call. The windings of the brushes are built in parallel using the given
+	 * pool, the rest of the b-rep is done in the calling thread, which must
+	 * be the main thread. Brushes not handled here are evaluated one by one
+	 * when they are first queried.
+	 */
+	static void evaluatePendingBReps(util::ThreadPool& pool);
+
     void transformChanged();
     void evaluateTransform();
 
@@ -315,18 +328,6 @@ private:
 	/// \brief Returns true if the face identified by \p index is preceded by another plane that takes priority over it.
 	bool plane_unique(std::size_t index) const;
 
-	/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
-	void removeDegenerateEdges();
-
-	/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
-	void removeDegenerateFaces();
-
-	/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
-	void removeDuplicateEdges();
-
-	/// \brief Removes edges that do not have a matching pair in their adjacent-face.
-	void verifyConnectivityGraph();
-
 	/// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 	bool isBounded();
 
@@ -335,6 +336,13 @@ private:
 
 	/// \brief Constructs the face windings and updates anything that depends on them.
 	void buildBRep();
+
+	/// \brief Updates everything depending on the face windings, after they have been built.
+	void buildBRepFromWindings(bool degenerate);
+
+	// Adds this brush to the list of brushes waiting for a batched evaluation
+	void queueBRepEvaluation();
+	void unqueueBRepEvaluation();
 }; // class Brush
 
 typedef std::vector<Brush*> BrushVector;
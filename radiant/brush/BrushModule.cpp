@@ -18,9 +18,17 @@
 #include "modulesystem/StaticModule.h"
 
 #include "selection/algorithm/Primitives.h"
+#include "util/ThreadPool.h"
 
 // ---------------------------------------------------------------------------------------
 
+BrushModuleImpl::BrushModuleImpl() :
+	_textureLockEnabled(false)
+{}
+
+BrushModuleImpl::~BrushModuleImpl()
+{}
+
 void BrushModuleImpl::constructPreferences()
 {
 	// Add a page to the given group
@@ -43,6 +51,8 @@ void BrushModuleImpl::construct()
 
 void BrushModuleImpl::destroy()
 {
+	_brepPool.reset();
+
 	Brush::m_maxWorldCoord = 0;
 }
 
@@ -76,6 +86,16 @@ scene::INodePtr BrushModuleImpl::createBrush()
 	return node;
 }
 
+void BrushModuleImpl::evaluatePendingBReps()
+{
+	if (!_brepPool)
+	{
+		_brepPool.reset(new util::ThreadPool);
+	}
+
+	Brush::evaluatePendingBReps(*_brepPool);
+}
+
 // RegisterableModule implementation
 const std::string& BrushModuleImpl::getName() const {
 	static std::string _name(MODULE_BRUSHCREATOR);
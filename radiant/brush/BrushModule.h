@@ -6,20 +6,29 @@
 #include "brush/TexDef.h"
 #include "ibrush.h"
 
+#include <memory>
+
+namespace util { class ThreadPool; }
+
 class BrushModuleImpl : 
 	public BrushCreator
 {
 private:
 	bool _textureLockEnabled;
 
+	// Builds the brush windings in parallel, created on demand
+	std::unique_ptr<util::ThreadPool> _brepPool;
+
 private:
 	void keyChanged();
 
 	void registerBrushCommands();
 
 public:
+	BrushModuleImpl();
+
     // destructor
-	virtual ~BrushModuleImpl() {}
+	virtual ~BrushModuleImpl();
 
 	// This constructs the brush preferences, initialises static variables, etc.
 	void construct();
@@ -35,6 +44,8 @@ public:
 	// Creates a new brush node on the heap and returns it
 	scene::INodePtr createBrush();
 
+	void evaluatePendingBReps();
+
 	// ----------------------------------------------------------------------------------
 
 	// returns true if the texture lock is enabled
@@ -139,6 +139,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const;
+	AABB litObjectAABB() const;
 	void insertLight(const RendererLight& light);
 	void clearLights();
 
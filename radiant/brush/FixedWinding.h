@@ -3,7 +3,10 @@
 #include "math/Vector3.h"
 #include "math/Plane3.h"
 
-#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <boost/noncopyable.hpp>
 
 class Winding;
 
@@ -32,23 +35,92 @@ public:
 		edge(edge_),
 		adjacent(adjacent_)
 	{}
-
-	virtual ~FixedWindingVertex() {}
 };
 
 /**
- * greebo: A FixedWinding is a vector of FixedWindingVertices
- *         with a pre-allocated size of MAX_POINTS_ON_WINDING.
+ * greebo: A FixedWinding is a sequence of FixedWindingVertices used as
+ * scratch space when clipping polygons against the planes of a brush.
+ *
+ * The first MAX_POINTS_ON_WINDING vertices are stored inline, so building
+ * the windings of regular faces doesn't touch the heap at all. Only faces
+ * exceeding that number of vertices move their data to a heap buffer.
  */
 class FixedWinding :
-	public std::vector<FixedWindingVertex>
+	public boost::noncopyable
 {
+private:
+	typedef std::aligned_storage<sizeof(FixedWindingVertex),
+		std::alignment_of<FixedWindingVertex>::value>::type VertexStorage;
+
+	// Vertices are never destructed, clear() just forgets about them
+	static_assert(std::is_trivially_destructible<FixedWindingVertex>::value,
+		"FixedWindingVertex must be trivially destructible");
+
+	VertexStorage _inline[MAX_POINTS_ON_WINDING];
+	std::unique_ptr<VertexStorage[]> _heap;
+
+	FixedWindingVertex* _vertices;
+	std::size_t _size;
+	std::size_t _capacity;
+
 public:
-	FixedWinding() {
-		reserve(MAX_POINTS_ON_WINDING);
+	FixedWinding() :
+		_vertices(reinterpret_cast<FixedWindingVertex*>(_inline)),
+		_size(0),
+		_capacity(MAX_POINTS_ON_WINDING)
+	{}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	// Returns true if the vertices had to be moved out of the inline storage
+	bool isOnHeap() const
+	{
+		return _heap.get() != NULL;
+	}
+
+	void clear()
+	{
+		_size = 0;
+	}
+
+	void push_back(const FixedWindingVertex& vertex)
+	{
+		if (_size == _capacity)
+		{
+			grow();
+		}
+
+		new (_vertices + _size) FixedWindingVertex(vertex);
+		++_size;
+	}
+
+	FixedWindingVertex& operator[](std::size_t index)
+	{
+		return _vertices[index];
+	}
+
+	const FixedWindingVertex& operator[](std::size_t index) const
+	{
+		return _vertices[index];
+	}
+
+	FixedWindingVertex& back()
+	{
+		return _vertices[_size - 1];
 	}
 
-	virtual ~FixedWinding() {}
+	const FixedWindingVertex& back() const
+	{
+		return _vertices[_size - 1];
+	}
 
 	// Writes the FixedWinding data into the given Winding
 	void writeToWinding(Winding& winding);
@@ -61,4 +133,22 @@ public:
 	/// If \p winding is completely in back of the plane, \p clipped will be empty.
 	/// If \p winding intersects the plane, the edge of \p clipped which lies on \p clipPlane will store the value of \p adjacent.
 	void clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped);
+
+private:
+	void grow()
+	{
+		std::size_t newCapacity = _capacity * 2;
+		std::unique_ptr<VertexStorage[]> heap(new VertexStorage[newCapacity]);
+
+		FixedWindingVertex* vertices = reinterpret_cast<FixedWindingVertex*>(heap.get());
+
+		for (std::size_t i = 0; i < _size; ++i)
+		{
+			new (vertices + i) FixedWindingVertex(_vertices[i]);
+		}
+
+		_heap.swap(heap);
+		_vertices = vertices;
+		_capacity = newCapacity;
+	}
 };
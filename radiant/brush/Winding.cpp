@@ -190,19 +190,6 @@ BrushSplitType Winding::classifyPlane(const Plane3& plane) const
 	return split;
 }
 
-PlaneClassification Winding::classifyDistance(const float distance, const float epsilon)
-{
-	if (distance > epsilon) {
-		return ePlaneFront;
-	}
-
-	if (distance < -epsilon) {
-		return ePlaneBack;
-	}
-
-	return ePlaneOn;
-}
-
 bool Winding::planesConcave(const Winding& w1, const Winding& w2, const Plane3& plane1, const Plane3& plane2)
 {
 	return !w1.testPlane(plane2, false) || !w2.testPlane(plane1, false);
@@ -81,7 +81,18 @@ public:
 	// Returns the classification for the given plane
 	BrushSplitType classifyPlane(const Plane3& plane) const;
 
-	static PlaneClassification classifyDistance(const float distance, const float epsilon);
+	static PlaneClassification classifyDistance(const float distance, const float epsilon)
+	{
+		if (distance > epsilon) {
+			return ePlaneFront;
+		}
+
+		if (distance < -epsilon) {
+			return ePlaneBack;
+		}
+
+		return ePlaneOn;
+	}
 
 	/// \brief Returns true if
 	/// !flipped && winding is completely BACK or ON
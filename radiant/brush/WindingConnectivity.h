@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ibrush.h"
+#include "debugging/debugging.h"
+#include "Winding.h"
+
+/**
+ * The connectivity cleanup steps of Brush::buildWindings(), working on the
+ * windings of a set of faces. The CSG code applies them to plain windings to
+ * evaluate a volume exactly the way a Brush would.
+ *
+ * The windings are accessed through the given function, returning the
+ * IWinding of the face with the given index. The steps have to be applied
+ * in this order, and only if every winding vertex has an adjacent face.
+ */
+namespace brush
+{
+
+namespace detail
+{
+	inline std::size_t nextIndex(const IWinding& winding, std::size_t index)
+	{
+		return (index + 1) % winding.size();
+	}
+
+	// Same as Winding::findAdjacent()
+	inline std::size_t findAdjacent(const IWinding& winding, std::size_t face)
+	{
+		for (std::size_t i = 0; i < winding.size(); ++i)
+		{
+			ASSERT_MESSAGE(winding[i].adjacent != c_brush_maxFaces, "edge connectivity data is invalid");
+
+			if (winding[i].adjacent == face)
+			{
+				return i;
+			}
+		}
+
+		return c_brush_maxFaces;
+	}
+}
+
+/// \brief Returns true if edge (\p x, \p y) is smaller than the epsilon used to classify winding points against a plane.
+inline bool Edge_isDegenerate(const Vector3& x, const Vector3& y)
+{
+	return (y - x).getLengthSquared() < (ON_EPSILON * ON_EPSILON);
+}
+
+/// \brief Removes edges that are smaller than the tolerance used when generating brush windings.
+template<typename WindingAccessor>
+void removeDegenerateEdges(std::size_t numFaces, const WindingAccessor& getWinding)
+{
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		IWinding& winding = getWinding(i);
+
+		for (std::size_t index = 0; index < winding.size();)
+		{
+			std::size_t next = detail::nextIndex(winding, index);
+
+			if (Edge_isDegenerate(winding[index].vertex, winding[next].vertex))
+			{
+				IWinding& other = getWinding(winding[index].adjacent);
+				std::size_t adjacent = detail::findAdjacent(other, i);
+
+				if (adjacent != c_brush_maxFaces)
+				{
+					other.erase(other.begin() + adjacent);
+				}
+
+				// Delete and leave index where it is
+				winding.erase(winding.begin() + index);
+			}
+			else
+			{
+				++index;
+			}
+		}
+	}
+}
+
+/// \brief Invalidates faces that have only two vertices in their winding, while preserving edge-connectivity information.
+template<typename WindingAccessor>
+void removeDegenerateFaces(std::size_t numFaces, const WindingAccessor& getWinding)
+{
+	// save adjacency info for degenerate faces
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		IWinding& degen = getWinding(i);
+
+		if (degen.size() == 2)
+		{
+			// this is an "edge" face, where the plane touches the edge of the brush
+			{
+				IWinding& winding = getWinding(degen[0].adjacent);
+				std::size_t index = detail::findAdjacent(winding, i);
+
+				if (index != c_brush_maxFaces)
+				{
+					winding[index].adjacent = degen[1].adjacent;
+				}
+			}
+
+			{
+				IWinding& winding = getWinding(degen[1].adjacent);
+				std::size_t index = detail::findAdjacent(winding, i);
+
+				if (index != c_brush_maxFaces)
+				{
+					winding[index].adjacent = degen[0].adjacent;
+				}
+			}
+
+			degen.resize(0);
+		}
+	}
+}
+
+/// \brief Removes edges that have the same adjacent-face as their immediate neighbour.
+template<typename WindingAccessor>
+void removeDuplicateEdges(std::size_t numFaces, const WindingAccessor& getWinding)
+{
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		IWinding& winding = getWinding(i);
+
+		for (std::size_t j = 0; j != winding.size();)
+		{
+			std::size_t next = detail::nextIndex(winding, j);
+
+			if (winding[j].adjacent == winding[next].adjacent)
+			{
+				winding.erase(winding.begin() + next);
+			}
+			else
+			{
+				++j;
+			}
+		}
+	}
+}
+
+/// \brief Removes edges that do not have a matching pair in their adjacent-face.
+template<typename WindingAccessor>
+void verifyConnectivityGraph(std::size_t numFaces, const WindingAccessor& getWinding)
+{
+	for (std::size_t i = 0; i < numFaces; ++i)
+	{
+		IWinding& winding = getWinding(i);
+
+		for (std::size_t j = 0; j < winding.size();)
+		{
+			WindingVertex& vertex = winding[j];
+
+			// remove unidirectional graph edges
+			if (vertex.adjacent == c_brush_maxFaces ||
+				detail::findAdjacent(getWinding(vertex.adjacent), i) == c_brush_maxFaces)
+			{
+				// Delete the offending vertex and leave the index j where it is
+				winding.erase(winding.begin() + j);
+			}
+			else
+			{
+				++j;
+			}
+		}
+	}
+}
+
+/// \brief Applies all of the above, in the order Brush::buildWindings() does.
+template<typename WindingAccessor>
+void cleanupWindingConnectivity(std::size_t numFaces, const WindingAccessor& getWinding)
+{
+	removeDegenerateEdges(numFaces, getWinding);
+	removeDegenerateFaces(numFaces, getWinding);
+	removeDuplicateEdges(numFaces, getWinding);
+	verifyConnectivityGraph(numFaces, getWinding);
+}
+
+} // namespace brush
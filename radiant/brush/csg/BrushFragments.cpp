@@ -0,0 +1,220 @@
+#include "BrushFragments.h"
+
+#include "brush/Brush.h"
+#include "brush/FixedWinding.h"
+#include "brush/Winding.h"
+#include "brush/WindingConnectivity.h"
+
+namespace brush {
+namespace algorithm {
+
+ConvexVolume::ConvexVolume(const FragmentFaces& faces, double maxWorldCoord)
+{
+	// Planes preceded by another plane taking priority are ignored, like Brush::plane_unique()
+	std::vector<bool> unique(faces.size(), true);
+
+	for (std::size_t f = 0; f < faces.size(); ++f)
+	{
+		for (std::size_t i = 0; i < faces.size(); ++i)
+		{
+			if (f != i && !plane3_inside(faces[f].plane, faces[i].plane))
+			{
+				unique[f] = false;
+				break;
+			}
+		}
+	}
+
+	FixedWinding buffer[2];
+
+	_windings.resize(faces.size());
+
+	// Same as Brush::windingForClipPlane
+	for (std::size_t f = 0; f < faces.size(); ++f)
+	{
+		const Plane3& plane = faces[f].plane;
+
+		if (!plane.isValid() || !unique[f])
+		{
+			continue;
+		}
+
+		bool swap = false;
+
+		buffer[swap].clear();
+		buffer[swap].createInfinite(plane, maxWorldCoord + 1);
+
+		for (std::size_t i = 0; i < faces.size(); ++i)
+		{
+			const Plane3& clip = faces[i].plane;
+
+			if (clip == plane || !clip.isValid() || !unique[i] || plane == -clip)
+			{
+				continue;
+			}
+
+			buffer[!swap].clear();
+
+			// flip the plane, because we want to keep the back side
+			buffer[swap].clip(plane, Plane3(-clip.normal(), -clip.dist()), i, buffer[!swap]);
+
+			swap = !swap;
+		}
+
+		const FixedWinding& fixedWinding = buffer[swap];
+		IWinding& winding = _windings[f];
+
+		winding.resize(fixedWinding.size());
+
+		for (std::size_t i = 0; i < fixedWinding.size(); ++i)
+		{
+			winding[i].vertex = fixedWinding[i].vertex;
+			winding[i].adjacent = fixedWinding[i].adjacent;
+
+			// Like the brush bounds, these include the points removed below
+			_bounds.includePoint(winding[i].vertex);
+		}
+	}
+
+	// Same as Brush::buildWindings(), the connectivity is only cleaned up for bounded volumes
+	bool degenerate = false;
+
+	for (const IWinding& winding : _windings)
+	{
+		for (const WindingVertex& vertex : winding)
+		{
+			if (vertex.adjacent == c_brush_maxFaces)
+			{
+				degenerate = true;
+			}
+		}
+	}
+
+	if (!degenerate)
+	{
+		cleanupWindingConnectivity(_windings.size(), [this] (std::size_t i) -> IWinding&
+		{
+			return _windings[i];
+		});
+	}
+
+	// Same as Brush::buildBRepFromWindings(), volumes failing these checks end up with empty windings
+	std::size_t contributingFaces = 0;
+	std::size_t numVertices = 0;
+
+	for (const IWinding& winding : _windings)
+	{
+		if (winding.size() > 2)
+		{
+			++contributingFaces;
+		}
+
+		numVertices += winding.size();
+	}
+
+	if (degenerate || contributingFaces < 4 || numVertices % 2 != 0)
+	{
+		for (IWinding& winding : _windings)
+		{
+			winding.clear();
+		}
+	}
+}
+
+BrushSplitType ConvexVolume::classifyPlane(const Plane3& plane) const
+{
+	BrushSplitType split;
+
+	// Only the windings of contributing faces count, like in Brush_classifyPlane()
+	for (const IWinding& winding : _windings)
+	{
+		if (winding.size() <= 2)
+		{
+			continue;
+		}
+
+		for (const WindingVertex& vertex : winding)
+		{
+			++split.counts[Winding::classifyDistance(plane.distanceToPoint(vertex.vertex), ON_EPSILON)];
+		}
+	}
+
+	return split;
+}
+
+bool subtractVolume(const FragmentFaces& faces, const SubtractedVolume& volume,
+	double maxWorldCoord, std::vector<FragmentFaces>& fragments)
+{
+	ConvexVolume back(faces, maxWorldCoord);
+
+	if (!back.getBounds().isValid() || !back.getBounds().intersects(volume.bounds))
+	{
+		return false;
+	}
+
+	std::vector<FragmentFaces> newFragments;
+	newFragments.reserve(volume.faces.size());
+
+	FragmentFaces backFaces(faces);
+
+	for (const FragmentFace& face : volume.faces)
+	{
+		BrushSplitType split = back.classifyPlane(face.plane);
+
+		if (split.counts[ePlaneFront] != 0 && split.counts[ePlaneBack] != 0)
+		{
+			newFragments.push_back(backFaces);
+
+			// Brush::addFace() refuses to add more faces than that
+			if (backFaces.size() < c_brush_maxFaces)
+			{
+				newFragments.back().push_back(face.getFlipped());
+
+				backFaces.push_back(face);
+				back = ConvexVolume(backFaces, maxWorldCoord);
+			}
+		}
+		else if (split.counts[ePlaneBack] == 0)
+		{
+			return false;
+		}
+	}
+
+	fragments.insert(fragments.end(), newFragments.begin(), newFragments.end());
+	return true;
+}
+
+bool subtractVolumes(const FragmentFaces& faces, const std::vector<const SubtractedVolume*>& volumes,
+	double maxWorldCoord, std::vector<FragmentFaces>& fragments)
+{
+	std::vector<FragmentFaces> buffer[2];
+	std::size_t swap = 0;
+	bool changed = false;
+
+	buffer[swap].push_back(faces);
+
+	for (const SubtractedVolume* volume : volumes)
+	{
+		for (FragmentFaces& fragment : buffer[swap])
+		{
+			if (subtractVolume(fragment, *volume, maxWorldCoord, buffer[1 - swap]))
+			{
+				changed = true;
+			}
+			else
+			{
+				buffer[1 - swap].push_back(std::move(fragment));
+			}
+		}
+
+		buffer[swap].clear();
+		swap = 1 - swap;
+	}
+
+	fragments.swap(buffer[swap]);
+
+	return changed;
+}
+
+} // namespace algorithm
+} // namespace brush
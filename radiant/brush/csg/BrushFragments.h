@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+
+#include "iclipper.h"
+#include "ibrush.h"
+#include "math/Plane3.h"
+#include "math/AABB.h"
+
+class Face;
+
+namespace brush {
+namespace algorithm {
+
+/**
+ * A face of a convex volume taking part in a CSG operation. It carries
+ * the plane and refers to the brush face it originates from, which is
+ * used to create the actual Face once the volume is turned into a brush.
+ */
+struct FragmentFace
+{
+	// The plane, reversed if the face is flipped
+	Plane3 plane;
+
+	// The brush face this one is a copy of
+	const Face* source;
+
+	// TRUE if the winding of the source face needs to be flipped
+	bool flipped;
+
+	FragmentFace(const Plane3& plane_, const Face* source_, bool flipped_) :
+		plane(plane_),
+		source(source_),
+		flipped(flipped_)
+	{}
+
+	FragmentFace getFlipped() const
+	{
+		return FragmentFace(-plane, source, !flipped);
+	}
+};
+
+typedef std::vector<FragmentFace> FragmentFaces;
+
+/**
+ * greebo: The vertices of the convex volume bounded by a set of planes,
+ * calculated the same way a Brush evaluates its b-rep.
+ *
+ * This works on plain planes without touching any scene nodes or brushes,
+ * so several volumes can be processed by worker threads at once.
+ */
+class ConvexVolume
+{
+private:
+	// One winding per face, cleaned up like the windings of a Brush
+	std::vector<IWinding> _windings;
+	AABB _bounds;
+
+public:
+	ConvexVolume(const FragmentFaces& faces, double maxWorldCoord);
+
+	// The bounds of the face windings, invalid if there are none (like Brush::localAABB())
+	const AABB& getBounds() const
+	{
+		return _bounds;
+	}
+
+	// Classifies the face windings against the given plane, like Brush_classifyPlane()
+	BrushSplitType classifyPlane(const Plane3& plane) const;
+};
+
+// A selected brush subtracted from the surrounding brushes
+struct SubtractedVolume
+{
+	// The contributing faces of the brush
+	FragmentFaces faces;
+	AABB bounds;
+};
+
+/**
+ * Subtracts the given volume from the one bounded by the given faces. Returns
+ * FALSE if the volumes don't intersect, otherwise the remaining fragments
+ * are appended to the given vector (which might be none at all).
+ */
+bool subtractVolume(const FragmentFaces& faces, const SubtractedVolume& volume,
+	double maxWorldCoord, std::vector<FragmentFaces>& fragments);
+
+/**
+ * Subtracts all the given volumes one after the other from the one bounded
+ * by the given faces, the result is stored in the fragments vector.
+ * Returns FALSE if none of the volumes had any effect on the faces.
+ */
+bool subtractVolumes(const FragmentFaces& faces, const std::vector<const SubtractedVolume*>& volumes,
+	double maxWorldCoord, std::vector<FragmentFaces>& fragments);
+
+} // namespace algorithm
+} // namespace brush
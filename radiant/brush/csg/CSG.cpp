@@ -10,11 +10,14 @@
 #include "imainframe.h"
 #include "iselection.h"
 #include "ieventmanager.h"
+#include "ibrush.h"
+#include "ispacepartition.h"
 
 #include "scenelib.h"
 #include "shaderlib.h"
 
 #include "registry/registry.h"
+#include "util/ThreadPool.h"
 #include "brush/Face.h"
 #include "brush/Brush.h"
 #include "brush/BrushNode.h"
@@ -25,6 +28,7 @@
 #include "wxutil/dialog/MessageBox.h"
 
 #include "BrushByPlaneClipper.h"
+#include "BrushFragments.h"
 
 namespace brush {
 namespace algorithm {
@@ -128,154 +132,195 @@ BrushSplitType Brush_classifyPlane(const Brush& brush, const Plane3& plane) {
 	return split;
 }
 
-// Returns true if fragments have been inserted into the given ret_fragments list
-bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVector& ret_fragments)
+namespace
 {
-	if (brush->getBrush().localAABB().intersects(other.localAABB()))
+
+// Below this number of touched brushes the fragments are calculated in the calling thread
+const std::size_t MIN_PARALLEL_SUBTRACT_BRUSHES = 8;
+
+// All faces of the given brush
+FragmentFaces getFragmentFaces(const Brush& brush)
+{
+	FragmentFaces faces;
+	faces.reserve(brush.getNumFaces());
+
+	for (Brush::const_iterator i = brush.begin(); i != brush.end(); ++i)
 	{
-		BrushPtrVector fragments;
-		fragments.reserve(other.getNumFaces());
+		faces.push_back(FragmentFace((*i)->plane3(), i->get(), false));
+	}
 
-		BrushNodePtr back = std::dynamic_pointer_cast<BrushNode>(brush->clone());
+	return faces;
+}
 
-		for (Brush::const_iterator i(other.begin()); i != other.end(); ++i)
-		{
-			const Face& face = *(*i);
+// An unselected brush overlapping the subtracted ones
+struct SubtractionTarget
+{
+	BrushNodePtr node;
 
-			if (!face.contributes()) continue;
+	// The faces of the brush
+	FragmentFaces faces;
 
-			BrushSplitType split = Brush_classifyPlane(back->getBrush(), face.plane3());
+	// The volumes overlapping this brush
+	std::vector<const SubtractedVolume*> volumes;
 
-			if (split.counts[ePlaneFront] != 0 && split.counts[ePlaneBack] != 0)
-			{
-				fragments.push_back(std::dynamic_pointer_cast<BrushNode>(back->clone()));
+	// The fragments replacing the brush if changed is TRUE
+	std::vector<FragmentFaces> fragments;
+	bool changed;
 
-				FacePtr newFace = fragments.back()->getBrush().addFace(face);
+	SubtractionTarget(const BrushNodePtr& node_) :
+		node(node_),
+		faces(getFragmentFaces(node_->getBrush())),
+		changed(false)
+	{}
+};
 
-				if (newFace != 0)
-				{
-					newFace->flipWinding();
-				}
+// Adds the visible, unselected brushes of the given space partition node and its
+// children which are overlapping the given bounds
+void collectUnselectedBrushes(const scene::ISPNodePtr& spNode, const AABB& bounds,
+	std::vector<BrushNodePtr>& brushes)
+{
+	for (const scene::INodePtr& member : spNode->getMembers())
+	{
+		Brush* brush = Node_getBrush(member);
 
-				back->getBrush().addFace(face);
-			}
-			else if (split.counts[ePlaneBack] == 0)
-			{
-				return false;
-			}
+		if (brush != NULL && member->visible() && !Node_isSelected(member) &&
+			brush->localAABB().intersects(bounds))
+		{
+			brushes.push_back(std::dynamic_pointer_cast<BrushNode>(member));
 		}
-
-		ret_fragments.insert(ret_fragments.end(), fragments.begin(), fragments.end());
-		return true;
 	}
 
-	return false;
+	for (const scene::ISPNodePtr& child : spNode->getChildNodes())
+	{
+		if (child->getBounds().intersects(bounds))
+		{
+			collectUnselectedBrushes(child, bounds, brushes);
+		}
+	}
 }
 
-class SubtractBrushesFromUnselected :
-	public scene::NodeVisitor
+void subtractBrushes(const BrushPtrVector& brushes, std::size_t& before, std::size_t& after)
 {
-	const BrushPtrVector& _brushlist;
-	std::size_t& _before;
-	std::size_t& _after;
+	// Have all changed brushes evaluated in one go, Face::plane3() and the bounds
+	// are then up to date and the parallel part only works on the collected planes
+	GlobalBrushCreator().evaluatePendingBReps();
 
-	std::list<scene::INodePtr> _deleteList;
-public:
-	SubtractBrushesFromUnselected(const BrushPtrVector& brushlist, std::size_t& before, std::size_t& after) :
-		_brushlist(brushlist),
-		_before(before),
-		_after(after)
-	{}
+	std::vector<SubtractedVolume> volumes(brushes.size());
+
+	for (std::size_t i = 0; i < brushes.size(); ++i)
+	{
+		const Brush& brush = brushes[i]->getBrush();
 
-	virtual ~SubtractBrushesFromUnselected() {
-		for (std::list<scene::INodePtr>::iterator i = _deleteList.begin();
-			 i != _deleteList.end(); i++)
+		brush.forEachFace([&] (const Face& face)
 		{
-			scene::removeNodeFromParent(*i);
-		}
-	}
+			if (face.contributes())
+			{
+				volumes[i].faces.push_back(FragmentFace(face.plane3(), &face, false));
+			}
+		});
 
-	bool pre(const scene::INodePtr& node) {
-		return true;
+		volumes[i].bounds = brush.localAABB();
 	}
 
-	void post(const scene::INodePtr& node) {
-		if (!node->visible()) {
-			return;
-		}
+	// Broad phase: look up the unselected brushes near each subtracted brush in the octree
+	std::vector<SubtractionTarget> targets;
+	std::map<scene::INodePtr, std::size_t> targetIndices;
 
-		Brush* brush = Node_getBrush(node);
+	scene::ISPNodePtr root = GlobalSceneGraph().getSpacePartition()->getRoot();
 
-		if (brush != NULL && !Node_isSelected(node))
+	for (const SubtractedVolume& volume : volumes)
+	{
+		std::vector<BrushNodePtr> touched;
+		collectUnselectedBrushes(root, volume.bounds, touched);
+
+		for (const BrushNodePtr& node : touched)
 		{
-			BrushNodePtr brushNode = std::dynamic_pointer_cast<BrushNode>(node);
+			std::pair<std::map<scene::INodePtr, std::size_t>::iterator, bool> result =
+				targetIndices.insert(std::make_pair(node, targets.size()));
 
-			// Get the parent of this brush
-			scene::INodePtr parent = node->getParent();
-			assert(parent != NULL); // parent should not be NULL
+			if (result.second)
+			{
+				targets.push_back(SubtractionTarget(node));
+			}
 
-			BrushPtrVector buffer[2];
-			std::size_t swap = 0;
+			targets[result.first->second].volumes.push_back(&volume);
+		}
+	}
 
-			BrushNodePtr original = std::dynamic_pointer_cast<BrushNode>(brushNode->clone());
+	// Calculate the fragments, this doesn't modify any brush or scene node
+	auto calculateFragments = [&] (std::size_t index)
+	{
+		SubtractionTarget& target = targets[index];
 
-			//Brush* original = new Brush(*brush);
-			buffer[swap].push_back(original);
+		target.changed = subtractVolumes(target.faces, target.volumes, Brush::m_maxWorldCoord, target.fragments);
+	};
 
-			// Iterate over all selected brushes
-			for (BrushPtrVector::const_iterator i(_brushlist.begin()); i != _brushlist.end(); ++i)
-			{
-				for (BrushPtrVector::iterator j(buffer[swap].begin());
-					 j != buffer[swap].end(); ++j)
-				{
-					if (Brush_subtract(*j, (*i)->getBrush(), buffer[1 - swap]))
-					{
-						// greebo: Delete not necessary, nodes get deleted automatically by clear() below
-						// delete (*j);
-					}
-					else
-					{
-						buffer[1 - swap].push_back(*j);
-					}
-				}
+	if (targets.size() >= MIN_PARALLEL_SUBTRACT_BRUSHES)
+	{
+		util::ThreadPool pool;
+		pool.parallelFor(targets.size(), calculateFragments);
+	}
+	else
+	{
+		for (std::size_t i = 0; i < targets.size(); ++i)
+		{
+			calculateFragments(i);
+		}
+	}
 
-				buffer[swap].clear();
-				swap = 1 - swap;
-			}
+	// Replace the changed brushes with their fragments
+	for (const SubtractionTarget& target : targets)
+	{
+		if (!target.changed)
+		{
+			continue;
+		}
 
-			BrushPtrVector& out = buffer[swap];
+		before++;
 
-			if (out.size() == 1 && out.back() == original)
-			{
-				// greebo: shared_ptr is taking care of this
-				//delete original;
-			}
-			else
-			{
-				_before++;
+		const Brush& source = target.node->getBrush();
+		scene::INodePtr parent = target.node->getParent();
+		assert(parent); // parent should not be NULL
 
-				for (BrushPtrVector::const_iterator i = out.begin(); i != out.end(); ++i)
-				{
-					_after++;
+		for (const FragmentFaces& fragment : target.fragments)
+		{
+			after++;
 
-					scene::INodePtr newBrush = GlobalBrushCreator().createBrush();
+			scene::INodePtr newNode = GlobalBrushCreator().createBrush();
 
-					parent->addChildNode(newBrush);
+			parent->addChildNode(newNode);
 
-					// Move the new Brush to the same layers as the source node
-					newBrush->assignToLayers(node->getLayers());
+			// Move the new Brush to the same layers as the source node
+			newNode->assignToLayers(target.node->getLayers());
 
-					(*i)->getBrush().removeEmptyFaces();
-					ASSERT_MESSAGE(!(*i)->getBrush().empty(), "brush left with no faces after subtract");
+			Brush& newBrush = *Node_getBrush(newNode);
+			newBrush.setDetailFlag(source.getDetailFlag());
 
-					Node_getBrush(newBrush)->copy((*i)->getBrush());
-				}
+			for (const FragmentFace& face : fragment)
+			{
+				FacePtr newFace = newBrush.addFace(*face.source);
 
-			    _deleteList.push_back(node);
+				if (newFace != 0 && face.flipped)
+				{
+					newFace->flipWinding();
+				}
 			}
+
+			newBrush.removeEmptyFaces();
+			ASSERT_MESSAGE(!newBrush.empty(), "brush left with no faces after subtract");
 		}
 	}
-};
+
+	for (const SubtractionTarget& target : targets)
+	{
+		if (target.changed)
+		{
+			scene::removeNodeFromParent(target.node);
+		}
+	}
+}
+
+}
 
 void subtractBrushesFromUnselected(const cmd::ArgumentList& args)
 {
@@ -307,11 +352,7 @@ void subtractBrushesFromUnselected(const cmd::ArgumentList& args)
 	std::size_t before = 0;
 	std::size_t after = 0;
 
-	// instantiate a scoped walker class
-	{
-		SubtractBrushesFromUnselected walker(brushes, before, after);
-		GlobalSceneGraph().root()->traverse(walker);
-	}
+	subtractBrushes(brushes, before, after);
 
 	rMessage() << "CSG Subtract: Result: "
 		<< after << " fragment" << (after == 1 ? "" : "s")
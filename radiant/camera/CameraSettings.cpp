@@ -70,6 +70,9 @@ void CameraSettings::constructPreferencePage()
 	// States whether the selection boxes are stippled or not
 	page->appendCheckBox("", _("Solid selection boxes"), RKEY_SOLID_SELECTION_BOXES);
 
+	// The scenegraph is observing this key itself
+	page->appendCheckBox("", _("Multi-threaded scene culling"), RKEY_PARALLEL_SCENE_TRAVERSAL);
+
     // Whether to show the toolbar (to please the screenspace addicts)
     page->appendCheckBox(
         "", _("Show camera toolbar"), RKEY_SHOW_CAMERA_TOOLBAR
@@ -29,6 +29,7 @@ namespace
 	const std::string RKEY_TOGGLE_FREE_MOVE = RKEY_CAMERA_ROOT + "/toggleFreeMove";
 	const std::string RKEY_CAMERA_WINDOW_STATE = RKEY_CAMERA_ROOT + "/window";
     const std::string RKEY_SHOW_CAMERA_TOOLBAR = RKEY_CAMERA_ROOT + "/showToolbar";
+	const std::string RKEY_PARALLEL_SCENE_TRAVERSAL = "user/ui/scenegraph/parallelTraversal";
 }
 
 enum CameraDrawMode 
@@ -100,6 +100,12 @@ void AutoMapSaver::onRadiantShutdown()
 {
 	_enabled = false;
 	stopTimer();
+
+	// Let a running autosave finish its file
+	if (_pendingSave.valid())
+	{
+		_pendingSave.wait();
+	}
 }
 
 void AutoMapSaver::clearChanges()
@@ -117,6 +123,18 @@ void AutoMapSaver::stopTimer()
 	_timer.Stop();
 }
 
+void AutoMapSaver::saveInBackground(const std::string& filename)
+{
+	// The scene is copied right away, the file is written by a worker thread
+	_pendingSave = GlobalMap().saveDirectInBackground(filename);
+}
+
+bool AutoMapSaver::saveInProgress()
+{
+	return _pendingSave.valid() &&
+		_pendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
 void AutoMapSaver::saveSnapshot() 
 {
 	// Original GtkRadiant comments:
@@ -180,7 +198,7 @@ void AutoMapSaver::saveSnapshot()
 		rMessage() << "Autosaving snapshot to " << filename << std::endl;
 
 		// Dump to map to the next available filename
-		GlobalMap().saveDirect(filename);
+		saveInBackground(filename);
 
 		// Display a warning, if the folder size exceeds the limit
 		if (folderSize > maxSnapshotFolderSize*1024*1024)
@@ -221,6 +239,14 @@ void AutoMapSaver::checkSave()
 		return;
 	}
 
+	// Don't start another save while the previous one is still being written
+	if (saveInProgress())
+	{
+		rMessage() << "AutoSaver: Previous autosave is still being written, " <<
+			"will wait for another period." << std::endl;
+		return;
+	}
+
 	// Check if the user is currently pressing a mouse button
 	// Don't start the save if the user is holding a mouse button
 	if (wxGetMouseState().ButtonIsDown(wxMOUSE_BTN_ANY)) 
@@ -264,7 +290,7 @@ void AutoMapSaver::checkSave()
 				rMessage() << "Autosaving unnamed map to " << autoSaveFilename << std::endl;
 
 				// Invoke the save call
-				GlobalMap().saveDirect(autoSaveFilename);
+				saveInBackground(autoSaveFilename);
 			}
 			else
 			{
@@ -280,7 +306,7 @@ void AutoMapSaver::checkSave()
 				rMessage() << "Autosaving map to " << filename << std::endl;
 
 				// Invoke the save call
-				GlobalMap().saveDirect(filename);
+				saveInBackground(filename);
 			}
 		}
 	}
@@ -3,6 +3,7 @@
 #include "iregistry.h"
 
 #include <wx/timer.h>
+#include <future>
 
 /* greebo: The AutoMapSaver class lets itself being called in distinct intervals
  * and saves the map files either to snapshots or to a single yyyy.autosave.map file.
@@ -29,6 +30,9 @@ class AutoMapSaver :
 
 	std::size_t _changes;
 
+	// The autosave currently being written in the background
+	std::future<bool> _pendingSave;
+
 public:
 	// Constructor
 	AutoMapSaver();
@@ -60,6 +64,12 @@ private:
 	// Saves a snapshot of the currently active map (only named maps)
 	void saveSnapshot();
 
+	// Starts writing the map to the given file in the background
+	void saveInBackground(const std::string& filename);
+
+	// Returns true if the previous autosave is still being written
+	bool saveInProgress();
+
 	// This gets called when the interval time is over
 	void onIntervalReached(wxTimerEvent& ev);
 
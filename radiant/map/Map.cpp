@@ -10,6 +10,7 @@
 #include "ifilesystem.h"
 #include "ifiletypes.h"
 #include "ifilter.h"
+#include "ibrush.h"
 #include "icounter.h"
 #include "iradiant.h"
 #include "imainframe.h"
@@ -630,6 +631,38 @@ bool Map::saveDirect(const std::string& filename, const MapFormatPtr& mapFormat)
     return result;
 }
 
+std::future<bool> Map::saveDirectInBackground(const std::string& filename, const MapFormatPtr& mapFormat)
+{
+    if (_saveInProgress)
+    {
+        std::promise<bool> failed;
+        failed.set_value(false);
+
+        return failed.get_future();
+    }
+
+    _saveInProgress = true;
+
+	MapFormatPtr format = mapFormat;
+
+	if (!mapFormat)
+	{
+		format = getFormatForFile(filename);
+	}
+
+    // Only the scene snapshot is taken here, no need to block screen updates
+    std::future<bool> result = MapResource::saveFileInBackground(
+        *format,
+        GlobalSceneGraph().root(),
+        map::traverse, // TraversalFunc
+        filename
+    );
+
+    _saveInProgress = false;
+
+    return result;
+}
+
 bool Map::saveSelected(const std::string& filename, const MapFormatPtr& mapFormat)
 {
     if (_saveInProgress) return false; // safeguard
@@ -990,6 +1023,8 @@ void Map::importSelected(std::istream& in)
         // Prepare child primitives
         addOriginToChildPrimitives(root);
 
+        GlobalBrushCreator().evaluatePendingBReps();
+
         // Adjust all new names to fit into the existing map namespace,
         // this routine will be changing a lot of names in the importNamespace
         INamespacePtr nspace = getRoot()->getNamespace();
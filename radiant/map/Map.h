@@ -13,6 +13,7 @@
 
 #include <sigc++/signal.h>
 #include <wx/stopwatch.h>
+#include <future>
 
 class TextInputStream;
 
@@ -134,6 +135,13 @@ public:
 	 */
 	bool saveDirect(const std::string& filename, const MapFormatPtr& mapFormat = MapFormatPtr());
 
+	/**
+	 * Like saveDirect(), but the scenegraph content is only copied before
+	 * returning, the file is written in the background. The returned future
+	 * yields true once the map file has been written successfully.
+	 */
+	std::future<bool> saveDirectInBackground(const std::string& filename, const MapFormatPtr& mapFormat = MapFormatPtr());
+
 	/** greebo: Creates a new map file.
 	 *
 	 * Note: Can't be called "new" as this is a reserved word...
@@ -8,6 +8,7 @@
 #include "ientity.h"
 #include "iarchive.h"
 #include "igroupnode.h"
+#include "ibrush.h"
 #include "ifilesystem.h"
 #include "imainframe.h"
 #include "iregistry.h"
@@ -32,6 +33,7 @@
 
 #include "algorithm/MapImporter.h"
 #include "algorithm/MapExporter.h"
+#include "algorithm/MapSnapshot.h"
 #include "algorithm/InfoFileExporter.h"
 #include "algorithm/AssignLayerMappingWalker.h"
 #include "algorithm/ChildPrimitives.h"
@@ -508,6 +510,9 @@ bool MapResource::loadFile(std::istream& mapStream, const MapFormat& format, con
 		// Prepare child primitives
 		addOriginToChildPrimitives(root);
 
+		// Build the new brushes at once, before the scene asks for their bounds
+		GlobalBrushCreator().evaluatePendingBReps();
+
 		if (!format.allowInfoFileCreation())
 		{
 			// No info file handling, just return success
@@ -726,4 +731,105 @@ bool MapResource::saveFile(const MapFormat& format, const scene::INodePtr& root,
 	}
 }
 
+std::future<bool> MapResource::saveFileInBackground(const MapFormat& format, const scene::INodePtr& root,
+						   const GraphTraversalFunc& traverse, const std::string& filename)
+{
+	// Actual output file paths
+	fs::path outFile = filename;
+	fs::path auxFile = outFile;
+	auxFile.replace_extension(_infoFileExt);
+
+	// Check writeability of the output files
+	if (!checkIsWriteable(outFile) || !checkIsWriteable(auxFile))
+	{
+		std::promise<bool> failed;
+		failed.set_value(false);
+
+		return failed.get_future();
+	}
+
+	// Record the scene contents, this is the only part accessing the scene
+	MapSnapshotPtr snapshot = std::make_shared<MapSnapshot>();
+	std::ostringstream auxStream;
+
+	bool writeInfoFile = format.allowInfoFileCreation();
+
+	{
+		// The exporter cleans up the scene on destruction
+		MapExporterPtr exporter;
+
+		if (writeInfoFile)
+		{
+			exporter.reset(new MapExporter(*snapshot, root, auxStream));
+		}
+		else
+		{
+			exporter.reset(new MapExporter(*snapshot, root));
+		}
+
+		exporter->exportMap(root, traverse);
+	}
+
+	IMapWriterPtr mapWriter = format.getMapWriter();
+	std::string auxContents = auxStream.str();
+
+	// The files are written next to the target files and renamed when complete,
+	// the target files remain intact if anything goes wrong
+	std::string tempExtension = "." + getTemporaryFileExtension() + ".tmp";
+	fs::path tempOutFile = outFile.string() + tempExtension;
+	fs::path tempAuxFile = auxFile.string() + tempExtension;
+
+	return std::async(std::launch::async, [=]() -> bool
+	{
+		std::ofstream outFileStream(tempOutFile.string().c_str());
+
+		if (!outFileStream.is_open())
+		{
+			rError() << "Could not open " << tempOutFile.string() << " for writing" << std::endl;
+			return false;
+		}
+
+		snapshot->writeTo(*mapWriter, outFileStream);
+		outFileStream.close();
+
+		bool success = !outFileStream.fail();
+
+		if (success && writeInfoFile)
+		{
+			std::ofstream auxFileStream(tempAuxFile.string().c_str());
+			auxFileStream << auxContents;
+			auxFileStream.close();
+
+			success = !auxFileStream.fail();
+		}
+
+		try
+		{
+			if (success)
+			{
+				fs::rename(tempOutFile, outFile);
+
+				if (writeInfoFile)
+				{
+					fs::rename(tempAuxFile, auxFile);
+				}
+
+				rMessage() << "Map saved to " << outFile.string() << std::endl;
+				return true;
+			}
+
+			rError() << "Failure writing " << tempOutFile.string() << std::endl;
+
+			fs::remove(tempOutFile);
+			fs::remove(tempAuxFile);
+		}
+		catch (fs::filesystem_error& ex)
+		{
+			rError() << "Error while saving map: " << ex.what() << std::endl;
+		}
+
+		return false;
+	});
+}
+
 } // namespace map
@@ -5,6 +5,7 @@
 #include "imodel.h"
 #include "imap.h"
 #include <set>
+#include <future>
 #include "RootNode.h"
 #include <boost/filesystem.hpp>
 
@@ -83,6 +84,12 @@ public:
 	static bool saveFile(const MapFormat& format, const scene::INodePtr& root,
 						 const GraphTraversalFunc& traverse, const std::string& filename);
 
+	// Like saveFile(), but only a snapshot of the scene is taken on the calling thread.
+	// The file is written on a worker thread and moved into place once it's complete.
+	// The returned future yields true if the map file has been written successfully.
+	static std::future<bool> saveFileInBackground(const MapFormat& format, const scene::INodePtr& root,
+						 const GraphTraversalFunc& traverse, const std::string& filename);
+
 private:
 	// Create a backup copy of the map (used before saving)
 	bool saveBackup();
@@ -25,8 +25,9 @@ namespace map
 	}
 
 MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root, std::ostream& mapStream, std::size_t nodeCount) :
-	_writer(writer),
-	_mapStream(mapStream),
+	_writer(&writer),
+	_mapStream(&mapStream),
+	_snapshot(nullptr),
 	_root(root),
 	_dialogEventLimiter(registry::getValue<int>(RKEY_MAP_SAVE_STATUS_INTERLEAVE)),
 	_totalNodeCount(nodeCount),
@@ -39,8 +40,9 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root, std::o
 
 MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root, 
 				std::ostream& mapStream, std::ostream& auxStream, std::size_t nodeCount) :
-	_writer(writer),
-	_mapStream(mapStream),
+	_writer(&writer),
+	_mapStream(&mapStream),
+	_snapshot(nullptr),
 	_infoFileExporter(new InfoFileExporter(auxStream)),
 	_root(root),
 	_dialogEventLimiter(registry::getValue<int>(RKEY_MAP_SAVE_STATUS_INTERLEAVE)),
@@ -52,6 +54,35 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root,
 	construct();
 }
 
+MapExporter::MapExporter(MapSnapshot& snapshot, const scene::INodePtr& root) :
+	_writer(nullptr),
+	_mapStream(nullptr),
+	_snapshot(&snapshot),
+	_root(root),
+	_dialogEventLimiter(registry::getValue<int>(RKEY_MAP_SAVE_STATUS_INTERLEAVE)),
+	_totalNodeCount(0),
+	_curNodeCount(0),
+	_entityNum(0),
+	_primitiveNum(0)
+{
+	construct();
+}
+
+MapExporter::MapExporter(MapSnapshot& snapshot, const scene::INodePtr& root, std::ostream& auxStream) :
+	_writer(nullptr),
+	_mapStream(nullptr),
+	_snapshot(&snapshot),
+	_infoFileExporter(new InfoFileExporter(auxStream)),
+	_root(root),
+	_dialogEventLimiter(registry::getValue<int>(RKEY_MAP_SAVE_STATUS_INTERLEAVE)),
+	_totalNodeCount(0),
+	_curNodeCount(0),
+	_entityNum(0),
+	_primitiveNum(0)
+{
+	construct();
+}
+
 MapExporter::~MapExporter()
 {
 	// Close any info file stream
@@ -77,7 +108,15 @@ void MapExporter::construct()
 	assert(!nodes.empty());
 
 	int precision = string::convert<int>(nodes[0].getAttributeValue("value"));
-	_mapStream.precision(precision);
+
+	if (_snapshot != nullptr)
+	{
+		_snapshot->setPrecision(precision);
+	}
+	else
+	{
+		_mapStream->precision(precision);
+	}
 
 	// Add origin to func_* children before writing
 	prepareScene();
@@ -85,9 +124,16 @@ void MapExporter::construct()
 
 void MapExporter::exportMap(const scene::INodePtr& root, const GraphTraversalFunc& traverse)
 {
+	if (_snapshot != nullptr)
+	{
+		// Just record the nodes, the snapshot will invoke the begin/end methods when written
+		traverse(root, *this);
+		return;
+	}
+
 	try
 	{
-		_writer.beginWriteMap(_mapStream);
+		_writer->beginWriteMap(*_mapStream);
 	}
 	catch (IMapWriter::FailureException& ex)
 	{
@@ -99,7 +145,7 @@ void MapExporter::exportMap(const scene::INodePtr& root, const GraphTraversalFun
 
 	try
 	{
-		_writer.endWriteMap(_mapStream);
+		_writer->endWriteMap(*_mapStream);
 	}
 	catch (IMapWriter::FailureException& ex)
 	{
@@ -130,7 +176,7 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			// Progress dialog handling
 			onNodeProgress();
 			
-			_writer.beginWriteEntity(*entity, _mapStream);
+			beginEntity(*entity);
 
 			if (_infoFileExporter) _infoFileExporter->visitEntity(node, _entityNum);
 
@@ -144,7 +190,7 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			// Progress dialog handling
 			onNodeProgress();
 
-			_writer.beginWriteBrush(*brush, _mapStream);
+			exportBrush(*brush);
 
 			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
 
@@ -158,7 +204,7 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			// Progress dialog handling
 			onNodeProgress();
 
-			_writer.beginWritePatch(*patch, _mapStream);
+			exportPatch(*patch);
 
 			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
 
@@ -181,7 +227,7 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (entity != NULL)
 		{
-			_writer.endWriteEntity(*entity, _mapStream);
+			endEntity();
 
 			_entityNum++;
 			return;
@@ -191,7 +237,6 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (brush != NULL && brush->hasContributingFaces())
 		{
-			_writer.endWriteBrush(*brush, _mapStream);
 			_primitiveNum++;
 			return;
 		}
@@ -200,7 +245,6 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (patch != NULL)
 		{
-			_writer.endWritePatch(*patch, _mapStream);
 			_primitiveNum++;
 			return;
 		}
@@ -211,6 +255,60 @@ void MapExporter::post(const scene::INodePtr& node)
 	}
 }
 
+void MapExporter::beginEntity(const Entity& entity)
+{
+	if (_snapshot != nullptr)
+	{
+		_snapshot->beginEntity(entity);
+		return;
+	}
+
+	_openEntities.push_back(EntitySnapshot(entity));
+	_writer->beginWriteEntity(_openEntities.back(), *_mapStream);
+}
+
+void MapExporter::endEntity()
+{
+	if (_snapshot != nullptr)
+	{
+		_snapshot->endEntity();
+		return;
+	}
+
+	EntitySnapshot entity(std::move(_openEntities.back()));
+	_openEntities.pop_back();
+
+	_writer->endWriteEntity(entity, *_mapStream);
+}
+
+void MapExporter::exportBrush(const IBrush& brush)
+{
+	if (_snapshot != nullptr)
+	{
+		_snapshot->addBrush(brush);
+		return;
+	}
+
+	BrushSnapshot snapshot(brush);
+
+	_writer->beginWriteBrush(snapshot, *_mapStream);
+	_writer->endWriteBrush(snapshot, *_mapStream);
+}
+
+void MapExporter::exportPatch(const IPatch& patch)
+{
+	if (_snapshot != nullptr)
+	{
+		_snapshot->addPatch(patch);
+		return;
+	}
+
+	PatchSnapshot snapshot(patch);
+
+	_writer->beginWritePatch(snapshot, *_mapStream);
+	_writer->endWritePatch(snapshot, *_mapStream);
+}
+
 void MapExporter::onNodeProgress()
 {
 	_curNodeCount++;
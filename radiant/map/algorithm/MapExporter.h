@@ -6,6 +6,7 @@
 
 #include "wxutil/ModalProgressDialog.h"
 #include "InfoFileExporter.h"
+#include "MapSnapshot.h"
 #include "EventRateLimiter.h"
 
 namespace map
@@ -18,6 +19,9 @@ namespace map
  * to dispatch various calls like beginWriteEntity(), 
  * beginMap(), endWriteBrush() during scene traversal etc.
  *
+ * Alternatively the exporter can record the visited nodes into a
+ * MapSnapshot, which can be written to a stream later on.
+ *
  * If the progress dialog is enabled (i.e. nodeCount > 0 in constructor)
  * a gtkutil::OperationAbortedException& might be thrown during traversal, 
  * the calling code needs to be able to handle that.
@@ -27,10 +31,16 @@ class MapExporter :
 {
 private:
 	// The actual map format for writing nodes to the stream
-	IMapWriter& _writer;
+	IMapWriter* _writer;
 
 	// The stream we're writing to
-	std::ostream& _mapStream;
+	std::ostream* _mapStream;
+
+	// The snapshot the nodes are recorded into, instead of using the writer
+	MapSnapshot* _snapshot;
+
+	// The entities currently being written
+	std::vector<EntitySnapshot> _openEntities;
 
 	// Optional info file exporter (is NULL if no info file should be written)
 	InfoFileExporterPtr _infoFileExporter;
@@ -61,6 +71,10 @@ public:
 	MapExporter(IMapWriter& writer, const scene::INodePtr& root, 
 				std::ostream& mapStream, std::ostream& auxStream, std::size_t nodeCount = 0);
 
+	// Constructors recording the scene into the given snapshot, without progress dialog
+	MapExporter(MapSnapshot& snapshot, const scene::INodePtr& root);
+	MapExporter(MapSnapshot& snapshot, const scene::INodePtr& root, std::ostream& auxStream);
+
 	// Cleans up the scene on destruction
 	~MapExporter();
 
@@ -80,6 +94,12 @@ private:
 
 	void onNodeProgress();
 
+	// Pass the element to the writer or record it in the snapshot
+	void beginEntity(const Entity& entity);
+	void endEntity();
+	void exportBrush(const IBrush& brush);
+	void exportPatch(const IPatch& patch);
+
 	// Is called before exporting the scene to prepare func_* groups.
 	void prepareScene();
 
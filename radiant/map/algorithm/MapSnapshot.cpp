@@ -0,0 +1,109 @@
+#include "MapSnapshot.h"
+
+#include "itextstream.h"
+
+namespace map
+{
+
+MapSnapshot::MapSnapshot() :
+	_precision(0)
+{}
+
+void MapSnapshot::setPrecision(std::streamsize precision)
+{
+	_precision = precision;
+}
+
+void MapSnapshot::beginEntity(const Entity& entity)
+{
+	Element element = { Element::EntityStart, _entities.size() };
+	_elements.push_back(element);
+
+	_openEntities.push_back(_entities.size());
+	_entities.push_back(EntitySnapshot(entity));
+}
+
+void MapSnapshot::endEntity()
+{
+	assert(!_openEntities.empty());
+
+	Element element = { Element::EntityEnd, _openEntities.back() };
+	_elements.push_back(element);
+
+	_openEntities.pop_back();
+}
+
+void MapSnapshot::addBrush(const IBrush& brush)
+{
+	Element element = { Element::Brush, _brushes.size() };
+	_elements.push_back(element);
+
+	_brushes.push_back(BrushSnapshot(brush));
+}
+
+void MapSnapshot::addPatch(const IPatch& patch)
+{
+	Element element = { Element::Patch, _patches.size() };
+	_elements.push_back(element);
+
+	_patches.push_back(PatchSnapshot(patch));
+}
+
+void MapSnapshot::writeTo(IMapWriter& writer, std::ostream& stream) const
+{
+	if (_precision > 0)
+	{
+		stream.precision(_precision);
+	}
+
+	try
+	{
+		writer.beginWriteMap(stream);
+	}
+	catch (IMapWriter::FailureException& ex)
+	{
+		rError() << "Failure exporting a node (pre): " << ex.what() << std::endl;
+	}
+
+	for (const Element& element : _elements)
+	{
+		try
+		{
+			switch (element.type)
+			{
+			case Element::EntityStart:
+				writer.beginWriteEntity(_entities[element.index], stream);
+				break;
+
+			case Element::EntityEnd:
+				writer.endWriteEntity(_entities[element.index], stream);
+				break;
+
+			case Element::Brush:
+				writer.beginWriteBrush(_brushes[element.index], stream);
+				writer.endWriteBrush(_brushes[element.index], stream);
+				break;
+
+			case Element::Patch:
+				writer.beginWritePatch(_patches[element.index], stream);
+				writer.endWritePatch(_patches[element.index], stream);
+				break;
+			}
+		}
+		catch (IMapWriter::FailureException& ex)
+		{
+			rError() << "Failure exporting a node: " << ex.what() << std::endl;
+		}
+	}
+
+	try
+	{
+		writer.endWriteMap(stream);
+	}
+	catch (IMapWriter::FailureException& ex)
+	{
+		rError() << "Failure exporting a node (post): " << ex.what() << std::endl;
+	}
+}
+
+} // namespace
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "imapformat.h"
+#include "imapsnapshot.h"
+
+#include <ostream>
+#include <vector>
+#include <memory>
+
+namespace map
+{
+
+/**
+ * A copy of the exportable contents of a scene, as recorded by the
+ * MapExporter. The snapshot doesn't reference any scene nodes, it can be
+ * passed to an IMapWriter on a worker thread while the map is being edited.
+ */
+class MapSnapshot
+{
+private:
+	// The recorded scene elements in traversal order,
+	// the index is pointing into the according list below
+	struct Element
+	{
+		enum Type
+		{
+			EntityStart,
+			EntityEnd,
+			Brush,
+			Patch,
+		};
+
+		Type type;
+		std::size_t index;
+	};
+	std::vector<Element> _elements;
+
+	std::vector<EntitySnapshot> _entities;
+	std::vector<BrushSnapshot> _brushes;
+	std::vector<PatchSnapshot> _patches;
+
+	// The entities which have been started but not ended yet
+	std::vector<std::size_t> _openEntities;
+
+	// The floating point precision of the map stream
+	std::streamsize _precision;
+
+public:
+	MapSnapshot();
+
+	void setPrecision(std::streamsize precision);
+
+	// Recording methods, invoked by the MapExporter in traversal order
+	void beginEntity(const Entity& entity);
+	void endEntity();
+	void addBrush(const IBrush& brush);
+	void addPatch(const IPatch& patch);
+
+	// Passes the recorded elements to the given writer. Does not access the scene,
+	// failures to write single elements are logged but don't stop the export.
+	void writeTo(IMapWriter& writer, std::ostream& stream) const;
+};
+typedef std::shared_ptr<MapSnapshot> MapSnapshotPtr;
+
+} // namespace
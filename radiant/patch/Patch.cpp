@@ -50,6 +50,7 @@ int Patch::m_CycleCapIndex = 0;
 
 	namespace {
 		const std::size_t MAX_PATCH_SUBDIVISIONS = 32;
+		const std::string RKEY_PATCH_SUBDIVIDE_THRESHOLD = "user/ui/patch/subdivideThreshold";
 	}
 
 // Constructor
@@ -57,9 +58,11 @@ Patch::Patch(PatchNode& node, const Callback& evaluateTransform) :
 	_node(node),
 	_shader(texdef_name_default()),
 	_undoStateSaver(NULL),
-	_solidRenderable(_mesh),
-	_wireframeRenderable(_mesh),
-	_fixedWireframeRenderable(_mesh),
+	_mesh(std::make_shared<PatchTesselation>()),
+	_meshOffset(0, 0, 0),
+	_solidRenderable(_mesh, _meshOffset),
+	_wireframeRenderable(_mesh, _meshOffset),
+	_fixedWireframeRenderable(_mesh, _meshOffset),
 	_renderableCtrlPoints(GL_POINTS, m_ctrl_vertices),
 	_renderableLattice(GL_LINES, m_lattice_indices, m_ctrl_vertices),
 	m_transformChanged(false),
@@ -78,9 +81,11 @@ Patch::Patch(const Patch& other, PatchNode& node, const Callback& evaluateTransf
 	_node(node),
 	_shader(other._shader.getMaterialName()),
 	_undoStateSaver(NULL),
-	_solidRenderable(_mesh),
-	_wireframeRenderable(_mesh),
-	_fixedWireframeRenderable(_mesh),
+	_mesh(std::make_shared<PatchTesselation>()),
+	_meshOffset(0, 0, 0),
+	_solidRenderable(_mesh, _meshOffset),
+	_wireframeRenderable(_mesh, _meshOffset),
+	_fixedWireframeRenderable(_mesh, _meshOffset),
 	_renderableCtrlPoints(GL_POINTS, m_ctrl_vertices),
 	_renderableLattice(GL_LINES, m_lattice_indices, m_ctrl_vertices),
 	m_transformChanged(false),
@@ -274,14 +279,17 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
 	updateTesselation();
 
 	// The updateTesselation routine might have produced a degenerate patch, catch this
-	if (_mesh.vertices.empty()) return;
+	if (_mesh->vertices.empty()) return;
+
+	// The tesselation is relative to the mesh offset
+	test.BeginMesh(_node.localToWorld().getTranslatedBy(_meshOffset), true);
 
 	SelectionIntersection best;
-	IndexPointer::index_type* pIndex = &_mesh.indices.front();
+	IndexPointer::index_type* pIndex = &_mesh->indices.front();
 
-	for (std::size_t s=0; s<_mesh.m_numStrips; s++) {
-		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()), IndexPointer(pIndex, _mesh.m_lenStrips), best);
-		pIndex += _mesh.m_lenStrips;
+	for (std::size_t s=0; s<_mesh->m_numStrips; s++) {
+		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh->vertices.front()), IndexPointer(pIndex, _mesh->m_lenStrips), best);
+		pIndex += _mesh->m_lenStrips;
 	}
 
 	if (best.valid()) {
@@ -496,9 +504,6 @@ Patch::~Patch()
 		(*i++)->onPatchDestruction();
 	}
 
-	BezierCurveTreeArray_deleteAll(_mesh.curveTreeU);
-	BezierCurveTreeArray_deleteAll(_mesh.curveTreeV);
-
 	// Release the shaders
     _pointShader.reset();
     _latticeShader.reset();
@@ -564,14 +569,17 @@ void Patch::updateTesselation()
     
     if(!isValid())
     {
-        _mesh.clear();
+        // Don't touch the old tesselation, it might be shared
+        _mesh = std::make_shared<PatchTesselation>();
+        _meshOffset = Vector3(0, 0, 0);
         m_aabb_local = AABB();
         return;
     }
     
-    BuildTesselationCurves(ROW);
-    BuildTesselationCurves(COL);
-    BuildVertexArray();
+    static float subdivideThreshold = registry::getValue<float>(RKEY_PATCH_SUBDIVIDE_THRESHOLD);
+
+    PatchTesselationCache::Instance().update(_mesh, _meshOffset, m_width, m_height, m_ctrlTransformed,
+        m_patchDef3, Subdivisions(m_subdivisions_x, m_subdivisions_y), subdivideThreshold);
     updateAABB();
     
     IndexBuffer ctrl_indices;
@@ -1955,12 +1963,12 @@ void Patch::alignTexture(EAlignType align)
 	controlPointsChanged();
 }
 
-PatchTesselation& Patch::getTesselation()
+const PatchTesselation& Patch::getTesselation()
 {
 	// Ensure the tesselation is up to date
 	updateTesselation();
 
-	return _mesh;
+	return *_mesh;
 }
 
 PatchMesh Patch::getTesselatedPatchMesh() const
@@ -1970,15 +1978,15 @@ PatchMesh Patch::getTesselatedPatchMesh() const
 
 	PatchMesh mesh;
 
-	mesh.width = _mesh.m_nArrayWidth;
-	mesh.height = _mesh.m_nArrayHeight;
+	mesh.width = _mesh->m_nArrayWidth;
+	mesh.height = _mesh->m_nArrayHeight;
 
-	for (std::vector<ArbitraryMeshVertex>::const_iterator i = _mesh.vertices.begin();
-		i != _mesh.vertices.end(); ++i)
+	for (std::vector<ArbitraryMeshVertex>::const_iterator i = _mesh->vertices.begin();
+		i != _mesh->vertices.end(); ++i)
 	{
 		VertexNT v;
 
-		v.vertex = i->vertex;
+		v.vertex = i->vertex + _meshOffset;
 		v.texcoord = i->texcoord;
 		v.normal = i->normal;
 
@@ -2356,1320 +2364,6 @@ void Patch::ConstructPrefab(const AABB& aabb, EPatchPrefab eType, EViewType view
 	NaturalTexture();
 }
 
-#define DEGEN_0a  0x01
-#define DEGEN_1a  0x02
-#define DEGEN_2a  0x04
-#define DEGEN_0b  0x08
-#define DEGEN_1b  0x10
-#define DEGEN_2b  0x20
-#define SPLIT     0x40
-#define AVERAGE   0x80
-
-
-unsigned int subarray_get_degen(PatchControlIter subarray, std::size_t strideU, std::size_t strideV)
-{
-  unsigned int nDegen = 0;
-  PatchControlIter p1;
-  PatchControlIter p2;
-
-  p1 = subarray;
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_0a;
-  p1 = p2;
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_0b;
-
-  p1 = subarray + strideV;
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_1a;
-  p1 = p2;
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_1b;
-
-  p1 = subarray + (strideV << 1);
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_2a;
-  p1 = p2;
-  p2 = p1 + strideU;
-  if(p1->vertex == p2->vertex)
-    nDegen |= DEGEN_2b;
-
-  return nDegen;
-}
-
-
-inline void deCasteljau3(const Vector3& P0, const Vector3& P1, const Vector3& P2, Vector3& P01, Vector3& P12, Vector3& P012)
-{
-  P01 = P0.mid(P1);
-  P12 = P1.mid(P2);
-  P012 = P01.mid(P12);
-}
-
-inline void BezierInterpolate3( const Vector3& start, Vector3& left, Vector3& mid, Vector3& right, const Vector3& end )
-{
-  left = start.mid(mid);
-  right = mid.mid(end);
-  mid = left.mid(right);
-}
-
-inline void BezierInterpolate2( const Vector2& start, Vector2& left, Vector2& mid, Vector2& right, const Vector2& end )
-{
-  left[0]= float_mid(start[0], mid[0]);
-  left[1] = float_mid(start[1], mid[1]);
-  right[0] = float_mid(mid[0], end[0]);
-  right[1] = float_mid(mid[1], end[1]);
-  mid[0] = float_mid(left[0], right[0]);
-  mid[1] = float_mid(left[1], right[1]);
-}
-
-#include "math/curve.h"
-
-inline PatchControl QuadraticBezier_evaluate(const PatchControl* firstPoint, double t)
-{
-  PatchControl result = { Vector3(0, 0, 0), Vector2(0, 0) };
-  double denominator = 0;
-
-  {
-    double weight = BernsteinPolynomial<Zero, Two>::apply(t);
-    result.vertex += firstPoint[0].vertex * weight;
-    result.texcoord += firstPoint[0].texcoord * weight;
-    denominator += weight;
-  }
-  {
-    double weight = BernsteinPolynomial<One, Two>::apply(t);
-    result.vertex += firstPoint[1].vertex * weight;
-    result.texcoord += firstPoint[1].texcoord * weight;
-    denominator += weight;
-  }
-  {
-    double weight = BernsteinPolynomial<Two, Two>::apply(t);
-    result.vertex  += firstPoint[2].vertex * weight;
-    result.texcoord += firstPoint[2].texcoord * weight;
-    denominator += weight;
-  }
-
-  result.vertex /= denominator;
-  result.texcoord /= denominator;
-  return result;
-}
-
-inline Vector3 vector3_linear_interpolated(const Vector3& a, const Vector3& b, double t)
-{
-  return a*(1.0 - t) + b*t;
-}
-
-inline Vector2 vector2_linear_interpolated(const Vector2& a, const Vector2& b, double t)
-{
-  return a*(1.0 - t) + b*t;
-}
-
-void normalise_safe(Vector3& normal)
-{
-	if (normal != g_vector3_identity)
-	{
-		normal.normalise();
-	}
-}
-
-inline void QuadraticBezier_evaluate(const PatchControl& a, const PatchControl& b, const PatchControl& c, double t, PatchControl& point, PatchControl& left, PatchControl& right)
-{
-  left.vertex = vector3_linear_interpolated(a.vertex, b.vertex, t);
-  left.texcoord = vector2_linear_interpolated(a.texcoord, b.texcoord, t);
-  right.vertex = vector3_linear_interpolated(b.vertex, c.vertex, t);
-  right.texcoord = vector2_linear_interpolated(b.texcoord, c.texcoord, t);
-  point.vertex = vector3_linear_interpolated(left.vertex, right.vertex, t);
-  point.texcoord = vector2_linear_interpolated(left.texcoord, right.texcoord, t);
-}
-
-void Patch::TesselateSubMatrixFixed(ArbitraryMeshVertex* vertices,
-									std::size_t strideX, std::size_t strideY,
-									unsigned int nFlagsX, unsigned int nFlagsY,
-									PatchControlIter subMatrix[3][3])
-{
-  double incrementU = 1.0 / m_subdivisions_x;
-  double incrementV = 1.0 / m_subdivisions_y;
-  const std::size_t width = m_subdivisions_x + 1;
-  const std::size_t height = m_subdivisions_y + 1;
-
-  for(std::size_t i = 0; i != width; ++i)
-  {
-    double tU = (i + 1 == width) ? 1 : i * incrementU;
-    PatchControl pointX[3];
-    PatchControl leftX[3];
-    PatchControl rightX[3];
-    QuadraticBezier_evaluate(*subMatrix[0][0], *subMatrix[0][1], *subMatrix[0][2], tU, pointX[0], leftX[0], rightX[0]);
-    QuadraticBezier_evaluate(*subMatrix[1][0], *subMatrix[1][1], *subMatrix[1][2], tU, pointX[1], leftX[1], rightX[1]);
-    QuadraticBezier_evaluate(*subMatrix[2][0], *subMatrix[2][1], *subMatrix[2][2], tU, pointX[2], leftX[2], rightX[2]);
-
-    ArbitraryMeshVertex* p = vertices + i * strideX;
-    for(std::size_t j = 0; j != height; ++j)
-    {
-      if((j == 0 || j + 1 == height) && (i == 0 || i + 1 == width))
-      {
-      }
-      else
-      {
-        double tV = (j + 1 == height) ? 1 : j * incrementV;
-
-        PatchControl pointY[3];
-        PatchControl leftY[3];
-        PatchControl rightY[3];
-        QuadraticBezier_evaluate(*subMatrix[0][0], *subMatrix[1][0], *subMatrix[2][0], tV, pointY[0], leftY[0], rightY[0]);
-        QuadraticBezier_evaluate(*subMatrix[0][1], *subMatrix[1][1], *subMatrix[2][1], tV, pointY[1], leftY[1], rightY[1]);
-        QuadraticBezier_evaluate(*subMatrix[0][2], *subMatrix[1][2], *subMatrix[2][2], tV, pointY[2], leftY[2], rightY[2]);
-
-        PatchControl point;
-        PatchControl left;
-        PatchControl right;
-        QuadraticBezier_evaluate(pointX[0], pointX[1], pointX[2], tV, point, left, right);
-        PatchControl up;
-        PatchControl down;
-        QuadraticBezier_evaluate(pointY[0], pointY[1], pointY[2], tU, point, up, down);
-
-        p->vertex = Vertex3f(point.vertex);
-        p->texcoord = point.texcoord;
-
-        ArbitraryMeshVertex a, b, c;
-
-        a.vertex = Vertex3f(left.vertex);
-        a.texcoord = left.texcoord;
-        b.vertex = Vertex3f(right.vertex);
-        b.texcoord = right.texcoord;
-
-        if(i != 0)
-        {
-          c.vertex = Vertex3f(up.vertex);
-          c.texcoord = up.texcoord;
-        }
-        else
-        {
-          c.vertex = Vertex3f(down.vertex);
-          c.texcoord = down.texcoord;
-        }
-
-        Vector3 normal = (right.vertex - left.vertex).crossProduct(up.vertex - down.vertex).getNormalised();
-
-        Vector3 tangent, bitangent;
-        ArbitraryMeshTriangle_calcTangents(a, b, c, tangent, bitangent);
-        tangent = tangent.getNormalised();
-        bitangent = bitangent.getNormalised();
-
-        if(((nFlagsX & AVERAGE) != 0 && i == 0) || ((nFlagsY & AVERAGE) != 0  && j == 0))
-        {
-          p->normal = Normal3f(p->normal + normal.getNormalised());
-          p->tangent = Normal3f(p->tangent + tangent.getNormalised());
-          p->bitangent = Normal3f((p->bitangent + bitangent).getNormalised());
-        }
-        else
-        {
-          p->normal = Normal3f(normal);
-          p->tangent = Normal3f(tangent);
-          p->bitangent = Normal3f(bitangent);
-        }
-      }
-
-      p += strideY;
-    }
-  }
-}
-
-void Patch::TesselateSubMatrix( const BezierCurveTree *BX, const BezierCurveTree *BY,
-                                        std::size_t offStartX, std::size_t offStartY,
-                                        std::size_t offEndX, std::size_t offEndY,
-                                        std::size_t nFlagsX, std::size_t nFlagsY,
-                                        Vector3& left, Vector3& mid, Vector3& right,
-                                        Vector2& texLeft, Vector2& texMid, Vector2& texRight,
-                                        bool bTranspose )
-{
-  int newFlagsX, newFlagsY;
-
-  Vector3 tmp;
-  Vector3 vertex_0_0, vertex_0_1, vertex_1_0, vertex_1_1, vertex_2_0, vertex_2_1;
-  Vector2 texTmp;
-  Vector2 texcoord_0_0, texcoord_0_1, texcoord_1_0, texcoord_1_1, texcoord_2_0, texcoord_2_1;
-
-  {
-   // texcoords
-
-    BezierInterpolate2( _mesh.vertices[offStartX + offStartY].texcoord,
-                     texcoord_0_0,
-                     _mesh.vertices[BX->index + offStartY].texcoord,
-                     texcoord_0_1,
-                     _mesh.vertices[offEndX + offStartY].texcoord);
-
-
-    BezierInterpolate2( _mesh.vertices[offStartX + offEndY].texcoord,
-                     texcoord_2_0,
-                     _mesh.vertices[BX->index + offEndY].texcoord,
-                     texcoord_2_1,
-                     _mesh.vertices[offEndX + offEndY].texcoord);
-
-    texTmp = texMid;
-
-    BezierInterpolate2(texLeft,
-                      texcoord_1_0,
-                      texTmp,
-                      texcoord_1_1,
-                      texRight);
-
-	if(!BY->isLeaf())
-    {
-      _mesh.vertices[BX->index + BY->index].texcoord = texTmp;
-    }
-
-
-	if(!BX->left->isLeaf())
-    {
-      _mesh.vertices[BX->left->index + offStartY].texcoord = texcoord_0_0;
-      _mesh.vertices[BX->left->index + offEndY].texcoord = texcoord_2_0;
-
-	  if(!BY->isLeaf())
-      {
-        _mesh.vertices[BX->left->index + BY->index].texcoord = texcoord_1_0;
-      }
-    }
-	if(!BX->right->isLeaf())
-    {
-      _mesh.vertices[BX->right->index + offStartY].texcoord = texcoord_0_1;
-      _mesh.vertices[BX->right->index + offEndY].texcoord = texcoord_2_1;
-
-	  if(!BY->isLeaf())
-      {
-        _mesh.vertices[BX->right->index + BY->index].texcoord = texcoord_1_1;
-      }
-    }
-
-
-    // verts
-
-    BezierInterpolate3( _mesh.vertices[offStartX + offStartY].vertex,
-                     vertex_0_0,
-                     _mesh.vertices[BX->index + offStartY].vertex,
-                     vertex_0_1,
-                     _mesh.vertices[offEndX + offStartY].vertex);
-
-
-    BezierInterpolate3( _mesh.vertices[offStartX + offEndY].vertex,
-                     vertex_2_0,
-                     _mesh.vertices[BX->index + offEndY].vertex,
-                     vertex_2_1,
-                     _mesh.vertices[offEndX + offEndY].vertex);
-
-
-    tmp = mid;
-
-    BezierInterpolate3( left,
-                     vertex_1_0,
-                     tmp,
-                     vertex_1_1,
-                     right );
-
-	if(!BY->isLeaf())
-    {
-      _mesh.vertices[BX->index + BY->index].vertex = tmp;
-    }
-
-
-	if(!BX->left->isLeaf())
-    {
-      _mesh.vertices[BX->left->index + offStartY].vertex = vertex_0_0;
-      _mesh.vertices[BX->left->index + offEndY].vertex = vertex_2_0;
-
-	  if(!BY->isLeaf())
-      {
-        _mesh.vertices[BX->left->index + BY->index].vertex = vertex_1_0;
-      }
-    }
-	if(!BX->right->isLeaf())
-    {
-      _mesh.vertices[BX->right->index + offStartY].vertex = vertex_0_1;
-      _mesh.vertices[BX->right->index + offEndY].vertex = vertex_2_1;
-
-	  if(!BY->isLeaf())
-      {
-        _mesh.vertices[BX->right->index + BY->index].vertex = vertex_1_1;
-      }
-    }
-
-    // normals
-
-    if(nFlagsX & SPLIT)
-    {
-      ArbitraryMeshVertex a, b, c;
-      Vector3 tangentU;
-
-      if(!(nFlagsX & DEGEN_0a) || !(nFlagsX & DEGEN_0b))
-      {
-        tangentU = vertex_0_1 - vertex_0_0;
-        a.vertex = Vertex3f(vertex_0_0);
-        a.texcoord = texcoord_0_0;
-        c.vertex = Vertex3f(vertex_0_1);
-        c.texcoord = texcoord_0_1;
-      }
-      else if(!(nFlagsX & DEGEN_1a) || !(nFlagsX & DEGEN_1b))
-      {
-        tangentU = vertex_1_1 - vertex_1_0;
-        a.vertex = Vertex3f(vertex_1_0);
-        a.texcoord = texcoord_1_0;
-        c.vertex = Vertex3f(vertex_1_1);
-        c.texcoord = texcoord_1_1;
-      }
-      else
-      {
-        tangentU = vertex_2_1 - vertex_2_0;
-        a.vertex = Vertex3f(vertex_2_0);
-        a.texcoord = texcoord_2_0;
-        c.vertex = Vertex3f(vertex_2_1);
-        c.texcoord = texcoord_2_1;
-      }
-
-      Vector3 tangentV;
-
-      if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_1a) && (nFlagsY & DEGEN_2a))
-      {
-        tangentV = _mesh.vertices[BX->index + offEndY].vertex - tmp;
-        b.vertex = Vertex3f(tmp);//_mesh.vertices[BX->index + offEndY].vertex;
-        b.texcoord = texTmp;//_mesh.vertices[BX->index + offEndY].texcoord;
-      }
-      else
-      {
-        tangentV = tmp - _mesh.vertices[BX->index + offStartY].vertex;
-        b.vertex = Vertex3f(tmp);//_mesh.vertices[BX->index + offStartY].vertex;
-        b.texcoord = texTmp; //_mesh.vertices[BX->index + offStartY].texcoord;
-      }
-
-
-      Vector3 normal, s, t;
-      ArbitraryMeshVertex& v = _mesh.vertices[offStartY + BX->index];
-      Vector3& p = v.normal;
-      Vector3& ps = v.tangent;
-      Vector3& pt = v.bitangent;
-
-      if(bTranspose)
-      {
-        normal = tangentV.crossProduct(tangentU);
-      }
-      else
-      {
-        normal = tangentU.crossProduct(tangentV);
-      }
-      normalise_safe(normal);
-
-      ArbitraryMeshTriangle_calcTangents(a, b, c, s, t);
-      normalise_safe(s);
-      normalise_safe(t);
-
-      if(nFlagsX & AVERAGE)
-      {
-        p = (p + normal).getNormalised();
-        ps = (ps + s).getNormalised();
-        pt = (pt + t).getNormalised();
-      }
-      else
-      {
-        p = normal;
-        ps = s;
-        pt = t;
-      }
-    }
-
-    {
-      ArbitraryMeshVertex a, b, c;
-      Vector3 tangentU;
-
-      if(!(nFlagsX & DEGEN_2a) || !(nFlagsX & DEGEN_2b))
-      {
-        tangentU = vertex_2_1 - vertex_2_0;
-        a.vertex = Vertex3f(vertex_2_0);
-        a.texcoord = texcoord_2_0;
-        c.vertex = Vertex3f(vertex_2_1);
-        c.texcoord = texcoord_2_1;
-      }
-      else if(!(nFlagsX & DEGEN_1a) || !(nFlagsX & DEGEN_1b))
-      {
-        tangentU = vertex_1_1 - vertex_1_0;
-        a.vertex = Vertex3f(vertex_1_0);
-        a.texcoord = texcoord_1_0;
-        c.vertex = Vertex3f(vertex_1_1);
-        c.texcoord = texcoord_1_1;
-      }
-      else
-      {
-        tangentU = vertex_0_1 - vertex_0_0;
-        a.vertex = Vertex3f(vertex_0_0);
-        a.texcoord = texcoord_0_0;
-        c.vertex = Vertex3f(vertex_0_1);
-        c.texcoord = texcoord_0_1;
-      }
-
-      Vector3 tangentV;
-
-      if((nFlagsY & DEGEN_0b) && (nFlagsY & DEGEN_1b) && (nFlagsY & DEGEN_2b))
-      {
-        tangentV = tmp - _mesh.vertices[BX->index + offStartY].vertex;
-        b.vertex = Vertex3f(tmp);//_mesh.vertices[BX->index + offStartY].vertex;
-        b.texcoord = texTmp;//_mesh.vertices[BX->index + offStartY].texcoord;
-      }
-      else
-      {
-        tangentV = _mesh.vertices[BX->index + offEndY].vertex - tmp;
-        b.vertex = Vertex3f(tmp);//_mesh.vertices[BX->index + offEndY].vertex;
-        b.texcoord = texTmp;//_mesh.vertices[BX->index + offEndY].texcoord;
-      }
-
-      ArbitraryMeshVertex& v = _mesh.vertices[offEndY+BX->index];
-      Vector3& p = v.normal;
-      Vector3& ps = v.tangent;
-      Vector3& pt = v.bitangent;
-
-      if(bTranspose)
-      {
-        p = tangentV.crossProduct(tangentU);
-      }
-      else
-      {
-        p = tangentU.crossProduct(tangentV);
-      }
-      normalise_safe(p);
-
-      ArbitraryMeshTriangle_calcTangents(a, b, c, ps, pt);
-      normalise_safe(ps);
-      normalise_safe(pt);
-    }
-  }
-
-
-  newFlagsX = newFlagsY = 0;
-
-  if((nFlagsX & DEGEN_0a) && (nFlagsX & DEGEN_0b))
-  {
-    newFlagsX |= DEGEN_0a;
-    newFlagsX |= DEGEN_0b;
-  }
-  if((nFlagsX & DEGEN_1a) && (nFlagsX & DEGEN_1b))
-  {
-    newFlagsX |= DEGEN_1a;
-    newFlagsX |= DEGEN_1b;
-  }
-  if((nFlagsX & DEGEN_2a) && (nFlagsX & DEGEN_2b))
-  {
-    newFlagsX |= DEGEN_2a;
-    newFlagsX |= DEGEN_2b;
-  }
-  if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_1a) && (nFlagsY & DEGEN_2a))
-  {
-    newFlagsY |= DEGEN_0a;
-    newFlagsY |= DEGEN_1a;
-    newFlagsY |= DEGEN_2a;
-  }
-  if((nFlagsY & DEGEN_0b) && (nFlagsY & DEGEN_1b) && (nFlagsY & DEGEN_2b))
-  {
-    newFlagsY |= DEGEN_0b;
-    newFlagsY |= DEGEN_1b;
-    newFlagsY |= DEGEN_2b;
-  }
-
-
-  //if((nFlagsX & DEGEN_0a) && (nFlagsX & DEGEN_1a) && (nFlagsX & DEGEN_2a)) { newFlagsX |= DEGEN_0a; newFlagsX |= DEGEN_1a; newFlagsX |= DEGEN_2a; }
-  //if((nFlagsX & DEGEN_0b) && (nFlagsX & DEGEN_1b) && (nFlagsX & DEGEN_2b)) { newFlagsX |= DEGEN_0b; newFlagsX |= DEGEN_1b; newFlagsX |= DEGEN_2b; }
-
-  newFlagsX |= (nFlagsX & SPLIT);
-  newFlagsX |= (nFlagsX & AVERAGE);
-
-  if(!BY->isLeaf())
-  {
-    {
-      int nTemp = newFlagsY;
-
-      if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_0b))
-      {
-        newFlagsY |= DEGEN_0a;
-        newFlagsY |= DEGEN_0b;
-      }
-      newFlagsY |= (nFlagsY & SPLIT);
-      newFlagsY |= (nFlagsY & AVERAGE);
-
-      Vector3& p = _mesh.vertices[BX->index+BY->index].vertex;
-      Vector3 vTemp(p);
-
-      Vector2& p2 = _mesh.vertices[BX->index+BY->index].texcoord;
-      Vector2 stTemp(p2);
-
-      TesselateSubMatrix( BY, BX->left,
-                          offStartY, offStartX,
-                          offEndY, BX->index,
-                          newFlagsY, newFlagsX,
-                          vertex_0_0, vertex_1_0, vertex_2_0,
-                          texcoord_0_0, texcoord_1_0, texcoord_2_0,
-                          !bTranspose );
-
-      newFlagsY = nTemp;
-      p = vTemp;
-      p2 = stTemp;
-    }
-
-    if((nFlagsY & DEGEN_2a) && (nFlagsY & DEGEN_2b)) { newFlagsY |= DEGEN_2a; newFlagsY |= DEGEN_2b; }
-
-    TesselateSubMatrix( BY, BX->right,
-                        offStartY, BX->index,
-                        offEndY, offEndX,
-                        newFlagsY, newFlagsX,
-                        vertex_0_1, vertex_1_1, vertex_2_1,
-                        texcoord_0_1, texcoord_1_1, texcoord_2_1,
-                        !bTranspose );
-  }
-  else
-  {
-	  if(!BX->left->isLeaf())
-    {
-      TesselateSubMatrix( BX->left,  BY,
-                          offStartX, offStartY,
-                          BX->index, offEndY,
-                          newFlagsX, newFlagsY,
-                          left, vertex_1_0, tmp,
-                          texLeft, texcoord_1_0, texTmp,
-                          bTranspose );
-    }
-
-	  if(!BX->right->isLeaf())
-    {
-      TesselateSubMatrix( BX->right, BY,
-                          BX->index, offStartY,
-                          offEndX, offEndY,
-                          newFlagsX, newFlagsY,
-                          tmp, vertex_1_1, right,
-                          texTmp, texcoord_1_1, texRight,
-                          bTranspose );
-    }
-  }
-
-}
-
-void Patch::BuildTesselationCurves(EMatrixMajor major)
-{
-  std::size_t nArrayStride, length, cross, strideU, strideV;
-  switch(major)
-  {
-  case ROW:
-    nArrayStride = 1;
-    length = (m_width - 1) >> 1;
-    cross = m_height;
-    strideU = 1;
-    strideV = m_width;
-
-    if(!m_patchDef3)
-    {
-      BezierCurveTreeArray_deleteAll(_mesh.curveTreeU);
-    }
-
-    break;
-  case COL:
-    nArrayStride = _mesh.m_nArrayWidth;
-    length = (m_height - 1) >> 1;
-    cross = m_width;
-    strideU = m_width;
-    strideV = 1;
-
-    if(!m_patchDef3)
-    {
-      BezierCurveTreeArray_deleteAll(_mesh.curveTreeV);
-    }
-
-    break;
-  default:
-    ERROR_MESSAGE("neither row-major nor column-major");
-    return;
-  }
-
-	std::vector<std::size_t> arrayLength;
-	std::vector<BezierCurveTree*> pCurveTree(length);
-
-	std::size_t nArrayLength = 1;
-
-	if (m_patchDef3)
-	{
-		// This is a patch using fixed tesselation (patchDef3)
-		std::size_t subdivisions = (major == ROW) ? m_subdivisions_x : m_subdivisions_y;
-
-		// Assign the fixed number of tesselations to each column
-		arrayLength.resize(length, subdivisions);
-		nArrayLength += subdivisions * length;
-	}
-	else
-	{
-		// Resize the array and calculate the values
-		arrayLength.resize(length);
-
-		// create a list of the horizontal control curves in each column of sub-patches
-		// adaptively tesselate each horizontal control curve in the list
-		// create a binary tree representing the combined tesselation of the list
-		for (std::size_t i = 0; i != length; ++i)
-		{
-			PatchControlIter p1 = m_ctrlTransformed.begin() + (i * 2 * strideU);
-
-			BezierCurveList curveList;
-
-			for (std::size_t j = 0; j < cross; j += 2)
-			{
-				// directly taken from one row of control points
-				{
-					BezierCurve* pCurve = new BezierCurve(
-						(p1+strideU)->vertex,		// crd
-						p1->vertex,					// left
-						(p1+(strideU<<1))->vertex	// right
-					);
-
-					curveList.push_front(pCurve);
-				}
-
-				// Skip the rest if this is the last turn
-				if (j+2 >= cross) break;
-
-				PatchControlIter p2 = p1 + strideV;
-				PatchControlIter p3 = p2 + strideV;
-
-				// interpolated from three columns of control points
-				{
-					BezierCurve* pCurve = new BezierCurve(
-						(p1+strideU)->vertex.mid((p3+strideU)->vertex),			// crd
-						p1->vertex.mid(p3->vertex),								// left
-						(p1+(strideU<<1))->vertex.mid((p3+(strideU<<1))->vertex)	// right
-					);
-
-					pCurve->crd = pCurve->crd.mid((p2+strideU)->vertex);
-					pCurve->left = pCurve->left.mid(p2->vertex);
-					pCurve->right = pCurve->right.mid((p2+(strideU<<1))->vertex);
-
-					curveList.push_front(pCurve);
-				}
-
-				p1 = p3;
-			}
-
-			// Sort the curve list into a BezierCurveTree
-			pCurveTree[i] = new BezierCurveTree;
-
-			BezierCurveTree_FromCurveList(pCurveTree[i], curveList);
-
-			// The curve list is not needed anymore, free it
-			std::for_each(curveList.begin(), curveList.end(), [] (BezierCurve* curve)
-			{
-				delete curve;
-			});
-
-			curveList.clear();
-
-			// set up array indices for binary tree
-			// accumulate subarray width
-			std::size_t l = pCurveTree[i]->setup(nArrayLength, nArrayStride) - (nArrayLength - 1);
-			arrayLength[i] = l;
-
-			// accumulate total array width
-			nArrayLength += l;
-		}
-	}
-
-  switch(major)
-  {
-  case ROW:
-    _mesh.m_nArrayWidth = nArrayLength;
-    std::swap(_mesh.arrayWidth, arrayLength);
-
-    if(!m_patchDef3)
-    {
-      std::swap(_mesh.curveTreeU, pCurveTree);
-    }
-    break;
-  case COL:
-    _mesh.m_nArrayHeight = nArrayLength;
-    std::swap(_mesh.arrayHeight, arrayLength);
-
-    if(!m_patchDef3)
-    {
-      std::swap(_mesh.curveTreeV, pCurveTree);
-    }
-    break;
-  }
-}
-
-inline void vertex_assign_ctrl(ArbitraryMeshVertex& vertex, const PatchControl& ctrl)
-{
-  vertex.vertex = Vertex3f(ctrl.vertex);
-  vertex.texcoord = ctrl.texcoord;
-}
-
-inline void vertex_clear_normal(ArbitraryMeshVertex& vertex)
-{
-  vertex.normal = Normal3f(0, 0, 0);
-  vertex.tangent = Normal3f(0, 0, 0);
-  vertex.bitangent = Normal3f(0, 0, 0);
-}
-
-inline void tangents_remove_degenerate(Vector3 tangents[6], Vector2 textureTangents[6], unsigned int flags)
-{
-  if(flags & DEGEN_0a)
-  {
-    const std::size_t i =
-      (flags & DEGEN_0b)
-      ? (flags & DEGEN_1a)
-        ? (flags & DEGEN_1b)
-          ? (flags & DEGEN_2a)
-            ? 5
-            : 4
-          : 3
-        : 2
-      : 1;
-    tangents[0] = tangents[i];
-    textureTangents[0] = textureTangents[i];
-  }
-  if(flags & DEGEN_0b)
-  {
-    const std::size_t i =
-      (flags & DEGEN_0a)
-      ? (flags & DEGEN_1b)
-        ? (flags & DEGEN_1a)
-          ? (flags & DEGEN_2b)
-            ? 4
-            : 5
-          : 2
-        : 3
-      : 0;
-    tangents[1] = tangents[i];
-    textureTangents[1] = textureTangents[i];
-  }
-  if(flags & DEGEN_2a)
-  {
-    const std::size_t i =
-      (flags & DEGEN_2b)
-      ? (flags & DEGEN_1a)
-        ? (flags & DEGEN_1b)
-          ? (flags & DEGEN_0a)
-            ? 1
-            : 0
-          : 3
-        : 2
-      : 5;
-    tangents[4] = tangents[i];
-    textureTangents[4] = textureTangents[i];
-  }
-  if(flags & DEGEN_2b)
-  {
-    const std::size_t i =
-      (flags & DEGEN_2a)
-      ? (flags & DEGEN_1b)
-        ? (flags & DEGEN_1a)
-          ? (flags & DEGEN_0b)
-            ? 0
-            : 1
-          : 2
-        : 3
-      : 4;
-    tangents[5] = tangents[i];
-    textureTangents[5] = textureTangents[i];
-  }
-}
-
-void bestTangents00(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
-{
-  if(fabs(dot + length) < 0.001) // opposing direction = degenerate
-  {
-    if(!(degenerateFlags & DEGEN_1a)) // if this tangent is degenerate we cannot use it
-    {
-      index0 = 2;
-      index1 = 0;
-    }
-    else if(!(degenerateFlags & DEGEN_0b))
-    {
-      index0 = 0;
-      index1 = 1;
-    }
-    else
-    {
-      index0 = 1;
-      index1 = 0;
-    }
-  }
-  else if(fabs(dot - length) < 0.001) // same direction = degenerate
-  {
-    if(degenerateFlags & DEGEN_0b)
-    {
-      index0 = 0;
-      index1 = 1;
-    }
-    else
-    {
-      index0 = 1;
-      index1 = 0;
-    }
-  }
-}
-
-void bestTangents01(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
-{
-  if(fabs(dot - length) < 0.001) // same direction = degenerate
-  {
-    if(!(degenerateFlags & DEGEN_1a)) // if this tangent is degenerate we cannot use it
-    {
-      index0 = 2;
-      index1 = 1;
-    }
-    else if(!(degenerateFlags & DEGEN_2b))
-    {
-      index0 = 4;
-      index1 = 0;
-    }
-    else
-    {
-      index0 = 5;
-      index1 = 1;
-    }
-  }
-  else if(fabs(dot + length) < 0.001) // opposing direction = degenerate
-  {
-    if(degenerateFlags & DEGEN_2b)
-    {
-      index0 = 4;
-      index1 = 0;
-    }
-    else
-    {
-      index0 = 5;
-      index1 = 1;
-    }
-  }
-}
-
-void bestTangents10(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
-{
-  if(fabs(dot - length) < 0.001) // same direction = degenerate
-  {
-    if(!(degenerateFlags & DEGEN_1b)) // if this tangent is degenerate we cannot use it
-    {
-      index0 = 3;
-      index1 = 4;
-    }
-    else if(!(degenerateFlags & DEGEN_0a))
-    {
-      index0 = 1;
-      index1 = 5;
-    }
-    else
-    {
-      index0 = 0;
-      index1 = 4;
-    }
-  }
-  else if(fabs(dot + length) < 0.001) // opposing direction = degenerate
-  {
-    if(degenerateFlags & DEGEN_0a)
-    {
-      index0 = 1;
-      index1 = 5;
-    }
-    else
-    {
-      index0 = 0;
-      index1 = 4;
-    }
-  }
-}
-
-void bestTangents11(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
-{
-  if(fabs(dot + length) < 0.001) // opposing direction = degenerate
-  {
-    if(!(degenerateFlags & DEGEN_1b)) // if this tangent is degenerate we cannot use it
-    {
-      index0 = 3;
-      index1 = 5;
-    }
-    else if(!(degenerateFlags & DEGEN_2a))
-    {
-      index0 = 5;
-      index1 = 4;
-    }
-    else
-    {
-      index0 = 4;
-      index1 = 5;
-    }
-  }
-  else if(fabs(dot - length) < 0.001) // same direction = degenerate
-  {
-    if(degenerateFlags & DEGEN_2a)
-    {
-      index0 = 5;
-      index1 = 4;
-    }
-    else
-    {
-      index0 = 4;
-      index1 = 5;
-    }
-  }
-}
-
-void Patch::accumulateVertexTangentSpace(std::size_t index, Vector3 tangentX[6], Vector3 tangentY[6], Vector2 tangentS[6], Vector2 tangentT[6], std::size_t index0, std::size_t index1)
-{
-  {
-    Vector3 normal(tangentX[index0].crossProduct(tangentY[index1]));
-    if(normal != g_vector3_identity)
-    {
-      _mesh.vertices[index].normal += normal.getNormalised();
-    }
-  }
-
-  {
-    ArbitraryMeshVertex a, b, c;
-    a.vertex = Vertex3f(0, 0, 0);
-    a.texcoord = TexCoord2f(0, 0);
-    b.vertex = Vertex3f(tangentX[index0]);
-    b.texcoord = tangentS[index0];
-    c.vertex = Vertex3f(tangentY[index1]);
-    c.texcoord = tangentT[index1];
-
-    Vector3 s, t;
-    ArbitraryMeshTriangle_calcTangents(a, b, c, s, t);
-    if(s != g_vector3_identity)
-    {
-		_mesh.vertices[index].tangent += s.getNormalised();
-    }
-    if(t != g_vector3_identity)
-    {
-		_mesh.vertices[index].bitangent += t.getNormalised();
-    }
-  }
-}
-
-const std::size_t PATCH_MAX_VERTEX_ARRAY = 1048576;
-
-void Patch::BuildVertexArray()
-{
-  const std::size_t strideU = 1;
-  const std::size_t strideV = m_width;
-
-  const std::size_t numElems = _mesh.m_nArrayWidth*_mesh.m_nArrayHeight; // total number of elements in vertex array
-
-  const bool bWidthStrips = (_mesh.m_nArrayWidth >= _mesh.m_nArrayHeight); // decide if horizontal strips are longer than vertical
-
-
-  // allocate vertex, normal, texcoord and primitive-index arrays
-  _mesh.vertices.resize(numElems);
-  _mesh.indices.resize(_mesh.m_nArrayWidth *2 * (_mesh.m_nArrayHeight - 1));
-
-  // set up strip indices
-  if(bWidthStrips)
-  {
-    _mesh.m_numStrips = _mesh.m_nArrayHeight-1;
-    _mesh.m_lenStrips = _mesh.m_nArrayWidth*2;
-
-    for(std::size_t i=0; i<_mesh.m_nArrayWidth; i++)
-    {
-      for(std::size_t j=0; j<_mesh.m_numStrips; j++)
-      {
-        _mesh.indices[(j*_mesh.m_lenStrips)+i*2] = RenderIndex(j*_mesh.m_nArrayWidth+i);
-        _mesh.indices[(j*_mesh.m_lenStrips)+i*2+1] = RenderIndex((j+1)*_mesh.m_nArrayWidth+i);
-        // reverse because radiant uses CULL_FRONT
-        //_mesh.indices[(j*_mesh.m_lenStrips)+i*2+1] = RenderIndex(j*_mesh.m_nArrayWidth+i);
-        //_mesh.indices[(j*_mesh.m_lenStrips)+i*2] = RenderIndex((j+1)*_mesh.m_nArrayWidth+i);
-      }
-    }
-  }
-  else
-  {
-    _mesh.m_numStrips = _mesh.m_nArrayWidth-1;
-    _mesh.m_lenStrips = _mesh.m_nArrayHeight*2;
-
-    for(std::size_t i=0; i<_mesh.m_nArrayHeight; i++)
-    {
-      for(std::size_t j=0; j<_mesh.m_numStrips; j++)
-      {
-        _mesh.indices[(j*_mesh.m_lenStrips)+i*2] = RenderIndex(((_mesh.m_nArrayHeight-1)-i)*_mesh.m_nArrayWidth+j);
-        _mesh.indices[(j*_mesh.m_lenStrips)+i*2+1] = RenderIndex(((_mesh.m_nArrayHeight-1)-i)*_mesh.m_nArrayWidth+j+1);
-        // reverse because radiant uses CULL_FRONT
-        //_mesh.indices[(j*_mesh.m_lenStrips)+i*2+1] = RenderIndex(((_mesh.m_nArrayHeight-1)-i)*_mesh.m_nArrayWidth+j);
-        //_mesh.indices[(j*_mesh.m_lenStrips)+i*2] = RenderIndex(((_mesh.m_nArrayHeight-1)-i)*_mesh.m_nArrayWidth+j+1);
-
-      }
-    }
-  }
-
-  {
-    PatchControlIter pCtrl = m_ctrlTransformed.begin();
-    for(std::size_t j = 0, offStartY = 0; j+1 < m_height; j += 2, pCtrl += (strideU + strideV))
-    {
-      // set up array offsets for this sub-patch
-		const bool leafY = (m_patchDef3) ? false : _mesh.curveTreeV[j>>1]->isLeaf();
-      const std::size_t offMidY = (m_patchDef3) ? 0 : _mesh.curveTreeV[j>>1]->index;
-      const std::size_t widthY = _mesh.arrayHeight[j>>1] * _mesh.m_nArrayWidth;
-      const std::size_t offEndY = offStartY + widthY;
-
-      for(std::size_t i = 0, offStartX = 0; i+1 < m_width; i += 2, pCtrl += (strideU << 1))
-      {
-		  const bool leafX = (m_patchDef3) ? false : _mesh.curveTreeU[i>>1]->isLeaf();
-        const std::size_t offMidX = (m_patchDef3) ? 0 : _mesh.curveTreeU[i>>1]->index;
-        const std::size_t widthX = _mesh.arrayWidth[i>>1];
-        const std::size_t offEndX = offStartX + widthX;
-
-        PatchControlIter subMatrix[3][3];
-        subMatrix[0][0] = pCtrl;
-        subMatrix[0][1] = subMatrix[0][0]+strideU;
-        subMatrix[0][2] = subMatrix[0][1]+strideU;
-        subMatrix[1][0] = subMatrix[0][0]+strideV;
-        subMatrix[1][1] = subMatrix[1][0]+strideU;
-        subMatrix[1][2] = subMatrix[1][1]+strideU;
-        subMatrix[2][0] = subMatrix[1][0]+strideV;
-        subMatrix[2][1] = subMatrix[2][0]+strideU;
-        subMatrix[2][2] = subMatrix[2][1]+strideU;
-
-        // assign on-patch control points to vertex array
-        if(i == 0 && j == 0)
-        {
-          vertex_clear_normal(_mesh.vertices[offStartX + offStartY]);
-        }
-        vertex_assign_ctrl(_mesh.vertices[offStartX + offStartY], *subMatrix[0][0]);
-        if(j == 0)
-        {
-          vertex_clear_normal(_mesh.vertices[offEndX + offStartY]);
-        }
-        vertex_assign_ctrl(_mesh.vertices[offEndX + offStartY], *subMatrix[0][2]);
-        if(i == 0)
-        {
-          vertex_clear_normal(_mesh.vertices[offStartX + offEndY]);
-        }
-        vertex_assign_ctrl(_mesh.vertices[offStartX + offEndY], *subMatrix[2][0]);
-
-        vertex_clear_normal(_mesh.vertices[offEndX + offEndY]);
-        vertex_assign_ctrl(_mesh.vertices[offEndX + offEndY], *subMatrix[2][2]);
-
-        if(!m_patchDef3)
-        {
-          // assign remaining control points to vertex array
-          if(!leafX)
-          {
-            vertex_assign_ctrl(_mesh.vertices[offMidX + offStartY], *subMatrix[0][1]);
-            vertex_assign_ctrl(_mesh.vertices[offMidX + offEndY], *subMatrix[2][1]);
-          }
-          if(!leafY)
-          {
-            vertex_assign_ctrl(_mesh.vertices[offStartX + offMidY], *subMatrix[1][0]);
-            vertex_assign_ctrl(_mesh.vertices[offEndX + offMidY], *subMatrix[1][2]);
-
-            if(!leafX)
-            {
-              vertex_assign_ctrl(_mesh.vertices[offMidX + offMidY], *subMatrix[1][1]);
-            }
-          }
-        }
-
-        // test all 12 edges for degeneracy
-        unsigned int nFlagsX = subarray_get_degen(pCtrl, strideU, strideV);
-        unsigned int nFlagsY = subarray_get_degen(pCtrl, strideV, strideU);
-        Vector3 tangentX[6], tangentY[6];
-        Vector2 tangentS[6], tangentT[6];
-
-        // set up tangents for each of the 12 edges if they were not degenerate
-        if(!(nFlagsX & DEGEN_0a))
-        {
-          tangentX[0] = subMatrix[0][1]->vertex - subMatrix[0][0]->vertex;
-          tangentS[0] = subMatrix[0][1]->texcoord - subMatrix[0][0]->texcoord;
-        }
-        if(!(nFlagsX & DEGEN_0b))
-        {
-          tangentX[1] = subMatrix[0][2]->vertex - subMatrix[0][1]->vertex;
-          tangentS[1] = subMatrix[0][2]->texcoord - subMatrix[0][1]->texcoord;
-        }
-        if(!(nFlagsX & DEGEN_1a))
-        {
-          tangentX[2] = subMatrix[1][1]->vertex - subMatrix[1][0]->vertex;
-          tangentS[2] = subMatrix[1][1]->texcoord - subMatrix[1][0]->texcoord;
-        }
-        if(!(nFlagsX & DEGEN_1b))
-        {
-          tangentX[3] = subMatrix[1][2]->vertex - subMatrix[1][1]->vertex;
-          tangentS[3] = subMatrix[1][2]->texcoord - subMatrix[1][1]->texcoord;
-        }
-        if(!(nFlagsX & DEGEN_2a))
-        {
-          tangentX[4] = subMatrix[2][1]->vertex - subMatrix[2][0]->vertex;
-          tangentS[4] = subMatrix[2][1]->texcoord - subMatrix[2][0]->texcoord;
-        }
-        if(!(nFlagsX & DEGEN_2b))
-        {
-          tangentX[5] = subMatrix[2][2]->vertex - subMatrix[2][1]->vertex;
-          tangentS[5] = subMatrix[2][2]->texcoord - subMatrix[2][1]->texcoord;
-        }
-
-        if(!(nFlagsY & DEGEN_0a))
-        {
-          tangentY[0] = subMatrix[1][0]->vertex - subMatrix[0][0]->vertex;
-          tangentT[0] = subMatrix[1][0]->texcoord - subMatrix[0][0]->texcoord;
-        }
-        if(!(nFlagsY & DEGEN_0b))
-        {
-          tangentY[1] = subMatrix[2][0]->vertex - subMatrix[1][0]->vertex;
-          tangentT[1] = subMatrix[2][0]->texcoord - subMatrix[1][0]->texcoord;
-        }
-        if(!(nFlagsY & DEGEN_1a))
-        {
-          tangentY[2] = subMatrix[1][1]->vertex - subMatrix[0][1]->vertex;
-          tangentT[2] = subMatrix[1][1]->texcoord - subMatrix[0][1]->texcoord;
-        }
-        if(!(nFlagsY & DEGEN_1b))
-        {
-          tangentY[3] = subMatrix[2][1]->vertex - subMatrix[1][1]->vertex;
-          tangentT[3] = subMatrix[2][1]->texcoord - subMatrix[1][1]->texcoord;
-        }
-        if(!(nFlagsY & DEGEN_2a))
-        {
-          tangentY[4] = subMatrix[1][2]->vertex - subMatrix[0][2]->vertex;
-          tangentT[4] = subMatrix[1][2]->texcoord - subMatrix[0][2]->texcoord;
-        }
-        if(!(nFlagsY & DEGEN_2b))
-        {
-          tangentY[5] = subMatrix[2][2]->vertex - subMatrix[1][2]->vertex;
-          tangentT[5] = subMatrix[2][2]->texcoord - subMatrix[1][2]->texcoord;
-        }
-
-        // set up remaining edge tangents by borrowing the tangent from the closest parallel non-degenerate edge
-        tangents_remove_degenerate(tangentX, tangentS, nFlagsX);
-        tangents_remove_degenerate(tangentY, tangentT, nFlagsY);
-
-        {
-          // x=0, y=0
-          std::size_t index = offStartX + offStartY;
-          std::size_t index0 = 0;
-          std::size_t index1 = 0;
-
-          double dot = tangentX[index0].dot(tangentY[index1]);
-          double length = tangentX[index0].getLength() * tangentY[index1].getLength();
-
-          bestTangents00(nFlagsX, dot, length, index0, index1);
-
-          accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
-        }
-
-        {
-          // x=1, y=0
-          std::size_t index = offEndX + offStartY;
-          std::size_t index0 = 1;
-          std::size_t index1 = 4;
-
-          double dot = tangentX[index0].dot(tangentY[index1]);
-          double length = tangentX[index0].getLength() * tangentY[index1].getLength();
-
-          bestTangents10(nFlagsX, dot, length, index0, index1);
-
-          accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
-        }
-
-        {
-          // x=0, y=1
-          std::size_t index = offStartX + offEndY;
-          std::size_t index0 = 4;
-          std::size_t index1 = 1;
-
-          double dot = tangentX[index0].dot(tangentY[index1]);
-          double length = tangentX[index1].getLength() * tangentY[index1].getLength();
-
-          bestTangents01(nFlagsX, dot, length, index0, index1);
-
-          accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
-        }
-
-        {
-          // x=1, y=1
-          std::size_t index = offEndX + offEndY;
-          std::size_t index0 = 5;
-          std::size_t index1 = 5;
-
-          double dot = tangentX[index0].dot(tangentY[index1]);
-          double length = tangentX[index0].getLength() * tangentY[index1].getLength();
-
-          bestTangents11(nFlagsX, dot, length, index0, index1);
-
-          accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
-        }
-
-        //normalise normals that won't be accumulated again
-        if(i!=0 || j!=0)
-        {
-			normalise_safe(_mesh.vertices[offStartX + offStartY].normal);
-			normalise_safe(_mesh.vertices[offStartX + offStartY].tangent);
-			normalise_safe(_mesh.vertices[offStartX + offStartY].bitangent);
-        }
-        if(i+3 == m_width)
-        {
-			normalise_safe(_mesh.vertices[offEndX + offStartY].normal);
-			normalise_safe(_mesh.vertices[offEndX + offStartY].tangent);
-			normalise_safe(_mesh.vertices[offEndX + offStartY].bitangent);
-        }
-        if(j+3 == m_height)
-        {
-			normalise_safe(_mesh.vertices[offStartX + offEndY].normal);
-			normalise_safe(_mesh.vertices[offStartX + offEndY].tangent);
-			normalise_safe(_mesh.vertices[offStartX + offEndY].bitangent);
-        }
-        if(i+3 == m_width && j+3 == m_height)
-        {
-			normalise_safe(_mesh.vertices[offEndX + offEndY].normal);
-			normalise_safe(_mesh.vertices[offEndX + offEndY].tangent);
-			normalise_safe(_mesh.vertices[offEndX + offEndY].bitangent);
-        }
-
-        // set flags to average normals between shared edges
-        if(j != 0)
-        {
-          nFlagsX |= AVERAGE;
-        }
-        if(i != 0)
-        {
-          nFlagsY |= AVERAGE;
-        }
-        // set flags to save evaluating shared edges twice
-        nFlagsX |= SPLIT;
-        nFlagsY |= SPLIT;
-
-        // if the patch is curved.. tesselate recursively
-        // use the relevant control curves for this sub-patch
-        if(m_patchDef3)
-        {
-          TesselateSubMatrixFixed(&_mesh.vertices[offStartX + offStartY], 1, _mesh.m_nArrayWidth, nFlagsX, nFlagsY, subMatrix);
-        }
-        else
-        {
-          if(!leafX)
-          {
-            TesselateSubMatrix( _mesh.curveTreeU[i>>1], _mesh.curveTreeV[j>>1],
-                                offStartX, offStartY, offEndX, offEndY, // array offsets
-                                nFlagsX, nFlagsY,
-                                subMatrix[1][0]->vertex, subMatrix[1][1]->vertex, subMatrix[1][2]->vertex,
-                                subMatrix[1][0]->texcoord, subMatrix[1][1]->texcoord, subMatrix[1][2]->texcoord,
-                                false );
-          }
-          else if(!leafY)
-          {
-            TesselateSubMatrix( _mesh.curveTreeV[j>>1], _mesh.curveTreeU[i>>1],
-                                offStartY, offStartX, offEndY, offEndX, // array offsets
-                                nFlagsY, nFlagsX,
-                                subMatrix[0][1]->vertex, subMatrix[1][1]->vertex, subMatrix[2][1]->vertex,
-                                subMatrix[0][1]->texcoord, subMatrix[1][1]->texcoord, subMatrix[2][1]->texcoord,
-                                true );
-          }
-        }
-
-        offStartX = offEndX;
-      }
-      offStartY = offEndY;
-    }
-  }
-}
-
 Vector3 getAverageNormal(const Vector3& normal1, const Vector3& normal2, double thickness)
 {
 	// Beware of normals with 0 length
@@ -4094,44 +2788,47 @@ bool Patch::subdivionsFixed() const {
 
 bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 {
-	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
+	// The tesselation is relative to the mesh offset
+	Ray localRay(ray.origin - _meshOffset, ray.direction);
+
+	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh->indices.begin();
 
 	// Go over each quad strip and intersect the ray with its triangles
-	for (std::size_t strip = 0; strip < _mesh.m_numStrips; ++strip)
+	for (std::size_t strip = 0; strip < _mesh->m_numStrips; ++strip)
 	{
 		// Iterate over the indices. The +2 increment will lead up to the next quad
 		for (std::vector<RenderIndex>::const_iterator indexIter = stripStartIndex;
-			indexIter + 2 < stripStartIndex + _mesh.m_lenStrips; indexIter += 2)
+			indexIter + 2 < stripStartIndex + _mesh->m_lenStrips; indexIter += 2)
 		{
 			Vector3 triangleIntersection;
 
 			// Run a selection test against the quad's triangles
 			{
-				const Vector3& p1 = _mesh.vertices[*indexIter].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 2)].vertex;
+				const Vector3& p1 = _mesh->vertices[*indexIter].vertex;
+				const Vector3& p2 = _mesh->vertices[*(indexIter + 1)].vertex;
+				const Vector3& p3 = _mesh->vertices[*(indexIter + 2)].vertex;
 
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
+				if (localRay.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
 				{
-					intersection = triangleIntersection;
+					intersection = triangleIntersection + _meshOffset;
 					return true;
 				}
 			}
 
 			{
-				const Vector3& p1 = _mesh.vertices[*(indexIter + 2)].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 3)].vertex;
+				const Vector3& p1 = _mesh->vertices[*(indexIter + 2)].vertex;
+				const Vector3& p2 = _mesh->vertices[*(indexIter + 1)].vertex;
+				const Vector3& p3 = _mesh->vertices[*(indexIter + 3)].vertex;
 
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
+				if (localRay.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
 				{
-					intersection = triangleIntersection;
+					intersection = triangleIntersection + _meshOffset;
 					return true;
 				}
 			}
 		}
 
-		stripStartIndex += _mesh.m_lenStrips;
+		stripStartIndex += _mesh->m_lenStrips;
 	}
 
 	return false;
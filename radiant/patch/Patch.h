@@ -12,7 +12,7 @@
 
 #include "PatchConstants.h"
 #include "PatchControl.h"
-#include "PatchTesselation.h"
+#include "PatchTesselationCache.h"
 #include "PatchRenderables.h"
 #include "brush/TexDef.h"
 #include "brush/FacePlane.h"
@@ -51,8 +51,10 @@ class Patch :
 	PatchControlArray m_ctrlTransformed;	// a temporary control array used during transformations, so that the
 											// changes can be reverted and overwritten by <m_ctrl>
 
-	// The tesselation for this patch
-	PatchTesselation _mesh;
+	// The tesselation for this patch, shared with all patches of the same shape.
+	// Its vertices are relative to the offset (the first control point).
+	PatchTesselationPtr _mesh;
+	Vector3 _meshOffset;
 
 	// The OpenGL renderables for three rendering modes
 	RenderablePatchSolid _solidRenderable;
@@ -198,7 +200,8 @@ public:
 		return m_ctrl.end();
 	}
 
-	PatchTesselation& getTesselation();
+	// Returns the tesselation, which is relative to the first control point
+	const PatchTesselation& getTesselation();
 
 	// Returns a copy of the tesselated geometry
 	PatchMesh getTesselatedPatchMesh() const;
@@ -369,23 +372,4 @@ private:
 	void check_shader();
 
 	void updateAABB();
-
-	void TesselateSubMatrixFixed(ArbitraryMeshVertex* vertices,
-								 std::size_t strideX, std::size_t strideY,
-								 unsigned int nFlagsX, unsigned int nFlagsY,
-								 PatchControlIter subMatrix[3][3]);
-
-	// uses binary trees representing bezier curves to recursively tesselate a bezier sub-patch
-	void TesselateSubMatrix( const BezierCurveTree *BX, const BezierCurveTree *BY,
-                           std::size_t offStartX, std::size_t offStartY,
-                           std::size_t offEndX, std::size_t offEndY,
-                           std::size_t nFlagsX, std::size_t nFlagsY,
-                           Vector3& left, Vector3& mid, Vector3& right,
-                           Vector2& texLeft, Vector2& texMid, Vector2& texRight,
-                           bool bTranspose );
-
-	// tesselates the entire surface
-	void BuildTesselationCurves(EMatrixMajor major);
-	void accumulateVertexTangentSpace(std::size_t index, Vector3 tangentX[6], Vector3 tangentY[6], Vector2 tangentS[6], Vector2 tangentT[6], std::size_t index0, std::size_t index1);
-	void BuildVertexArray();
 };
@@ -1,11 +1,7 @@
 #include "PatchBezier.h"
 
+#include <algorithm>
 #include "math/pi.h"
-#include "registry/registry.h"
-
-	namespace {
-		const std::string RKEY_PATCH_SUBDIVIDE_THRESHOLD = "user/ui/patch/subdivideThreshold";
-	}
 
 /* greebo: These are a lot of helper functions related to bezier curves
  */
@@ -16,7 +12,7 @@ void BezierInterpolate(BezierCurve *pCurve) {
 	pCurve->crd = pCurve->left.mid(pCurve->right);
 }
 
-bool BezierCurve::isCurved() const
+bool BezierCurve::isCurved(float subdivideThreshold) const
 {
 	// Calculate the deltas
 	Vector3 vTemp(right - left);
@@ -53,8 +49,6 @@ bool BezierCurve::isCurved() const
 
 	const double index = width * angle;
 
-	static float subdivideThreshold = registry::getValue<float>(RKEY_PATCH_SUBDIVIDE_THRESHOLD);
-
 	if (index > subdivideThreshold)
 	{
 		return true;
@@ -127,58 +121,80 @@ std::size_t BezierCurveTree::setup(std::size_t idx, std::size_t stride)
 
 const std::size_t PATCH_MAX_SUBDIVISION_DEPTH = 16;
 
-void BezierCurveTree_FromCurveList(BezierCurveTree *pTree, BezierCurveList& curveList, std::size_t depth)
+BezierCurveTree* BezierCurveTreePool::allocate()
+{
+	if (_numUsed == _nodes.size())
+	{
+		_nodes.push_back(BezierCurveTree());
+	}
+
+	BezierCurveTree* node = &_nodes[_numUsed++];
+
+	node->left = NULL;
+	node->right = NULL;
+
+	return node;
+}
+
+BezierCurveTree* BezierCurveTreeBuilder::build(BezierCurveTreePool& pool, float subdivideThreshold)
 {
-	BezierCurveList leftList;
-	BezierCurveList rightList;
+	// The curve lists used to be assembled using push_front(), which reversed the order of the curves.
+	// Only the curves from the first curved one onwards are subdivided, so keep processing them in that order.
+	std::reverse(_curves.begin(), _curves.end());
+
+	BezierCurveTree* root = pool.allocate();
 
-	bool listSplit = false;
+	_ranges.clear();
+	_ranges.push_back(CurveRange(root, 0, _curves.size(), 0));
 
-	// Traverse the list and interpolate all curves which satisfy the "isCurved" condition
-	for (BezierCurveList::iterator l = curveList.begin(); l != curveList.end(); ++l)
+	while (!_ranges.empty())
 	{
-		BezierCurve* curve = *l;
+		CurveRange range = _ranges.back();
+		_ranges.pop_back();
 
-		if (listSplit || curve->isCurved())
+		// The ranges are processed depth-first, everything behind this one has been sorted into the tree already
+		const std::size_t end = range.first + range.count;
+		_curves.resize(end);
+
+		if (range.depth == PATCH_MAX_SUBDIVISION_DEPTH)
 		{
-			// Set the flag to TRUE to indicate that we already subdivided one part of this list
-			// All other parts will be subdivided too
-			listSplit = true;
+			continue;
+		}
 
-			// Split this curve in two, by allocating two new curves
-			BezierCurve* leftCurve = new BezierCurve;
-			BezierCurve* rightCurve = new BezierCurve;
+		// Find the first curve satisfying the "isCurved" condition, all the following ones are subdivided too
+		std::size_t first = range.first;
 
-			// Let the current curve submit interpolation data to the newly allocated curves
-			curve->interpolate(leftCurve, rightCurve);
+		while (first != end && !_curves[first].isCurved(subdivideThreshold))
+		{
+			++first;
+		}
 
-			// Add the new curves to the allocated list
-			leftList.push_front(leftCurve);
-			rightList.push_front(rightCurve);
+		// If no subdivisions have been calculated, just leave this tree node, children are NULL by default
+		if (first == end)
+		{
+			continue;
 		}
-	}
 
-	// If we have a subdivision in this list, enter to the next level of recursion
-	if (!leftList.empty() && !rightList.empty() && depth != PATCH_MAX_SUBDIVISION_DEPTH)
-	{
-		// Allocate two new tree nodes for the left and right part
-		pTree->left = new BezierCurveTree;
-		pTree->right = new BezierCurveTree;
+		const std::size_t count = end - first;
+		const std::size_t leftFirst = end;
+		const std::size_t rightFirst = leftFirst + count;
 
-		BezierCurveTree_FromCurveList(pTree->left, leftList, depth + 1);
-		BezierCurveTree_FromCurveList(pTree->right, rightList, depth + 1);
+		_curves.resize(rightFirst + count);
 
-		// Free the left and right lists from this level recursion
-		std::for_each(leftList.begin(), leftList.end(), [] (BezierCurve* curve)
+		// Split the curves in two, the halves are stored in reverse order (as push_front did before)
+		for (std::size_t i = 0; i < count; ++i)
 		{
-			delete curve;
-		});
+			_curves[first + i].interpolate(&_curves[rightFirst - 1 - i], &_curves[rightFirst + count - 1 - i]);
+		}
 
-		std::for_each(rightList.begin(), rightList.end(), [] (BezierCurve* curve)
-		{
-			delete curve;
-		});
+		range.node->left = pool.allocate();
+		range.node->right = pool.allocate();
+
+		_ranges.push_back(CurveRange(range.node->left, leftFirst, count, range.depth + 1));
+		_ranges.push_back(CurveRange(range.node->right, rightFirst, count, range.depth + 1));
 	}
 
-	// If no subdivisions have been calculated, just leave this tree node, children are NULL by default
+	_curves.clear();
+
+	return root;
 }
@@ -3,7 +3,7 @@
 #include "math/Vector3.h"
 #include <limits>
 #include <vector>
-#include <forward_list>
+#include <deque>
 
 struct BezierCurve
 {
@@ -21,8 +21,9 @@ struct BezierCurve
 	{}
 
 	// Returns true if the given set of coordinates satisfies the "curved" condition
-	// This is determined by comparing the directions of the various deltas
-	bool isCurved() const;
+	// This is determined by comparing the directions of the various deltas,
+	// curves whose index exceeds the given threshold are subdivided.
+	bool isCurved(float subdivideThreshold) const;
 
 	// Interpolates the curve values and writes them to <leftCurve> and <rightCurve>
 	// which will form two new (connected) segments interpolating the current one.
@@ -49,12 +50,6 @@ public:
 		right(NULL)
 	{}
 
-	~BezierCurveTree()
-	{
-		delete left;	// it's safe to pass NULL to delete
-		delete right;
-	}
-
 	// Returns TRUE when no more subdivisions are available beyond this depth
 	bool isLeaf() const
 	{
@@ -67,14 +62,71 @@ public:
 	std::size_t setup(std::size_t idx, std::size_t stride);
 };
 
-typedef std::forward_list<BezierCurve*> BezierCurveList;
+/**
+ * greebo: The nodes of a BezierCurveTree are owned by a pool, which
+ * keeps them around for the next time the tree is rebuilt. Clearing the
+ * pool invalidates all nodes handed out so far, without freeing any memory.
+ */
+class BezierCurveTreePool
+{
+private:
+	// A deque doesn't move its elements when growing
+	std::deque<BezierCurveTree> _nodes;
+	std::size_t _numUsed;
 
-void BezierCurveTree_FromCurveList(BezierCurveTree *pTree, BezierCurveList& curveList, std::size_t depth = 0);
+public:
+	BezierCurveTreePool() :
+		_numUsed(0)
+	{}
 
-void BezierInterpolate(BezierCurve *pCurve);
+	// Returns a leaf node, valid until this pool is cleared
+	BezierCurveTree* allocate();
+
+	void clear()
+	{
+		_numUsed = 0;
+	}
+};
 
-inline void BezierCurveTreeArray_deleteAll(std::vector<BezierCurveTree*>& curveTrees) {
-  for(std::vector<BezierCurveTree*>::iterator i = curveTrees.begin(); i != curveTrees.end(); ++i) {
-     delete *i;
-  }
-}
+typedef std::vector<BezierCurve> BezierCurveList;
+
+/**
+ * Turns a list of curves into a BezierCurveTree by subdividing them until
+ * they're flat enough. This doesn't recurse, the interpolated curves are
+ * kept in a buffer which is reused by subsequent runs.
+ */
+class BezierCurveTreeBuilder
+{
+private:
+	// A part of the curve buffer waiting to be sorted into the given node
+	struct CurveRange
+	{
+		BezierCurveTree* node;
+		std::size_t first;
+		std::size_t count;
+		std::size_t depth;
+
+		CurveRange(BezierCurveTree* node_, std::size_t first_, std::size_t count_, std::size_t depth_) :
+			node(node_),
+			first(first_),
+			count(count_),
+			depth(depth_)
+		{}
+	};
+
+	BezierCurveList _curves;
+	std::vector<CurveRange> _ranges;
+
+public:
+	// Adds a control curve to the list of the next tree to build
+	void addCurve(const BezierCurve& curve)
+	{
+		_curves.push_back(curve);
+	}
+
+	// Builds the tree out of the curves added so far, the nodes are taken from the given pool.
+	// The list of curves is empty afterwards.
+	BezierCurveTree* build(BezierCurveTreePool& pool, float subdivideThreshold);
+};
+
+void BezierInterpolate(BezierCurve *pCurve);
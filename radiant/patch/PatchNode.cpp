@@ -130,8 +130,7 @@ void PatchNode::testSelect(Selector& selector, SelectionTest& test) {
 	if (!isVisible())
 		return;
 
-    test.BeginMesh(localToWorld(), true);
-    // Pass the selection test call to the patch
+    // Pass the selection test call to the patch, which sets up the mesh transform
     m_patch.testSelect(selector, test);
 }
 
@@ -288,6 +287,10 @@ bool PatchNode::intersectsLight(const RendererLight& light) const {
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB PatchNode::litObjectAABB() const {
+	return worldAABB();
+}
+
 void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
 {
 	// Don't render invisible shaders
@@ -125,6 +125,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const;
+	AABB litObjectAABB() const;
 
 	// Renderable implementation
 
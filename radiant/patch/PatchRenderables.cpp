@@ -1,5 +1,20 @@
 #include "PatchRenderables.h"
 
+namespace
+{
+    // Tesselations are shared among identical patches, this moves the vertices to their actual location
+    void getTranslatedVertices(const PatchTesselation& tess, const Vector3& offset,
+        std::vector<ArbitraryMeshVertex>& vertices)
+    {
+        vertices = tess.vertices;
+
+        for (std::vector<ArbitraryMeshVertex>::iterator i = vertices.begin(); i != vertices.end(); ++i)
+        {
+            i->vertex += offset;
+        }
+    }
+}
+
 void RenderablePatchWireframe::render(const RenderInfo& info) const
 {
     // No colour changing
@@ -9,53 +24,54 @@ void RenderablePatchWireframe::render(const RenderInfo& info) const
         glColor3f(1, 1, 1);
     }
 
-    if (_tess.vertices.empty()) return;
+    if (_tess->vertices.empty()) return;
 
     if (_needsUpdate)
     {
         _needsUpdate = false;
 
-        const std::vector<ArbitraryMeshVertex>& patchVerts = _tess.vertices;
+        std::vector<ArbitraryMeshVertex> patchVerts;
+        getTranslatedVertices(*_tess, _offset, patchVerts);
 
         // Vertex buffer to receive and render vertices
         VertexBuffer_T currentVBuf;
 
         std::size_t firstIndex = 0;
-        for (std::size_t i = 0; i <= _tess.curveTreeV.size(); ++i)
+        for (std::size_t i = 0; i <= _tess->curveTreeV.size(); ++i)
         {
             currentVBuf.addBatch(patchVerts.begin() + firstIndex,
-                _tess.m_nArrayWidth);
+                _tess->m_nArrayWidth);
 
-            if (i == _tess.curveTreeV.size()) break;
+            if (i == _tess->curveTreeV.size()) break;
 
-            if (!_tess.curveTreeV[i]->isLeaf())
+            if (!_tess->curveTreeV[i]->isLeaf())
             {
                 currentVBuf.addBatch(
-                    patchVerts.begin() + GLint(_tess.curveTreeV[i]->index),
-                    _tess.m_nArrayWidth
+                    patchVerts.begin() + GLint(_tess->curveTreeV[i]->index),
+                    _tess->m_nArrayWidth
                     );
             }
 
-            firstIndex += (_tess.arrayHeight[i] * _tess.m_nArrayWidth);
+            firstIndex += (_tess->arrayHeight[i] * _tess->m_nArrayWidth);
         }
 
         const ArbitraryMeshVertex* p = &patchVerts.front();
-        std::size_t uStride = _tess.m_nArrayWidth;
-        for (std::size_t i = 0; i <= _tess.curveTreeU.size(); ++i)
+        std::size_t uStride = _tess->m_nArrayWidth;
+        for (std::size_t i = 0; i <= _tess->curveTreeU.size(); ++i)
         {
-            currentVBuf.addBatch(p, _tess.m_nArrayHeight, uStride);
+            currentVBuf.addBatch(p, _tess->m_nArrayHeight, uStride);
 
-            if (i == _tess.curveTreeU.size()) break;
+            if (i == _tess->curveTreeU.size()) break;
 
-            if (!_tess.curveTreeU[i]->isLeaf())
+            if (!_tess->curveTreeU[i]->isLeaf())
             {
                 currentVBuf.addBatch(
-                    patchVerts.begin() + _tess.curveTreeU[i]->index,
-                    _tess.m_nArrayHeight, uStride
+                    patchVerts.begin() + _tess->curveTreeU[i]->index,
+                    _tess->m_nArrayHeight, uStride
                     );
             }
 
-            p += _tess.arrayWidth[i];
+            p += _tess->arrayWidth[i];
         }
 
         // Render all vertex batches
@@ -72,7 +88,7 @@ void RenderablePatchWireframe::queueUpdate()
 
 void RenderablePatchFixedWireframe::render(const RenderInfo& info) const
 {
-    if (_tess.vertices.empty() || _tess.indices.empty()) return;
+    if (_tess->vertices.empty() || _tess->indices.empty()) return;
 
     // No colour changing
     glDisableClientState(GL_COLOR_ARRAY);
@@ -87,15 +103,18 @@ void RenderablePatchFixedWireframe::render(const RenderInfo& info) const
 
         // Create a VBO and add the vertex data
         VertexBuffer_T currentVBuf;
-        currentVBuf.addVertices(_tess.vertices.begin(), _tess.vertices.end());
+        std::vector<ArbitraryMeshVertex> vertices;
+        getTranslatedVertices(*_tess, _offset, vertices);
+
+        currentVBuf.addVertices(vertices.begin(), vertices.end());
 
         // Submit index batches
-        const RenderIndex* strip_indices = &_tess.indices.front();
+        const RenderIndex* strip_indices = &_tess->indices.front();
         for (std::size_t i = 0;
-            i < _tess.m_numStrips;
-            i++, strip_indices += _tess.m_lenStrips)
+            i < _tess->m_numStrips;
+            i++, strip_indices += _tess->m_lenStrips)
         {
-            currentVBuf.addIndexBatch(strip_indices, _tess.m_lenStrips);
+            currentVBuf.addIndexBatch(strip_indices, _tess->m_lenStrips);
         }
 
         // Render all index batches
@@ -110,14 +129,15 @@ void RenderablePatchFixedWireframe::queueUpdate()
     _needsUpdate = true;
 }
 
-RenderablePatchSolid::RenderablePatchSolid(PatchTesselation& tess) :
+RenderablePatchSolid::RenderablePatchSolid(const PatchTesselationPtr& tess, const Vector3& offset) :
     _tess(tess),
+    _offset(offset),
     _needsUpdate(true)
 {}
 
 void RenderablePatchSolid::render(const RenderInfo& info) const
 {
-    if (_tess.vertices.empty() || _tess.indices.empty()) return;
+    if (_tess->vertices.empty() || _tess->indices.empty()) return;
 
     if (!info.checkFlag(RENDER_BUMP))
     {
@@ -137,15 +157,18 @@ void RenderablePatchSolid::render(const RenderInfo& info) const
 
         // Add vertex geometry to vertex buffer
         VertexBuffer_T currentVBuf;
-        currentVBuf.addVertices(_tess.vertices.begin(), _tess.vertices.end());
+        std::vector<ArbitraryMeshVertex> vertices;
+        getTranslatedVertices(*_tess, _offset, vertices);
+
+        currentVBuf.addVertices(vertices.begin(), vertices.end());
 
         // Submit indices
-        const RenderIndex* strip_indices = &_tess.indices.front();
+        const RenderIndex* strip_indices = &_tess->indices.front();
         for (std::size_t i = 0;
-            i < _tess.m_numStrips;
-            i++, strip_indices += _tess.m_lenStrips)
+            i < _tess->m_numStrips;
+            i++, strip_indices += _tess->m_lenStrips)
         {
-            currentVBuf.addIndexBatch(strip_indices, _tess.m_lenStrips);
+            currentVBuf.addIndexBatch(strip_indices, _tess->m_lenStrips);
         }
 
         // Render all batches
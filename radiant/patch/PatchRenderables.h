@@ -7,7 +7,7 @@
 #pragma once
 
 #include "igl.h"
-#include "PatchTesselation.h"
+#include "PatchTesselationCache.h"
 
 #include "render/VertexBuffer.h"
 #include "render/IndexedVertexBuffer.h"
@@ -15,8 +15,9 @@
 /// Helper class to render a PatchTesselation in wireframe mode
 class RenderablePatchWireframe : public OpenGLRenderable
 {
-    // Geometry source
-    const PatchTesselation& _tess;
+    // Geometry source, relative to the offset
+    const PatchTesselationPtr& _tess;
+    const Vector3& _offset;
 
     // VertexBuffer for rendering
     typedef render::VertexBuffer<Vertex3f> VertexBuffer_T;
@@ -26,8 +27,9 @@ class RenderablePatchWireframe : public OpenGLRenderable
 
 public:
 
-    RenderablePatchWireframe(const PatchTesselation& tess) : 
+    RenderablePatchWireframe(const PatchTesselationPtr& tess, const Vector3& offset) : 
         _tess(tess),
+        _offset(offset),
         _needsUpdate(true)
     { }
 
@@ -39,8 +41,9 @@ public:
 /// Helper class to render a fixed geometry PatchTesselation in wireframe mode
 class RenderablePatchFixedWireframe : public OpenGLRenderable
 {
-    // Geometry source
-    PatchTesselation& _tess;
+    // Geometry source, relative to the offset
+    const PatchTesselationPtr& _tess;
+    const Vector3& _offset;
 
     // VertexBuffer for rendering
     typedef render::IndexedVertexBuffer<Vertex3f> VertexBuffer_T;
@@ -50,8 +53,9 @@ class RenderablePatchFixedWireframe : public OpenGLRenderable
 
 public:
 
-    RenderablePatchFixedWireframe(PatchTesselation& tess) : 
+    RenderablePatchFixedWireframe(const PatchTesselationPtr& tess, const Vector3& offset) : 
         _tess(tess),
+        _offset(offset),
         _needsUpdate(true)
     {}
 
@@ -64,8 +68,9 @@ public:
 class RenderablePatchSolid :
 	public OpenGLRenderable
 {
-    // Geometry source
-	PatchTesselation& _tess;
+    // Geometry source, relative to the offset
+	const PatchTesselationPtr& _tess;
+	const Vector3& _offset;
 
     // VertexBuffer for rendering
     typedef render::IndexedVertexBuffer<ArbitraryMeshVertex> VertexBuffer_T;
@@ -74,7 +79,7 @@ class RenderablePatchSolid :
     mutable bool _needsUpdate;
 
 public:
-	RenderablePatchSolid(PatchTesselation& tess);
+	RenderablePatchSolid(const PatchTesselationPtr& tess, const Vector3& offset);
 
 	void render(const RenderInfo& info) const;
 
@@ -1,6 +1,1605 @@
 #include "PatchTesselation.h"
 
+#include <algorithm>
+#include <functional>
+#include "math/curve.h"
+
+#define DEGEN_0a  0x01
+#define DEGEN_1a  0x02
+#define DEGEN_2a  0x04
+#define DEGEN_0b  0x08
+#define DEGEN_1b  0x10
+#define DEGEN_2b  0x20
+#define SPLIT     0x40
+#define AVERAGE   0x80
+
+
+unsigned int subarray_get_degen(PatchControlConstIter subarray, std::size_t strideU, std::size_t strideV)
+{
+  unsigned int nDegen = 0;
+  PatchControlConstIter p1;
+  PatchControlConstIter p2;
+
+  p1 = subarray;
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_0a;
+  p1 = p2;
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_0b;
+
+  p1 = subarray + strideV;
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_1a;
+  p1 = p2;
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_1b;
+
+  p1 = subarray + (strideV << 1);
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_2a;
+  p1 = p2;
+  p2 = p1 + strideU;
+  if(p1->vertex == p2->vertex)
+    nDegen |= DEGEN_2b;
+
+  return nDegen;
+}
+
+
+inline void deCasteljau3(const Vector3& P0, const Vector3& P1, const Vector3& P2, Vector3& P01, Vector3& P12, Vector3& P012)
+{
+  P01 = P0.mid(P1);
+  P12 = P1.mid(P2);
+  P012 = P01.mid(P12);
+}
+
+inline void BezierInterpolate3( const Vector3& start, Vector3& left, Vector3& mid, Vector3& right, const Vector3& end )
+{
+  left = start.mid(mid);
+  right = mid.mid(end);
+  mid = left.mid(right);
+}
+
+inline void BezierInterpolate2( const Vector2& start, Vector2& left, Vector2& mid, Vector2& right, const Vector2& end )
+{
+  left[0]= float_mid(start[0], mid[0]);
+  left[1] = float_mid(start[1], mid[1]);
+  right[0] = float_mid(mid[0], end[0]);
+  right[1] = float_mid(mid[1], end[1]);
+  mid[0] = float_mid(left[0], right[0]);
+  mid[1] = float_mid(left[1], right[1]);
+}
+
+inline PatchControl QuadraticBezier_evaluate(const PatchControl* firstPoint, double t)
+{
+  PatchControl result = { Vector3(0, 0, 0), Vector2(0, 0) };
+  double denominator = 0;
+
+  {
+    double weight = BernsteinPolynomial<Zero, Two>::apply(t);
+    result.vertex += firstPoint[0].vertex * weight;
+    result.texcoord += firstPoint[0].texcoord * weight;
+    denominator += weight;
+  }
+  {
+    double weight = BernsteinPolynomial<One, Two>::apply(t);
+    result.vertex += firstPoint[1].vertex * weight;
+    result.texcoord += firstPoint[1].texcoord * weight;
+    denominator += weight;
+  }
+  {
+    double weight = BernsteinPolynomial<Two, Two>::apply(t);
+    result.vertex  += firstPoint[2].vertex * weight;
+    result.texcoord += firstPoint[2].texcoord * weight;
+    denominator += weight;
+  }
+
+  result.vertex /= denominator;
+  result.texcoord /= denominator;
+  return result;
+}
+
+inline Vector3 vector3_linear_interpolated(const Vector3& a, const Vector3& b, double t)
+{
+  return a*(1.0 - t) + b*t;
+}
+
+inline Vector2 vector2_linear_interpolated(const Vector2& a, const Vector2& b, double t)
+{
+  return a*(1.0 - t) + b*t;
+}
+
+void normalise_safe(Vector3& normal)
+{
+	if (normal != g_vector3_identity)
+	{
+		normal.normalise();
+	}
+}
+
+inline void QuadraticBezier_evaluate(const PatchControl& a, const PatchControl& b, const PatchControl& c, double t, PatchControl& point, PatchControl& left, PatchControl& right)
+{
+  left.vertex = vector3_linear_interpolated(a.vertex, b.vertex, t);
+  left.texcoord = vector2_linear_interpolated(a.texcoord, b.texcoord, t);
+  right.vertex = vector3_linear_interpolated(b.vertex, c.vertex, t);
+  right.texcoord = vector2_linear_interpolated(b.texcoord, c.texcoord, t);
+  point.vertex = vector3_linear_interpolated(left.vertex, right.vertex, t);
+  point.texcoord = vector2_linear_interpolated(left.texcoord, right.texcoord, t);
+}
+
+
+void PatchTesselation::TesselateSubMatrixFixed(ArbitraryMeshVertex* vertices,
+									std::size_t strideX, std::size_t strideY,
+									unsigned int nFlagsX, unsigned int nFlagsY,
+									PatchControlConstIter subMatrix[3][3])
+{
+  double incrementU = 1.0 / _subdivisions.x();
+  double incrementV = 1.0 / _subdivisions.y();
+  const std::size_t width = _subdivisions.x() + 1;
+  const std::size_t height = _subdivisions.y() + 1;
+
+  for(std::size_t i = 0; i != width; ++i)
+  {
+    double tU = (i + 1 == width) ? 1 : i * incrementU;
+    PatchControl pointX[3];
+    PatchControl leftX[3];
+    PatchControl rightX[3];
+    QuadraticBezier_evaluate(*subMatrix[0][0], *subMatrix[0][1], *subMatrix[0][2], tU, pointX[0], leftX[0], rightX[0]);
+    QuadraticBezier_evaluate(*subMatrix[1][0], *subMatrix[1][1], *subMatrix[1][2], tU, pointX[1], leftX[1], rightX[1]);
+    QuadraticBezier_evaluate(*subMatrix[2][0], *subMatrix[2][1], *subMatrix[2][2], tU, pointX[2], leftX[2], rightX[2]);
+
+    ArbitraryMeshVertex* p = vertices + i * strideX;
+    for(std::size_t j = 0; j != height; ++j)
+    {
+      if((j == 0 || j + 1 == height) && (i == 0 || i + 1 == width))
+      {
+      }
+      else
+      {
+        double tV = (j + 1 == height) ? 1 : j * incrementV;
+
+        PatchControl pointY[3];
+        PatchControl leftY[3];
+        PatchControl rightY[3];
+        QuadraticBezier_evaluate(*subMatrix[0][0], *subMatrix[1][0], *subMatrix[2][0], tV, pointY[0], leftY[0], rightY[0]);
+        QuadraticBezier_evaluate(*subMatrix[0][1], *subMatrix[1][1], *subMatrix[2][1], tV, pointY[1], leftY[1], rightY[1]);
+        QuadraticBezier_evaluate(*subMatrix[0][2], *subMatrix[1][2], *subMatrix[2][2], tV, pointY[2], leftY[2], rightY[2]);
+
+        PatchControl point;
+        PatchControl left;
+        PatchControl right;
+        QuadraticBezier_evaluate(pointX[0], pointX[1], pointX[2], tV, point, left, right);
+        PatchControl up;
+        PatchControl down;
+        QuadraticBezier_evaluate(pointY[0], pointY[1], pointY[2], tU, point, up, down);
+
+        p->vertex = Vertex3f(point.vertex);
+        p->texcoord = point.texcoord;
+
+        ArbitraryMeshVertex a, b, c;
+
+        a.vertex = Vertex3f(left.vertex);
+        a.texcoord = left.texcoord;
+        b.vertex = Vertex3f(right.vertex);
+        b.texcoord = right.texcoord;
+
+        if(i != 0)
+        {
+          c.vertex = Vertex3f(up.vertex);
+          c.texcoord = up.texcoord;
+        }
+        else
+        {
+          c.vertex = Vertex3f(down.vertex);
+          c.texcoord = down.texcoord;
+        }
+
+        Vector3 normal = (right.vertex - left.vertex).crossProduct(up.vertex - down.vertex).getNormalised();
+
+        Vector3 tangent, bitangent;
+        ArbitraryMeshTriangle_calcTangents(a, b, c, tangent, bitangent);
+        tangent = tangent.getNormalised();
+        bitangent = bitangent.getNormalised();
+
+        if(((nFlagsX & AVERAGE) != 0 && i == 0) || ((nFlagsY & AVERAGE) != 0  && j == 0))
+        {
+          p->normal = Normal3f(p->normal + normal.getNormalised());
+          p->tangent = Normal3f(p->tangent + tangent.getNormalised());
+          p->bitangent = Normal3f((p->bitangent + bitangent).getNormalised());
+        }
+        else
+        {
+          p->normal = Normal3f(normal);
+          p->tangent = Normal3f(tangent);
+          p->bitangent = Normal3f(bitangent);
+        }
+      }
+
+      p += strideY;
+    }
+  }
+}
+
+void PatchTesselation::TesselateSubMatrix( const BezierCurveTree *BX, const BezierCurveTree *BY,
+                                        std::size_t offStartX, std::size_t offStartY,
+                                        std::size_t offEndX, std::size_t offEndY,
+                                        std::size_t nFlagsX, std::size_t nFlagsY,
+                                        const Vector3& left, const Vector3& mid, const Vector3& right,
+                                        const Vector2& texLeft, const Vector2& texMid, const Vector2& texRight,
+                                        bool bTranspose )
+{
+  int newFlagsX, newFlagsY;
+
+  Vector3 tmp;
+  Vector3 vertex_0_0, vertex_0_1, vertex_1_0, vertex_1_1, vertex_2_0, vertex_2_1;
+  Vector2 texTmp;
+  Vector2 texcoord_0_0, texcoord_0_1, texcoord_1_0, texcoord_1_1, texcoord_2_0, texcoord_2_1;
+
+  {
+   // texcoords
+
+    BezierInterpolate2( vertices[offStartX + offStartY].texcoord,
+                     texcoord_0_0,
+                     vertices[BX->index + offStartY].texcoord,
+                     texcoord_0_1,
+                     vertices[offEndX + offStartY].texcoord);
+
+
+    BezierInterpolate2( vertices[offStartX + offEndY].texcoord,
+                     texcoord_2_0,
+                     vertices[BX->index + offEndY].texcoord,
+                     texcoord_2_1,
+                     vertices[offEndX + offEndY].texcoord);
+
+    texTmp = texMid;
+
+    BezierInterpolate2(texLeft,
+                      texcoord_1_0,
+                      texTmp,
+                      texcoord_1_1,
+                      texRight);
+
+	if(!BY->isLeaf())
+    {
+      vertices[BX->index + BY->index].texcoord = texTmp;
+    }
+
+
+	if(!BX->left->isLeaf())
+    {
+      vertices[BX->left->index + offStartY].texcoord = texcoord_0_0;
+      vertices[BX->left->index + offEndY].texcoord = texcoord_2_0;
+
+	  if(!BY->isLeaf())
+      {
+        vertices[BX->left->index + BY->index].texcoord = texcoord_1_0;
+      }
+    }
+	if(!BX->right->isLeaf())
+    {
+      vertices[BX->right->index + offStartY].texcoord = texcoord_0_1;
+      vertices[BX->right->index + offEndY].texcoord = texcoord_2_1;
+
+	  if(!BY->isLeaf())
+      {
+        vertices[BX->right->index + BY->index].texcoord = texcoord_1_1;
+      }
+    }
+
+
+    // verts
+
+    BezierInterpolate3( vertices[offStartX + offStartY].vertex,
+                     vertex_0_0,
+                     vertices[BX->index + offStartY].vertex,
+                     vertex_0_1,
+                     vertices[offEndX + offStartY].vertex);
+
+
+    BezierInterpolate3( vertices[offStartX + offEndY].vertex,
+                     vertex_2_0,
+                     vertices[BX->index + offEndY].vertex,
+                     vertex_2_1,
+                     vertices[offEndX + offEndY].vertex);
+
+
+    tmp = mid;
+
+    BezierInterpolate3( left,
+                     vertex_1_0,
+                     tmp,
+                     vertex_1_1,
+                     right );
+
+	if(!BY->isLeaf())
+    {
+      vertices[BX->index + BY->index].vertex = tmp;
+    }
+
+
+	if(!BX->left->isLeaf())
+    {
+      vertices[BX->left->index + offStartY].vertex = vertex_0_0;
+      vertices[BX->left->index + offEndY].vertex = vertex_2_0;
+
+	  if(!BY->isLeaf())
+      {
+        vertices[BX->left->index + BY->index].vertex = vertex_1_0;
+      }
+    }
+	if(!BX->right->isLeaf())
+    {
+      vertices[BX->right->index + offStartY].vertex = vertex_0_1;
+      vertices[BX->right->index + offEndY].vertex = vertex_2_1;
+
+	  if(!BY->isLeaf())
+      {
+        vertices[BX->right->index + BY->index].vertex = vertex_1_1;
+      }
+    }
+
+    // normals
+
+    if(nFlagsX & SPLIT)
+    {
+      ArbitraryMeshVertex a, b, c;
+      Vector3 tangentU;
+
+      if(!(nFlagsX & DEGEN_0a) || !(nFlagsX & DEGEN_0b))
+      {
+        tangentU = vertex_0_1 - vertex_0_0;
+        a.vertex = Vertex3f(vertex_0_0);
+        a.texcoord = texcoord_0_0;
+        c.vertex = Vertex3f(vertex_0_1);
+        c.texcoord = texcoord_0_1;
+      }
+      else if(!(nFlagsX & DEGEN_1a) || !(nFlagsX & DEGEN_1b))
+      {
+        tangentU = vertex_1_1 - vertex_1_0;
+        a.vertex = Vertex3f(vertex_1_0);
+        a.texcoord = texcoord_1_0;
+        c.vertex = Vertex3f(vertex_1_1);
+        c.texcoord = texcoord_1_1;
+      }
+      else
+      {
+        tangentU = vertex_2_1 - vertex_2_0;
+        a.vertex = Vertex3f(vertex_2_0);
+        a.texcoord = texcoord_2_0;
+        c.vertex = Vertex3f(vertex_2_1);
+        c.texcoord = texcoord_2_1;
+      }
+
+      Vector3 tangentV;
+
+      if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_1a) && (nFlagsY & DEGEN_2a))
+      {
+        tangentV = vertices[BX->index + offEndY].vertex - tmp;
+        b.vertex = Vertex3f(tmp);//vertices[BX->index + offEndY].vertex;
+        b.texcoord = texTmp;//vertices[BX->index + offEndY].texcoord;
+      }
+      else
+      {
+        tangentV = tmp - vertices[BX->index + offStartY].vertex;
+        b.vertex = Vertex3f(tmp);//vertices[BX->index + offStartY].vertex;
+        b.texcoord = texTmp; //vertices[BX->index + offStartY].texcoord;
+      }
+
+
+      Vector3 normal, s, t;
+      ArbitraryMeshVertex& v = vertices[offStartY + BX->index];
+      Vector3& p = v.normal;
+      Vector3& ps = v.tangent;
+      Vector3& pt = v.bitangent;
+
+      if(bTranspose)
+      {
+        normal = tangentV.crossProduct(tangentU);
+      }
+      else
+      {
+        normal = tangentU.crossProduct(tangentV);
+      }
+      normalise_safe(normal);
+
+      ArbitraryMeshTriangle_calcTangents(a, b, c, s, t);
+      normalise_safe(s);
+      normalise_safe(t);
+
+      if(nFlagsX & AVERAGE)
+      {
+        p = (p + normal).getNormalised();
+        ps = (ps + s).getNormalised();
+        pt = (pt + t).getNormalised();
+      }
+      else
+      {
+        p = normal;
+        ps = s;
+        pt = t;
+      }
+    }
+
+    {
+      ArbitraryMeshVertex a, b, c;
+      Vector3 tangentU;
+
+      if(!(nFlagsX & DEGEN_2a) || !(nFlagsX & DEGEN_2b))
+      {
+        tangentU = vertex_2_1 - vertex_2_0;
+        a.vertex = Vertex3f(vertex_2_0);
+        a.texcoord = texcoord_2_0;
+        c.vertex = Vertex3f(vertex_2_1);
+        c.texcoord = texcoord_2_1;
+      }
+      else if(!(nFlagsX & DEGEN_1a) || !(nFlagsX & DEGEN_1b))
+      {
+        tangentU = vertex_1_1 - vertex_1_0;
+        a.vertex = Vertex3f(vertex_1_0);
+        a.texcoord = texcoord_1_0;
+        c.vertex = Vertex3f(vertex_1_1);
+        c.texcoord = texcoord_1_1;
+      }
+      else
+      {
+        tangentU = vertex_0_1 - vertex_0_0;
+        a.vertex = Vertex3f(vertex_0_0);
+        a.texcoord = texcoord_0_0;
+        c.vertex = Vertex3f(vertex_0_1);
+        c.texcoord = texcoord_0_1;
+      }
+
+      Vector3 tangentV;
+
+      if((nFlagsY & DEGEN_0b) && (nFlagsY & DEGEN_1b) && (nFlagsY & DEGEN_2b))
+      {
+        tangentV = tmp - vertices[BX->index + offStartY].vertex;
+        b.vertex = Vertex3f(tmp);//vertices[BX->index + offStartY].vertex;
+        b.texcoord = texTmp;//vertices[BX->index + offStartY].texcoord;
+      }
+      else
+      {
+        tangentV = vertices[BX->index + offEndY].vertex - tmp;
+        b.vertex = Vertex3f(tmp);//vertices[BX->index + offEndY].vertex;
+        b.texcoord = texTmp;//vertices[BX->index + offEndY].texcoord;
+      }
+
+      ArbitraryMeshVertex& v = vertices[offEndY+BX->index];
+      Vector3& p = v.normal;
+      Vector3& ps = v.tangent;
+      Vector3& pt = v.bitangent;
+
+      if(bTranspose)
+      {
+        p = tangentV.crossProduct(tangentU);
+      }
+      else
+      {
+        p = tangentU.crossProduct(tangentV);
+      }
+      normalise_safe(p);
+
+      ArbitraryMeshTriangle_calcTangents(a, b, c, ps, pt);
+      normalise_safe(ps);
+      normalise_safe(pt);
+    }
+  }
+
+
+  newFlagsX = newFlagsY = 0;
+
+  if((nFlagsX & DEGEN_0a) && (nFlagsX & DEGEN_0b))
+  {
+    newFlagsX |= DEGEN_0a;
+    newFlagsX |= DEGEN_0b;
+  }
+  if((nFlagsX & DEGEN_1a) && (nFlagsX & DEGEN_1b))
+  {
+    newFlagsX |= DEGEN_1a;
+    newFlagsX |= DEGEN_1b;
+  }
+  if((nFlagsX & DEGEN_2a) && (nFlagsX & DEGEN_2b))
+  {
+    newFlagsX |= DEGEN_2a;
+    newFlagsX |= DEGEN_2b;
+  }
+  if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_1a) && (nFlagsY & DEGEN_2a))
+  {
+    newFlagsY |= DEGEN_0a;
+    newFlagsY |= DEGEN_1a;
+    newFlagsY |= DEGEN_2a;
+  }
+  if((nFlagsY & DEGEN_0b) && (nFlagsY & DEGEN_1b) && (nFlagsY & DEGEN_2b))
+  {
+    newFlagsY |= DEGEN_0b;
+    newFlagsY |= DEGEN_1b;
+    newFlagsY |= DEGEN_2b;
+  }
+
+
+  //if((nFlagsX & DEGEN_0a) && (nFlagsX & DEGEN_1a) && (nFlagsX & DEGEN_2a)) { newFlagsX |= DEGEN_0a; newFlagsX |= DEGEN_1a; newFlagsX |= DEGEN_2a; }
+  //if((nFlagsX & DEGEN_0b) && (nFlagsX & DEGEN_1b) && (nFlagsX & DEGEN_2b)) { newFlagsX |= DEGEN_0b; newFlagsX |= DEGEN_1b; newFlagsX |= DEGEN_2b; }
+
+  newFlagsX |= (nFlagsX & SPLIT);
+  newFlagsX |= (nFlagsX & AVERAGE);
+
+  if(!BY->isLeaf())
+  {
+    {
+      int nTemp = newFlagsY;
+
+      if((nFlagsY & DEGEN_0a) && (nFlagsY & DEGEN_0b))
+      {
+        newFlagsY |= DEGEN_0a;
+        newFlagsY |= DEGEN_0b;
+      }
+      newFlagsY |= (nFlagsY & SPLIT);
+      newFlagsY |= (nFlagsY & AVERAGE);
+
+      Vector3& p = vertices[BX->index+BY->index].vertex;
+      Vector3 vTemp(p);
+
+      Vector2& p2 = vertices[BX->index+BY->index].texcoord;
+      Vector2 stTemp(p2);
+
+      TesselateSubMatrix( BY, BX->left,
+                          offStartY, offStartX,
+                          offEndY, BX->index,
+                          newFlagsY, newFlagsX,
+                          vertex_0_0, vertex_1_0, vertex_2_0,
+                          texcoord_0_0, texcoord_1_0, texcoord_2_0,
+                          !bTranspose );
+
+      newFlagsY = nTemp;
+      p = vTemp;
+      p2 = stTemp;
+    }
+
+    if((nFlagsY & DEGEN_2a) && (nFlagsY & DEGEN_2b)) { newFlagsY |= DEGEN_2a; newFlagsY |= DEGEN_2b; }
+
+    TesselateSubMatrix( BY, BX->right,
+                        offStartY, BX->index,
+                        offEndY, offEndX,
+                        newFlagsY, newFlagsX,
+                        vertex_0_1, vertex_1_1, vertex_2_1,
+                        texcoord_0_1, texcoord_1_1, texcoord_2_1,
+                        !bTranspose );
+  }
+  else
+  {
+	  if(!BX->left->isLeaf())
+    {
+      TesselateSubMatrix( BX->left,  BY,
+                          offStartX, offStartY,
+                          BX->index, offEndY,
+                          newFlagsX, newFlagsY,
+                          left, vertex_1_0, tmp,
+                          texLeft, texcoord_1_0, texTmp,
+                          bTranspose );
+    }
+
+	  if(!BX->right->isLeaf())
+    {
+      TesselateSubMatrix( BX->right, BY,
+                          BX->index, offStartY,
+                          offEndX, offEndY,
+                          newFlagsX, newFlagsY,
+                          tmp, vertex_1_1, right,
+                          texTmp, texcoord_1_1, texRight,
+                          bTranspose );
+    }
+  }
+
+}
+
+
+inline void vertex_assign_ctrl(ArbitraryMeshVertex& vertex, const PatchControl& ctrl)
+{
+  vertex.vertex = Vertex3f(ctrl.vertex);
+  vertex.texcoord = ctrl.texcoord;
+}
+
+inline void vertex_clear_normal(ArbitraryMeshVertex& vertex)
+{
+  vertex.normal = Normal3f(0, 0, 0);
+  vertex.tangent = Normal3f(0, 0, 0);
+  vertex.bitangent = Normal3f(0, 0, 0);
+}
+
+inline void tangents_remove_degenerate(Vector3 tangents[6], Vector2 textureTangents[6], unsigned int flags)
+{
+  if(flags & DEGEN_0a)
+  {
+    const std::size_t i =
+      (flags & DEGEN_0b)
+      ? (flags & DEGEN_1a)
+        ? (flags & DEGEN_1b)
+          ? (flags & DEGEN_2a)
+            ? 5
+            : 4
+          : 3
+        : 2
+      : 1;
+    tangents[0] = tangents[i];
+    textureTangents[0] = textureTangents[i];
+  }
+  if(flags & DEGEN_0b)
+  {
+    const std::size_t i =
+      (flags & DEGEN_0a)
+      ? (flags & DEGEN_1b)
+        ? (flags & DEGEN_1a)
+          ? (flags & DEGEN_2b)
+            ? 4
+            : 5
+          : 2
+        : 3
+      : 0;
+    tangents[1] = tangents[i];
+    textureTangents[1] = textureTangents[i];
+  }
+  if(flags & DEGEN_2a)
+  {
+    const std::size_t i =
+      (flags & DEGEN_2b)
+      ? (flags & DEGEN_1a)
+        ? (flags & DEGEN_1b)
+          ? (flags & DEGEN_0a)
+            ? 1
+            : 0
+          : 3
+        : 2
+      : 5;
+    tangents[4] = tangents[i];
+    textureTangents[4] = textureTangents[i];
+  }
+  if(flags & DEGEN_2b)
+  {
+    const std::size_t i =
+      (flags & DEGEN_2a)
+      ? (flags & DEGEN_1b)
+        ? (flags & DEGEN_1a)
+          ? (flags & DEGEN_0b)
+            ? 0
+            : 1
+          : 2
+        : 3
+      : 4;
+    tangents[5] = tangents[i];
+    textureTangents[5] = textureTangents[i];
+  }
+}
+
+void bestTangents00(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
+{
+  if(fabs(dot + length) < 0.001) // opposing direction = degenerate
+  {
+    if(!(degenerateFlags & DEGEN_1a)) // if this tangent is degenerate we cannot use it
+    {
+      index0 = 2;
+      index1 = 0;
+    }
+    else if(!(degenerateFlags & DEGEN_0b))
+    {
+      index0 = 0;
+      index1 = 1;
+    }
+    else
+    {
+      index0 = 1;
+      index1 = 0;
+    }
+  }
+  else if(fabs(dot - length) < 0.001) // same direction = degenerate
+  {
+    if(degenerateFlags & DEGEN_0b)
+    {
+      index0 = 0;
+      index1 = 1;
+    }
+    else
+    {
+      index0 = 1;
+      index1 = 0;
+    }
+  }
+}
+
+void bestTangents01(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
+{
+  if(fabs(dot - length) < 0.001) // same direction = degenerate
+  {
+    if(!(degenerateFlags & DEGEN_1a)) // if this tangent is degenerate we cannot use it
+    {
+      index0 = 2;
+      index1 = 1;
+    }
+    else if(!(degenerateFlags & DEGEN_2b))
+    {
+      index0 = 4;
+      index1 = 0;
+    }
+    else
+    {
+      index0 = 5;
+      index1 = 1;
+    }
+  }
+  else if(fabs(dot + length) < 0.001) // opposing direction = degenerate
+  {
+    if(degenerateFlags & DEGEN_2b)
+    {
+      index0 = 4;
+      index1 = 0;
+    }
+    else
+    {
+      index0 = 5;
+      index1 = 1;
+    }
+  }
+}
+
+void bestTangents10(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
+{
+  if(fabs(dot - length) < 0.001) // same direction = degenerate
+  {
+    if(!(degenerateFlags & DEGEN_1b)) // if this tangent is degenerate we cannot use it
+    {
+      index0 = 3;
+      index1 = 4;
+    }
+    else if(!(degenerateFlags & DEGEN_0a))
+    {
+      index0 = 1;
+      index1 = 5;
+    }
+    else
+    {
+      index0 = 0;
+      index1 = 4;
+    }
+  }
+  else if(fabs(dot + length) < 0.001) // opposing direction = degenerate
+  {
+    if(degenerateFlags & DEGEN_0a)
+    {
+      index0 = 1;
+      index1 = 5;
+    }
+    else
+    {
+      index0 = 0;
+      index1 = 4;
+    }
+  }
+}
+
+void bestTangents11(unsigned int degenerateFlags, double dot, double length, std::size_t& index0, std::size_t& index1)
+{
+  if(fabs(dot + length) < 0.001) // opposing direction = degenerate
+  {
+    if(!(degenerateFlags & DEGEN_1b)) // if this tangent is degenerate we cannot use it
+    {
+      index0 = 3;
+      index1 = 5;
+    }
+    else if(!(degenerateFlags & DEGEN_2a))
+    {
+      index0 = 5;
+      index1 = 4;
+    }
+    else
+    {
+      index0 = 4;
+      index1 = 5;
+    }
+  }
+  else if(fabs(dot - length) < 0.001) // same direction = degenerate
+  {
+    if(degenerateFlags & DEGEN_2a)
+    {
+      index0 = 5;
+      index1 = 4;
+    }
+    else
+    {
+      index0 = 4;
+      index1 = 5;
+    }
+  }
+}
+
+void PatchTesselation::accumulateVertexTangentSpace(std::size_t index, Vector3 tangentX[6], Vector3 tangentY[6], Vector2 tangentS[6], Vector2 tangentT[6], std::size_t index0, std::size_t index1)
+{
+  {
+    Vector3 normal(tangentX[index0].crossProduct(tangentY[index1]));
+    if(normal != g_vector3_identity)
+    {
+      vertices[index].normal += normal.getNormalised();
+    }
+  }
+
+  {
+    ArbitraryMeshVertex a, b, c;
+    a.vertex = Vertex3f(0, 0, 0);
+    a.texcoord = TexCoord2f(0, 0);
+    b.vertex = Vertex3f(tangentX[index0]);
+    b.texcoord = tangentS[index0];
+    c.vertex = Vertex3f(tangentY[index1]);
+    c.texcoord = tangentT[index1];
+
+    Vector3 s, t;
+    ArbitraryMeshTriangle_calcTangents(a, b, c, s, t);
+    if(s != g_vector3_identity)
+    {
+		vertices[index].tangent += s.getNormalised();
+    }
+    if(t != g_vector3_identity)
+    {
+		vertices[index].bitangent += t.getNormalised();
+    }
+  }
+}
+
+
 void PatchTesselation::clear()
 {
-    *this = PatchTesselation();
+	vertices.clear();
+	indices.clear();
+
+	m_numStrips = 0;
+	m_lenStrips = 0;
+
+	arrayWidth.clear();
+	m_nArrayWidth = 0;
+	arrayHeight.clear();
+	m_nArrayHeight = 0;
+
+	curveTreeU.clear();
+	curveTreeV.clear();
+
+	_width = 0;
+	_height = 0;
+	_controlPoints.clear();
+}
+
+void PatchTesselation::generate(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+	bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold)
+{
+	// Fixed tesselations are averaging some of their normals with whatever the vertex
+	// array contained before, these are always evaluated as a whole
+	bool rebuild = vertices.empty() || subdivisionsFixed || _subdivisionsFixed ||
+		width != _width || height != _height || controlPoints.size() != _controlPoints.size() ||
+		subdivideThreshold != _subdivideThreshold;
+
+	if (!rebuild && !collectChangedSubPatches(controlPoints))
+	{
+		return; // nothing changed
+	}
+
+	_width = width;
+	_height = height;
+	_controlPoints = controlPoints;
+	_subdivisionsFixed = subdivisionsFixed;
+	_subdivisions = subdivisions;
+	_subdivideThreshold = subdivideThreshold;
+
+	// As long as the curve trees keep their shape, the array layout stays the same
+	if (!rebuild && updateChangedCurveTrees(ROW) && updateChangedCurveTrees(COL))
+	{
+		tesselateChangedSubPatches();
+		return;
+	}
+
+	const std::size_t previousArrayWidth = m_nArrayWidth;
+	const std::size_t previousArrayHeight = m_nArrayHeight;
+
+	buildCurveTrees(ROW);
+	buildCurveTrees(COL);
+
+	vertices.resize(m_nArrayWidth * m_nArrayHeight);
+
+	// The strip indices only depend on the array dimensions
+	if (indices.empty() || m_nArrayWidth != previousArrayWidth || m_nArrayHeight != previousArrayHeight)
+	{
+		buildIndexArray();
+	}
+
+	for (std::size_t row = 0; row < arrayHeight.size(); ++row)
+	{
+		for (std::size_t column = 0; column < arrayWidth.size(); ++column)
+		{
+			tesselateSubPatch(column, row);
+		}
+	}
+}
+
+bool PatchTesselation::isTesselationOf(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+	bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold) const
+{
+	// The subdivisions don't matter unless they're fixed
+	if (vertices.empty() || width != _width || height != _height || subdivisionsFixed != _subdivisionsFixed ||
+		(subdivisionsFixed && subdivisions != _subdivisions) || subdivideThreshold != _subdivideThreshold ||
+		controlPoints.size() != _controlPoints.size())
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < controlPoints.size(); ++i)
+	{
+		if (controlPoints[i].vertex != _controlPoints[i].vertex ||
+			controlPoints[i].texcoord != _controlPoints[i].texcoord)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+namespace
+{
+	inline void hashCombine(std::size_t& seed, double value)
+	{
+		seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+}
+
+std::size_t PatchTesselation::GetHash(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+	bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold)
+{
+	std::size_t hash = std::hash<std::size_t>()(width * MAX_PATCH_HEIGHT + height);
+
+	hashCombine(hash, subdivideThreshold);
+
+	if (subdivisionsFixed)
+	{
+		hashCombine(hash, subdivisions.x());
+		hashCombine(hash, subdivisions.y());
+	}
+
+	for (PatchControlConstIter i = controlPoints.begin(); i != controlPoints.end(); ++i)
+	{
+		hashCombine(hash, i->vertex.x());
+		hashCombine(hash, i->vertex.y());
+		hashCombine(hash, i->vertex.z());
+		hashCombine(hash, i->texcoord.x());
+		hashCombine(hash, i->texcoord.y());
+	}
+
+	return hash;
+}
+
+std::size_t PatchTesselation::getHash() const
+{
+	return GetHash(_width, _height, _controlPoints, _subdivisionsFixed, _subdivisions, _subdivideThreshold);
+}
+
+bool PatchTesselation::collectChangedSubPatches(const PatchControlArray& controlPoints)
+{
+	const std::size_t columns = arrayWidth.size();
+	const std::size_t rows = arrayHeight.size();
+
+	_changedTreesU.assign(columns, false);
+	_changedTreesV.assign(rows, false);
+	_changedSubPatches.assign(columns * rows, false);
+
+	bool changed = false;
+
+	for (std::size_t y = 0; y < _height; ++y)
+	{
+		// The control points on the edges between two sub-patches belong to both of them
+		const std::size_t firstRow = y > 0 ? (y - 1) >> 1 : 0;
+		const std::size_t lastRow = std::min(y >> 1, rows - 1);
+
+		for (std::size_t x = 0; x < _width; ++x)
+		{
+			const PatchControl& ctrl = controlPoints[y * _width + x];
+			const PatchControl& previous = _controlPoints[y * _width + x];
+
+			if (ctrl.vertex == previous.vertex && ctrl.texcoord == previous.texcoord)
+			{
+				continue;
+			}
+
+			changed = true;
+
+			const std::size_t firstColumn = x > 0 ? (x - 1) >> 1 : 0;
+			const std::size_t lastColumn = std::min(x >> 1, columns - 1);
+
+			// The curve trees don't care about the texture coordinates
+			if (ctrl.vertex != previous.vertex)
+			{
+				for (std::size_t column = firstColumn; column <= lastColumn; ++column)
+				{
+					_changedTreesU[column] = true;
+				}
+
+				for (std::size_t row = firstRow; row <= lastRow; ++row)
+				{
+					_changedTreesV[row] = true;
+				}
+			}
+
+			for (std::size_t row = firstRow; row <= lastRow; ++row)
+			{
+				for (std::size_t column = firstColumn; column <= lastColumn; ++column)
+				{
+					_changedSubPatches[row * columns + column] = true;
+				}
+			}
+		}
+	}
+
+	return changed;
+}
+
+std::size_t PatchTesselation::buildCurveTree(EMatrixMajor major, std::size_t index, std::size_t arrayOffset)
+{
+	std::size_t nArrayStride, cross, strideU, strideV;
+
+	if (major == ROW)
+	{
+		nArrayStride = 1;
+		cross = _height;
+		strideU = 1;
+		strideV = _width;
+	}
+	else
+	{
+		nArrayStride = m_nArrayWidth;
+		cross = _width;
+		strideU = _width;
+		strideV = 1;
+	}
+
+	// create a list of the horizontal control curves in this column of sub-patches
+	// adaptively tesselate each horizontal control curve in the list
+	// create a binary tree representing the combined tesselation of the list
+	PatchControlConstIter p1 = _controlPoints.begin() + (index * 2 * strideU);
+
+	for (std::size_t j = 0; j < cross; j += 2)
+	{
+		// directly taken from one row of control points
+		_curveTreeBuilder.addCurve(BezierCurve(
+			(p1+strideU)->vertex,		// crd
+			p1->vertex,					// left
+			(p1+(strideU<<1))->vertex	// right
+		));
+
+		// Skip the rest if this is the last turn
+		if (j+2 >= cross) break;
+
+		PatchControlConstIter p2 = p1 + strideV;
+		PatchControlConstIter p3 = p2 + strideV;
+
+		// interpolated from three columns of control points
+		BezierCurve curve(
+			(p1+strideU)->vertex.mid((p3+strideU)->vertex),			// crd
+			p1->vertex.mid(p3->vertex),								// left
+			(p1+(strideU<<1))->vertex.mid((p3+(strideU<<1))->vertex)	// right
+		);
+
+		curve.crd = curve.crd.mid((p2+strideU)->vertex);
+		curve.left = curve.left.mid(p2->vertex);
+		curve.right = curve.right.mid((p2+(strideU<<1))->vertex);
+
+		_curveTreeBuilder.addCurve(curve);
+
+		p1 = p3;
+	}
+
+	// Sort the curve list into a BezierCurveTree, the nodes of the previous one are re-used
+	BezierCurveTreePool& pool = (major == ROW) ? _curveTreePoolU[index] : _curveTreePoolV[index];
+	pool.clear();
+
+	BezierCurveTree* tree = _curveTreeBuilder.build(pool, _subdivideThreshold);
+	((major == ROW) ? curveTreeU : curveTreeV)[index] = tree;
+
+	// set up array indices for binary tree
+	return tree->setup(arrayOffset, nArrayStride) - (arrayOffset - 1);
+}
+
+void PatchTesselation::buildCurveTrees(EMatrixMajor major)
+{
+	const std::size_t length = (((major == ROW) ? _width : _height) - 1) >> 1;
+
+	std::vector<std::size_t>& arrayLength = (major == ROW) ? arrayWidth : arrayHeight;
+	std::vector<std::size_t>& subPatchStart = (major == ROW) ? _subPatchStartX : _subPatchStartY;
+	std::vector<BezierCurveTree*>& curveTrees = (major == ROW) ? curveTreeU : curveTreeV;
+
+	arrayLength.resize(length);
+	subPatchStart.resize(length);
+
+	std::size_t nArrayLength = 1;
+
+	if (_subdivisionsFixed)
+	{
+		// This is a patch using fixed tesselation (patchDef3)
+		std::size_t subdivisions = (major == ROW) ? _subdivisions.x() : _subdivisions.y();
+
+		curveTrees.clear();
+
+		// Assign the fixed number of tesselations to each column
+		for (std::size_t i = 0; i != length; ++i)
+		{
+			subPatchStart[i] = nArrayLength - 1;
+			arrayLength[i] = subdivisions;
+			nArrayLength += subdivisions;
+		}
+	}
+	else
+	{
+		curveTrees.resize(length);
+		((major == ROW) ? _curveTreePoolU : _curveTreePoolV).resize(length);
+
+		for (std::size_t i = 0; i != length; ++i)
+		{
+			subPatchStart[i] = nArrayLength - 1;
+
+			// accumulate subarray width
+			arrayLength[i] = buildCurveTree(major, i, nArrayLength);
+
+			// accumulate total array width
+			nArrayLength += arrayLength[i];
+		}
+	}
+
+	if (major == ROW)
+	{
+		m_nArrayWidth = nArrayLength;
+	}
+	else
+	{
+		m_nArrayHeight = nArrayLength;
+	}
+}
+
+void PatchTesselation::getTreeShape(const BezierCurveTree* tree, std::vector<bool>& shape)
+{
+	shape.clear();
+
+	_treeNodes.clear();
+	_treeNodes.push_back(tree);
+
+	while (!_treeNodes.empty())
+	{
+		const BezierCurveTree* node = _treeNodes.back();
+		_treeNodes.pop_back();
+
+		shape.push_back(node->isLeaf());
+
+		if (!node->isLeaf())
+		{
+			_treeNodes.push_back(node->right);
+			_treeNodes.push_back(node->left);
+		}
+	}
+}
+
+bool PatchTesselation::updateChangedCurveTrees(EMatrixMajor major)
+{
+	const std::vector<bool>& changedTrees = (major == ROW) ? _changedTreesU : _changedTreesV;
+	const std::vector<std::size_t>& subPatchStart = (major == ROW) ? _subPatchStartX : _subPatchStartY;
+	const std::vector<BezierCurveTree*>& curveTrees = (major == ROW) ? curveTreeU : curveTreeV;
+
+	for (std::size_t i = 0; i < curveTrees.size(); ++i)
+	{
+		if (!changedTrees[i]) continue;
+
+		getTreeShape(curveTrees[i], _previousTreeShape);
+
+		buildCurveTree(major, i, subPatchStart[i] + 1);
+
+		getTreeShape(curveTrees[i], _treeShape);
+
+		// A different shape changes the number of vertices, all sub-patches need to be evaluated again
+		if (_treeShape != _previousTreeShape)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PatchTesselation::buildIndexArray()
+{
+  const bool bWidthStrips = (m_nArrayWidth >= m_nArrayHeight); // decide if horizontal strips are longer than vertical
+
+  indices.resize(m_nArrayWidth *2 * (m_nArrayHeight - 1));
+
+  // set up strip indices
+  if(bWidthStrips)
+  {
+    m_numStrips = m_nArrayHeight-1;
+    m_lenStrips = m_nArrayWidth*2;
+
+    for(std::size_t i=0; i<m_nArrayWidth; i++)
+    {
+      for(std::size_t j=0; j<m_numStrips; j++)
+      {
+        indices[(j*m_lenStrips)+i*2] = RenderIndex(j*m_nArrayWidth+i);
+        indices[(j*m_lenStrips)+i*2+1] = RenderIndex((j+1)*m_nArrayWidth+i);
+        // reverse because radiant uses CULL_FRONT
+        //indices[(j*m_lenStrips)+i*2+1] = RenderIndex(j*m_nArrayWidth+i);
+        //indices[(j*m_lenStrips)+i*2] = RenderIndex((j+1)*m_nArrayWidth+i);
+      }
+    }
+  }
+  else
+  {
+    m_numStrips = m_nArrayWidth-1;
+    m_lenStrips = m_nArrayHeight*2;
+
+    for(std::size_t i=0; i<m_nArrayHeight; i++)
+    {
+      for(std::size_t j=0; j<m_numStrips; j++)
+      {
+        indices[(j*m_lenStrips)+i*2] = RenderIndex(((m_nArrayHeight-1)-i)*m_nArrayWidth+j);
+        indices[(j*m_lenStrips)+i*2+1] = RenderIndex(((m_nArrayHeight-1)-i)*m_nArrayWidth+j+1);
+        // reverse because radiant uses CULL_FRONT
+        //indices[(j*m_lenStrips)+i*2+1] = RenderIndex(((m_nArrayHeight-1)-i)*m_nArrayWidth+j);
+        //indices[(j*m_lenStrips)+i*2] = RenderIndex(((m_nArrayHeight-1)-i)*m_nArrayWidth+j+1);
+
+      }
+    }
+  }
+}
+
+void PatchTesselation::tesselateSubPatch(std::size_t column, std::size_t row)
+{
+  const std::size_t strideU = 1;
+  const std::size_t strideV = _width;
+
+  // the first control point of this sub-patch
+  const std::size_t i = column << 1;
+  const std::size_t j = row << 1;
+
+  PatchControlConstIter pCtrl = _controlPoints.begin() + (j * strideV + i * strideU);
+
+  // set up array offsets for this sub-patch
+  const bool leafY = (_subdivisionsFixed) ? false : curveTreeV[row]->isLeaf();
+  const std::size_t offMidY = (_subdivisionsFixed) ? 0 : curveTreeV[row]->index;
+  const std::size_t offStartY = _subPatchStartY[row] * m_nArrayWidth;
+  const std::size_t offEndY = offStartY + arrayHeight[row] * m_nArrayWidth;
+
+  const bool leafX = (_subdivisionsFixed) ? false : curveTreeU[column]->isLeaf();
+  const std::size_t offMidX = (_subdivisionsFixed) ? 0 : curveTreeU[column]->index;
+  const std::size_t offStartX = _subPatchStartX[column];
+  const std::size_t offEndX = offStartX + arrayWidth[column];
+
+  PatchControlConstIter subMatrix[3][3];
+  subMatrix[0][0] = pCtrl;
+  subMatrix[0][1] = subMatrix[0][0]+strideU;
+  subMatrix[0][2] = subMatrix[0][1]+strideU;
+  subMatrix[1][0] = subMatrix[0][0]+strideV;
+  subMatrix[1][1] = subMatrix[1][0]+strideU;
+  subMatrix[1][2] = subMatrix[1][1]+strideU;
+  subMatrix[2][0] = subMatrix[1][0]+strideV;
+  subMatrix[2][1] = subMatrix[2][0]+strideU;
+  subMatrix[2][2] = subMatrix[2][1]+strideU;
+
+  // assign on-patch control points to vertex array
+  if(i == 0 && j == 0)
+  {
+    vertex_clear_normal(vertices[offStartX + offStartY]);
+  }
+  vertex_assign_ctrl(vertices[offStartX + offStartY], *subMatrix[0][0]);
+  if(j == 0)
+  {
+    vertex_clear_normal(vertices[offEndX + offStartY]);
+  }
+  vertex_assign_ctrl(vertices[offEndX + offStartY], *subMatrix[0][2]);
+  if(i == 0)
+  {
+    vertex_clear_normal(vertices[offStartX + offEndY]);
+  }
+  vertex_assign_ctrl(vertices[offStartX + offEndY], *subMatrix[2][0]);
+
+  vertex_clear_normal(vertices[offEndX + offEndY]);
+  vertex_assign_ctrl(vertices[offEndX + offEndY], *subMatrix[2][2]);
+
+  if(!_subdivisionsFixed)
+  {
+    // assign remaining control points to vertex array
+    if(!leafX)
+    {
+      vertex_assign_ctrl(vertices[offMidX + offStartY], *subMatrix[0][1]);
+      vertex_assign_ctrl(vertices[offMidX + offEndY], *subMatrix[2][1]);
+    }
+    if(!leafY)
+    {
+      vertex_assign_ctrl(vertices[offStartX + offMidY], *subMatrix[1][0]);
+      vertex_assign_ctrl(vertices[offEndX + offMidY], *subMatrix[1][2]);
+
+      if(!leafX)
+      {
+        vertex_assign_ctrl(vertices[offMidX + offMidY], *subMatrix[1][1]);
+      }
+    }
+  }
+
+  // test all 12 edges for degeneracy
+  unsigned int nFlagsX = subarray_get_degen(pCtrl, strideU, strideV);
+  unsigned int nFlagsY = subarray_get_degen(pCtrl, strideV, strideU);
+  Vector3 tangentX[6], tangentY[6];
+  Vector2 tangentS[6], tangentT[6];
+
+  // set up tangents for each of the 12 edges if they were not degenerate
+  if(!(nFlagsX & DEGEN_0a))
+  {
+    tangentX[0] = subMatrix[0][1]->vertex - subMatrix[0][0]->vertex;
+    tangentS[0] = subMatrix[0][1]->texcoord - subMatrix[0][0]->texcoord;
+  }
+  if(!(nFlagsX & DEGEN_0b))
+  {
+    tangentX[1] = subMatrix[0][2]->vertex - subMatrix[0][1]->vertex;
+    tangentS[1] = subMatrix[0][2]->texcoord - subMatrix[0][1]->texcoord;
+  }
+  if(!(nFlagsX & DEGEN_1a))
+  {
+    tangentX[2] = subMatrix[1][1]->vertex - subMatrix[1][0]->vertex;
+    tangentS[2] = subMatrix[1][1]->texcoord - subMatrix[1][0]->texcoord;
+  }
+  if(!(nFlagsX & DEGEN_1b))
+  {
+    tangentX[3] = subMatrix[1][2]->vertex - subMatrix[1][1]->vertex;
+    tangentS[3] = subMatrix[1][2]->texcoord - subMatrix[1][1]->texcoord;
+  }
+  if(!(nFlagsX & DEGEN_2a))
+  {
+    tangentX[4] = subMatrix[2][1]->vertex - subMatrix[2][0]->vertex;
+    tangentS[4] = subMatrix[2][1]->texcoord - subMatrix[2][0]->texcoord;
+  }
+  if(!(nFlagsX & DEGEN_2b))
+  {
+    tangentX[5] = subMatrix[2][2]->vertex - subMatrix[2][1]->vertex;
+    tangentS[5] = subMatrix[2][2]->texcoord - subMatrix[2][1]->texcoord;
+  }
+
+  if(!(nFlagsY & DEGEN_0a))
+  {
+    tangentY[0] = subMatrix[1][0]->vertex - subMatrix[0][0]->vertex;
+    tangentT[0] = subMatrix[1][0]->texcoord - subMatrix[0][0]->texcoord;
+  }
+  if(!(nFlagsY & DEGEN_0b))
+  {
+    tangentY[1] = subMatrix[2][0]->vertex - subMatrix[1][0]->vertex;
+    tangentT[1] = subMatrix[2][0]->texcoord - subMatrix[1][0]->texcoord;
+  }
+  if(!(nFlagsY & DEGEN_1a))
+  {
+    tangentY[2] = subMatrix[1][1]->vertex - subMatrix[0][1]->vertex;
+    tangentT[2] = subMatrix[1][1]->texcoord - subMatrix[0][1]->texcoord;
+  }
+  if(!(nFlagsY & DEGEN_1b))
+  {
+    tangentY[3] = subMatrix[2][1]->vertex - subMatrix[1][1]->vertex;
+    tangentT[3] = subMatrix[2][1]->texcoord - subMatrix[1][1]->texcoord;
+  }
+  if(!(nFlagsY & DEGEN_2a))
+  {
+    tangentY[4] = subMatrix[1][2]->vertex - subMatrix[0][2]->vertex;
+    tangentT[4] = subMatrix[1][2]->texcoord - subMatrix[0][2]->texcoord;
+  }
+  if(!(nFlagsY & DEGEN_2b))
+  {
+    tangentY[5] = subMatrix[2][2]->vertex - subMatrix[1][2]->vertex;
+    tangentT[5] = subMatrix[2][2]->texcoord - subMatrix[1][2]->texcoord;
+  }
+
+  // set up remaining edge tangents by borrowing the tangent from the closest parallel non-degenerate edge
+  tangents_remove_degenerate(tangentX, tangentS, nFlagsX);
+  tangents_remove_degenerate(tangentY, tangentT, nFlagsY);
+
+  {
+    // x=0, y=0
+    std::size_t index = offStartX + offStartY;
+    std::size_t index0 = 0;
+    std::size_t index1 = 0;
+
+    double dot = tangentX[index0].dot(tangentY[index1]);
+    double length = tangentX[index0].getLength() * tangentY[index1].getLength();
+
+    bestTangents00(nFlagsX, dot, length, index0, index1);
+
+    accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
+  }
+
+  {
+    // x=1, y=0
+    std::size_t index = offEndX + offStartY;
+    std::size_t index0 = 1;
+    std::size_t index1 = 4;
+
+    double dot = tangentX[index0].dot(tangentY[index1]);
+    double length = tangentX[index0].getLength() * tangentY[index1].getLength();
+
+    bestTangents10(nFlagsX, dot, length, index0, index1);
+
+    accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
+  }
+
+  {
+    // x=0, y=1
+    std::size_t index = offStartX + offEndY;
+    std::size_t index0 = 4;
+    std::size_t index1 = 1;
+
+    double dot = tangentX[index0].dot(tangentY[index1]);
+    double length = tangentX[index1].getLength() * tangentY[index1].getLength();
+
+    bestTangents01(nFlagsX, dot, length, index0, index1);
+
+    accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
+  }
+
+  {
+    // x=1, y=1
+    std::size_t index = offEndX + offEndY;
+    std::size_t index0 = 5;
+    std::size_t index1 = 5;
+
+    double dot = tangentX[index0].dot(tangentY[index1]);
+    double length = tangentX[index0].getLength() * tangentY[index1].getLength();
+
+    bestTangents11(nFlagsX, dot, length, index0, index1);
+
+    accumulateVertexTangentSpace(index, tangentX, tangentY, tangentS, tangentT, index0, index1);
+  }
+
+  //normalise normals that won't be accumulated again
+  if(i!=0 || j!=0)
+  {
+			normalise_safe(vertices[offStartX + offStartY].normal);
+			normalise_safe(vertices[offStartX + offStartY].tangent);
+			normalise_safe(vertices[offStartX + offStartY].bitangent);
+  }
+  if(i+3 == _width)
+  {
+			normalise_safe(vertices[offEndX + offStartY].normal);
+			normalise_safe(vertices[offEndX + offStartY].tangent);
+			normalise_safe(vertices[offEndX + offStartY].bitangent);
+  }
+  if(j+3 == _height)
+  {
+			normalise_safe(vertices[offStartX + offEndY].normal);
+			normalise_safe(vertices[offStartX + offEndY].tangent);
+			normalise_safe(vertices[offStartX + offEndY].bitangent);
+  }
+  if(i+3 == _width && j+3 == _height)
+  {
+			normalise_safe(vertices[offEndX + offEndY].normal);
+			normalise_safe(vertices[offEndX + offEndY].tangent);
+			normalise_safe(vertices[offEndX + offEndY].bitangent);
+  }
+
+  // set flags to average normals between shared edges
+  if(j != 0)
+  {
+    nFlagsX |= AVERAGE;
+  }
+  if(i != 0)
+  {
+    nFlagsY |= AVERAGE;
+  }
+  // set flags to save evaluating shared edges twice
+  nFlagsX |= SPLIT;
+  nFlagsY |= SPLIT;
+
+  // if the patch is curved.. tesselate recursively
+  // use the relevant control curves for this sub-patch
+  if(_subdivisionsFixed)
+  {
+    TesselateSubMatrixFixed(&vertices[offStartX + offStartY], 1, m_nArrayWidth, nFlagsX, nFlagsY, subMatrix);
+  }
+  else
+  {
+    if(!leafX)
+    {
+      TesselateSubMatrix( curveTreeU[i>>1], curveTreeV[j>>1],
+                          offStartX, offStartY, offEndX, offEndY, // array offsets
+                          nFlagsX, nFlagsY,
+                          subMatrix[1][0]->vertex, subMatrix[1][1]->vertex, subMatrix[1][2]->vertex,
+                          subMatrix[1][0]->texcoord, subMatrix[1][1]->texcoord, subMatrix[1][2]->texcoord,
+                          false );
+    }
+    else if(!leafY)
+    {
+      TesselateSubMatrix( curveTreeV[j>>1], curveTreeU[i>>1],
+                          offStartY, offStartX, offEndY, offEndX, // array offsets
+                          nFlagsY, nFlagsX,
+                          subMatrix[0][1]->vertex, subMatrix[1][1]->vertex, subMatrix[2][1]->vertex,
+                          subMatrix[0][1]->texcoord, subMatrix[1][1]->texcoord, subMatrix[2][1]->texcoord,
+                          true );
+    }
+  }
+
+}
+
+void PatchTesselation::tesselateChangedSubPatches()
+{
+	const std::size_t columns = arrayWidth.size();
+	const std::size_t rows = arrayHeight.size();
+
+	// The vertices on the sub-patch edges receive their normals from all adjacent sub-patches,
+	// so the ones around the changed sub-patches are evaluated again too
+	_updatedSubPatches.assign(columns * rows, false);
+	_changedVertices.assign(vertices.size(), false);
+
+	for (std::size_t row = 0; row < rows; ++row)
+	{
+		for (std::size_t column = 0; column < columns; ++column)
+		{
+			if (!_changedSubPatches[row * columns + column]) continue;
+
+			for (std::size_t r = (row > 0 ? row - 1 : 0); r <= std::min(row + 1, rows - 1); ++r)
+			{
+				for (std::size_t c = (column > 0 ? column - 1 : 0); c <= std::min(column + 1, columns - 1); ++c)
+				{
+					_updatedSubPatches[r * columns + c] = true;
+				}
+			}
+
+			for (std::size_t y = _subPatchStartY[row]; y <= _subPatchStartY[row] + arrayHeight[row]; ++y)
+			{
+				for (std::size_t x = _subPatchStartX[column]; x <= _subPatchStartX[column] + arrayWidth[column]; ++x)
+				{
+					_changedVertices[y * m_nArrayWidth + x] = true;
+				}
+			}
+		}
+	}
+
+	// Evaluating a sub-patch on its own messes up the normals along its outer edges,
+	// the vertices not touched by any changed sub-patch get their previous values back
+	_unchangedVertices.clear();
+
+	for (std::size_t row = 0; row < rows; ++row)
+	{
+		for (std::size_t column = 0; column < columns; ++column)
+		{
+			std::size_t subPatch = row * columns + column;
+
+			if (!_updatedSubPatches[subPatch] || _changedSubPatches[subPatch]) continue;
+
+			for (std::size_t y = _subPatchStartY[row]; y <= _subPatchStartY[row] + arrayHeight[row]; ++y)
+			{
+				for (std::size_t x = _subPatchStartX[column]; x <= _subPatchStartX[column] + arrayWidth[column]; ++x)
+				{
+					std::size_t index = y * m_nArrayWidth + x;
+
+					if (!_changedVertices[index])
+					{
+						_unchangedVertices.push_back(std::make_pair(index, vertices[index]));
+					}
+				}
+			}
+		}
+	}
+
+	// Same order as the full evaluation, the normals are accumulated along the way
+	for (std::size_t row = 0; row < rows; ++row)
+	{
+		for (std::size_t column = 0; column < columns; ++column)
+		{
+			if (_updatedSubPatches[row * columns + column])
+			{
+				tesselateSubPatch(column, row);
+			}
+		}
+	}
+
+	for (std::vector<std::pair<std::size_t, ArbitraryMeshVertex> >::const_iterator i = _unchangedVertices.begin();
+		i != _unchangedVertices.end(); ++i)
+	{
+		vertices[i->first] = i->second;
+	}
 }
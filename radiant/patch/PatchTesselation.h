@@ -1,10 +1,14 @@
 #pragma once
 
+#include <boost/noncopyable.hpp>
 #include "render.h"
 #include "PatchBezier.h"
+#include "PatchControl.h"
+#include "PatchConstants.h"
 
 /// Representation of a patch as mesh geometry
-struct PatchTesselation
+struct PatchTesselation :
+	public boost::noncopyable
 {
 public:
 
@@ -22,6 +26,35 @@ public:
 	std::vector<BezierCurveTree*> curveTreeU;
 	std::vector<BezierCurveTree*> curveTreeV;
 
+private:
+	// The input of the previous generate() call
+	std::size_t _width;
+	std::size_t _height;
+	PatchControlArray _controlPoints;
+	bool _subdivisionsFixed;
+	Subdivisions _subdivisions;
+	float _subdivideThreshold;
+
+	// Each curve tree has its own node pool, to be able to rebuild them one by one
+	std::vector<BezierCurveTreePool> _curveTreePoolU;
+	std::vector<BezierCurveTreePool> _curveTreePoolV;
+	BezierCurveTreeBuilder _curveTreeBuilder;
+
+	// The first array column (row) of each column (row) of sub-patches
+	std::vector<std::size_t> _subPatchStartX;
+	std::vector<std::size_t> _subPatchStartY;
+
+	// Bookkeeping of the incremental updates, kept to avoid reallocations
+	std::vector<bool> _changedTreesU;
+	std::vector<bool> _changedTreesV;
+	std::vector<bool> _changedSubPatches;
+	std::vector<bool> _updatedSubPatches;
+	std::vector<bool> _changedVertices;
+	std::vector<bool> _treeShape;
+	std::vector<bool> _previousTreeShape;
+	std::vector<const BezierCurveTree*> _treeNodes;
+	std::vector<std::pair<std::size_t, ArbitraryMeshVertex> > _unchangedVertices;
+
 public:
 
     /// Construct an uninitialised patch tesselation
@@ -29,9 +62,73 @@ public:
 		m_numStrips(0),
 		m_lenStrips(0),
 		m_nArrayWidth(0),
-		m_nArrayHeight(0)
+		m_nArrayHeight(0),
+		_width(0),
+		_height(0),
+		_subdivisionsFixed(false),
+		_subdivideThreshold(0)
 	{}
 
     /// Clear all patch data
     void clear();
+
+	/**
+	 * Tesselates the patch defined by the given control points. The buffers are
+	 * re-used, and if the previous call was tesselating the same patch, only the
+	 * sub-patches affected by changed control points are evaluated again.
+	 */
+	void generate(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold);
+
+	/// Returns true if the last generate() call used the given arguments
+	bool isTesselationOf(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold) const;
+
+	/// Returns a hash value of the given generate() arguments
+	static std::size_t GetHash(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold);
+
+	/// The hash value of the arguments passed to the last generate() call
+	std::size_t getHash() const;
+
+private:
+	// Compares the control points to the ones of the previous run, returns FALSE if nothing changed
+	bool collectChangedSubPatches(const PatchControlArray& controlPoints);
+
+	// Rebuilds the curve tree of the given column (ROW) or row (COL) of sub-patches,
+	// returns the number of array elements between the start and the end of the sub-patches
+	std::size_t buildCurveTree(EMatrixMajor major, std::size_t index, std::size_t arrayOffset);
+
+	// Rebuilds the curve trees and array dimensions in the given direction
+	void buildCurveTrees(EMatrixMajor major);
+
+	// Stores the leaf flags of the given tree's nodes in depth-first order
+	void getTreeShape(const BezierCurveTree* tree, std::vector<bool>& shape);
+
+	// Rebuilds the changed curve trees, returns FALSE if one of them came out differently
+	bool updateChangedCurveTrees(EMatrixMajor major);
+
+	void buildIndexArray();
+
+	// Evaluates the vertices of the sub-patch in the given column and row
+	void tesselateSubPatch(std::size_t column, std::size_t row);
+
+	// Evaluates the sub-patches around the changed ones
+	void tesselateChangedSubPatches();
+
+	void TesselateSubMatrixFixed(ArbitraryMeshVertex* vertices,
+								 std::size_t strideX, std::size_t strideY,
+								 unsigned int nFlagsX, unsigned int nFlagsY,
+								 PatchControlConstIter subMatrix[3][3]);
+
+	// uses binary trees representing bezier curves to recursively tesselate a bezier sub-patch
+	void TesselateSubMatrix( const BezierCurveTree *BX, const BezierCurveTree *BY,
+                           std::size_t offStartX, std::size_t offStartY,
+                           std::size_t offEndX, std::size_t offEndY,
+                           std::size_t nFlagsX, std::size_t nFlagsY,
+                           const Vector3& left, const Vector3& mid, const Vector3& right,
+                           const Vector2& texLeft, const Vector2& texMid, const Vector2& texRight,
+                           bool bTranspose );
+
+	void accumulateVertexTangentSpace(std::size_t index, Vector3 tangentX[6], Vector3 tangentY[6], Vector2 tangentS[6], Vector2 tangentT[6], std::size_t index0, std::size_t index1);
 };
@@ -0,0 +1,148 @@
+#include "PatchTesselationCache.h"
+
+#include <algorithm>
+
+namespace
+{
+	const std::size_t MIN_CLEANUP_SIZE = 64;
+}
+
+PatchTesselationCache::PatchTesselationCache() :
+	_cleanupSize(MIN_CLEANUP_SIZE)
+{}
+
+void PatchTesselationCache::update(PatchTesselationPtr& tesselation, Vector3& offset,
+	std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+	bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold)
+{
+	offset = controlPoints.empty() ? Vector3(0, 0, 0) : controlPoints.front().vertex;
+
+	_relativeControlPoints.resize(controlPoints.size());
+
+	for (std::size_t i = 0; i < controlPoints.size(); ++i)
+	{
+		_relativeControlPoints[i].vertex = controlPoints[i].vertex - offset;
+		_relativeControlPoints[i].texcoord = controlPoints[i].texcoord;
+	}
+
+	// Moving the whole patch doesn't change its shape
+	if (tesselation && tesselation->isTesselationOf(width, height, _relativeControlPoints,
+		subdivisionsFixed, subdivisions, subdivideThreshold))
+	{
+		return;
+	}
+
+	std::size_t hash = PatchTesselation::GetHash(width, height, _relativeControlPoints,
+		subdivisionsFixed, subdivisions, subdivideThreshold);
+
+	PatchTesselationPtr existing = find(hash, width, height, subdivisionsFixed, subdivisions, subdivideThreshold);
+
+	if (existing)
+	{
+		tesselation = existing;
+		return;
+	}
+
+	if (tesselation && tesselation.use_count() == 1)
+	{
+		// Nobody else is using this one, it is re-tesselated under a new key
+		remove(*tesselation);
+	}
+	else
+	{
+		tesselation = std::make_shared<PatchTesselation>();
+	}
+
+	tesselation->generate(width, height, _relativeControlPoints, subdivisionsFixed, subdivisions, subdivideThreshold);
+
+	insert(hash, tesselation);
+}
+
+std::size_t PatchTesselationCache::getNumTesselations() const
+{
+	std::size_t count = 0;
+
+	for (TesselationMap::const_iterator i = _tesselations.begin(); i != _tesselations.end(); ++i)
+	{
+		if (!i->second.expired())
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+PatchTesselationCache& PatchTesselationCache::Instance()
+{
+	static PatchTesselationCache _instance;
+	return _instance;
+}
+
+PatchTesselationPtr PatchTesselationCache::find(std::size_t hash, std::size_t width, std::size_t height,
+	bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold)
+{
+	std::pair<TesselationMap::iterator, TesselationMap::iterator> range = _tesselations.equal_range(hash);
+
+	for (TesselationMap::iterator i = range.first; i != range.second;)
+	{
+		PatchTesselationPtr tesselation = i->second.lock();
+
+		if (!tesselation)
+		{
+			i = _tesselations.erase(i);
+			continue;
+		}
+
+		if (tesselation->isTesselationOf(width, height, _relativeControlPoints,
+			subdivisionsFixed, subdivisions, subdivideThreshold))
+		{
+			return tesselation;
+		}
+
+		++i;
+	}
+
+	return PatchTesselationPtr();
+}
+
+void PatchTesselationCache::insert(std::size_t hash, const PatchTesselationPtr& tesselation)
+{
+	_tesselations.insert(TesselationMap::value_type(hash, tesselation));
+
+	if (_tesselations.size() < _cleanupSize)
+	{
+		return;
+	}
+
+	for (TesselationMap::iterator i = _tesselations.begin(); i != _tesselations.end();)
+	{
+		if (i->second.expired())
+		{
+			i = _tesselations.erase(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	_cleanupSize = std::max(MIN_CLEANUP_SIZE, _tesselations.size() * 2);
+}
+
+void PatchTesselationCache::remove(const PatchTesselation& tesselation)
+{
+	std::pair<TesselationMap::iterator, TesselationMap::iterator> range =
+		_tesselations.equal_range(tesselation.getHash());
+
+	for (TesselationMap::iterator i = range.first; i != range.second; ++i)
+	{
+		PatchTesselationPtr cached = i->second.lock();
+
+		if (cached.get() == &tesselation)
+		{
+			_tesselations.erase(i);
+			return;
+		}
+	}
+}
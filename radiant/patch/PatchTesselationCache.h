@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <boost/noncopyable.hpp>
+#include "PatchTesselation.h"
+
+typedef std::shared_ptr<PatchTesselation> PatchTesselationPtr;
+
+/**
+ * Patches with the same shape (same control points relative to the first
+ * one, same subdivision settings) share a single tesselation, which is
+ * calculated relative to their first control point. Maps tend to contain
+ * lots of copies of the same pipe, arch or trim patch, so this saves the
+ * memory and the time spent on tesselating all of them.
+ *
+ * The cache holds weak references only, a tesselation lives as long as
+ * there are patches using it. Shared tesselations must not be modified,
+ * this class hands out new ones when a shared patch is changed.
+ *
+ * Not thread-safe, patches are tesselated by the main thread.
+ */
+class PatchTesselationCache :
+	public boost::noncopyable
+{
+private:
+	typedef std::unordered_multimap<std::size_t, std::weak_ptr<PatchTesselation> > TesselationMap;
+	TesselationMap _tesselations;
+
+	// The map is swept for expired entries when reaching this size
+	std::size_t _cleanupSize;
+
+	// Buffer for the control points relative to the first one
+	PatchControlArray _relativeControlPoints;
+
+public:
+	PatchTesselationCache();
+
+	/**
+	 * Points the given tesselation to the one of the patch defined by the given
+	 * control points, which is either taken from the cache or generated.
+	 * The offset receives the location the tesselation is relative to.
+	 *
+	 * A tesselation which is not shared with any other patch is updated in place,
+	 * so that only the parts affected by changed control points are evaluated.
+	 */
+	void update(PatchTesselationPtr& tesselation, Vector3& offset,
+		std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold);
+
+	/// The number of tesselations currently in use
+	std::size_t getNumTesselations() const;
+
+	/// The cache used by all patches of the scene
+	static PatchTesselationCache& Instance();
+
+private:
+	// Returns the cached tesselation for the given arguments, removing any expired entries along the way
+	PatchTesselationPtr find(std::size_t hash, std::size_t width, std::size_t height,
+		bool subdivisionsFixed, const Subdivisions& subdivisions, float subdivideThreshold);
+
+	void insert(std::size_t hash, const PatchTesselationPtr& tesselation);
+	void remove(const PatchTesselation& tesselation);
+};
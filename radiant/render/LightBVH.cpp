@@ -0,0 +1,142 @@
+#include "LightBVH.h"
+
+#include <algorithm>
+
+namespace render
+{
+
+namespace
+{
+	// Maximum number of lights in a leaf node
+	const std::uint32_t MAX_LEAF_SIZE = 4;
+}
+
+bool LightBVH::boundsOverlap(const AABB& a, const AABB& b)
+{
+	return fabs(a.origin[0] - b.origin[0]) <= (a.extents[0] + b.extents[0]) &&
+		   fabs(a.origin[1] - b.origin[1]) <= (a.extents[1] + b.extents[1]) &&
+		   fabs(a.origin[2] - b.origin[2]) <= (a.extents[2] + b.extents[2]);
+}
+
+void LightBVH::build(const RendererLights& lights)
+{
+	_entries.clear();
+	_nodes.clear();
+	_unbounded.clear();
+
+	for (const RendererLights::value_type& pair : lights)
+	{
+		if (pair.second.isValid())
+		{
+			Entry entry = { pair.first, pair.second };
+			_entries.push_back(entry);
+		}
+		else
+		{
+			_unbounded.push_back(pair.first);
+		}
+	}
+
+	if (_entries.empty())
+	{
+		return;
+	}
+
+	// A binary tree with n leaves has at most 2n - 1 nodes
+	_nodes.reserve(_entries.size() * 2);
+	_nodes.push_back(Node());
+
+	buildNode(0, 0, static_cast<std::uint32_t>(_entries.size()));
+}
+
+void LightBVH::buildNode(std::uint32_t nodeIndex, std::uint32_t first, std::uint32_t count)
+{
+	AABB bounds;
+	AABB centres;
+
+	for (std::uint32_t i = first; i < first + count; ++i)
+	{
+		bounds.includeAABB(_entries[i].bounds);
+		centres.includePoint(_entries[i].bounds.origin);
+	}
+
+	_nodes[nodeIndex].bounds = bounds;
+
+	if (count <= MAX_LEAF_SIZE)
+	{
+		_nodes[nodeIndex].first = first;
+		_nodes[nodeIndex].count = count;
+		return;
+	}
+
+	// Split at the median along the axis with the largest spread of light centres
+	std::size_t axis = 0;
+
+	if (centres.extents[1] > centres.extents[axis]) axis = 1;
+	if (centres.extents[2] > centres.extents[axis]) axis = 2;
+
+	std::uint32_t half = count / 2;
+
+	std::nth_element(_entries.begin() + first, _entries.begin() + first + half,
+		_entries.begin() + first + count,
+		[&](const Entry& a, const Entry& b) { return a.bounds.origin[axis] < b.bounds.origin[axis]; });
+
+	std::uint32_t children = static_cast<std::uint32_t>(_nodes.size());
+
+	_nodes.push_back(Node());
+	_nodes.push_back(Node());
+
+	_nodes[nodeIndex].first = children;
+	_nodes[nodeIndex].count = 0;
+
+	buildNode(children, first, half);
+	buildNode(children + 1, first + half, count - half);
+}
+
+void LightBVH::forEachIntersectingLight(const AABB& bounds, const LightVisitor& visitor) const
+{
+	for (RendererLight* light : _unbounded)
+	{
+		visitor(*light);
+	}
+
+	if (!bounds.isValid())
+	{
+		for (const Entry& entry : _entries)
+		{
+			visitor(*entry.light);
+		}
+
+		return;
+	}
+
+	if (!_nodes.empty())
+	{
+		visitNode(_nodes.front(), bounds, visitor);
+	}
+}
+
+void LightBVH::visitNode(const Node& node, const AABB& bounds, const LightVisitor& visitor) const
+{
+	if (!boundsOverlap(node.bounds, bounds))
+	{
+		return;
+	}
+
+	if (node.count == 0)
+	{
+		visitNode(_nodes[node.first], bounds, visitor);
+		visitNode(_nodes[node.first + 1], bounds, visitor);
+		return;
+	}
+
+	for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+	{
+		if (boundsOverlap(_entries[i].bounds, bounds))
+		{
+			visitor(*_entries[i].light);
+		}
+	}
+}
+
+} // namespace render
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "irender.h"
+#include "math/AABB.h"
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace render
+{
+
+// All lights attached to the render system, along with the bounds they're indexed with
+typedef std::map<RendererLight*, AABB> RendererLights;
+
+/**
+ * \brief
+ * Bounding volume hierarchy over the light volumes of the render system.
+ *
+ * The tree is built from scratch whenever lights have been changed, which is
+ * cheap for the few hundred lights of a map. Looking up the lights near a
+ * lit object then takes logarithmic time instead of testing each light.
+ *
+ * Lights with invalid bounds can't be sorted into the tree, they are kept
+ * in a separate list and reported for every query.
+ */
+class LightBVH
+{
+private:
+	struct Entry
+	{
+		RendererLight* light;
+		AABB bounds;
+	};
+	std::vector<Entry> _entries;
+
+	// Leaves reference the range [first, first + count) of _entries,
+	// inner nodes (count == 0) have their children at first and first + 1
+	struct Node
+	{
+		AABB bounds;
+		std::uint32_t first;
+		std::uint32_t count;
+	};
+	std::vector<Node> _nodes;
+
+	std::vector<RendererLight*> _unbounded;
+
+public:
+	typedef std::function<void(RendererLight&)> LightVisitor;
+
+	// Re-builds the tree from the given lights
+	void build(const RendererLights& lights);
+
+	// Invokes the visitor for each light whose bounds intersect the given ones.
+	// Passing invalid bounds will visit all lights.
+	void forEachIntersectingLight(const AABB& bounds, const LightVisitor& visitor) const;
+
+	// Unlike AABB::intersects() this treats touching boxes as intersecting,
+	// the index must never be stricter than the lights' intersectsAABB()
+	static bool boundsOverlap(const AABB& a, const AABB& b);
+
+private:
+	void buildNode(std::uint32_t nodeIndex, std::uint32_t first, std::uint32_t count);
+	void visitNode(const Node& node, const AABB& bounds, const LightVisitor& visitor) const;
+};
+
+} // namespace render
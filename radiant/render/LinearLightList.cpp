@@ -15,15 +15,18 @@ void LinearLightList::calculateIntersectingLights() const
         _activeLights.clear();
         _litObject.clearLights();
 
-        // Determine which lights intersect object
-        for (RendererLight* light : _allLights)
+        _bounds = _litObject.litObjectAABB();
+
+        // Determine which lights intersect object, only the lights
+        // near the object's bounds need to be tested
+        _allLights.forEachIntersectingLight(_bounds, [&](RendererLight& light)
         {
-            if (_litObject.intersectsLight(*light))
+            if (_litObject.intersectsLight(light))
             {
-                _activeLights.push_back(light);
-                _litObject.insertLight(*light);
+                _activeLights.push_back(&light);
+                _litObject.insertLight(light);
             }
-        }
+        });
     }
 }
 
@@ -42,4 +45,10 @@ void LinearLightList::setDirty()
     m_dirty = true;
 }
 
+bool LinearLightList::isAffectedBy(const AABB& region) const
+{
+    // Invalid bounds have been tested against every light
+    return !_bounds.isValid() || !region.isValid() || LightBVH::boundsOverlap(_bounds, region);
+}
+
 }
@@ -1,14 +1,13 @@
 #pragma once
 
 #include "irender.h"
+#include "LightBVH.h"
 #include <list>
 #include <functional>
 
 namespace render
 {
 
-typedef std::set<RendererLight*> RendererLights;
-
 /**
  * \brief
  * Main renderer implementation of LightList interface.
@@ -27,8 +26,8 @@ private:
     // Target object
 	LitObject& _litObject;
 
-    // Set of all available lights
-	RendererLights& _allLights;
+    // Spatial index of all available lights
+	const LightBVH& _allLights;
 
     // Update callback
 	VoidCallback _testDirtyFunc;
@@ -37,6 +36,9 @@ private:
 	typedef std::list<RendererLight*> Lights;
 	mutable Lights _activeLights;
 
+    // The object bounds used in the last calculation
+	mutable AABB _bounds;
+
     // Dirty flag indicating recalculation needed
 	mutable bool m_dirty;
 
@@ -50,14 +52,14 @@ public:
      * The illuminatable object whose lit status we are tracking.
      *
      * \param lights
-     * Entire set of available light sources provided by the renderer.
+     * Spatial index of all light sources provided by the renderer.
      *
      * \param testFunc
      * A callback function to request the renderer check if the light list
      * needs to recalculate its intersections, and call setDirty() if necessary.
      */
     LinearLightList(LitObject& object,
-                    RendererLights& lights,
+                    const LightBVH& lights,
                     VoidCallback testFunc)
     : _litObject(object), _allLights(lights), _testDirtyFunc(testFunc)
 	{
@@ -68,6 +70,15 @@ public:
 	void calculateIntersectingLights() const;
 	void forEachLight(const RendererLightCallback& callback) const;
 	void setDirty();
+
+	bool isDirty() const
+	{
+		return m_dirty;
+	}
+
+	// Returns true if a light change within the given region can affect
+	// the result of the last calculation
+	bool isAffectedBy(const AABB& region) const;
 };
 
 } // namespace render
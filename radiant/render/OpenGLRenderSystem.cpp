@@ -6,6 +6,7 @@
 #include "math/Matrix4.h"
 #include "modulesystem/StaticModule.h"
 #include "backend/GLProgramFactory.h"
+#include "RenderStatistics.h"
 
 #include <functional>
 
@@ -40,6 +41,8 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
 	_realised(false),
     _glProgramFactory(std::make_shared<GLProgramFactory>()),
 	_currentShaderProgram(SHADER_PROGRAM_NONE),
+	_stateRanksDirty(true),
+	_renderQueue(_frameAllocator),
 	_time(0),
 	m_lightsChanged(true),
 	m_traverseRenderablesMutex(false)
@@ -113,6 +116,13 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
                                const Matrix4& projection,
                                const Vector3& viewer)
 {
+	// Upload the textures which finished loading in the background
+	// before any GL state is set up for this frame
+	GlobalMaterialManager().processPendingTextureUploads();
+
+	// Entity-dependent shader expressions are evaluated afresh in each frame
+	GlobalMaterialManager().beginFrame();
+
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
 
 	// Set the projection and modelview matrices
@@ -193,20 +203,23 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
 	glHint(GL_FOG_HINT, GL_NICEST);
     glDisable(GL_FOG);
 
-    // Iterate over the sorted mapping between OpenGLStates and their
-    // OpenGLShaderPasses (containing the renderable geometry), and render the
-    // contents of each bucket. Each pass is passed a reference to the "current"
+    // Render the contents of the queue, which sorts the renderables
+    // by the position of their OpenGLShaderPass in the sorted state map
+    // and their entity. Each pass is passed a reference to the "current"
     // state, which it can change.
-	for (OpenGLStates::iterator i = _state_sorted.begin();
-		i != _state_sorted.end();
-		++i)
-	{
-        // Render the OpenGLShaderPass
-        if (!i->second->empty())
-        {
-            i->second->render(current, globalstate, viewer, _time);
-        }
-	}
+    if (_stateRanksDirty)
+    {
+        updateStateRanks();
+    }
+
+    _renderQueue.execute(current, globalstate, viewer, _time);
+
+    RenderStatistics::Instance().setFrameMemoryUsage(
+        _frameAllocator.getBytesUsed(), _frameAllocator.getHighWaterMark()
+    );
+
+    // All renderables have been processed, release the frame memory
+    _frameAllocator.reset();
 
 	glPopAttrib();
 }
@@ -267,6 +280,11 @@ GLProgramFactory& OpenGLRenderSystem::getGLProgramFactory()
     return *_glProgramFactory;
 }
 
+RenderQueue& OpenGLRenderSystem::getRenderQueue()
+{
+    return _renderQueue;
+}
+
 std::size_t OpenGLRenderSystem::getTime() const
 {
 	return _time;
@@ -388,9 +406,9 @@ LightList& OpenGLRenderSystem::attachLitObject(LitObject& object)
 			&object,
 			LinearLightList(
                 object,
-                m_lights,
+                _lightIndex,
                 std::bind(
-                    &OpenGLRenderSystem::propagateLightChangedFlagToAllLights,
+                    &OpenGLRenderSystem::updateChangedLights,
                     this
                 )
             )
@@ -414,42 +432,116 @@ void OpenGLRenderSystem::litObjectChanged(LitObject& object)
 void OpenGLRenderSystem::attachLight(RendererLight& light)
 {
     ASSERT_MESSAGE(m_lights.find(&light) == m_lights.end(), "light could not be attached");
-    m_lights.insert(&light);
+
+    // The light will be indexed with its actual bounds on the next update
+    m_lights.insert(RendererLights::value_type(&light, AABB()));
+    _newLights.insert(&light);
     lightChanged(light);
 }
 
 void OpenGLRenderSystem::detachLight(RendererLight& light)
 {
-    ASSERT_MESSAGE(m_lights.find(&light) != m_lights.end(), "light could not be detached");
-    m_lights.erase(&light);
-    lightChanged(light);
+    RendererLights::iterator i = m_lights.find(&light);
+    ASSERT_MESSAGE(i != m_lights.end(), "light could not be detached");
+
+    // Objects within the old bounds need to drop this light. Don't query the
+    // light itself here, it might be in the middle of being destroyed.
+    if (_newLights.erase(&light) == 0)
+    {
+        _changedLightRegions.push_back(i->second);
+    }
+
+    _changedLights.erase(&light);
+
+    m_lights.erase(i);
+    m_lightsChanged = true;
 }
 
 void OpenGLRenderSystem::lightChanged(RendererLight& light)
 {
+    // Evaluating the bounds is deferred until the light lists are updated
+    _changedLights.insert(&light);
     m_lightsChanged = true;
 }
 
-void OpenGLRenderSystem::propagateLightChangedFlagToAllLights()
+void OpenGLRenderSystem::updateChangedLights()
 {
-    if (m_lightsChanged)
+    if (!m_lightsChanged)
+    {
+        return;
+    }
+
+    m_lightsChanged = false;
+
+    for (RendererLight* light : _changedLights)
     {
-    	m_lightsChanged = false;
-    	for (LightLists::iterator i = m_lightLists.begin();
-             i != m_lightLists.end();
-             ++i) 
+        RendererLights::iterator i = m_lights.find(light);
+        assert(i != m_lights.end());
+
+        // Objects lit before and objects lit after the change are affected,
+        // newly attached lights don't have any old bounds.
+        // Invalid bounds will affect every object.
+        if (_newLights.find(light) == _newLights.end())
         {
-    		i->second.setDirty();
-    	}
-	}
+            _changedLightRegions.push_back(i->second);
+        }
+
+        i->second = light->lightAABB();
+        _changedLightRegions.push_back(i->second);
+    }
+
+    _changedLights.clear();
+    _newLights.clear();
+
+    _lightIndex.build(m_lights);
+
+    for (LightLists::value_type& pair : m_lightLists)
+    {
+        LinearLightList& lightList = pair.second;
+
+        if (lightList.isDirty()) continue;
+
+        for (const AABB& region : _changedLightRegions)
+        {
+            if (lightList.isAffectedBy(region))
+            {
+                lightList.setDirty();
+                break;
+            }
+        }
+    }
+
+    _changedLightRegions.clear();
+}
+
+void OpenGLRenderSystem::updateStateRanks()
+{
+    std::uint32_t rank = 0;
+
+    for (OpenGLStates::value_type& pair : _state_sorted)
+    {
+        pair.second->setSortRank(rank++);
+    }
+
+    _stateRanksDirty = false;
 }
 
 void OpenGLRenderSystem::insertSortedState(const OpenGLStates::value_type& val) {
 	_state_sorted.insert(val);
+	_stateRanksDirty = true;
 }
 
 void OpenGLRenderSystem::eraseSortedState(const OpenGLStates::key_type& key) {
-	_state_sorted.erase(key);
+	OpenGLStates::iterator found = _state_sorted.find(key);
+
+	if (found != _state_sorted.end())
+	{
+		// Don't leave any dangling pass references in the queue
+		_renderQueue.discard(*found->second);
+		_state_sorted.erase(found);
+	}
+
+	_stateRanksDirty = true;
 }
 
 // renderables
@@ -5,6 +5,8 @@
 #include "imodule.h"
 #include "backend/OpenGLStateManager.h"
 #include "backend/OpenGLShader.h"
+#include "backend/RenderQueue.h"
+#include "backend/FrameAllocator.h"
 #include "LinearLightList.h"
 #include "render/backend/OpenGLStateLess.h"
 
@@ -40,19 +42,46 @@ private:
 	// Map of OpenGLState references, with access functions.
 	OpenGLStates _state_sorted;
 
+	// Set when the sorted states changed and the pass ranks need to be re-assigned
+	bool _stateRanksDirty;
+
+	// Frame memory all shader passes are allocating their renderables from,
+	// reset after each call to render()
+	FrameAllocator _frameAllocator;
+
+	// Renderables submitted by the shader passes, executed by render()
+	RenderQueue _renderQueue;
+
 	// Render time
 	std::size_t _time;
 
 	// Lights
 	RendererLights m_lights;
 	bool m_lightsChanged;
+
+	// Lights modified since the last index update, and the subset of them
+	// which has been attached in the meantime (and has no old bounds)
+	std::set<RendererLight*> _changedLights;
+	std::set<RendererLight*> _newLights;
+
+	// Regions of lights which have been moved or removed since the last update,
+	// lit objects within these need to re-calculate their lights
+	std::vector<AABB> _changedLightRegions;
+
+	// Spatial index of m_lights
+	LightBVH _lightIndex;
 	typedef std::map<LitObject*, LinearLightList> LightLists;
 	LightLists m_lightLists;
 
 	sigc::signal<void> _sigExtensionsInitialised;
 
 private:
-	void propagateLightChangedFlagToAllLights();
+	// Re-builds the light index after light changes and dirties
+	// the light lists of all objects near the changed lights
+	void updateChangedLights();
+
+	// Assign each shader pass its position in the sorted state map
+	void updateStateRanks();
 
 public:
 
@@ -75,6 +104,9 @@ public:
 
     GLProgramFactory& getGLProgramFactory();
 
+	// The queue collecting the renderables of the next frame
+	RenderQueue& getRenderQueue();
+
 	std::size_t getTime() const;
 	void setTime(std::size_t milliSeconds);
 
@@ -2,6 +2,7 @@
 
 #include <wx/stopwatch.h>
 #include "string/string.h"
+#include "string/convert.h"
 
 namespace render
 {
@@ -14,13 +15,32 @@ class RenderStatistics
 	std::size_t _countStates;
 	std::size_t _countTransforms;
 
+	// Renderables which could re-use the state applied for the preceding one
+	std::size_t _countStatesAvoided;
+
+	// Frame memory used by the renderer front end, and its peak value
+	std::size_t _frameBytes;
+	std::size_t _frameBytesHighWaterMark;
+
 	wxStopWatch _timer;
 public:
+	RenderStatistics() :
+		_countPrims(0),
+		_countStates(0),
+		_countTransforms(0),
+		_countStatesAvoided(0),
+		_frameBytes(0),
+		_frameBytesHighWaterMark(0)
+	{}
+
 	const std::string& getStatString()
     {
         _statStr = "prims: " + string::to_string(_countPrims) +
 				  " | states: " + string::to_string(_countStates) +
+				  " (avoided: " + string::to_string(_countStatesAvoided) + ")" +
 				  " | transforms: "	+ string::to_string(_countTransforms) +
+				  " | frame mem: " + string::to_string(_frameBytes / 1024) +
+				  " KB (peak: " + string::to_string(_frameBytesHighWaterMark / 1024) + " KB)" +
 				  " | msec: " + string::to_string(_timer.Time());
 
 		return _statStr;
@@ -31,10 +51,37 @@ public:
 		_countPrims = 0;
 		_countStates = 0;
 		_countTransforms = 0;
+		_countStatesAvoided = 0;
 
 		_timer.Start();
 	}
 
+	void increasePrimitiveCount()
+	{
+		++_countPrims;
+	}
+
+	void increaseStateCount()
+	{
+		++_countStates;
+	}
+
+	void increaseTransformCount()
+	{
+		++_countTransforms;
+	}
+
+	void increaseStatesAvoided(std::size_t count)
+	{
+		_countStatesAvoided += count;
+	}
+
+	void setFrameMemoryUsage(std::size_t bytes, std::size_t highWaterMark)
+	{
+		_frameBytes = bytes;
+		_frameBytesHighWaterMark = highWaterMark;
+	}
+
 	static RenderStatistics& Instance()
     {
 		static RenderStatistics _instance;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace render
+{
+
+/**
+ * A linear allocator for objects which live for the duration of one frame.
+ *
+ * Memory is handed out from a chain of blocks by bumping an offset, and
+ * released all at once by calling reset() at the end of the frame. Blocks are
+ * never freed, so once the allocator has grown to the size of the largest
+ * frame (the high-water mark) it doesn't perform any heap allocations anymore.
+ *
+ * No destructors are invoked, only trivially destructible types can be created.
+ */
+class FrameAllocator
+{
+private:
+	static const std::size_t BLOCK_SIZE = 64 * 1024;
+
+	struct Block
+	{
+		std::unique_ptr<char[]> data;
+		std::size_t size;
+	};
+	std::vector<Block> _blocks;
+
+	// The block we're currently allocating from, and the offset into it
+	std::size_t _currentBlock;
+	std::size_t _offset;
+
+	std::size_t _bytesUsed;
+	std::size_t _highWaterMark;
+	std::size_t _capacity;
+
+public:
+	FrameAllocator() :
+		_currentBlock(0),
+		_offset(0),
+		_bytesUsed(0),
+		_highWaterMark(0),
+		_capacity(0)
+	{}
+
+	// Non-copyable, handed out pointers refer to the blocks
+	FrameAllocator(const FrameAllocator& other) = delete;
+	FrameAllocator& operator=(const FrameAllocator& other) = delete;
+
+	// Returns uninitialised memory which is valid until the next reset()
+	void* allocate(std::size_t size, std::size_t alignment)
+	{
+		while (_currentBlock < _blocks.size())
+		{
+			Block& block = _blocks[_currentBlock];
+
+			std::size_t start = (_offset + alignment - 1) & ~(alignment - 1);
+
+			if (start + size <= block.size)
+			{
+				_bytesUsed += start + size - _offset;
+				_offset = start + size;
+				_highWaterMark = std::max(_highWaterMark, _bytesUsed);
+
+				return block.data.get() + start;
+			}
+
+			// Move on to the next block, the rest of this one stays unused
+			_bytesUsed += block.size - _offset;
+			++_currentBlock;
+			_offset = 0;
+		}
+
+		// Out of blocks, this is only happening until the high-water mark is reached
+		Block block;
+		block.size = size + alignment > BLOCK_SIZE ? size + alignment : BLOCK_SIZE;
+		block.data.reset(new char[block.size]);
+
+		_capacity += block.size;
+		_blocks.push_back(std::move(block));
+
+		return allocate(size, alignment);
+	}
+
+	// Constructs a new T in the frame memory
+	template<typename T, typename... Args>
+	T* create(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value,
+			"FrameAllocator doesn't invoke destructors");
+
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	// Releases all memory handed out during this frame, keeping the blocks
+	void reset()
+	{
+		_currentBlock = 0;
+		_offset = 0;
+		_bytesUsed = 0;
+	}
+
+	// The number of bytes in use since the last reset (including alignment padding)
+	std::size_t getBytesUsed() const
+	{
+		return _bytesUsed;
+	}
+
+	// The largest number of bytes used within a single frame so far
+	std::size_t getHighWaterMark() const
+	{
+		return _highWaterMark;
+	}
+
+	// The number of bytes allocated from the heap
+	std::size_t getCapacity() const
+	{
+		return _capacity;
+	}
+};
+
+} // namespace render
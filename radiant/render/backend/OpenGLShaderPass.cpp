@@ -1,5 +1,7 @@
 #include "OpenGLShaderPass.h"
 #include "OpenGLShader.h"
+#include "../OpenGLRenderSystem.h"
+#include "../RenderStatistics.h"
 
 #include "math/Matrix4.h"
 #include "math/AABB.h"
@@ -301,6 +303,8 @@ void OpenGLShaderPass::applyState(OpenGLState& current,
                                   std::size_t time,
                                   const IRenderEntity* entity)
 {
+    RenderStatistics::Instance().increaseStateCount();
+
     // Evaluate any shader expressions
     if (_glState.stage0)
     {
@@ -571,7 +575,7 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const Matrix4& modelview,
                                       const RendererLight* light)
 {
-    _renderablesWithoutEntity.push_back(TransformedRenderable(renderable, modelview, light, NULL));
+    _owner.getRenderSystem().getRenderQueue().submit(*this, renderable, modelview, light, NULL);
 }
 
 void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
@@ -579,53 +583,31 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const IRenderEntity& entity,
                                       const RendererLight* light)
 {
-    RenderablesByEntity::iterator i = _renderables.find(&entity);
-
-    if (i == _renderables.end())
-    {
-        i = _renderables.insert(RenderablesByEntity::value_type(&entity, Renderables())).first;
-    }
-
-    i->second.push_back(TransformedRenderable(renderable, modelview, light, &entity));
+    _owner.getRenderSystem().getRenderQueue().submit(*this, renderable, modelview, light, &entity);
 }
 
-// Render the bucket contents
-void OpenGLShaderPass::render(OpenGLState& current,
-                              unsigned int flagsMask,
-                              const Vector3& viewer,
-                              std::size_t time)
+// Prepare rendering a batch of the render queue
+bool OpenGLShaderPass::applyBatchState(OpenGLState& current,
+                                       unsigned int flagsMask,
+                                       const Vector3& viewer,
+                                       std::size_t time,
+                                       const IRenderEntity* entity,
+                                       bool firstBatch)
 {
-    // Reset the texture matrix
-    glMatrixMode(GL_TEXTURE);
-    glLoadMatrixd(Matrix4::getIdentity());
-
-    glMatrixMode(GL_MODELVIEW);
-
-    // Apply our state to the current state object
-    applyState(current, flagsMask, viewer, time, NULL);
-
-    if (!_renderablesWithoutEntity.empty())
-    {
-        renderAllContained(_renderablesWithoutEntity, current, viewer, time);
-    }
-
-    for (RenderablesByEntity::const_iterator i = _renderables.begin();
-         i != _renderables.end();
-         ++i)
+    if (firstBatch)
     {
-        // Apply our state to the current state object
-        applyState(current, flagsMask, viewer, time, i->first);
-
-        if (!stateIsActive())
-        {
-            continue;
-        }
+        // Reset the texture matrix
+        glMatrixMode(GL_TEXTURE);
+        glLoadMatrixd(Matrix4::getIdentity());
 
-        renderAllContained(i->second, current, viewer, time);
+        glMatrixMode(GL_MODELVIEW);
     }
 
-    _renderablesWithoutEntity.clear();
-    _renderables.clear();
+    // Apply our state to the current state object
+    applyState(current, flagsMask, viewer, time, entity);
+
+    // Renderables without entity are not subject to the stage visibility
+    return entity == NULL || stateIsActive();
 }
 
 bool OpenGLShaderPass::stateIsActive()
@@ -701,15 +683,19 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
     glPushMatrix();
 
+    RenderStatistics& stats = RenderStatistics::Instance();
+
     // Iterate over each transformed renderable in the vector
-    for (const TransformedRenderable& r : renderables)
+    for (const TransformedRenderable* r : renderables)
     {
         // If the current iteration's transform matrix was different from the
         // last, apply it and store for the next iteration
         if (transform == NULL ||
-            (transform != r.transform && !transform->isAffineEqual(*r.transform)))
+            (transform != r->transform && !transform->isAffineEqual(*r->transform)))
         {
-            transform = r.transform;
+            transform = r->transform;
+            stats.increaseTransformCount();
+
             glPopMatrix();
             glPushMatrix();
             glMultMatrixd(*transform);
@@ -728,7 +714,7 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
         // If we are using a lighting program and this renderable is lit, set
         // up the lighting calculation
-        const RendererLight* light = r.light;
+        const RendererLight* light = r->light;
         if (current.glProgram && light)
         {
             setUpLightingCalculation(current, light, viewer, *transform, time);
@@ -736,7 +722,8 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
         // Render the renderable
         RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode);
-        r.renderable->render(info);
+        r->renderable->render(info);
+        stats.increasePrimitiveCount();
     }
 
     // Cleanup
@@ -2,9 +2,10 @@
 
 #include "math/Vector3.h"
 #include "iglrender.h"
+#include "RenderQueue.h"
 
 #include <vector>
-#include <map>
+#include <cstdint>
 
 /* FORWARD DECLS */
 class Matrix4;
@@ -20,8 +21,9 @@ class OpenGLShader;
  * @brief A single component pass of an OpenGL shader.
  *
  * Each OpenGLShader may contain multiple passes, which are rendered
- * independently. Each pass retains its own OpenGLState and a list of renderable
- * objects to be rendered in this pass.
+ * independently. Each pass retains its own OpenGLState, the renderable
+ * objects to be rendered in this pass are submitted to the render system's
+ * RenderQueue, which calls back into the pass in state order.
  */
 class OpenGLShaderPass
 {
@@ -30,44 +32,9 @@ class OpenGLShaderPass
 	// The state applied to this bucket
 	OpenGLState _glState;
 
-	/*
-	 * Representation of a transformed-and-lit renderable object. Stores a
-	 * single object, with its transform matrix and illuminating light source.
-	 */
-	struct TransformedRenderable
-	{
-    	// The renderable object
-    	const OpenGLRenderable* renderable;
-
-    	// The modelview transform for this renderable
-    	const Matrix4* transform;
-
-		// The light falling on this obejct
-    	const RendererLight* light;
-
-		// The entity attached to this renderable
-		const IRenderEntity* entity;
-
-		// Constructor
-		TransformedRenderable(const OpenGLRenderable& r,
-							  const Matrix4& t,
-							  const RendererLight* l,
-							  const IRenderEntity* e)
-		: renderable(&r),
-		  transform(&t),
-		  light(l),
-		  entity(e)
-		{}
-	};
-
-	// Vector of transformed renderables using this state
-	typedef std::vector<TransformedRenderable> Renderables;
-	Renderables _renderablesWithoutEntity;
-	
-	// Renderables sorted by RenderEntity
-	typedef std::map<const IRenderEntity*, Renderables> RenderablesByEntity;
-
-	RenderablesByEntity _renderables;
+	// The rank of this pass in the render system's sorted state map,
+	// used as most significant part of the render queue's sort keys
+	std::uint32_t _sortRank;
 
 private:
 
@@ -85,12 +52,6 @@ private:
 
 	void setupTextureMatrix(GLenum textureUnit, const ShaderLayerPtr& stage);
 
-	// Render all of the given TransformedRenderables
-	void renderAllContained(const Renderables& renderables,
-							OpenGLState& current,
-						    const Vector3& viewer,
-							std::size_t time);
-
     /* Helper functions to enable/disable particular GL states */
 
     void setTexture0();
@@ -121,8 +82,12 @@ private:
 
 public:
 
+	// Renderables of a single batch, sharing the same pass and entity
+	typedef std::vector<const TransformedRenderable*> Renderables;
+
 	OpenGLShaderPass(OpenGLShader& owner) :
-		_owner(owner)
+		_owner(owner),
+		_sortRank(0)
 	{}
 
 	/**
@@ -155,33 +120,49 @@ public:
 		return &_glState;
 	}
 
-	/**
-	 * \brief
-     * Render the renderables attached to this shader pass.
-     *
-     * \param current
-     * The current OpenGL state variables.
-     *
-     * \param flagsMask
-     * Mask of allowed render flags.
-     *
-     * \param viewer
-     * Viewer location in world space.
-     *
-     */
-	void render(OpenGLState& current,
-				unsigned int flagsMask,
-				const Vector3& viewer,
-				std::size_t time);
+	std::uint32_t getSortRank() const
+	{
+		return _sortRank;
+	}
 
-	/**
-	 * Returns true if this shaderpass doesn't have anything to render.
-	 */
-	bool empty() const
+	void setSortRank(std::uint32_t rank)
 	{
-		return _renderables.empty() && _renderablesWithoutEntity.empty();
+		_sortRank = rank;
 	}
 
+	/**
+	 * \brief
+	 * Apply the state of this pass before rendering a batch of renderables
+	 * attached to the given entity (which can be NULL).
+	 *
+	 * \param current
+	 * The current OpenGL state variables.
+	 *
+	 * \param flagsMask
+	 * Mask of allowed render flags.
+	 *
+	 * \param viewer
+	 * Viewer location in world space.
+	 *
+	 * \param firstBatch
+	 * True if this is the first batch of this pass in the current frame.
+	 *
+	 * \return
+	 * false if the pass is inactive for this entity and the batch should be skipped.
+	 */
+	bool applyBatchState(OpenGLState& current,
+						 unsigned int flagsMask,
+						 const Vector3& viewer,
+						 std::size_t time,
+						 const IRenderEntity* entity,
+						 bool firstBatch);
+
+	// Render all of the given TransformedRenderables
+	void renderAllContained(const Renderables& renderables,
+							OpenGLState& current,
+							const Vector3& viewer,
+							std::size_t time);
+
 	friend std::ostream& operator<<(std::ostream& st, const OpenGLShaderPass& self);
 };
 
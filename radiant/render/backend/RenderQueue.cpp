@@ -0,0 +1,241 @@
+#include "RenderQueue.h"
+
+#include "OpenGLShaderPass.h"
+#include "../RenderStatistics.h"
+
+#include <algorithm>
+
+namespace render
+{
+
+namespace
+{
+	inline std::size_t hashEntity(const IRenderEntity* entity)
+	{
+		// Fibonacci hashing, the lowest bits of heap addresses are always zero
+		std::uint64_t value = reinterpret_cast<std::uintptr_t>(entity) >> 4;
+		return static_cast<std::size_t>((value * 11400714819323198485ull) >> 32);
+	}
+
+	const std::size_t MIN_ENTITY_SLOTS = 64;
+}
+
+RenderQueue::RenderQueue(FrameAllocator& allocator) :
+	_allocator(allocator),
+	_numEntities(0),
+	_frame(1)
+{}
+
+void RenderQueue::submit(OpenGLShaderPass& pass,
+						 const OpenGLRenderable& renderable,
+						 const Matrix4& modelview,
+						 const RendererLight* light,
+						 const IRenderEntity* entity)
+{
+	SortItem item = { 0, _allocator.create<Submission>(pass,
+		TransformedRenderable(renderable, modelview, light, entity)) };
+	_items.push_back(item);
+}
+
+void RenderQueue::discard(const OpenGLShaderPass& pass)
+{
+	// The submissions stay in the frame memory until it is reset
+	_items.erase(std::remove_if(_items.begin(), _items.end(),
+		[&](const SortItem& item) { return item.submission->pass == &pass; }),
+		_items.end());
+}
+
+void RenderQueue::execute(OpenGLState& current,
+						  unsigned int flagsMask,
+						  const Vector3& viewer,
+						  std::size_t time)
+{
+	if (_items.empty())
+	{
+		return;
+	}
+
+	// Assign the sort keys
+	for (SortItem& item : _items)
+	{
+		item.key = (static_cast<std::uint64_t>(item.submission->pass->getSortRank()) << 32) |
+			getEntityOrdinal(item.submission->renderable.entity);
+	}
+
+	sortItems();
+
+	RenderStatistics& stats = RenderStatistics::Instance();
+
+	const std::size_t count = _items.size();
+	OpenGLShaderPass* previousPass = nullptr;
+
+	for (std::size_t begin = 0; begin < count;)
+	{
+		const Submission& first = *_items[begin].submission;
+
+		// Collect all renderables sharing this pass and entity
+		_batch.clear();
+
+		std::size_t end = begin;
+
+		for (; end < count && _items[end].key == _items[begin].key; ++end)
+		{
+			const Submission& submission = *_items[end].submission;
+
+			if (submission.pass != first.pass) break; // unranked passes might share a key
+
+			_batch.push_back(&submission.renderable);
+		}
+
+		bool firstBatchOfPass = first.pass != previousPass;
+		previousPass = first.pass;
+
+		if (first.pass->applyBatchState(current, flagsMask, viewer, time,
+			first.renderable.entity, firstBatchOfPass))
+		{
+			first.pass->renderAllContained(_batch, current, viewer, time);
+		}
+
+		// Every renderable after the first one is re-using the state applied above
+		stats.increaseStatesAvoided(_batch.size() - 1);
+
+		begin = end;
+	}
+
+	finishFrame();
+}
+
+std::uint32_t RenderQueue::getEntityOrdinal(const IRenderEntity* entity)
+{
+	if (entity == nullptr)
+	{
+		return 0; // renderables without entity go first
+	}
+
+	// Keep the load factor below 0.5
+	if ((_numEntities + 1) * 2 > _entitySlots.size())
+	{
+		growEntitySlots();
+	}
+
+	std::size_t mask = _entitySlots.size() - 1;
+
+	for (std::size_t i = hashEntity(entity) & mask; ; i = (i + 1) & mask)
+	{
+		EntitySlot& slot = _entitySlots[i];
+
+		if (slot.frame != _frame)
+		{
+			slot.entity = entity;
+			slot.ordinal = ++_numEntities;
+			slot.frame = _frame;
+			return slot.ordinal;
+		}
+
+		if (slot.entity == entity)
+		{
+			return slot.ordinal;
+		}
+	}
+}
+
+void RenderQueue::growEntitySlots()
+{
+	std::vector<EntitySlot> oldSlots(std::max(_entitySlots.size() * 2, MIN_ENTITY_SLOTS),
+		EntitySlot{ nullptr, 0, 0 });
+	oldSlots.swap(_entitySlots);
+
+	std::size_t mask = _entitySlots.size() - 1;
+
+	// Only the entities of the current frame need to be carried over
+	for (const EntitySlot& slot : oldSlots)
+	{
+		if (slot.frame != _frame) continue;
+
+		std::size_t i = hashEntity(slot.entity) & mask;
+
+		while (_entitySlots[i].frame == _frame)
+		{
+			i = (i + 1) & mask;
+		}
+
+		_entitySlots[i] = slot;
+	}
+}
+
+void RenderQueue::sortItems()
+{
+	const std::size_t count = _items.size();
+	const std::size_t NUM_DIGITS = sizeof(std::uint64_t);
+
+	// Build the histograms of all digits in one go
+	std::size_t histograms[NUM_DIGITS][256] = {};
+
+	for (const SortItem& item : _items)
+	{
+		for (std::size_t digit = 0; digit < NUM_DIGITS; ++digit)
+		{
+			++histograms[digit][(item.key >> (digit * 8)) & 0xff];
+		}
+	}
+
+	_sortBuffer.resize(count);
+
+	SortItem* source = _items.data();
+	SortItem* target = _sortBuffer.data();
+
+	for (std::size_t digit = 0; digit < NUM_DIGITS; ++digit)
+	{
+		std::size_t* histogram = histograms[digit];
+		const unsigned int shift = static_cast<unsigned int>(digit * 8);
+
+		// Skip this pass if all keys share the same digit, which is the
+		// case for most of the upper bytes of the rank and the ordinal
+		if (histogram[(source[0].key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		// Turn the counts into offsets
+		std::size_t offset = 0;
+
+		for (std::size_t bucket = 0; bucket < 256; ++bucket)
+		{
+			std::size_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			target[histogram[(source[i].key >> shift) & 0xff]++] = source[i];
+		}
+
+		std::swap(source, target);
+	}
+
+	// Make sure the sorted sequence ends up in _items
+	if (source != _items.data())
+	{
+		_items.swap(_sortBuffer);
+	}
+}
+
+void RenderQueue::finishFrame()
+{
+	// Clearing keeps the capacity of the buffers
+	_items.clear();
+	_batch.clear();
+
+	_numEntities = 0;
+
+	// Entity slots of the past frame are invalidated by advancing the frame number,
+	// on wrap-around all slots need to be reset explicitly
+	if (++_frame == 0)
+	{
+		std::fill(_entitySlots.begin(), _entitySlots.end(), EntitySlot{ nullptr, 0, 0 });
+		_frame = 1;
+	}
+}
+
+} // namespace render
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "math/Vector3.h"
+#include "FrameAllocator.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/* FORWARD DECLS */
+class Matrix4;
+class OpenGLRenderable;
+class OpenGLState;
+class RendererLight;
+class IRenderEntity;
+
+namespace render
+{
+
+class OpenGLShaderPass;
+
+/*
+ * Representation of a transformed-and-lit renderable object. Stores a
+ * single object, with its transform matrix and illuminating light source.
+ */
+struct TransformedRenderable
+{
+	// The renderable object
+	const OpenGLRenderable* renderable;
+
+	// The modelview transform for this renderable
+	const Matrix4* transform;
+
+	// The light falling on this obejct
+	const RendererLight* light;
+
+	// The entity attached to this renderable
+	const IRenderEntity* entity;
+
+	// Constructor
+	TransformedRenderable(const OpenGLRenderable& r,
+						  const Matrix4& t,
+						  const RendererLight* l,
+						  const IRenderEntity* e)
+	: renderable(&r),
+	  transform(&t),
+	  light(l),
+	  entity(e)
+	{}
+};
+
+/**
+ * The RenderQueue collects the renderables submitted to all shader passes
+ * of a render system during one frame and renders them in state order.
+ *
+ * Submissions are placed in the render system's FrameAllocator, the queue
+ * only keeps a list of pointers to them. When the queue is executed,
+ * each submission is assigned a 64-bit sort key: the upper 32 bits hold the
+ * rank of its shader pass in the render system's sorted state map (which
+ * orders by sort position, textures and render flags), the lower 32 bits
+ * hold the ordinal of its render entity within this frame (0 for renderables
+ * without entity). The keys are radix-sorted, such that the GL state needs
+ * to be applied only once per pass and entity.
+ *
+ * The frame memory and all buffers keep their capacity between frames, so
+ * once the queue has seen a frame of typical size it doesn't allocate any
+ * memory anymore.
+ */
+class RenderQueue
+{
+private:
+	// The memory the submissions are allocated from
+	FrameAllocator& _allocator;
+
+	struct Submission
+	{
+		OpenGLShaderPass* pass;
+		TransformedRenderable renderable;
+
+		Submission(OpenGLShaderPass& p, const TransformedRenderable& r) :
+			pass(&p),
+			renderable(r)
+		{}
+	};
+
+	// Sort key and submission, plus the buffer used by the radix sort
+	struct SortItem
+	{
+		std::uint64_t key;
+		const Submission* submission;
+	};
+	std::vector<SortItem> _items;
+	std::vector<SortItem> _sortBuffer;
+
+	// Open-addressing table assigning ordinals to the entities of this frame,
+	// slots carrying an older frame number are considered empty
+	struct EntitySlot
+	{
+		const IRenderEntity* entity;
+		std::uint32_t ordinal;
+		std::uint32_t frame;
+	};
+	std::vector<EntitySlot> _entitySlots;
+	std::uint32_t _numEntities;
+	std::uint32_t _frame;
+
+	// The renderables of the batch currently being rendered
+	std::vector<const TransformedRenderable*> _batch;
+
+public:
+	RenderQueue(FrameAllocator& allocator);
+
+	// Queues a renderable for the given pass, the light and entity can be NULL
+	void submit(OpenGLShaderPass& pass,
+				const OpenGLRenderable& renderable,
+				const Matrix4& modelview,
+				const RendererLight* light,
+				const IRenderEntity* entity);
+
+	bool empty() const
+	{
+		return _items.empty();
+	}
+
+	// Drops all submissions of the given pass, to be called before a pass is removed
+	void discard(const OpenGLShaderPass& pass);
+
+	/**
+	 * Sorts and renders all queued renderables, leaving the queue empty.
+	 * The shader passes must have been assigned their sort rank before.
+	 * The owner is responsible for resetting the frame allocator afterwards.
+	 */
+	void execute(OpenGLState& current,
+				 unsigned int flagsMask,
+				 const Vector3& viewer,
+				 std::size_t time);
+
+private:
+	std::uint32_t getEntityOrdinal(const IRenderEntity* entity);
+	void growEntitySlots();
+
+	// Stable LSD radix sort of _items by key
+	void sortItems();
+
+	void finishFrame();
+};
+
+} // namespace render
@@ -4,6 +4,7 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "iscenegraph.h"
+#include "ibrush.h"
 #include <functional>
 
 namespace render
@@ -106,6 +107,10 @@ public:
     static void collectRenderablesInScene(RenderableCollector& collector,
                                           const VolumeTest& volume)
     {
+        // Bring changed brushes up to date in one go, instead of building
+        // them one after the other during the traversal
+        GlobalBrushCreator().evaluatePendingBReps();
+
         // Instantiate a new walker class
         RenderableCollectionWalker renderHighlightWalker(collector, volume);
 
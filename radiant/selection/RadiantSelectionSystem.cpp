@@ -2,6 +2,7 @@
 
 #include "iundo.h"
 #include "igrid.h"
+#include "ibrush.h"
 #include "iradiant.h"
 #include "ieventmanager.h"
 #include "imousetoolmanager.h"
@@ -930,6 +931,9 @@ void RadiantSelectionSystem::cancelMove() {
 void RadiantSelectionSystem::freezeTransforms()
 {
 	GlobalSceneGraph().foreachNode(scene::freezeTransformableNode);
+
+	// Rebuild the transformed brushes in parallel
+	GlobalBrushCreator().evaluatePendingBReps();
     
     // The selection bounds have possibly changed, request an idle callback
     _requestWorkZoneRecalculation = true;
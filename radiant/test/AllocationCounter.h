@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * Counts the heap allocations of a test program by replacing the global
+ * operator new. The replacements are defined in this header, so it must be
+ * included by exactly one source file of each program.
+ */
+namespace test
+{
+
+// Number of heap allocations done by this process so far
+inline std::size_t& allocationCount()
+{
+	static std::size_t count = 0;
+	return count;
+}
+
+// Counts the heap allocations done since its construction
+class AllocationCounter
+{
+private:
+	std::size_t _start;
+
+public:
+	AllocationCounter() :
+		_start(allocationCount())
+	{}
+
+	std::size_t getCount() const
+	{
+		return allocationCount() - _start;
+	}
+};
+
+} // namespace test
+
+void* operator new(std::size_t size)
+{
+	++test::allocationCount();
+
+	void* p = std::malloc(size != 0 ? size : 1);
+
+	if (p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "radiant/patch/PatchTesselationCache.h"
+
+#include <random>
+
+/**
+ * Terrain patches and tesselation helpers shared by the patch tesselation
+ * tests and benchmarks.
+ */
+namespace test
+{
+
+const float SUBDIVIDE_THRESHOLD = 4;
+const std::size_t TERRAIN_SIZE = 31;
+
+// A hilly terrain patch with some degenerate edges
+inline PatchControlArray createTerrain(std::mt19937& generator, std::size_t width, std::size_t height)
+{
+	std::uniform_real_distribution<double> elevation(-64, 64);
+
+	PatchControlArray controlPoints(width * height);
+
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		for (std::size_t x = 0; x < width; ++x)
+		{
+			PatchControl& ctrl = controlPoints[y * width + x];
+
+			ctrl.vertex = Vector3(x * 64.0, y * 64.0, elevation(generator));
+			ctrl.texcoord = Vector2(x / 4.0, y / 4.0);
+		}
+	}
+
+	controlPoints[1].vertex = controlPoints[0].vertex;
+	controlPoints[width + 1].vertex = controlPoints[width].vertex;
+
+	return controlPoints;
+}
+
+inline void generate(PatchTesselation& tess, std::size_t width, std::size_t height, const PatchControlArray& controlPoints)
+{
+	tess.generate(width, height, controlPoints, false, Subdivisions(4, 4), SUBDIVIDE_THRESHOLD);
+}
+
+inline void update(PatchTesselationCache& cache, PatchTesselationPtr& tess, Vector3& offset,
+	std::size_t width, std::size_t height, const PatchControlArray& controlPoints)
+{
+	cache.update(tess, offset, width, height, controlPoints, false, Subdivisions(4, 4), SUBDIVIDE_THRESHOLD);
+}
+
+inline PatchControlArray getTranslated(const PatchControlArray& controlPoints, const Vector3& translation)
+{
+	PatchControlArray translated(controlPoints);
+
+	for (PatchControlIter i = translated.begin(); i != translated.end(); ++i)
+	{
+		i->vertex += translation;
+	}
+
+	return translated;
+}
+
+} // namespace test
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "radiant/brush/FixedWinding.h"
+#include "radiant/brush/Brush.h"
+#include "radiant/brush/Winding.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * Random convex brushes and the previous vector-based winding, shared by
+ * the winding tests and benchmarks.
+ */
+namespace test
+{
+
+inline DoubleLine intersectPlanes(const Plane3& plane, const Plane3& other)
+{
+	DoubleLine line;
+	line.direction = plane.normal().crossProduct(other.normal());
+
+	int axis = fabs(line.direction[1]) > fabs(line.direction[0])
+		? (fabs(line.direction[1]) > fabs(line.direction[2]) ? 1 : 2)
+		: (fabs(line.direction[0]) > fabs(line.direction[2]) ? 0 : 2);
+
+	switch (axis) {
+	case 0:
+		line.origin.x() = 0;
+		line.origin.y() = (-other.dist() * plane.normal().z() - -plane.dist() * other.normal().z()) / line.direction.x();
+		line.origin.z() = (-plane.dist() * other.normal().y() - -other.dist() * plane.normal().y()) / line.direction.x();
+		break;
+	case 1:
+		line.origin.x() = (-plane.dist() * other.normal().z() - -other.dist() * plane.normal().z()) / line.direction.y();
+		line.origin.y() = 0;
+		line.origin.z() = (-other.dist() * plane.normal().x() - -plane.dist() * other.normal().x()) / line.direction.y();
+		break;
+	default:
+		line.origin.x() = (-other.dist() * plane.normal().y() - -plane.dist() * other.normal().y()) / line.direction.z();
+		line.origin.y() = (-plane.dist() * other.normal().x() - -other.dist() * plane.normal().x()) / line.direction.z();
+		line.origin.z() = 0;
+		break;
+	}
+
+	return line;
+}
+
+// The previous vector-based FixedWinding, allocating its storage on construction
+class ReferenceWinding :
+	public std::vector<FixedWindingVertex>
+{
+public:
+	ReferenceWinding()
+	{
+		reserve(MAX_POINTS_ON_WINDING);
+	}
+
+	void createInfinite(const Plane3& plane, double infinity)
+	{
+		FixedWinding winding;
+		winding.createInfinite(plane, infinity);
+
+		for (std::size_t i = 0; i < winding.size(); ++i)
+		{
+			push_back(winding[i]);
+		}
+	}
+
+	void clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, ReferenceWinding& clipped)
+	{
+		if (size() == 0) {
+			return;
+		}
+
+		PlaneClassification classification = Winding::classifyDistance(clipPlane.distanceToPoint(back().vertex), ON_EPSILON);
+		PlaneClassification nextClassification;
+
+		for (std::size_t next = 0, i = size() - 1;
+			 next != size();
+			 i = next, ++next, classification = nextClassification)
+		{
+			nextClassification = Winding::classifyDistance(clipPlane.distanceToPoint((*this)[next].vertex), ON_EPSILON);
+			const FixedWindingVertex& vertex = (*this)[i];
+
+			if (classification == ePlaneOn) {
+				if (nextClassification == ePlaneBack) {
+					clipped.push_back(
+						FixedWindingVertex(vertex.vertex, intersectPlanes(plane, clipPlane), adjacent)
+					);
+				}
+				else {
+					clipped.push_back(vertex);
+				}
+				continue;
+			}
+
+			if (classification == ePlaneFront) {
+				clipped.push_back(vertex);
+			}
+
+			if (nextClassification == ePlaneOn) {
+				continue;
+			}
+			else if (nextClassification == classification) {
+				continue;
+			}
+			else if (classification == ePlaneFront && size() == 2) {
+				continue;
+			}
+			else {
+				Vector3 mid(vertex.edge.intersectPlane(clipPlane));
+
+				if (classification == ePlaneFront) {
+					clipped.push_back(FixedWindingVertex(mid,
+							intersectPlanes(plane, clipPlane), adjacent));
+				} else {
+					clipped.push_back(FixedWindingVertex(mid, vertex.edge,
+							vertex.adjacent));
+				}
+			}
+		}
+	}
+};
+
+const double MAX_WORLD_COORD = 65536;
+
+// The face planes of a convex brush around the origin
+typedef std::vector<Plane3> BrushPlanes;
+
+inline BrushPlanes createRandomBrush(std::mt19937& generator, std::size_t numPlanes)
+{
+	std::normal_distribution<double> direction(0, 1);
+	std::uniform_real_distribution<double> distance(32, 256);
+
+	BrushPlanes planes;
+
+	while (planes.size() < numPlanes)
+	{
+		Vector3 normal(direction(generator), direction(generator), direction(generator));
+
+		if (normal.getLength() < 0.01)
+		{
+			continue;
+		}
+
+		planes.push_back(Plane3(normal.getNormalised(), distance(generator)));
+	}
+
+	return planes;
+}
+
+// Same as Brush::windingForClipPlane, on a plain list of planes
+template<typename WindingType>
+void windingForPlane(const BrushPlanes& planes, std::size_t index, WindingType& result)
+{
+	WindingType buffer[2];
+	bool swap = false;
+
+	const Plane3& plane = planes[index];
+
+	buffer[swap].createInfinite(plane, MAX_WORLD_COORD + 1);
+
+	for (std::size_t i = 0; i < planes.size(); ++i)
+	{
+		if (i == index) continue;
+
+		buffer[!swap].clear();
+
+		Plane3 clipPlane(-planes[i].normal(), -planes[i].dist());
+		buffer[swap].clip(plane, clipPlane, i, buffer[!swap]);
+
+		swap = !swap;
+	}
+
+	for (std::size_t i = 0; i < buffer[swap].size(); ++i)
+	{
+		result.push_back(buffer[swap][i]);
+	}
+}
+
+template<typename WindingType>
+std::size_t countBrushVertices(const std::vector<BrushPlanes>& brushes)
+{
+	std::size_t count = 0;
+
+	for (const BrushPlanes& brush : brushes)
+	{
+		for (std::size_t i = 0; i < brush.size(); ++i)
+		{
+			WindingType winding;
+			windingForPlane(brush, i, winding);
+			count += winding.size();
+		}
+	}
+
+	return count;
+}
+
+} // namespace test
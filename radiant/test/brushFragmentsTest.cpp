@@ -0,0 +1,187 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE brushFragmentsTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/brush/csg/BrushFragments.h"
+
+using namespace brush::algorithm;
+
+namespace
+{
+	const double MAX_WORLD_COORD = 65536;
+
+	// The outward facing planes of a box
+	FragmentFaces createBox(const Vector3& mins, const Vector3& maxs)
+	{
+		FragmentFaces faces;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			Vector3 normal(0, 0, 0);
+
+			normal[axis] = 1;
+			faces.push_back(FragmentFace(Plane3(normal, maxs[axis]), NULL, false));
+
+			normal[axis] = -1;
+			faces.push_back(FragmentFace(Plane3(normal, -mins[axis]), NULL, false));
+		}
+
+		return faces;
+	}
+
+	SubtractedVolume createSubtractedBox(const Vector3& mins, const Vector3& maxs)
+	{
+		SubtractedVolume volume;
+		volume.faces = createBox(mins, maxs);
+		volume.bounds = AABB::createFromMinMax(mins, maxs);
+		return volume;
+	}
+
+	double getVolume(const AABB& bounds)
+	{
+		return bounds.extents.x() * bounds.extents.y() * bounds.extents.z() * 8;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(boxVolume)
+{
+	ConvexVolume volume(createBox(Vector3(-64, -32, 0), Vector3(64, 32, 16)), MAX_WORLD_COORD);
+
+	BOOST_CHECK_EQUAL(volume.getBounds().origin, Vector3(0, 0, 8));
+	BOOST_CHECK_EQUAL(volume.getBounds().extents, Vector3(64, 32, 8));
+
+	// 6 faces with 4 vertices each
+	BrushSplitType split = volume.classifyPlane(Plane3(1, 0, 0, 0));
+	BOOST_CHECK_EQUAL(split.counts[ePlaneFront], 12);
+	BOOST_CHECK_EQUAL(split.counts[ePlaneBack], 12);
+	BOOST_CHECK_EQUAL(split.counts[ePlaneOn], 0);
+}
+
+BOOST_AUTO_TEST_CASE(unboundedVolumeIsEmpty)
+{
+	FragmentFaces faces = createBox(Vector3(-64, -64, -64), Vector3(64, 64, 64));
+	faces.pop_back();
+
+	ConvexVolume volume(faces, MAX_WORLD_COORD);
+
+	// Like Brush::localAABB() the bounds still cover the unclipped windings
+	BOOST_CHECK(volume.getBounds().isValid());
+
+	BrushSplitType split = volume.classifyPlane(Plane3(1, 0, 0, 0));
+	BOOST_CHECK_EQUAL(split.counts[ePlaneFront] + split.counts[ePlaneBack] + split.counts[ePlaneOn], 0);
+}
+
+// The expected counts are the ones of the windings a Brush with the same planes ends up with
+BOOST_AUTO_TEST_CASE(sliverFacesDontContribute)
+{
+	// A box with one of its vertical edges bevelled by less than the winding epsilon
+	FragmentFaces faces = createBox(Vector3(0, 0, 0), Vector3(64, 64, 64));
+	faces.push_back(FragmentFace(Plane3(Vector3(1, 1, 0).getNormalised(), 128 / sqrt(2.0) - 0.001), NULL, false));
+
+	ConvexVolume volume(faces, MAX_WORLD_COORD);
+
+	// The bevel face is removed and the short edges are merged into single vertices,
+	// which leaves 6 faces with 4 vertices each
+	BrushSplitType split = volume.classifyPlane(Plane3(1, 0, 0, 32));
+	BOOST_CHECK_EQUAL(split.counts[ePlaneFront], 12);
+	BOOST_CHECK_EQUAL(split.counts[ePlaneBack], 12);
+	BOOST_CHECK_EQUAL(split.counts[ePlaneOn], 0);
+
+	// It is cut like the box without the bevel
+	std::vector<FragmentFaces> fragments;
+	BOOST_REQUIRE(subtractVolume(faces, createSubtractedBox(Vector3(32, 32, 32), Vector3(128, 128, 128)),
+		MAX_WORLD_COORD, fragments));
+	BOOST_CHECK_EQUAL(fragments.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(sliverVolumeIsEmpty)
+{
+	// Thinner than the winding epsilon, all side faces are degenerate
+	FragmentFaces faces = createBox(Vector3(0, 0, 0), Vector3(64, 64, 0.001));
+
+	ConvexVolume volume(faces, MAX_WORLD_COORD);
+
+	BrushSplitType split = volume.classifyPlane(Plane3(1, 0, 0, 32));
+	BOOST_CHECK_EQUAL(split.counts[ePlaneFront] + split.counts[ePlaneBack] + split.counts[ePlaneOn], 0);
+
+	// Brush_subtract() leaves brushes without a b-rep alone
+	std::vector<FragmentFaces> fragments;
+	BOOST_CHECK(!subtractVolume(faces, createSubtractedBox(Vector3(32, 32, -32), Vector3(128, 128, 32)),
+		MAX_WORLD_COORD, fragments));
+	BOOST_CHECK(fragments.empty());
+}
+
+BOOST_AUTO_TEST_CASE(subtractOverlappingBox)
+{
+	FragmentFaces box = createBox(Vector3(-64, -64, -64), Vector3(64, 64, 64));
+	SubtractedVolume corner = createSubtractedBox(Vector3(0, 0, 0), Vector3(128, 128, 128));
+
+	std::vector<FragmentFaces> fragments;
+	BOOST_REQUIRE(subtractVolume(box, corner, MAX_WORLD_COORD, fragments));
+
+	// The box is cut by three planes of the corner
+	BOOST_REQUIRE_EQUAL(fragments.size(), 3);
+
+	double volume = 0;
+
+	for (std::size_t i = 0; i < fragments.size(); ++i)
+	{
+		const FragmentFaces& fragment = fragments[i];
+
+		// The faces of the box and the previous cuts, followed by the flipped cutting face
+		BOOST_REQUIRE_EQUAL(fragment.size(), box.size() + i + 1);
+		BOOST_CHECK(fragment.back().flipped);
+		BOOST_CHECK_EQUAL(fragment.back().plane, -corner.faces[2 * i + 1].plane);
+
+		volume += getVolume(ConvexVolume(fragment, MAX_WORLD_COORD).getBounds());
+	}
+
+	BOOST_CHECK_CLOSE(volume, 128.0 * 128 * 128 - 64.0 * 64 * 64, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(subtractDisjointAndEnclosingBoxes)
+{
+	FragmentFaces box = createBox(Vector3(0, 0, 0), Vector3(64, 64, 64));
+
+	SubtractedVolume disjoint = createSubtractedBox(Vector3(128, 0, 0), Vector3(192, 64, 64));
+	SubtractedVolume enclosing = createSubtractedBox(Vector3(-8, -8, -8), Vector3(72, 72, 72));
+
+	std::vector<FragmentFaces> fragments;
+	BOOST_CHECK(!subtractVolume(box, disjoint, MAX_WORLD_COORD, fragments));
+	BOOST_CHECK(fragments.empty());
+
+	std::vector<const SubtractedVolume*> volumes(1, &disjoint);
+	BOOST_CHECK(!subtractVolumes(box, volumes, MAX_WORLD_COORD, fragments));
+	BOOST_REQUIRE_EQUAL(fragments.size(), 1);
+	BOOST_CHECK_EQUAL(fragments.front().size(), box.size());
+
+	// Enclosed brushes are removed entirely
+	volumes.push_back(&enclosing);
+	BOOST_CHECK(subtractVolumes(box, volumes, MAX_WORLD_COORD, fragments));
+	BOOST_CHECK(fragments.empty());
+}
+
+BOOST_AUTO_TEST_CASE(subtractSeveralBoxes)
+{
+	// Carving two holes into a slab
+	FragmentFaces slab = createBox(Vector3(0, 0, 0), Vector3(256, 256, 16));
+
+	SubtractedVolume first = createSubtractedBox(Vector3(32, 32, -8), Vector3(64, 64, 24));
+	SubtractedVolume second = createSubtractedBox(Vector3(160, 160, -8), Vector3(192, 192, 24));
+
+	std::vector<const SubtractedVolume*> volumes;
+	volumes.push_back(&first);
+	volumes.push_back(&second);
+
+	std::vector<FragmentFaces> fragments;
+	BOOST_REQUIRE(subtractVolumes(slab, volumes, MAX_WORLD_COORD, fragments));
+
+	double volume = 0;
+
+	for (const FragmentFaces& fragment : fragments)
+	{
+		volume += getVolume(ConvexVolume(fragment, MAX_WORLD_COORD).getBounds());
+	}
+
+	BOOST_CHECK_CLOSE(volume, 256.0 * 256 * 16 - 2 * 32.0 * 32 * 16, 0.001);
+}
@@ -0,0 +1,45 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE fixedWindingBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "TestWindings.h"
+#include "AllocationCounter.h"
+
+#include <chrono>
+
+using namespace test;
+
+// Compares building the windings of random convex brushes
+BOOST_AUTO_TEST_CASE(brushClipping)
+{
+	std::mt19937 generator(42);
+
+	std::vector<BrushPlanes> brushes;
+
+	for (int b = 0; b < 20000; ++b)
+	{
+		brushes.push_back(createRandomBrush(generator, 6 + b % 12));
+	}
+
+	AllocationCounter referenceCounter;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::size_t referenceVertices = countBrushVertices<ReferenceWinding>(brushes);
+
+	std::size_t referenceAllocations = referenceCounter.getCount();
+	AllocationCounter counter;
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	std::size_t vertices = countBrushVertices<FixedWinding>(brushes);
+
+	std::size_t allocations = counter.getCount();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_CHECK_EQUAL(vertices, referenceVertices);
+
+	BOOST_TEST_MESSAGE("Windings of " << brushes.size() << " brushes: vector windings "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count() << " ms, "
+		<< referenceAllocations << " allocations, inline windings "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count() << " ms, "
+		<< allocations << " allocations");
+}
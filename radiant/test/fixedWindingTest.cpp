@@ -0,0 +1,83 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE fixedWindingTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestWindings.h"
+#include "AllocationCounter.h"
+
+using namespace test;
+
+
+BOOST_AUTO_TEST_CASE(clipsLikeVectorWinding)
+{
+	std::mt19937 generator(17);
+
+	for (int b = 0; b < 200; ++b)
+	{
+		BrushPlanes brush = createRandomBrush(generator, 4 + b % 40);
+
+		for (std::size_t i = 0; i < brush.size(); ++i)
+		{
+			FixedWinding winding;
+			ReferenceWinding reference;
+
+			windingForPlane(brush, i, winding);
+			windingForPlane(brush, i, reference);
+
+			BOOST_REQUIRE_EQUAL(winding.size(), reference.size());
+
+			for (std::size_t v = 0; v < winding.size(); ++v)
+			{
+				BOOST_CHECK_EQUAL(winding[v].vertex, reference[v].vertex);
+				BOOST_CHECK_EQUAL(winding[v].adjacent, reference[v].adjacent);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(regularWindingsDontAllocate)
+{
+	std::mt19937 generator(42);
+
+	std::vector<BrushPlanes> brushes;
+
+	for (int b = 0; b < 500; ++b)
+	{
+		brushes.push_back(createRandomBrush(generator, 6 + b % 12));
+	}
+
+	AllocationCounter allocations;
+
+	BOOST_CHECK(countBrushVertices<FixedWinding>(brushes) > 0);
+	BOOST_CHECK_EQUAL(allocations.getCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(growsBeyondInlineStorage)
+{
+	FixedWinding winding;
+	DoubleLine edge;
+
+	for (std::size_t i = 0; i < MAX_POINTS_ON_WINDING; ++i)
+	{
+		winding.push_back(FixedWindingVertex(Vector3(i, 0, 0), edge, i));
+	}
+
+	BOOST_CHECK(!winding.isOnHeap());
+
+	for (std::size_t i = MAX_POINTS_ON_WINDING; i < 5 * MAX_POINTS_ON_WINDING; ++i)
+	{
+		winding.push_back(FixedWindingVertex(Vector3(i, 0, 0), edge, i));
+	}
+
+	BOOST_CHECK(winding.isOnHeap());
+	BOOST_REQUIRE_EQUAL(winding.size(), 5 * MAX_POINTS_ON_WINDING);
+
+	for (std::size_t i = 0; i < winding.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(winding[i].adjacent, i);
+		BOOST_CHECK_EQUAL(winding[i].vertex.x(), i);
+	}
+
+	winding.clear();
+	BOOST_CHECK(winding.empty());
+}
@@ -0,0 +1,120 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE patchTesselationBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include "TestPatches.h"
+#include "AllocationCounter.h"
+
+#include <chrono>
+
+using namespace test;
+
+// Compares re-tesselating a whole terrain patch to updating the changed parts
+BOOST_AUTO_TEST_CASE(vertexDrag)
+{
+	const int numSteps = 500;
+
+	std::mt19937 generator(42);
+	PatchControlArray controlPoints = createTerrain(generator, TERRAIN_SIZE, TERRAIN_SIZE);
+
+	// Dragging a vertex in the middle of the patch up and down
+	PatchControl& dragged = controlPoints[(TERRAIN_SIZE / 2) * TERRAIN_SIZE + TERRAIN_SIZE / 2];
+	const double elevation = dragged.vertex.z();
+
+	PatchTesselation tess;
+	generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < numSteps; ++i)
+	{
+		dragged.vertex.z() = elevation + (i % 2);
+
+		PatchTesselation full;
+		generate(full, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+	}
+
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	// The first update fills up the buffers
+	dragged.vertex.z() = elevation + 1;
+	generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+	AllocationCounter counter;
+
+	for (int i = 0; i < numSteps; ++i)
+	{
+		dragged.vertex.z() = elevation + (i % 2);
+		generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+	}
+
+	std::size_t allocations = counter.getCount();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_TEST_MESSAGE("Dragging a vertex of a " << TERRAIN_SIZE << "x" << TERRAIN_SIZE << " patch " << numSteps
+		<< " times: full tesselation " << std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count()
+		<< " ms, incremental " << std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count()
+		<< " ms, " << allocations << " allocations");
+}
+
+// Compares tesselating many copies of a few patches with and without the cache
+BOOST_AUTO_TEST_CASE(identicalPatches)
+{
+	const std::size_t numShapes = 4;
+	const std::size_t numCopies = 500;
+	const std::size_t size = 9;
+
+	std::mt19937 generator(1);
+	std::vector<PatchControlArray> shapes;
+
+	for (std::size_t i = 0; i < numShapes; ++i)
+	{
+		shapes.push_back(createTerrain(generator, size, size));
+	}
+
+	std::vector<PatchControlArray> patches;
+
+	for (std::size_t i = 0; i < numShapes * numCopies; ++i)
+	{
+		patches.push_back(getTranslated(shapes[i % numShapes], Vector3((i % 64) * 1024.0, (i / 64) * 1024.0, 0)));
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::size_t uncachedVertices = 0;
+
+	for (std::size_t i = 0; i < patches.size(); ++i)
+	{
+		PatchTesselation tess;
+		generate(tess, size, size, patches[i]);
+		uncachedVertices += tess.vertices.size();
+	}
+
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+	PatchTesselationCache cache;
+	std::vector<PatchTesselationPtr> tesselations(patches.size());
+	Vector3 offset;
+
+	for (std::size_t i = 0; i < patches.size(); ++i)
+	{
+		update(cache, tesselations[i], offset, size, size, patches[i]);
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	BOOST_CHECK_EQUAL(cache.getNumTesselations(), numShapes);
+
+	std::size_t cachedVertices = 0;
+
+	for (std::size_t i = 0; i < numShapes; ++i)
+	{
+		cachedVertices += tesselations[i]->vertices.size();
+	}
+
+	BOOST_TEST_MESSAGE("Tesselating " << patches.size() << " copies of " << numShapes << " patches: "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count() << " ms and "
+		<< uncachedVertices << " vertices without cache, "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count() << " ms and "
+		<< cachedVertices << " vertices with cache");
+}
@@ -0,0 +1,252 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE patchTesselationTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestPatches.h"
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace test;
+
+namespace
+{
+
+// Maps use grid-snapped coordinates, which are translated without rounding errors
+void snapToGrid(PatchControlArray& controlPoints)
+{
+	for (PatchControlIter i = controlPoints.begin(); i != controlPoints.end(); ++i)
+	{
+		i->vertex.snap(0.125);
+	}
+}
+
+void checkSameTesselation(const PatchTesselation& tess, const PatchTesselation& expected)
+{
+	BOOST_REQUIRE_EQUAL(tess.m_nArrayWidth, expected.m_nArrayWidth);
+	BOOST_REQUIRE_EQUAL(tess.m_nArrayHeight, expected.m_nArrayHeight);
+	BOOST_REQUIRE_EQUAL(tess.m_numStrips, expected.m_numStrips);
+	BOOST_REQUIRE_EQUAL(tess.m_lenStrips, expected.m_lenStrips);
+
+	// Only the strips are compared, the index array might be a bit larger than that
+	BOOST_REQUIRE(std::equal(expected.indices.begin(), expected.indices.begin() + expected.m_numStrips * expected.m_lenStrips,
+		tess.indices.begin()));
+	BOOST_REQUIRE_EQUAL(tess.vertices.size(), expected.vertices.size());
+
+	// Bitwise comparison, degenerate texture coordinates produce NaN tangents
+	for (std::size_t i = 0; i < tess.vertices.size(); ++i)
+	{
+		BOOST_REQUIRE(std::memcmp(&tess.vertices[i], &expected.vertices[i], sizeof(ArbitraryMeshVertex)) == 0);
+	}
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(curveTreesAreSubdivided)
+{
+	std::mt19937 generator(3);
+	PatchControlArray controlPoints = createTerrain(generator, 5, 3);
+
+	PatchTesselation tess;
+	generate(tess, 5, 3, controlPoints);
+
+	BOOST_REQUIRE_EQUAL(tess.curveTreeU.size(), 2);
+	BOOST_REQUIRE_EQUAL(tess.curveTreeV.size(), 1);
+	BOOST_CHECK(!tess.curveTreeU[0]->isLeaf());
+	BOOST_CHECK_EQUAL(tess.vertices.size(), tess.m_nArrayWidth * tess.m_nArrayHeight);
+
+	// A flat grid doesn't need any subdivisions, not even the middle control points
+	for (std::size_t i = 0; i < controlPoints.size(); ++i)
+	{
+		controlPoints[i].vertex = Vector3((i % 5) * 64.0, (i / 5) * 64.0, 0);
+	}
+
+	generate(tess, 5, 3, controlPoints);
+
+	BOOST_CHECK(tess.curveTreeU[0]->isLeaf());
+	BOOST_CHECK(tess.curveTreeU[1]->isLeaf());
+	BOOST_CHECK(tess.curveTreeV[0]->isLeaf());
+	BOOST_CHECK_EQUAL(tess.m_nArrayWidth, 3);
+	BOOST_CHECK_EQUAL(tess.m_nArrayHeight, 2);
+	BOOST_CHECK_EQUAL(tess.vertices.size(), 6);
+}
+
+BOOST_AUTO_TEST_CASE(incrementalUpdateMatchesFullTesselation)
+{
+	std::mt19937 generator(11);
+	std::uniform_int_distribution<std::size_t> coordinate(0, TERRAIN_SIZE - 1);
+	std::uniform_real_distribution<double> offset(-2, 2);
+
+	PatchControlArray controlPoints = createTerrain(generator, TERRAIN_SIZE, TERRAIN_SIZE);
+
+	PatchTesselation tess;
+	generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+	for (int step = 0; step < 200; ++step)
+	{
+		PatchControl& ctrl = controlPoints[coordinate(generator) * TERRAIN_SIZE + coordinate(generator)];
+
+		switch (step % 4)
+		{
+		case 0:
+			// Small vertical moves, keeping the subdivisions
+			ctrl.vertex.z() += offset(generator);
+			break;
+		case 1:
+			ctrl.texcoord += Vector2(0.5, 0);
+			break;
+		case 2:
+			// Large moves, changing the subdivisions of the column or row
+			ctrl.vertex.z() += offset(generator) * 100;
+			break;
+		default:
+			ctrl.vertex = controlPoints[0].vertex;
+			break;
+		}
+
+		generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+		PatchTesselation expected;
+		generate(expected, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+		checkSameTesselation(tess, expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(fixedSubdivisions)
+{
+	std::mt19937 generator(7);
+	PatchControlArray controlPoints = createTerrain(generator, 7, 5);
+
+	PatchTesselation tess;
+	tess.generate(7, 5, controlPoints, true, Subdivisions(3, 5), SUBDIVIDE_THRESHOLD);
+
+	BOOST_CHECK(tess.curveTreeU.empty());
+	BOOST_CHECK_EQUAL(tess.m_nArrayWidth, 3 * 3 + 1);
+	BOOST_CHECK_EQUAL(tess.m_nArrayHeight, 2 * 5 + 1);
+	BOOST_CHECK_EQUAL(tess.vertices.size(), tess.m_nArrayWidth * tess.m_nArrayHeight);
+
+	// Switching back to variable subdivisions
+	generate(tess, 7, 5, controlPoints);
+
+	PatchTesselation expected;
+	generate(expected, 7, 5, controlPoints);
+
+	checkSameTesselation(tess, expected);
+}
+
+BOOST_AUTO_TEST_CASE(incrementalUpdatesDontAllocate)
+{
+	std::mt19937 generator(42);
+	PatchControlArray controlPoints = createTerrain(generator, TERRAIN_SIZE, TERRAIN_SIZE);
+
+	// Dragging a vertex in the middle of the patch up and down
+	PatchControl& dragged = controlPoints[(TERRAIN_SIZE / 2) * TERRAIN_SIZE + TERRAIN_SIZE / 2];
+	const double elevation = dragged.vertex.z();
+
+	PatchTesselation tess;
+	generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+	// The first update fills up the buffers
+	dragged.vertex.z() = elevation + 1;
+	generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+
+	AllocationCounter allocations;
+
+	for (int i = 0; i < 20; ++i)
+	{
+		dragged.vertex.z() = elevation + (i % 2);
+		generate(tess, TERRAIN_SIZE, TERRAIN_SIZE, controlPoints);
+	}
+
+	BOOST_CHECK_EQUAL(allocations.getCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(identicalPatchesShareTesselation)
+{
+	std::mt19937 generator(5);
+	PatchControlArray controlPoints = createTerrain(generator, 9, 5);
+	snapToGrid(controlPoints);
+
+	PatchControlArray translated = getTranslated(controlPoints, Vector3(512, -1024, 64));
+
+	PatchTesselationCache cache;
+
+	PatchTesselationPtr first;
+	PatchTesselationPtr second;
+	Vector3 firstOffset;
+	Vector3 secondOffset;
+
+	update(cache, first, firstOffset, 9, 5, controlPoints);
+	update(cache, second, secondOffset, 9, 5, translated);
+
+	BOOST_REQUIRE(first);
+	BOOST_CHECK(first == second);
+	BOOST_CHECK_EQUAL(firstOffset, controlPoints[0].vertex);
+	BOOST_CHECK_EQUAL(secondOffset, translated[0].vertex);
+	BOOST_CHECK_EQUAL(cache.getNumTesselations(), 1);
+
+	// The shared tesselation is relative to the first control point
+	PatchTesselation absolute;
+	generate(absolute, 9, 5, translated);
+
+	BOOST_REQUIRE_EQUAL(second->vertices.size(), absolute.vertices.size());
+
+	for (std::size_t i = 0; i < absolute.vertices.size(); ++i)
+	{
+		BOOST_CHECK((second->vertices[i].vertex + secondOffset).isEqual(absolute.vertices[i].vertex, 0.001));
+	}
+
+	// Changing one of the patches doesn't affect the other one
+	translated[12].vertex.z() += 32;
+	update(cache, second, secondOffset, 9, 5, translated);
+
+	BOOST_CHECK(first != second);
+	BOOST_CHECK_EQUAL(cache.getNumTesselations(), 2);
+
+	PatchTesselation expected;
+	generate(expected, 9, 5, getTranslated(controlPoints, -controlPoints[0].vertex));
+	checkSameTesselation(*first, expected);
+
+	// Changing it back shares the tesselation again, the other one expires
+	translated[12].vertex.z() -= 32;
+	update(cache, second, secondOffset, 9, 5, translated);
+
+	BOOST_CHECK(first == second);
+	BOOST_CHECK_EQUAL(cache.getNumTesselations(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(uniqueTesselationIsUpdatedInPlace)
+{
+	std::mt19937 generator(9);
+	PatchControlArray controlPoints = createTerrain(generator, 9, 9);
+	snapToGrid(controlPoints);
+
+	PatchTesselationCache cache;
+	PatchTesselationPtr tess;
+	Vector3 offset;
+
+	update(cache, tess, offset, 9, 9, controlPoints);
+	const PatchTesselation* original = tess.get();
+
+	// Moving the whole patch only changes the offset
+	controlPoints = getTranslated(controlPoints, Vector3(64, 64, 0));
+	update(cache, tess, offset, 9, 9, controlPoints);
+
+	BOOST_CHECK_EQUAL(tess.get(), original);
+	BOOST_CHECK_EQUAL(offset, controlPoints[0].vertex);
+
+	controlPoints[40].vertex.z() += 16;
+	update(cache, tess, offset, 9, 9, controlPoints);
+
+	BOOST_CHECK_EQUAL(tess.get(), original);
+	BOOST_CHECK_EQUAL(cache.getNumTesselations(), 1);
+
+	// The cache finds the tesselation under its new key
+	PatchTesselationPtr other;
+	Vector3 otherOffset;
+	update(cache, other, otherOffset, 9, 9, getTranslated(controlPoints, Vector3(0, 0, 128)));
+
+	BOOST_CHECK(other == tess);
+}
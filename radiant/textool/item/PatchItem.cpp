@@ -28,7 +28,7 @@ void PatchItem::render() {
 	glColor3f(1, 1, 1);
 
 	// Get the tesselation and the first
-	PatchTesselation& tess = _sourcePatch.getTesselation();
+	const PatchTesselation& tess = _sourcePatch.getTesselation();
 
 	const RenderIndex* strip_indices = &tess.indices.front();
 
@@ -39,7 +39,7 @@ void PatchItem::render() {
 		for (std::size_t offset = 0; offset < tess.m_lenStrips; offset++)
 		{
 			// Retrieve the mesh vertex from the line strip
-			ArbitraryMeshVertex& meshVertex = tess.vertices[*(strip_indices + offset)];
+			const ArbitraryMeshVertex& meshVertex = tess.vertices[*(strip_indices + offset)];
 			glVertex2d(meshVertex.texcoord[0], meshVertex.texcoord[1]);
 		}
 
@@ -641,6 +641,16 @@ void TextureBrowser::performUpdate()
     CurrentPosition layout;
     _entireSpaceHeight = 0;
 
+    // Request all editor images first, the layout needs their sizes
+    // which lets the background loader decode the images in parallel
+    GlobalMaterialManager().foreachMaterial([&](const MaterialPtr& mat)
+    {
+        if (materialIsVisible(mat))
+        {
+            mat->getEditorImage();
+        }
+    });
+
     GlobalMaterialManager().foreachMaterial([&](const MaterialPtr& mat)
     {
         if (!materialIsVisible(mat))